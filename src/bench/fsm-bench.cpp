@@ -0,0 +1,662 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <random>
+#include <atomic>
+#include <algorithm>
+#include <numeric>
+#include <functional>
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include "interface/FsmPresentationLayer.h"
+#include "fsm/Dfsm.h"
+#include "fsm/Fsm.h"
+#include "fsm/IOTrace.h"
+#include "fsm/IOTraceContainer.h"
+#include "fsm/MutationAnalysis.h"
+#include "trees/IOListContainer.h"
+
+
+using namespace std;
+
+
+/**
+ *   Allocation counting: every allocation of the program passes the
+ *   replaced global operator new
+ */
+static atomic<size_t> numAllocations(0);
+static atomic<size_t> numAllocatedBytes(0);
+
+void* operator new(size_t n) {
+    numAllocations++;
+    numAllocatedBytes += n;
+    void* p = malloc(n > 0 ? n : 1);
+    if ( p == NULL ) throw bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+
+/**
+ *   Peak resident set size. On Linux, the peak is reset before every
+ *   measurement, so that it refers to the measured algorithm alone.
+ *   Elsewhere, the peak of the whole process so far is reported.
+ */
+static void resetPeakRss() {
+#ifdef __linux__
+    ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+#endif
+}
+
+/** @return peak resident set size in KiB, -1 if it is not available */
+static long getPeakRssKB() {
+#ifdef __linux__
+    ifstream status("/proc/self/status");
+    string line;
+    while ( getline(status,line) ) {
+        if ( line.compare(0,6,"VmHWM:") == 0 ) {
+            return atol(line.c_str() + 6);
+        }
+    }
+#endif
+#if defined(__APPLE__)
+    struct rusage usage;
+    if ( getrusage(RUSAGE_SELF,&usage) == 0 ) return usage.ru_maxrss / 1024;
+#elif defined(__unix__)
+    struct rusage usage;
+    if ( getrusage(RUSAGE_SELF,&usage) == 0 ) return usage.ru_maxrss;
+#endif
+    return -1;
+}
+
+
+/**
+ *   Program execution parameters
+ */
+typedef enum {
+    OUT_JSON,
+    OUT_CSV
+} output_format_t;
+
+static output_format_t outputFormat = OUT_JSON;
+static string outputFileName;
+static unsigned int seed = 1;
+static int numRepetitions = 5;
+static int numWarmup = 1;
+static unsigned int numAddStates = 1;
+static unsigned int numThreads = 1;
+/** Number of random mutants executed by the mutation analysis benchmark */
+static size_t numMutants = 1000;
+static vector<int> gridStates { 5, 10, 20 };
+static vector<int> gridInputs { 2, 3 };
+static vector<int> gridOutputs { 3 };
+static vector<float> gridNonDeterminism { 0.0f, 0.25f, 0.5f };
+static vector<string> selectedAlgorithms;
+
+
+/**
+ *  The models of one point of the grid, created from a seed
+ *  which only depends on the master seed and the grid point
+ */
+struct Models {
+    /** Completely specified DFSM and its minimised variant */
+    shared_ptr<Dfsm> dfsm;
+    shared_ptr<Dfsm> dfsmMin;
+    /** Nondeterministic, non-observable FSM and a mutant of it */
+    shared_ptr<Fsm> fsm;
+    shared_ptr<Fsm> fsmMutant;
+    /** Minimal observable FSM and minimised mutant for adaptive state counting */
+    shared_ptr<Fsm> ofsmMin;
+    shared_ptr<Fsm> ofsmMutantMin;
+};
+
+/**
+ *  Measurement of a single execution. The algorithm calls start()
+ *  and stop() around the measured operation, so that copying the
+ *  input models is not measured.
+ */
+class Timer {
+public:
+    void start() {
+        resetPeakRss();
+        allocations = numAllocations;
+        allocatedBytes = numAllocatedBytes;
+        t0 = chrono::steady_clock::now();
+    }
+    void stop() {
+        auto t1 = chrono::steady_clock::now();
+        ms = chrono::duration<double,milli>(t1 - t0).count();
+        allocations = numAllocations - allocations;
+        allocatedBytes = numAllocatedBytes - allocatedBytes;
+        peakRssKB = getPeakRssKB();
+    }
+
+    double ms = 0;
+    size_t allocations = 0;
+    size_t allocatedBytes = 0;
+    long peakRssKB = -1;
+private:
+    chrono::steady_clock::time_point t0;
+};
+
+/** Size of the result of an algorithm */
+struct ResultSize {
+    /** Number of states of a resulting FSM, -1 if there is none */
+    int states = -1;
+    /** Number of test cases and sum of their lengths, -1 if there is no test suite */
+    long suiteSize = -1;
+    long suiteLength = -1;
+};
+
+static void setSuiteSize(const IOListContainer& suite, ResultSize& r) {
+    r.suiteSize = suite.size();
+    r.suiteLength = 0;
+    for ( const auto& tc : *suite.getIOLists() ) {
+        r.suiteLength += tc.size();
+    }
+}
+
+
+/**
+ *  The benchmarked algorithms
+ */
+struct Algorithm {
+    const char* name;
+    /** true if the algorithm works on the DFSM models, which do not depend on the nondeterminism */
+    bool deterministic;
+    function<void(const Models&, Timer&, ResultSize&)> run;
+};
+
+static void benchMinimise(const Models& models, Timer& timer, ResultSize& r) {
+    Dfsm d = Dfsm(Fsm(*models.dfsm));
+    timer.start();
+    Dfsm dMin = d.minimise();
+    timer.stop();
+    r.states = dMin.getMaxNodes();
+}
+
+static void benchWpMethod(const Models& models, Timer& timer, ResultSize& r) {
+    Dfsm d = Dfsm(Fsm(*models.dfsm));
+    timer.start();
+    IOListContainer suite = d.wpMethod(numAddStates);
+    timer.stop();
+    setSuiteSize(suite,r);
+}
+
+static void benchHMethod(const Models& models, Timer& timer, ResultSize& r) {
+    Dfsm d = Dfsm(Fsm(*models.dfsmMin));
+    timer.start();
+    IOListContainer suite = d.hMethodOnMinimisedDfsm(numAddStates);
+    timer.stop();
+    setSuiteSize(suite,r);
+}
+
+static void benchSpyhMethod(const Models& models, Timer& timer, ResultSize& r) {
+    Dfsm d = Dfsm(Fsm(*models.dfsmMin));
+    timer.start();
+    IOListContainer suite = d.spyhMethodOnMinimisedCompleteDfsm(numAddStates,numThreads);
+    timer.stop();
+    setSuiteSize(suite,r);
+}
+
+static void benchIntersect(const Models& models, Timer& timer, ResultSize& r) {
+    Fsm f(*models.fsm);
+    timer.start();
+    Fsm inter = f.intersect(*models.fsmMutant);
+    timer.stop();
+    r.states = inter.getMaxNodes();
+}
+
+static void benchTransformToObservable(const Models& models, Timer& timer, ResultSize& r) {
+    timer.start();
+    Fsm o = models.fsm->transformToObservableFSM();
+    timer.stop();
+    r.states = o.getMaxNodes();
+}
+
+static void benchAdaptiveStateCounting(const Models& models, Timer& timer, ResultSize& r) {
+    Fsm spec(*models.ofsmMin);
+    Fsm iut(*models.ofsmMutantMin);
+    IOTraceContainer observedTraces;
+    shared_ptr<IOTrace> failTrace;
+    int iterations = 0;
+    timer.start();
+    Fsm::adaptiveStateCounting(spec, iut, static_cast<size_t>(iut.getMaxNodes()),
+                               observedTraces, failTrace, iterations, numThreads);
+    timer.stop();
+    r.suiteSize = observedTraces.size();
+    r.suiteLength = 0;
+    for ( auto it = observedTraces.cbegin(); it != observedTraces.cend(); ++it ) {
+        r.suiteLength += (*it)->size();
+    }
+}
+
+static void benchMutationAnalysis(const Models& models, Timer& timer, ResultSize& r) {
+    Dfsm d = Dfsm(Fsm(*models.dfsmMin));
+    IOListContainer suite = d.wpMethodOnMinimisedDfsm(numAddStates);
+    mt19937 gen(seed);
+    MutationAnalysis analysis(d);
+    analysis.createMutants(numMutants, 1, d.size() > 1 ? 1 : 0, gen);
+    timer.start();
+    analysis.run(suite, numThreads);
+    timer.stop();
+    setSuiteSize(suite,r);
+}
+
+static const vector<Algorithm> algorithms {
+    { "minimise", true, benchMinimise },
+    { "wpMethod", true, benchWpMethod },
+    { "hMethodOnMinimisedDfsm", true, benchHMethod },
+    { "spyhMethodOnMinimisedCompleteDfsm", true, benchSpyhMethod },
+    { "intersect", false, benchIntersect },
+    { "transformToObservableFSM", false, benchTransformToObservable },
+    { "adaptiveStateCounting", false, benchAdaptiveStateCounting },
+    { "mutationAnalysis", true, benchMutationAnalysis }
+};
+
+
+/**
+ *  Create the models of a grid point. The DFSM models are only created
+ *  if deterministic is true, the FSM models otherwise.
+ */
+static Models createModels(bool deterministic, int states, int inputs, int outputs, float nd) {
+
+    seed_seq seq { seed,
+        static_cast<unsigned int>(states),
+        static_cast<unsigned int>(inputs),
+        static_cast<unsigned int>(outputs),
+        static_cast<unsigned int>(deterministic ? 0 : 1 + nd * 1000) };
+    mt19937 gen(seq);
+
+    Models models;
+    if ( deterministic ) {
+        auto pl = make_shared<FsmPresentationLayer>();
+        models.dfsm = make_shared<Dfsm>("D", states, inputs - 1, outputs - 1, pl, gen);
+        // Dfsm::minimise() modifies the DFSM, so that a copy is minimised
+        Dfsm d = Dfsm(Fsm(*models.dfsm));
+        models.dfsmMin = make_shared<Dfsm>(d.minimise());
+        return models;
+    }
+
+    auto pl = make_shared<FsmPresentationLayer>();
+    models.fsm = Fsm::createRandomFsm("F", inputs - 1, outputs - 1, states - 1, pl,
+                                      1.0f, nd, nd > 0, false, false, gen);
+    models.fsmMutant = models.fsm->createMutant("FM", 1, 1, false, gen);
+
+    auto ofsm = Fsm::createRandomFsm("O", inputs - 1, outputs - 1, states - 1, pl,
+                                     1.0f, nd, nd > 0, true, true, gen);
+    auto ofsmMutant = ofsm->createMutant("OM", 1, 1, true, gen);
+    models.ofsmMin = make_shared<Fsm>(ofsm->minimise("", "", false));
+    models.ofsmMutantMin = make_shared<Fsm>(ofsmMutant->minimise("", "", false));
+
+    return models;
+}
+
+
+/**
+ *  Result of the benchmark of one algorithm on one grid point
+ */
+struct BenchResult {
+    string algorithm;
+    int states;
+    int inputs;
+    int outputs;
+    /** Maximal degree of nondeterminism, -1 for algorithms on DFSMs */
+    float nonDeterminism;
+    vector<double> ms;
+    long peakRssKB = -1;
+    size_t allocations = 0;
+    size_t allocatedBytes = 0;
+    ResultSize size;
+    /** Reason why the benchmark could not be executed, empty on success */
+    string error;
+};
+
+static BenchResult runBenchmark(const Algorithm& alg, const Models& models) {
+
+    BenchResult res;
+    res.algorithm = alg.name;
+
+    try {
+        for ( int i = 0; i < numWarmup + numRepetitions; i++ ) {
+            Timer timer;
+            ResultSize size;
+            alg.run(models,timer,size);
+            if ( i < numWarmup ) continue;
+            res.ms.push_back(timer.ms);
+            res.peakRssKB = max(res.peakRssKB,timer.peakRssKB);
+            res.allocations = timer.allocations;
+            res.allocatedBytes = timer.allocatedBytes;
+            res.size = size;
+        }
+    }
+    catch ( const exception& e ) {
+        res.error = e.what();
+    }
+    catch ( const string& e ) {
+        res.error = e;
+    }
+
+    return res;
+}
+
+
+/**
+ *  Output of the results
+ */
+static double median(vector<double> v) {
+    if ( v.empty() ) return 0;
+    sort(v.begin(),v.end());
+    size_t n = v.size();
+    return ( n % 2 == 1 ) ? v[n/2] : (v[n/2 - 1] + v[n/2]) / 2;
+}
+
+static double mean(const vector<double>& v) {
+    if ( v.empty() ) return 0;
+    return accumulate(v.begin(),v.end(),0.0) / v.size();
+}
+
+static string escape(const string& s) {
+    string r;
+    for ( char c : s ) {
+        if ( c == '"' or c == '\\' ) r += '\\';
+        if ( c == '\n' ) {
+            r += "\\n";
+            continue;
+        }
+        r += c;
+    }
+    return r;
+}
+
+static void writeCsvHeader(ostream& out) {
+    out << "algorithm;states;inputs;outputs;nonDeterminism;seed;repetitions;"
+    << "minMS;medianMS;meanMS;maxMS;peakRssKB;allocations;allocatedBytes;"
+    << "resultStates;testSuiteSize;testSuiteLength;error" << endl;
+}
+
+static void writeCsv(ostream& out, const BenchResult& r) {
+    out << r.algorithm << ";" << r.states << ";" << r.inputs << ";" << r.outputs << ";"
+    << r.nonDeterminism << ";" << seed << ";" << r.ms.size() << ";";
+    if ( r.ms.empty() ) {
+        out << ";;;;";
+    }
+    else {
+        out << *min_element(r.ms.begin(),r.ms.end()) << ";"
+        << median(r.ms) << ";"
+        << mean(r.ms) << ";"
+        << *max_element(r.ms.begin(),r.ms.end()) << ";";
+    }
+    out << r.peakRssKB << ";" << r.allocations << ";" << r.allocatedBytes << ";"
+    << r.size.states << ";" << r.size.suiteSize << ";" << r.size.suiteLength << ";"
+    << "\"" << escape(r.error) << "\"" << endl;
+}
+
+static void writeJson(ostream& out, const BenchResult& r) {
+    out << "    { \"algorithm\": \"" << r.algorithm << "\""
+    << ", \"states\": " << r.states
+    << ", \"inputs\": " << r.inputs
+    << ", \"outputs\": " << r.outputs
+    << ", \"nonDeterminism\": " << r.nonDeterminism
+    << "," << endl << "      \"ms\": [";
+    for ( size_t i = 0; i < r.ms.size(); i++ ) {
+        out << (i > 0 ? ", " : "") << r.ms[i];
+    }
+    out << "]";
+    if ( not r.ms.empty() ) {
+        out << ", \"minMS\": " << *min_element(r.ms.begin(),r.ms.end())
+        << ", \"medianMS\": " << median(r.ms)
+        << ", \"meanMS\": " << mean(r.ms)
+        << ", \"maxMS\": " << *max_element(r.ms.begin(),r.ms.end());
+    }
+    out << "," << endl
+    << "      \"peakRssKB\": " << r.peakRssKB
+    << ", \"allocations\": " << r.allocations
+    << ", \"allocatedBytes\": " << r.allocatedBytes
+    << ", \"resultStates\": " << r.size.states
+    << ", \"testSuiteSize\": " << r.size.suiteSize
+    << ", \"testSuiteLength\": " << r.size.suiteLength;
+    if ( not r.error.empty() ) {
+        out << "," << endl << "      \"error\": \"" << escape(r.error) << "\"";
+    }
+    out << " }";
+}
+
+
+/**
+ * Write program usage to standard error.
+ * @param name program name as specified in argv[0]
+ */
+static void printUsage(char* name) {
+    cerr << "usage: " << name
+    << " [-format json|csv] [-o outputfile] [-seed n] [-r repetitions] [-w warmup]"
+    << " [-j numthreads] [-a numaddstates] [-states n,...] [-inputs n,...] [-outputs n,...]"
+    << " [-nd degree,...] [-only algorithm,...]" << endl;
+    cerr << "algorithms:";
+    for ( const auto& alg : algorithms ) cerr << " " << alg.name;
+    cerr << endl;
+}
+
+static vector<string> splitList(const char* s) {
+    vector<string> lst;
+    stringstream ss(s);
+    string item;
+    while ( getline(ss,item,',') ) {
+        if ( not item.empty() ) lst.push_back(item);
+    }
+    return lst;
+}
+
+static vector<int> parseIntList(const char* s) {
+    vector<int> lst;
+    for ( const auto& item : splitList(s) ) lst.push_back(atoi(item.c_str()));
+    return lst;
+}
+
+/**
+ * Parse parameters, stop execution if parameters are illegal.
+ *
+ * @param argc parameter 1 from main() invocation
+ * @param argv parameter 2 from main() invocation
+ */
+static void parseParameters(int argc, char* argv[]) {
+
+    for ( int p = 1; p < argc; p += 2 ) {
+        if ( p + 1 >= argc ) {
+            printUsage(argv[0]);
+            exit(1);
+        }
+        if ( strcmp(argv[p],"-format") == 0 ) {
+            if ( strcmp(argv[p+1],"csv") == 0 ) outputFormat = OUT_CSV;
+            else if ( strcmp(argv[p+1],"json") == 0 ) outputFormat = OUT_JSON;
+            else {
+                printUsage(argv[0]);
+                exit(1);
+            }
+        }
+        else if ( strcmp(argv[p],"-o") == 0 ) {
+            outputFileName = string(argv[p+1]);
+        }
+        else if ( strcmp(argv[p],"-seed") == 0 ) {
+            seed = static_cast<unsigned int>(strtoul(argv[p+1],NULL,10));
+        }
+        else if ( strcmp(argv[p],"-r") == 0 ) {
+            numRepetitions = atoi(argv[p+1]);
+        }
+        else if ( strcmp(argv[p],"-w") == 0 ) {
+            numWarmup = atoi(argv[p+1]);
+        }
+        else if ( strcmp(argv[p],"-j") == 0 ) {
+            numThreads = static_cast<unsigned int>(atoi(argv[p+1]));
+        }
+        else if ( strcmp(argv[p],"-a") == 0 ) {
+            numAddStates = static_cast<unsigned int>(atoi(argv[p+1]));
+        }
+        else if ( strcmp(argv[p],"-states") == 0 ) {
+            gridStates = parseIntList(argv[p+1]);
+        }
+        else if ( strcmp(argv[p],"-inputs") == 0 ) {
+            gridInputs = parseIntList(argv[p+1]);
+        }
+        else if ( strcmp(argv[p],"-outputs") == 0 ) {
+            gridOutputs = parseIntList(argv[p+1]);
+        }
+        else if ( strcmp(argv[p],"-nd") == 0 ) {
+            gridNonDeterminism.clear();
+            for ( const auto& item : splitList(argv[p+1]) ) {
+                gridNonDeterminism.push_back(static_cast<float>(atof(item.c_str())));
+            }
+        }
+        else if ( strcmp(argv[p],"-only") == 0 ) {
+            selectedAlgorithms = splitList(argv[p+1]);
+        }
+        else {
+            printUsage(argv[0]);
+            exit(1);
+        }
+    }
+
+    bool illegal = numRepetitions < 1 or numWarmup < 0;
+    for ( int n : gridStates ) illegal = illegal or n < 1;
+    for ( int n : gridInputs ) illegal = illegal or n < 1;
+    for ( int n : gridOutputs ) illegal = illegal or n < 1;
+    for ( float nd : gridNonDeterminism ) illegal = illegal or nd < 0 or nd > 1;
+    for ( const auto& name : selectedAlgorithms ) {
+        illegal = illegal or none_of(algorithms.begin(),algorithms.end(),
+                                     [&name](const Algorithm& alg) { return name == alg.name; });
+    }
+    if ( illegal ) {
+        printUsage(argv[0]);
+        exit(1);
+    }
+
+}
+
+static bool isSelected(const Algorithm& alg) {
+    return selectedAlgorithms.empty() or
+    find(selectedAlgorithms.begin(),selectedAlgorithms.end(),alg.name) != selectedAlgorithms.end();
+}
+
+int main(int argc, char* argv[])
+{
+
+    parseParameters(argc,argv);
+
+    ofstream outFile;
+    if ( not outputFileName.empty() ) {
+        outFile.open(outputFileName);
+        if ( not outFile ) {
+            cerr << "Could not open file " << outputFileName << " - exit." << endl;
+            exit(1);
+        }
+    }
+    ostream& out = outputFileName.empty() ? cout : outFile;
+
+    if ( outputFormat == OUT_CSV ) {
+        writeCsvHeader(out);
+    }
+    else {
+        out << "{" << endl
+        << "  \"seed\": " << seed
+        << ", \"warmup\": " << numWarmup
+        << ", \"repetitions\": " << numRepetitions
+        << ", \"numAddStates\": " << numAddStates
+        << ", \"threads\": " << numThreads
+        << "," << endl << "  \"results\": [" << endl;
+    }
+
+    bool first = true;
+    for ( int deterministic = 1; deterministic >= 0; deterministic-- ) {
+
+        vector<const Algorithm*> algs;
+        for ( const auto& alg : algorithms ) {
+            if ( alg.deterministic == (deterministic == 1) and isSelected(alg) ) {
+                algs.push_back(&alg);
+            }
+        }
+        if ( algs.empty() ) continue;
+
+        // The DFSM models do not depend on the degree of nondeterminism
+        vector<float> nds = gridNonDeterminism;
+        if ( deterministic ) nds = vector<float> { -1 };
+
+        for ( int states : gridStates ) {
+            for ( int inputs : gridInputs ) {
+                for ( int outputs : gridOutputs ) {
+                    for ( float nd : nds ) {
+
+                        Models models;
+                        string error;
+                        try {
+                            models = createModels(deterministic,states,inputs,outputs,nd);
+                        }
+                        catch ( const exception& e ) {
+                            error = e.what();
+                        }
+                        catch ( const string& e ) {
+                            error = e;
+                        }
+
+                        for ( const Algorithm* alg : algs ) {
+
+                            cerr << alg->name << " states=" << states
+                            << " inputs=" << inputs << " outputs=" << outputs;
+                            if ( not deterministic ) cerr << " nd=" << nd;
+                            cerr << endl;
+
+                            BenchResult r;
+                            if ( error.empty() ) {
+                                r = runBenchmark(*alg,models);
+                            }
+                            else {
+                                r.algorithm = alg->name;
+                                r.error = "Could not create models: " + error;
+                            }
+                            r.states = states;
+                            r.inputs = inputs;
+                            r.outputs = outputs;
+                            r.nonDeterminism = nd;
+
+                            if ( outputFormat == OUT_CSV ) {
+                                writeCsv(out,r);
+                            }
+                            else {
+                                if ( not first ) out << "," << endl;
+                                writeJson(out,r);
+                            }
+                            out.flush();
+                            first = false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    if ( outputFormat == OUT_JSON ) {
+        out << endl << "  ]" << endl << "}" << endl;
+    }
+
+    exit(0);
+
+}
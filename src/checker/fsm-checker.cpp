@@ -6,11 +6,15 @@
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <memory>
+#include <chrono>
+#include <vector>
 #include <stdlib.h>
 #include <string.h>
 
 #include "interface/FsmPresentationLayer.h"
+#include "fsm/BinaryFsm.h"
 #include "fsm/Dfsm.h"
 #include "fsm/Fsm.h"
 #include "fsm/FsmNode.h"
@@ -18,9 +22,11 @@
 #include "fsm/FsmPrintVisitor.h"
 #include "fsm/FsmSimVisitor.h"
 #include "fsm/FsmOraVisitor.h"
+#include "trees/BinaryTestSuite.h"
 #include "trees/IOListContainer.h"
 #include "trees/OutputTree.h"
 #include "trees/TestSuite.h"
+#include "utils/WorkStealingPool.hpp"
 #include "json/json.h"
 
 
@@ -34,7 +40,8 @@ using namespace Json;
 typedef enum {
     FSM_CSV,
     FSM_JSON,
-    FSM_BASIC
+    FSM_BASIC,
+    FSM_BINARY
 } model_type_t;
 
 typedef enum {
@@ -46,9 +53,18 @@ static model_type_t sutModelType;
 static string sutmodelFileName;
 static string testSuiteFileName;
 
+/** If not empty, the text test suite is converted to this binary test suite file */
+static string binaryTestSuiteFileName;
+
 
 static string fsmSutName;
 
+/** Number of worker threads executing test cases, 0 means one per hardware thread */
+static unsigned int numThreads = 1;
+
+/** Number of test cases read and executed in parallel at a time */
+static const size_t blockSize = 4096;
+
 
 static shared_ptr<FsmPresentationLayer> pl = nullptr;
 static shared_ptr<Dfsm> dfsmSut = nullptr;
@@ -62,7 +78,7 @@ static bool isDeterministic = true;
  */
 static void printUsage(char* name) {
     cerr << "usage: " << name
-    << " sutmodelfile testsuite"
+    << " [-j numthreads] [-convert binarytestsuite] sutmodelfile testsuite"
     << endl;
 }
 
@@ -75,15 +91,39 @@ static void printUsage(char* name) {
  */
 static void parseParameters(int argc, char* argv[]) {
     
-    if ( argc < 3 ) {
+    int p = 1;
+    
+    for ( ; argc > p+1; p += 2 ) {
+        if ( strcmp(argv[p],"-j") == 0 ) {
+            char* end;
+            long n = strtol(argv[p+1],&end,10);
+            if ( end == argv[p+1] or *end != 0 or n < 0 ) {
+                cerr << argv[0] << ": illegal number of threads " << argv[p+1] << endl;
+                printUsage(argv[0]);
+                exit(1);
+            }
+            numThreads = static_cast<unsigned int>(n);
+        }
+        else if ( strcmp(argv[p],"-convert") == 0 ) {
+            binaryTestSuiteFileName = string(argv[p+1]);
+        }
+        else {
+            break;
+        }
+    }
+    
+    if ( argc < p+2 ) {
         printUsage(argv[0]);
         exit(1);
     }
     
-    sutmodelFileName = string(argv[1]);
-    testSuiteFileName = string(argv[2]);
+    sutmodelFileName = string(argv[p]);
+    testSuiteFileName = string(argv[p+1]);
     
-    if ( strstr(sutmodelFileName.c_str(),".csv")  ) {
+    if ( BinaryFsm::isBinaryFsm(sutmodelFileName) ) {
+        sutModelType = FSM_BINARY;
+    }
+    else if ( strstr(sutmodelFileName.c_str(),".csv")  ) {
         sutModelType = FSM_CSV;
     }
     else {
@@ -125,6 +165,17 @@ static void readSUTModel() {
         }
             break;
             
+        case FSM_BINARY:
+            try {
+                dfsmSut = BinaryFsm(sutmodelFileName).createDfsm();
+                pl = dfsmSut->getPresentationLayer();
+            }
+            catch ( const exception& e ) {
+                cerr << e.what() << " - exit." << endl;
+                exit(1);
+            }
+            break;
+            
         default:
             cerr << "Could not parse this model type - exit." << endl;
             exit(1);
@@ -165,7 +216,54 @@ static void getNextIO(char** p, char** x, char** y) {
     
 }
 
-static void executeTestCase(const char* tcId, char* line) {
+/**
+ *  Check the IO trace (inVec,outVec) against the IO trace observed
+ *  when applying inVec to the SUT model, see Dfsm::pass().
+ *  @param layer Presentation layer of the calling worker
+ *  @param out Stream receiving the verdict
+ *  @return true if the test case passed
+ */
+static bool checkIOTrace(const IOTrace& observed,
+                         const vector<int>& inVec,
+                         const vector<int>& outVec,
+                         const shared_ptr<FsmPresentationLayer>& layer,
+                         ostream& out) {
+    
+    InputTrace inTrace(inVec,layer);
+    OutputTrace outTrace(outVec,layer);
+    
+    IOTrace io(inTrace,outTrace);
+    
+    
+    out << "Check IO Trace " << io << ": ";
+    
+    if ( observed.getOutputTrace() == io.getOutputTrace() ) {
+        out << " PASS" << endl;
+        return true;
+    }
+    else {
+        out << " FAIL - observed ";
+        out << observed.getOutputTrace() << endl;
+        return false;
+    }
+    
+}
+
+/**
+ *  Parse one test case into its inputs and expected outputs.
+ *  @param layer Presentation layer of the calling worker
+ *  @param out Stream receiving the verdict line
+ *  @param err Stream receiving diagnostic messages
+ *  @return true if the test case is to be executed, false if
+ *          it already failed
+ */
+static bool parseTestCase(const string& tcId,
+                          char* line,
+                          vector<int>& inVec,
+                          vector<int>& outVec,
+                          const shared_ptr<FsmPresentationLayer>& layer,
+                          ostream& out,
+                          ostream& err) {
     
     char* p = line;
     char* x = 0;
@@ -173,12 +271,10 @@ static void executeTestCase(const char* tcId, char* line) {
     int xInt;
     int yInt;
     string theLine(line);
-    vector<int> inVec;
-    vector<int> outVec;
     
     
     
-    printf("%s",tcId);
+    out << tcId;
     
     
     
@@ -187,22 +283,22 @@ static void executeTestCase(const char* tcId, char* line) {
         getNextIO(&p,&x,&y);
         
         if ( x != NULL && y != NULL ) {
-            xInt = pl->in2Num(x);
-            yInt = pl->out2Num(y);
+            xInt = layer->in2Num(x);
+            yInt = layer->out2Num(y);
         }
         else {
-            cerr << "Could not parse test case " << theLine << endl;
-            return;
+            err << "Could not parse test case " << theLine << endl;
+            return false;
         }
         
         if ( xInt < 0 ) {
-            cerr << "Unknown input " << x
+            err << "Unknown input " << x
             << " in test case " << theLine << endl;
         }
         else if ( yInt < 0 ) {
-            cout << "FAIL: SUT does not produce expected output "
+            out << "FAIL: SUT does not produce expected output "
             << y << " occurring in test case " << theLine << endl;
-            return;
+            return false;
         }
         
         inVec.push_back(xInt);
@@ -210,29 +306,180 @@ static void executeTestCase(const char* tcId, char* line) {
         
     }
     
+    return true;
     
-    InputTrace inTrace(inVec,pl);
-    OutputTrace outTrace(outVec,pl);
-    
-    IOTrace io(inTrace,outTrace);
-    
+}
+
+
+/**
+ *  Result of a test case executed by a worker thread. The output is
+ *  collected here and written after the whole block has been executed,
+ *  so that the verdicts appear in the order of the test suite file.
+ */
+struct TestCaseResult {
+    /** Test case as text, or empty for binary test suites */
+    string line;
+    vector<int> inputs;
+    vector<int> outputs;
+    /** false if the test case already failed when it was parsed */
+    bool execute;
+    string out;
+    string err;
+    bool pass;
+};
+
+
+static void executeTestSuite(const char* fname) {
     
-    cout << "Check IO Trace " << io << ": ";
+    const int lineSize = 100000;
+    char* line = (char*)calloc(lineSize,1);
+    FILE* f = NULL;
     
-    if ( dfsmSut->pass(io) ) {
-        printf(" PASS\n");
+    // Binary test suites are used in place, without parsing
+    unique_ptr<BinaryTestSuite> binSuite;
+    if ( BinaryTestSuite::isBinaryTestSuite(fname) ) {
+        try {
+            binSuite.reset(new BinaryTestSuite(fname));
+        }
+        catch ( const exception& e ) {
+            cerr << e.what() << " - exit." << endl;
+            exit(1);
+        }
+        if ( not binSuite->hasOutputs() ) {
+            cerr << "Test suite " << fname << " does not contain expected outputs - exit." << endl;
+            exit(1);
+        }
     }
     else {
-        cout << " FAIL - observed ";
-        IOTrace iot = dfsmSut->applyDet(inTrace);
-        cout << iot.getOutputTrace() << endl;
+        f = fopen(fname,"r");
+        if ( f == NULL ) {
+            fprintf(stderr,"Could not open file %s - exit.\n",fname);
+            exit(1);
+        }
+    }
+    
+    // Every worker executes the test cases on its own copy of the model
+    // and its presentation layer, the first worker uses the originals
+    WorkStealingPool pool(numThreads);
+    vector<shared_ptr<Dfsm>> models;
+    vector<shared_ptr<FsmPresentationLayer>> layers;
+    models.push_back(dfsmSut);
+    layers.push_back(pl);
+    for ( unsigned int w = 1; w < pool.getNumThreads(); w++ ) {
+        auto layer = make_shared<FsmPresentationLayer>(*pl);
+        models.push_back(make_shared<Dfsm>(Fsm(*dfsmSut,dfsmSut->getName(),layer)));
+        layers.push_back(layer);
+    }
+    
+    auto start = chrono::steady_clock::now();
+    
+    int tcNum = 0;
+    int numPass = 0;
+    int numFail = 0;
+    vector<TestCaseResult> block;
+    bool eof = false;
+    while ( not eof ) {
+        
+        // Read the next block of test cases
+        block.clear();
+        while ( binSuite != nullptr and block.size() < blockSize ) {
+            if ( tcNum + block.size() == binSuite->size() ) {
+                eof = true;
+                break;
+            }
+            block.push_back(TestCaseResult());
+        }
+        while ( binSuite == nullptr and block.size() < blockSize ) {
+            if ( not fgets(line,lineSize,f) ) {
+                eof = true;
+                break;
+            }
+            
+            size_t len = strlen(line);
+            
+            // Replace newline by null character
+            if ( len > 1 ) {
+                line[len-1] = 0;
+                TestCaseResult r;
+                r.line = string(line);
+                block.push_back(r);
+            }
+        }
+        
+        pool.run(block.size(), [&](const size_t i, const unsigned int w) {
+            TestCaseResult& r = block[i];
+            ostringstream tcId;
+            tcId << "TC-" << (tcNum + i + 1) << ": ";
+            ostringstream out;
+            ostringstream err;
+            if ( binSuite != nullptr ) {
+                size_t n = tcNum + i;
+                const int32_t* x = binSuite->inputs(n);
+                const int32_t* y = binSuite->outputs(n);
+                r.inputs.assign(x,x + binSuite->length(n));
+                r.outputs.assign(y,y + binSuite->length(n));
+                out << tcId.str();
+                r.execute = true;
+            }
+            else {
+                vector<char> lineBuf(r.line.begin(),r.line.end());
+                lineBuf.push_back(0);
+                r.execute = parseTestCase(tcId.str(),lineBuf.data(),r.inputs,r.outputs,layers[w],out,err);
+            }
+            r.pass = false;
+            r.out = out.str();
+            r.err = err.str();
+        });
+        
+        // Every worker executes a contiguous range of the block at once,
+        // so that the prefixes shared by neighbouring test cases are
+        // applied to the model only once
+        size_t numRanges = pool.getNumThreads();
+        pool.run(numRanges, [&](const size_t k, const unsigned int w) {
+            vector<size_t> tcs;
+            vector<InputTrace> inputs;
+            for ( size_t i = block.size() * k / numRanges; i < block.size() * (k+1) / numRanges; i++ ) {
+                if ( not block[i].execute ) continue;
+                tcs.push_back(i);
+                inputs.push_back(InputTrace(block[i].inputs,layers[w]));
+            }
+            vector<IOTrace> observed = models[w]->applyDet(inputs);
+            for ( size_t j = 0; j < tcs.size(); j++ ) {
+                TestCaseResult& r = block[tcs[j]];
+                ostringstream out;
+                r.pass = checkIOTrace(observed[j],r.inputs,r.outputs,layers[w],out);
+                r.out += out.str();
+            }
+        });
+        
+        for ( const auto& r : block ) {
+            cerr << r.err;
+            cout << r.out;
+            if ( r.pass ) numPass++;
+            else numFail++;
+        }
+        tcNum += static_cast<int>(block.size());
         
     }
+    if ( f != NULL ) fclose(f);
+    free(line);
+    
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    
+    cout << endl << "Number of test cases: " << tcNum << endl;
+    cout << "                PASS: " << numPass << endl;
+    cout << "                FAIL: " << numFail << endl;
+    cout << "          Throughput: "
+    << (secs > 0 ? tcNum / secs : 0) << " test cases/s ("
+    << pool.getNumThreads() << " threads)" << endl;
     
 }
 
-
-static void executeTestSuite(const char* fname) {
+/**
+ *  Convert the text test suite fname to the binary test suite
+ *  binaryTestSuiteFileName, using the names of the SUT model.
+ */
+static void convertTestSuite(const char* fname) {
     
     const int lineSize = 100000;
     char* line = (char*)calloc(lineSize,1);
@@ -242,23 +489,41 @@ static void executeTestSuite(const char* fname) {
         exit(1);
     }
     
+    BinaryTestSuite::Writer writer(binaryTestSuiteFileName,true);
     int tcNum = 0;
     while ( fgets(line,lineSize,f) ) {
         
         size_t len = strlen(line);
+        if ( len <= 1 ) continue;
         
         // Replace newline by null character
-        if ( len > 1 ) {
-            line[len-1] = 0;
-            char tcId[100];
-            *tcId = 0;
-            sprintf(tcId,"TC-%d: ",++tcNum);
-            executeTestCase(tcId,line);
-        }
+        line[len-1] = 0;
+        string theLine(line);
+        tcNum++;
         
+        char* p = line;
+        char* x = 0;
+        char* y = 0;
+        vector<int> inVec;
+        vector<int> outVec;
+        while ( *p ) {
+            getNextIO(&p,&x,&y);
+            int xInt = ( x != NULL and y != NULL ) ? pl->in2Num(x) : -1;
+            int yInt = ( x != NULL and y != NULL ) ? pl->out2Num(y) : -1;
+            if ( xInt < 0 or yInt < 0 ) {
+                cerr << "Could not convert test case " << theLine << " - exit." << endl;
+                exit(1);
+            }
+            inVec.push_back(xInt);
+            outVec.push_back(yInt);
+        }
+        writer.push(inVec,outVec);
     }
     fclose(f);
+    free(line);
     
+    writer.close();
+    cout << "Converted " << tcNum << " test cases to " << binaryTestSuiteFileName << endl;
     
 }
 
@@ -267,6 +532,10 @@ int main(int argc, char* argv[])
     
     parseParameters(argc,argv);
     readSUTModel();
+    if ( not binaryTestSuiteFileName.empty() ) {
+        convertTestSuite(testSuiteFileName.c_str());
+        exit(0);
+    }
     executeTestSuite(testSuiteFileName.c_str());
     
     exit(0);
@@ -0,0 +1,95 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include <sstream>
+#include <iostream>
+#include <unordered_set>
+
+#include "fsm/AdaptiveResponseCache.h"
+#include "fsm/Fsm.h"
+#include "fsm/FsmNode.h"
+#include "fsm/IOTrace.h"
+#include "fsm/InputTrace.h"
+#include "fsm/OutputTrace.h"
+#include "fsm/IOTraceContainer.h"
+#include "trees/IOTreeContainer.h"
+
+using namespace std;
+
+AdaptiveResponseCache::AdaptiveResponseCache(const Fsm& fsm, const IOTreeContainer& adaptiveTestCases):
+fsm(fsm),
+adaptiveTestCases(adaptiveTestCases),
+prefixes(fsm.getPresentationLayer())
+{
+}
+
+shared_ptr<const IOTraceContainer> AdaptiveResponseCache::get(const shared_ptr<FsmNode>& node)
+{
+    {
+        lock_guard<mutex> lock(mtx);
+        auto it = responses.find(node.get());
+        if (it != responses.end())
+        {
+            return it->second;
+        }
+    }
+
+    // The responses are calculated without holding the lock. If another
+    // thread calculates the responses of the same state concurrently,
+    // the first result is kept; both results are equal.
+    shared_ptr<IOTraceContainer> result = make_shared<IOTraceContainer>();
+    fsm.addPossibleIOTraces(node, adaptiveTestCases, *result);
+
+    lock_guard<mutex> lock(mtx);
+    return responses.emplace(node.get(), result).first->second;
+}
+
+IOTraceContainer AdaptiveResponseCache::bOmega(const IOTrace& trace)
+{
+    if (adaptiveTestCases.size() == 0)
+    {
+        return IOTraceContainer();
+    }
+
+    shared_ptr<FsmNode> initialState = fsm.getInitialState();
+    if (!initialState)
+    {
+        return IOTraceContainer();
+    }
+
+    shared_ptr<FsmNode> node = initialState;
+    {
+        const InputTrace& inputTrace = trace.getInputTrace();
+        const OutputTrace& outputTrace = trace.getOutputTrace();
+
+        lock_guard<mutex> lock(stateMtx);
+        size_t id = IOTracePool::emptyTraceId;
+        auto itOut = outputTrace.cbegin();
+        for (auto itIn = inputTrace.cbegin(); node && itIn != inputTrace.cend(); ++itIn, ++itOut)
+        {
+            id = prefixes.extend(id, *itIn, *itOut);
+            auto it = stateAfter.find(id);
+            if (it == stateAfter.end())
+            {
+                unordered_set<shared_ptr<FsmNode>> successorNodes = node->afterAsSet(*itIn, *itOut);
+                if (successorNodes.size() > 1)
+                {
+                    stringstream ss;
+                    ss << "The FSM does not seem to be observable.";
+                    std::cerr << ss.str();
+                    throw ss.str();
+                }
+                shared_ptr<FsmNode> successor = successorNodes.empty() ? nullptr : *successorNodes.begin();
+                it = stateAfter.emplace(id, successor).first;
+            }
+            node = it->second;
+        }
+    }
+    if (!node)
+    {
+        return IOTraceContainer();
+    }
+    return *get(node);
+}
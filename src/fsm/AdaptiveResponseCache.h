@@ -0,0 +1,74 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_FSM_ADAPTIVERESPONSECACHE_H_
+#define FSM_FSM_ADAPTIVERESPONSECACHE_H_
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "fsm/IOTracePool.h"
+
+class Fsm;
+class FsmNode;
+class IOTrace;
+class IOTraceContainer;
+class IOTreeContainer;
+
+/**
+ *  Responses of the states of an observable FSM to a fixed set of
+ *  adaptive test cases, as calculated by Fsm::addPossibleIOTraces().
+ *
+ *  The responses of each state are calculated when they are requested
+ *  for the first time, so that the adaptive test cases are not applied
+ *  again to a state reached by another trace. The cache may be queried
+ *  concurrently, as long as neither the FSM nor the adaptive test cases
+ *  are modified.
+ *
+ *  Entries are keyed by a single state, not by a set of states and an
+ *  adaptive test case: the FSM is observable, so every trace reaches at
+ *  most one state, and adaptive state counting always applies the whole
+ *  set of adaptive test cases, which is fixed for a run. A cache is
+ *  created for one set of adaptive test cases.
+ *
+ *  The states reached by the traces passed to bOmega() are memoised per
+ *  prefix in an IOTracePool, so that traces sharing a prefix are not
+ *  applied to the FSM again from its initial state.
+ */
+class AdaptiveResponseCache
+{
+private:
+    const Fsm& fsm;
+    const IOTreeContainer& adaptiveTestCases;
+
+    std::unordered_map<const FsmNode*, std::shared_ptr<const IOTraceContainer>> responses;
+    std::mutex mtx;
+
+    /** Prefixes of the traces passed to bOmega() */
+    IOTracePool prefixes;
+
+    /** State reached by each trace of the pool from the initial state, nullptr if undefined */
+    std::unordered_map<size_t, std::shared_ptr<FsmNode>> stateAfter;
+    std::mutex stateMtx;
+
+public:
+    AdaptiveResponseCache(const Fsm& fsm, const IOTreeContainer& adaptiveTestCases);
+
+    /**
+     *  @return the traces observed when applying the adaptive test
+     *          cases to the given state of the FSM
+     */
+    std::shared_ptr<const IOTraceContainer> get(const std::shared_ptr<FsmNode>& node);
+
+    /**
+     *  Same result as fsm.bOmega(adaptiveTestCases, trace): the responses
+     *  of the state reached by trace from the initial state, or an empty
+     *  container if trace is not defined in the FSM.
+     */
+    IOTraceContainer bOmega(const IOTrace& trace);
+};
+
+#endif //FSM_FSM_ADAPTIVERESPONSECACHE_H_
@@ -0,0 +1,228 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include "fsm/BinaryFsm.h"
+#include "fsm/Dfsm.h"
+#include "fsm/Fsm.h"
+#include "fsm/FsmNode.h"
+#include "fsm/FsmLabel.h"
+#include "fsm/FsmTransition.h"
+#include "interface/FsmPresentationLayer.h"
+
+using namespace std;
+
+static_assert(sizeof(BinaryFsm::Header) == 56, "unexpected padding in BinaryFsm::Header");
+static_assert(sizeof(BinaryFsm::Transition) == 16, "unexpected padding in BinaryFsm::Transition");
+
+static const char magic[4] = { 'F', 'S', 'M', 'B' };
+static const uint32_t byteOrderMark = 0x01020304;
+
+/**
+ *  Upper bound for the number of states of a model file: the states
+ *  are the initial state and the states occurring in the transitions,
+ *  unless the file names more states. As both numbers are bounded by
+ *  the size of the file, createFsm() never allocates more nodes than
+ *  the file can describe.
+ */
+static uint64_t maxNumStates(const BinaryFsm::Header& h)
+{
+    return max<uint64_t>(h.numStateNames, 2 * h.numTransitions + 1);
+}
+
+BinaryFsm::BinaryFsm(const string& fname)
+: file(fname), header(nullptr), transitions(nullptr), nameOffsets(nullptr), names(nullptr)
+{
+    const char* base = file.data();
+    size_t size = file.size();
+
+    if ( size < sizeof(Header) ) {
+        throw runtime_error(fname + " is not a binary model file");
+    }
+    header = reinterpret_cast<const Header*>(base);
+    if ( memcmp(header->magic, magic, sizeof(magic)) != 0 ) {
+        throw runtime_error(fname + " is not a binary model file");
+    }
+    if ( header->byteOrder != byteOrderMark ) {
+        throw runtime_error(fname + " has been written on a machine with different byte order");
+    }
+    if ( header->version != VERSION ) {
+        throw runtime_error(fname + " has unsupported format version " +
+                            to_string(header->version));
+    }
+
+    size_t numNames = 1 + static_cast<size_t>(header->numInputNames) +
+                      header->numOutputNames + header->numStateNames;
+    size_t pos = sizeof(Header);
+    size_t offsetsPos = pos + header->numTransitions * sizeof(Transition);
+    size_t namesPos = offsetsPos + (numNames + 1) * sizeof(uint64_t);
+    if ( header->numTransitions > size / sizeof(Transition) or namesPos > size ) {
+        throw runtime_error(fname + " is truncated");
+    }
+    if ( header->maxState < 0 or
+         static_cast<uint64_t>(header->maxState) >= maxNumStates(*header) ) {
+        throw runtime_error(fname + " contains an illegal number of states");
+    }
+
+    transitions = reinterpret_cast<const Transition*>(base + pos);
+    nameOffsets = reinterpret_cast<const uint64_t*>(base + offsetsPos);
+    names = base + namesPos;
+
+    if ( nameOffsets[numNames] > size - namesPos ) {
+        throw runtime_error(fname + " is truncated");
+    }
+    for ( size_t i = 0; i < numNames; i++ ) {
+        if ( nameOffsets[i] > nameOffsets[i+1] ) {
+            throw runtime_error(fname + " contains an illegal name table");
+        }
+    }
+}
+
+bool BinaryFsm::isBinaryFsm(const string& fname)
+{
+    ifstream in(fname, ios::binary);
+    char buf[sizeof(magic)];
+    if ( not in.read(buf, sizeof(buf)) ) return false;
+    return memcmp(buf, magic, sizeof(magic)) == 0;
+}
+
+void BinaryFsm::write(const Fsm& fsm, const string& fname)
+{
+    shared_ptr<FsmPresentationLayer> pl = fsm.getPresentationLayer();
+
+    Header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, magic, sizeof(magic));
+    h.version = VERSION;
+    h.byteOrder = byteOrderMark;
+    h.deterministic = ( dynamic_cast<const Dfsm*>(&fsm) != nullptr ) ? 1 : 0;
+    h.maxInput = fsm.getMaxInput();
+    h.maxOutput = fsm.getMaxOutput();
+    h.maxState = fsm.getMaxState();
+    h.initStateIdx = fsm.getInitStateIdx();
+
+    vector<Transition> trs;
+    for ( const auto& n : fsm.getNodes() ) {
+        if ( n == nullptr ) continue;
+        for ( const auto& tr : n->getTransitions() ) {
+            Transition t;
+            t.source = n->getId();
+            t.input = tr->getLabel()->getInput();
+            t.output = tr->getLabel()->getOutput();
+            t.target = tr->getTarget()->getId();
+            trs.push_back(t);
+        }
+    }
+    h.numTransitions = trs.size();
+
+    vector<string> nameLst;
+    nameLst.push_back(fsm.getName());
+    vector<string> in2String = pl->getIn2String();
+    vector<string> out2String = pl->getOut2String();
+    vector<string> state2String = pl->getState2String();
+    nameLst.insert(nameLst.end(), in2String.begin(), in2String.end());
+    nameLst.insert(nameLst.end(), out2String.begin(), out2String.end());
+    nameLst.insert(nameLst.end(), state2String.begin(), state2String.end());
+    h.numInputNames = static_cast<uint32_t>(in2String.size());
+    h.numOutputNames = static_cast<uint32_t>(out2String.size());
+    h.numStateNames = static_cast<uint32_t>(state2String.size());
+    if ( static_cast<uint64_t>(h.maxState) >= maxNumStates(h) ) {
+        throw runtime_error("Could not write binary model file " + fname +
+                            ": the state numbers of " + fsm.getName() + " contain too many gaps");
+    }
+
+    vector<uint64_t> offsets(1, 0);
+    for ( const auto& s : nameLst ) {
+        offsets.push_back(offsets.back() + s.size());
+    }
+
+    ofstream out(fname, ios::binary);
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.write(reinterpret_cast<const char*>(trs.data()), trs.size() * sizeof(Transition));
+    out.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+    for ( const auto& s : nameLst ) {
+        out.write(s.data(), s.size());
+    }
+    out.close();
+    if ( not out ) {
+        throw runtime_error("Could not write binary model file " + fname);
+    }
+}
+
+string BinaryFsm::getName(const size_t i) const
+{
+    return string(names + nameOffsets[i], nameOffsets[i+1] - nameOffsets[i]);
+}
+
+shared_ptr<FsmPresentationLayer> BinaryFsm::createPresentationLayer() const
+{
+    vector<string> in2String;
+    vector<string> out2String;
+    vector<string> state2String;
+
+    size_t i = 1;
+    for ( uint32_t k = 0; k < header->numInputNames; k++ ) {
+        in2String.push_back(getName(i++));
+    }
+    for ( uint32_t k = 0; k < header->numOutputNames; k++ ) {
+        out2String.push_back(getName(i++));
+    }
+    for ( uint32_t k = 0; k < header->numStateNames; k++ ) {
+        state2String.push_back(getName(i++));
+    }
+
+    return make_shared<FsmPresentationLayer>(in2String, out2String, state2String);
+}
+
+shared_ptr<Fsm> BinaryFsm::createFsm(const string& fsmName,
+                                     const shared_ptr<FsmPresentationLayer>& pl) const
+{
+    if ( header->initStateIdx < 0 or header->initStateIdx > header->maxState ) {
+        throw runtime_error("binary model file contains illegal initial state " +
+                            to_string(header->initStateIdx));
+    }
+
+    // Like Fsm::readFsm(), only create the nodes of states occurring
+    // in some transition, so that gaps in the state ids remain null
+    vector<shared_ptr<FsmNode>> lst(header->maxState + 1);
+    lst[header->initStateIdx] = make_shared<FsmNode>(header->initStateIdx, fsmName, pl);
+
+    for ( size_t i = 0; i < header->numTransitions; i++ ) {
+        const Transition& t = transitions[i];
+        if ( t.source < 0 or t.source > header->maxState or
+             t.target < 0 or t.target > header->maxState ) {
+            throw runtime_error("binary model file contains illegal state " +
+                                to_string(t.source < 0 or t.source > header->maxState ?
+                                          t.source : t.target));
+        }
+        if ( t.input < 0 or t.input > header->maxInput or
+             t.output < 0 or t.output > header->maxOutput ) {
+            throw runtime_error("binary model file contains illegal transition label " +
+                                to_string(t.input) + "/" + to_string(t.output));
+        }
+        if ( lst[t.source] == nullptr ) lst[t.source] = make_shared<FsmNode>(t.source, fsmName, pl);
+        if ( lst[t.target] == nullptr ) lst[t.target] = make_shared<FsmNode>(t.target, fsmName, pl);
+        auto lbl = make_shared<FsmLabel>(t.input, t.output, pl);
+        lst[t.source]->addTransition(make_shared<FsmTransition>(lst[t.source], lst[t.target], lbl));
+    }
+
+    return make_shared<Fsm>(fsmName, header->maxInput, header->maxOutput,
+                            lst, header->initStateIdx, pl);
+}
+
+shared_ptr<Fsm> BinaryFsm::createFsm() const
+{
+    return createFsm(getName(0), createPresentationLayer());
+}
+
+shared_ptr<Dfsm> BinaryFsm::createDfsm() const
+{
+    return make_shared<Dfsm>(*createFsm());
+}
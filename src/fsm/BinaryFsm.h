@@ -0,0 +1,122 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_FSM_BINARYFSM_H_
+#define FSM_FSM_BINARYFSM_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "utils/MappedFile.hpp"
+
+class Fsm;
+class Dfsm;
+class FsmPresentationLayer;
+
+/**
+ *  Binary file format for an Fsm or Dfsm together with its
+ *  presentation layer, designed to be memory-mapped and used in place.
+ *
+ *  Layout (all numbers in host byte order, detected by the byte order mark):
+ *  \li Header, see below
+ *  \li numTransitions transition records (source, input, output, target),
+ *      grouped by source state in the order of the FsmNode transition lists
+ *  \li (numNames + 1) 64-bit offsets of the names, relative to the
+ *      start of the character data
+ *  \li character data of the names: the FSM name, followed by the input
+ *      names, the output names and the state names, without terminators
+ *
+ *  A file is opened with the constructor, which only maps and checks
+ *  the file. The transitions and names can be accessed in place;
+ *  createFsm() and createDfsm() build the FsmNode graph from them.
+ */
+class BinaryFsm
+{
+public:
+
+    /** Current version of the format */
+    static const uint32_t VERSION = 1;
+
+    /** A transition source --input/output--> target */
+    struct Transition
+    {
+        int32_t source;
+        int32_t input;
+        int32_t output;
+        int32_t target;
+    };
+
+    struct Header
+    {
+        /** "FSMB" */
+        char magic[4];
+        uint32_t version;
+        /** 0x01020304, written in host byte order */
+        uint32_t byteOrder;
+        /** 1 if the model has been written from a Dfsm */
+        uint32_t deterministic;
+        int32_t maxInput;
+        int32_t maxOutput;
+        int32_t maxState;
+        int32_t initStateIdx;
+        uint64_t numTransitions;
+        uint32_t numInputNames;
+        uint32_t numOutputNames;
+        uint32_t numStateNames;
+        uint32_t reserved;
+    };
+
+private:
+
+    MappedFile file;
+    const Header* header;
+    const Transition* transitions;
+    const uint64_t* nameOffsets;
+    const char* names;
+
+    std::string getName(const size_t i) const;
+
+    std::shared_ptr<Fsm> createFsm(const std::string& fsmName,
+                                   const std::shared_ptr<FsmPresentationLayer>& pl) const;
+
+public:
+
+    /**
+     *  Map a binary model file
+     *  @throws std::runtime_error if the file cannot be read or is
+     *          not a binary model file of the current version
+     */
+    explicit BinaryFsm(const std::string& fname);
+
+    /**
+     *  Write fsm and its presentation layer to a binary model file
+     *  @throws std::runtime_error if the file cannot be written
+     */
+    static void write(const Fsm& fsm, const std::string& fname);
+
+    /** Return true if the file starts like a binary model file */
+    static bool isBinaryFsm(const std::string& fname);
+
+    const Header& getHeader() const { return *header; }
+    bool isDeterministic() const { return header->deterministic != 0; }
+
+    size_t getNumTransitions() const { return header->numTransitions; }
+
+    /** Transitions, stored in place in the mapped file */
+    const Transition* getTransitions() const { return transitions; }
+
+    /** Create a presentation layer from the names in the file */
+    std::shared_ptr<FsmPresentationLayer> createPresentationLayer() const;
+
+    /** Create an Fsm from the file, with a new presentation layer */
+    std::shared_ptr<Fsm> createFsm() const;
+
+    /** Create a Dfsm from the file, with a new presentation layer */
+    std::shared_ptr<Dfsm> createDfsm() const;
+
+};
+
+#endif //FSM_FSM_BINARYFSM_H_
@@ -0,0 +1,169 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include "CanonicalFsmEnumerator.h"
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+#include "fsm/Fsm.h"
+#include "fsm/FsmNode.h"
+#include "fsm/FsmTransition.h"
+#include "fsm/FsmLabel.h"
+
+namespace {
+
+/** Minimal number of prefixes per shard the shards are formed of */
+const unsigned long prefixesPerShard = 8;
+
+}
+
+CanonicalFsmEnumerator::CanonicalFsmEnumerator(int maxInput, int maxOutput, int maxState,
+                                               const std::shared_ptr<FsmPresentationLayer>& presentationLayer,
+                                               bool generateSmallerFsms, bool onlyMinimalFsms,
+                                               unsigned int numShards, unsigned int shard)
+    : maxInput(maxInput), maxOutput(maxOutput), maxState(maxState), generateSmallerFsms(generateSmallerFsms),
+      onlyMinimalFsms(onlyMinimalFsms), numShards(numShards), shard(shard),
+      presentationLayer(presentationLayer), numLabels((maxInput + 1) * (maxOutput + 1))
+{
+    if (numShards == 0 || shard >= numShards) {
+        throw std::invalid_argument("CanonicalFsmEnumerator: illegal shard " + std::to_string(shard) +
+                                    " of " + std::to_string(numShards) + " shards");
+    }
+    startTables(generateSmallerFsms ? 1 : maxState + 1);
+}
+
+bool CanonicalFsmEnumerator::admissible(int cell, int target, int maxSeen) const {
+    // state s+1 must occur as a target in a row up to s, and the
+    // largest state occurring grows by at most one per cell
+    int s = cell / numLabels;
+    int remaining = numLabels - 1 - cell % numLabels;
+    return s + 1 >= numStates || std::max(maxSeen, target) + remaining >= s + 1;
+}
+
+unsigned long CanonicalFsmEnumerator::countPrefixes(int cell, int depth, int maxSeen, unsigned long limit) const {
+    if (cell == depth) return 1;
+
+    unsigned long n = 0;
+    for (int target = -1; target <= std::min(numStates - 1, maxSeen + 1) && n < limit; ++target) {
+        if (admissible(cell, target, maxSeen)) {
+            n += countPrefixes(cell + 1, depth, std::max(maxSeen, target), limit - n);
+        }
+    }
+    return n;
+}
+
+void CanonicalFsmEnumerator::startTables(int states) {
+    numStates = states;
+    int numCells = numStates * numLabels;
+    table.assign(numCells, -1);
+    maxBefore.assign(numCells, 0);
+
+    // split at the first cell such that there are enough
+    // prefixes preceding it to distribute them evenly
+    numPrefixes = 0;
+    splitCell = 0;
+    if (numShards > 1) {
+        unsigned long target = prefixesPerShard * numShards;
+        do {
+            ++splitCell;
+        } while (splitCell < numCells && countPrefixes(0, splitCell, 0, target) < target);
+    }
+
+    currentCell = 0;
+    table[0] = -2;
+    if (splitCell == 0 && shard != 0) currentCell = -1;
+}
+
+bool CanonicalFsmEnumerator::nextTable() {
+    // depth-first search for the next canonical table in lexicographic
+    // order, where -1 precedes all targets, starting at currentCell
+    const int numCells = static_cast<int>(table.size());
+    int c = currentCell;
+    while (c >= 0) {
+        if (table[c] >= std::min(numStates - 1, maxBefore[c] + 1)) {
+            --c;
+            continue;
+        }
+        ++table[c];
+        if (!admissible(c, table[c], maxBefore[c])) continue;
+
+        // skip the tables of prefixes belonging to other shards
+        if (c + 1 == splitCell && (numPrefixes++) % numShards != shard) continue;
+
+        if (c + 1 == numCells) {
+            currentCell = c;
+            return true;
+        }
+        ++c;
+        maxBefore[c] = std::max(maxBefore[c - 1], table[c - 1]);
+        table[c] = -2;
+    }
+    currentCell = -1;
+    return false;
+}
+
+bool CanonicalFsmEnumerator::isMinimal() const {
+    // Refine the partition of the states until states in the same class
+    // have transitions with the same labels to targets in the same classes.
+    // As the FSM is observable, these are exactly the equivalent states.
+    std::vector<int> cls(numStates, 0);
+    size_t numClasses = 1;
+    while (true) {
+        std::map<std::vector<int>, int> classOf;
+        std::vector<int> refined(numStates);
+        std::vector<int> signature(numLabels + 1);
+        for (int s = 0; s < numStates; ++s) {
+            signature[0] = cls[s];
+            for (int l = 0; l < numLabels; ++l) {
+                int tgt = table[s * numLabels + l];
+                signature[l + 1] = (tgt < 0) ? -1 : cls[tgt];
+            }
+            int id = static_cast<int>(classOf.size());
+            refined[s] = classOf.emplace(signature, id).first->second;
+        }
+        if (classOf.size() == numClasses) break;
+        numClasses = classOf.size();
+        cls.swap(refined);
+    }
+    return static_cast<int>(numClasses) == numStates;
+}
+
+bool CanonicalFsmEnumerator::hasNext() {
+    while (true) {
+        while (nextTable()) {
+            if (onlyMinimalFsms && !isMinimal()) continue;
+            ++candidateNum;
+            return true;
+        }
+        if (numStates > maxState) return false;
+        startTables(numStates + 1);
+    }
+}
+
+Fsm CanonicalFsmEnumerator::getNext() {
+
+    std::vector<std::shared_ptr<FsmNode>> nodes;
+    for (int i = 0; i < numStates; ++i) {
+        nodes.push_back(std::make_shared<FsmNode>(i,presentationLayer));
+    }
+
+    for (int i = 0; i < numStates; ++i) {
+        for (int x = 0; x <= maxInput; ++x) {
+            for (int y = 0; y <= maxOutput; ++y) {
+                int tgt = table[(i * (maxInput + 1) + x) * (maxOutput + 1) + y];
+                if (tgt >= 0) {
+                    auto label = std::make_shared<FsmLabel>(x,y,presentationLayer);
+                    auto transition = std::make_shared<FsmTransition>(nodes[i], nodes[tgt], label);
+                    nodes[i]->addTransition(transition);
+                }
+            }
+        }
+    }
+
+    return Fsm(std::to_string(candidateNum),maxInput,maxOutput,nodes,presentationLayer);
+}
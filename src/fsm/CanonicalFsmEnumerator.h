@@ -0,0 +1,122 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef CANONICAL_FSM_ENUMERATOR_H_
+#define CANONICAL_FSM_ENUMERATOR_H_
+
+#include <memory>
+#include <vector>
+
+#include "fsm/Fsm.h"
+
+/**
+ * An enumerator that returns one FSM of each isomorphism class of FSMs using a given number
+ * of states, inputs and outputs. Like FsmEnumerator, it returns observable but possibly
+ * non-deterministic and/or partial FSMs whose states are all reachable from the initial state 0.
+ *
+ * Each FSM is represented by a table assigning to every state s, input x and output y the target
+ * state of the transition s --x/y--> or -1 if there is no such transition. The cells of the table
+ * are ordered by state, input and output, and only canonical tables are enumerated: tables in which
+ * the states are numbered in order of their first occurrence as a target, that is, in the order
+ * of a breadth-first search of the FSM visiting the transitions of each state in the order of their
+ * labels. As every FSM with reachable states has exactly one such numbering, each isomorphism class
+ * is produced exactly once. Prefixes of tables that cannot be completed to a canonical table are
+ * pruned, so that the enumeration never visits tables of FSMs with unreachable states.
+ *
+ * Reachability and, optionally, minimality are decided on the table itself, and an Fsm is only
+ * created when getNext() is called.
+ *
+ * The enumeration space can be split into numShards disjoint shards of roughly equal size,
+ * the union of which contains every canonical table. Enumerators for different shards of the
+ * same space are independent of each other and may be run in different threads or processes.
+ */
+class CanonicalFsmEnumerator
+{
+private:
+    const int maxInput;
+    const int maxOutput;
+    const int maxState;
+    const bool generateSmallerFsms;
+    const bool onlyMinimalFsms;
+    const unsigned int numShards;
+    const unsigned int shard;
+    const std::shared_ptr<FsmPresentationLayer> presentationLayer;
+
+    /** Number of cells in each row of the table, that is, the number of labels */
+    const int numLabels;
+
+    int candidateNum = 0;
+
+    /** Number of states of the tables currently enumerated */
+    int numStates;
+
+    /** Table currently enumerated, indexed by (s * (maxInput+1) + x) * (maxOutput+1) + y */
+    std::vector<int> table;
+
+    /**
+     * maxBefore[c] is the largest state among the initial state and the targets of the cells
+     * preceding cell c, so that the target of cell c is at most maxBefore[c]+1 in a canonical table
+     */
+    std::vector<int> maxBefore;
+
+    /** Cell to be changed by the next call of nextTable(), or -1 if the table is not initialised */
+    int currentCell = -1;
+
+    /** Shards are formed by the assignments to the cells preceding this cell */
+    int splitCell = 0;
+
+    /** Number of assignments to the cells preceding splitCell encountered so far */
+    unsigned long numPrefixes = 0;
+
+    /** Start the enumeration of the tables with the given number of states */
+    void startTables(int states);
+
+    /** Check whether a prefix ending in cell with the given target can be completed to a canonical table */
+    bool admissible(int cell, int target, int maxSeen) const;
+
+    /** Count the admissible assignments to the cells from cell to depth-1, stop counting at limit */
+    unsigned long countPrefixes(int cell, int depth, int maxSeen, unsigned long limit) const;
+
+    bool nextTable();
+    bool isMinimal() const;
+
+public:
+    /**
+     * @param maxInput The largest input to be used.
+     * @param maxOutput The largest output to be used.
+     * @param maxState The largest state index to be used.
+     * @param presentationLayer The presentation layer to be used in returned FSMs.
+     * @param generateSmallerFsms If true, then FSMs with 1 to (maxState+1) states are generated,
+     *                            in ascending order of their number of states.
+     *                            Otherwise, only FSMs with exactly (maxState+1) states are generated.
+     * @param onlyMinimalFsms If true, then only FSMs without equivalent states are generated.
+     * @param numShards Number of shards the enumeration space is split into.
+     * @param shard Index of the shard to be enumerated, in range 0..numShards-1.
+     * @throws std::invalid_argument if numShards is 0 or shard is not below numShards
+     */
+    CanonicalFsmEnumerator(int maxInput, int maxOutput, int maxState,
+                           const std::shared_ptr<FsmPresentationLayer>& presentationLayer,
+                           bool generateSmallerFsms = false,
+                           bool onlyMinimalFsms = false,
+                           unsigned int numShards = 1,
+                           unsigned int shard = 0);
+
+    bool hasNext();
+
+    /** Create the FSM of the table found by the last call of hasNext() */
+    Fsm getNext();
+
+    /**
+     * @return The table found by the last call of hasNext(), of size
+     *         getNumStates() * (maxInput+1) * (maxOutput+1)
+     */
+    const std::vector<int>& getTable() const { return table; }
+
+    /** @return The number of states of the table found by the last call of hasNext() */
+    int getNumStates() const { return numStates; }
+};
+
+
+#endif // CANONICAL_FSM_ENUMERATOR_H_
@@ -1,3 +1,8 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
 #include "fsm/ConvergenceGraph.h"
 #include "fsm/Dfsm.h"
 #include "fsm/FsmNode.h"
@@ -7,12 +12,14 @@
 
 #include <memory>
 #include <vector>
-#include <iostream>
+#include <utility>
 
 
 ConvergenceGraph::ConvergenceGraph(const Dfsm& dfsm, const std::shared_ptr<Tree> testSuit)
- : dfsm(dfsm), testSuite(testSuit), root(std::make_shared<ConvergenceNode>(dfsm.getInitialState(), testSuite->getRoot(), dfsm.getMaxInput() +1)) 
+ : testSuite(testSuit), numInputs(dfsm.getMaxInput() + 1), version(0)
 {
+    addConvergentNode(newNode(), testSuite->getRoot());
+
     // add the current traces in the test suite (avoiding computation of intermediate containers)
     for (auto& n : testSuite->getLeaves())
 	{
@@ -20,94 +27,130 @@ ConvergenceGraph::ConvergenceGraph(const Dfsm& dfsm, const std::shared_ptr<Tree>
 	}
 }
 
-std::shared_ptr<ConvergenceNode> ConvergenceGraph::after(const std::vector<int>& trace) {
-    std::shared_ptr<ConvergenceNode> node = root;
-    for (int x : trace) {
-        node = node->nextForInput[x];
+int ConvergenceGraph::newNode() {
+    int n = static_cast<int>(parent.size());
+    parent.push_back(n);
+    classSize.push_back(1);
+    next.insert(next.end(), numInputs, -1);
+    convergentNodes.emplace_back();
+    return n;
+}
+
+int ConvergenceGraph::find(int n) {
+    int r = n;
+    while (parent[r] != r) r = parent[r];
+    // path compression
+    while (parent[n] != r) {
+        int p = parent[n];
+        parent[n] = r;
+        n = p;
+    }
+    return r;
+}
+
+int ConvergenceGraph::representative(int n) const {
+    while (parent[n] != n) n = parent[n];
+    return n;
+}
+
+void ConvergenceGraph::addConvergentNode(int n, const std::shared_ptr<TreeNode>& treeNode) {
+    if (nodeOf.emplace(treeNode.get(), n).second) {
+        convergentNodes[find(n)].push_back(treeNode);
     }
-    return node;
 }
 
-void ConvergenceGraph::replaceAfter(const std::vector<int>& trace, int input, std::shared_ptr<ConvergenceNode> newNode) {
-    std::shared_ptr<ConvergenceNode> node = after(trace);
-    node->nextForInput[input] = newNode;
+int ConvergenceGraph::after(const std::vector<int>& trace) const {
+    int n = 0;
+    for (int x : trace) {
+        n = next[representative(n) * numInputs + x];
+        if (n < 0) return -1;
+    }
+    return representative(n);
 }
 
 
-void ConvergenceGraph::add(const std::vector<int>& trace) 
+void ConvergenceGraph::add(const std::vector<int>& trace)
 {
-    std::shared_ptr<ConvergenceNode> node = root;
-    std::shared_ptr<FsmNode> state = dfsm.getInitialState();
+    ++version;
+    int n = find(0);
     std::shared_ptr<TreeNode> treeNode = testSuite->getRoot();
     for (int x : trace) {
 
-        // the dfsm is assumed to be complete and any trace
-        // is assumed to contain only inputs accepted by the dfsm
-        // - thus exactly one state is reached via input x
-        state = *state->after({x}).begin();
-
-        // it is also assumed that trace is contained in the test suite
+        // it is assumed that trace is contained in the test suite
         treeNode = treeNode->after(x);
 
-        if (!node->nextForInput[x]) {
-            node->nextForInput[x] = std::make_shared<ConvergenceNode>(state,treeNode,dfsm.getMaxInput()+1);
+        int m = next[n * numInputs + x];
+        if (m < 0) {
+            m = newNode();
+            next[n * numInputs + x] = m;
         } else {
-            // if a convergent node already exists, then the current prefix of
-            // the trace converges with that node and should be added 
-            node->nextForInput[x]->convergentNodes.insert(treeNode);
+            m = find(m);
         }
 
-        node = node->nextForInput[x];
+        // if a convergent node already exists, then the current prefix of
+        // the trace converges with that node and is added to its class
+        addConvergentNode(m, treeNode);
+        n = m;
     }
 }
 
 
-void ConvergenceGraph::mergeInto(const std::shared_ptr<ConvergenceNode> node1, const std::shared_ptr<ConvergenceNode> node2) {
-    // if the nodes already coincide, no merge is necessary
-    if (node1 == node2) {
-        std::cout << "merging identical nodes!" << std::endl;
-        return;
-    }
-    
-    for (auto & conv : node1->convergentNodes) {
-        node2->convergentNodes.insert(conv);
-    }
-    
-    for (int x = 0; x <= dfsm.getMaxInput(); ++x) {
-        if (! node1->nextForInput[x]) {
-            // nothing to merge into right node here
-            continue;            
+void ConvergenceGraph::unite(int n1, int n2) {
+    std::vector<std::pair<int,int>> pending { std::make_pair(n1,n2) };
+
+    while (!pending.empty()) {
+        int r1 = find(pending.back().first);
+        int r2 = find(pending.back().second);
+        pending.pop_back();
+
+        // if the nodes already coincide, no merge is necessary
+        if (r1 == r2) continue;
+
+        // the smaller class is merged into the larger one
+        if (classSize[r1] > classSize[r2]) std::swap(r1,r2);
+        parent[r1] = r2;
+        classSize[r2] += classSize[r1];
+
+        auto& nodes1 = convergentNodes[r1];
+        auto& nodes2 = convergentNodes[r2];
+        if (nodes1.size() > nodes2.size()) nodes1.swap(nodes2);
+        nodes2.insert(nodes2.end(), nodes1.begin(), nodes1.end());
+        std::vector<std::shared_ptr<TreeNode>>().swap(nodes1);
+
+        // congruence: successors defined in both classes converge as well
+        for (size_t x = 0; x < numInputs; ++x) {
+            int s1 = next[r1 * numInputs + x];
+            int& s2 = next[r2 * numInputs + x];
+            if (s1 < 0) continue;
+            if (s2 < 0) {
+                s2 = s1;
+            } else {
+                pending.push_back(std::make_pair(s1,s2));
+            }
         }
-        
-        if (! node2->nextForInput[x]) {
-            // "replace" empty content of right node with content of left node
-            node2->nextForInput[x] = node1->nextForInput[x];
-        } else {
-            // both sides are not empty -> perform recursive merge
-            mergeInto(node1->nextForInput[x], node2->nextForInput[x]);    
-        }        
     }
 }
 
 
-void ConvergenceGraph::merge(const std::vector<int>& trace1, int input, const std::vector<int>& trace2) 
+void ConvergenceGraph::merge(const std::vector<int>& trace1, int input, const std::vector<int>& trace2)
 {
-    std::shared_ptr<ConvergenceNode> node  = after(trace1);
-    std::shared_ptr<ConvergenceNode> nodeL = node->nextForInput[input];
-    std::shared_ptr<ConvergenceNode> nodeR = after(trace2);
+    ++version;
+    int node = after(trace1);
+    int nodeL = next[node * numInputs + input];
+    int nodeR = after(trace2);
 
-    
-    node->nextForInput[input] = nodeR;    
-    mergeInto(nodeL,nodeR);
+    unite(nodeL,nodeR);
 }
 
 
-std::unordered_set<std::shared_ptr<TreeNode>> ConvergenceGraph::getConvergentTraces(const std::vector<int>& trace) 
+const std::vector<std::shared_ptr<TreeNode>>& ConvergenceGraph::getConvergentTraces(const std::vector<int>& trace) const
 {
-    return after(trace)->convergentNodes;
+    static const std::vector<std::shared_ptr<TreeNode>> none;
+    int n = after(trace);
+    return (n < 0) ? none : convergentNodes[n];
 }
 
-bool ConvergenceGraph::hasLeaf(const std::vector<int>& trace) 
+bool ConvergenceGraph::hasLeaf(const std::vector<int>& trace) const
 {
     for (auto & treeNode : getConvergentTraces(trace)) {
         if (treeNode->isLeaf())
@@ -115,3 +158,8 @@ bool ConvergenceGraph::hasLeaf(const std::vector<int>& trace)
     }
     return false;
 }
+
+int ConvergenceGraph::getClass(const std::vector<int>& trace) const
+{
+    return after(trace);
+}
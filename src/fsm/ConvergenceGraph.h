@@ -1,6 +1,6 @@
 /*
  * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
- * 
+ *
  * Licensed under the EUPL V.1.1
  */
 #ifndef FSM_FSM_CONVERGENCEGRAPH_H_
@@ -8,7 +8,7 @@
 
 #include <memory>
 #include <vector>
-#include <unordered_set>
+#include <unordered_map>
 
 #include <trees/TreeNode.h>
 #include <fsm/FsmNode.h>
@@ -17,49 +17,95 @@
 class Dfsm;
 
 
-// Type of nodes in the convergence graph
-struct ConvergenceNode {
-    // traces converging in this node
-    std::unordered_set<std::shared_ptr<TreeNode>> convergentNodes;
-    // nextForInput[x] is the convergence node reached by input x 
-    std::vector<std::shared_ptr<ConvergenceNode>> nextForInput;
-    // state of the underlying DFSM corresponding to this node
-    std::shared_ptr<FsmNode> state;
-
-    bool isLeaf = true;
-
-    ConvergenceNode(std::shared_ptr<FsmNode> node,std::shared_ptr<TreeNode> convergentNode, size_t numInputs) {
-        state = node;
-        convergentNodes.insert(convergentNode);
-        nextForInput.resize(numInputs);
-    }
-};
-
+/**
+ *  Convergence graph of the SPYH method.
+ *
+ *  Nodes are identified by their index. Convergent nodes are kept in
+ *  union-find classes (union by size, path compression), and every
+ *  merge is closed under congruence: if two classes are merged, then
+ *  so are their successors for each input defined in both classes.
+ *
+ *  Each node of the test suite tree is mapped to the node of the graph
+ *  it has been added to, so that every tree node is contained in
+ *  exactly one class.
+ *
+ *  The const queries do not modify the graph and may be called
+ *  concurrently, as long as neither add() nor merge() is called.
+ */
 class ConvergenceGraph
 {
 private:
-    const Dfsm& dfsm;
     const std::shared_ptr<Tree> testSuite;
-    const std::shared_ptr<ConvergenceNode> root;
 
-    // assumes that trace is aready defined in the graph
-    std::shared_ptr<ConvergenceNode> after(const std::vector<int>& trace);
+    /** Number of inputs of the underlying DFSM */
+    size_t numInputs;
+
+    /** Union-find parent of each node, a node is a representative if parent[n] == n */
+    std::vector<int> parent;
+
+    /** Number of nodes in the class of each representative */
+    std::vector<int> classSize;
+
+    /**
+     *  next[n * numInputs + x] is the node reached from node n by input x,
+     *  -1 if undefined. Only the entries of representatives are up-to-date.
+     */
+    std::vector<int> next;
+
+    /** Test suite tree nodes converging in each class, stored at the representative */
+    std::vector<std::vector<std::shared_ptr<TreeNode>>> convergentNodes;
 
-    // assumes that trace followed by input is aready defined in the graph
-    void replaceAfter(const std::vector<int>& trace, int input, std::shared_ptr<ConvergenceNode> newNode);
+    /** Node of the graph each test suite tree node has been added to */
+    std::unordered_map<const TreeNode*,int> nodeOf;
 
-    void mergeInto(const std::shared_ptr<ConvergenceNode> node1, const std::shared_ptr<ConvergenceNode> node2);
+    /** Number of calls of add() and merge() */
+    size_t version;
+
+    int newNode();
+
+    /** Find the representative of n and compress the path to it */
+    int find(int n);
+
+    /** Find the representative of n without modifying the graph */
+    int representative(int n) const;
+
+    /** Merge the classes of n1 and n2 and, recursively, their successors */
+    void unite(int n1, int n2);
+
+    /** @return representative of the class reached by trace, -1 if trace is not defined in the graph */
+    int after(const std::vector<int>& trace) const;
+
+    void addConvergentNode(int n, const std::shared_ptr<TreeNode>& treeNode);
 
 public:
 	ConvergenceGraph(const Dfsm& dfsm, const std::shared_ptr<Tree> testSuite);
 
+    /** Add a trace contained in the test suite */
     void add(const std::vector<int>& trace);
 
+    /** Declare trace1.input and trace2 convergent */
     void merge(const std::vector<int>& trace1, int input, const std::vector<int>& trace2);
 
-    std::unordered_set<std::shared_ptr<TreeNode>> getConvergentTraces(const std::vector<int>& trace);
+    /**
+     *  @return the test suite tree nodes converging with trace. The
+     *  reference is invalidated by subsequent calls of add() and merge().
+     */
+    const std::vector<std::shared_ptr<TreeNode>>& getConvergentTraces(const std::vector<int>& trace) const;
+
+    bool hasLeaf(const std::vector<int>& trace) const;
+
+    /**
+     *  @return an id of the class of trace, which is equal for two traces
+     *  if and only if they converge, -1 if trace is not defined in the graph.
+     *  Ids remain valid until the next call of add() or merge().
+     */
+    int getClass(const std::vector<int>& trace) const;
+
+    /**
+     *  @return a number that changes whenever the graph (and thus the
+     *  test suite it has been created for) is extended by add() or merge()
+     */
+    size_t getVersion() const { return version; }
 
-    bool hasLeaf(const std::vector<int>& trace);
-	
 };
 #endif //FSM_FSM_CONVERGENCEGRAPH_H_
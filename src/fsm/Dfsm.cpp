@@ -20,13 +20,19 @@
 #include "fsm/InputTrace.h"
 #include "fsm/IOTrace.h"
 #include "fsm/SegmentedTrace.h"
+#include "fsm/TransitionTable.h"
+#include "fsm/PartitionRefinement.h"
+#include "fsm/DistTraceMatrix.h"
+#include "fsm/LazyTestSuite.h"
 #include "trees/Tree.h"
 #include "trees/IOListContainer.h"
 #include "trees/TreeNode.h"
 #include "trees/TreeEdge.h"
+#include "trees/InputTrie.h"
 #include "trees/OutputTree.h"
 #include "json/json.h"
 #include "utils/Logger.hpp"
+#include "utils/WorkStealingPool.hpp"
 
 
 
@@ -400,25 +406,6 @@ void Dfsm::createDfsmTransitionGraph(const string& fname) {
     
 }
 
-void Dfsm::initDistTraces() {
-    
-    distTraces.clear();
-    
-    for ( size_t n = 0; n < size(); n++ ) {
-        // Create empty vector of for row n, to be extended in
-        // the inner loop
-        vector< vector< shared_ptr< vector<int> > > > thisRow;
-        for ( size_t m = 0; m < size(); m++ ) {
-            // Create empty vector of pointers to traces
-            vector< shared_ptr< vector<int> > > v;
-            thisRow.push_back(v);
-        }
-        // Add thisRow to distTraces
-        distTraces.push_back(thisRow);
-    }
-    
-}
-
 Dfsm::Dfsm(const std::string & fname,
            const std::string & fsmName) : Fsm(nullptr), dfsmTable(nullptr) {
     name = fsmName;
@@ -436,7 +423,20 @@ Dfsm::Dfsm(const std::string & fname,
 
 void Dfsm::createAtRandom()
 {
-    srand(getRandomSeed());
+    // A generator of its own, so that the sequence of rand() of the
+    // caller is neither reseeded nor consumed
+    mt19937 gen(getRandomSeed());
+    createAtRandom(gen);
+}
+
+void Dfsm::createAtRandom(mt19937& gen)
+{
+    RandomSource rnd(gen);
+    createAtRandom(rnd);
+}
+
+void Dfsm::createAtRandom(RandomSource& rnd)
+{
     
     for (unsigned int i = 0; i < nodes.size(); ++ i)
     {
@@ -449,9 +449,9 @@ void Dfsm::createAtRandom()
         
         for (int input = 0; input <= maxInput; ++ input)
         {
-            int nTarget = rand() % nodes.size();
+            int nTarget = rnd() % nodes.size();
             shared_ptr<FsmNode> target = nodes.at(nTarget);
-            int output = rand() % (maxOutput + 1);
+            int output = rnd() % (maxOutput + 1);
             shared_ptr<FsmTransition> transition =
             make_shared<FsmTransition>(source,
                                        target,
@@ -463,8 +463,32 @@ void Dfsm::createAtRandom()
     }
 }
 
-vector<shared_ptr<PkTable> > Dfsm::getPktblLst() const
+vector<shared_ptr<PkTable> > Dfsm::getPktblLst()
+{
+    return createAllPkTables();
+}
+
+size_t Dfsm::getNumPkTables() const
+{
+    return ( pkRefinement != nullptr ) ? pkRefinement->getNumPartitions() : pktblLst.size();
+}
+
+shared_ptr<PkTable> Dfsm::getPkTable(const size_t k)
+{
+    if ( k >= getNumPkTables() ) return nullptr;
+    
+    // Partition k of the refinement coincides with P(k+1),
+    // and pkCursor is positioned at the partition of pktblLst.back()
+    while ( pktblLst.size() <= k ) {
+        pkCursor.next();
+        pktblLst.push_back(pktblLst.back()->getPkPlusOneTable(pkCursor.getPartition()));
+    }
+    return pktblLst[k];
+}
+
+const vector<shared_ptr<PkTable>>& Dfsm::createAllPkTables()
 {
+    if ( not pktblLst.empty() ) getPkTable(getNumPkTables() - 1);
     return pktblLst;
 }
 
@@ -515,6 +539,7 @@ Dfsm::Dfsm(const string & fsmName, const int maxNodes, const int maxInput, const
     dfsmTable = nullptr;
     name = fsmName;
     nodes.insert(nodes.end(), maxNodes, nullptr);
+    maxState = maxNodes - 1;
     initStateIdx = 0;
     this->maxInput = maxInput;
     this->maxOutput = maxOutput;
@@ -525,6 +550,20 @@ Dfsm::Dfsm(const string & fsmName, const int maxNodes, const int maxInput, const
     out.close();
 }
 
+Dfsm::Dfsm(const string & fsmName, const int maxNodes, const int maxInput, const int maxOutput, const shared_ptr<FsmPresentationLayer>& presentationLayer, mt19937& gen)
+: Fsm(presentationLayer)
+{
+    dfsmTable = nullptr;
+    name = fsmName;
+    nodes.insert(nodes.end(), maxNodes, nullptr);
+    maxState = maxNodes - 1;
+    initStateIdx = 0;
+    this->maxInput = maxInput;
+    this->maxOutput = maxOutput;
+    currentParsedNode = nullptr;
+    createAtRandom(gen);
+}
+
 Dfsm::Dfsm(const string & fsmName, const int maxInput, const int maxOutput, const vector<shared_ptr<FsmNode>>& lst, const shared_ptr<FsmPresentationLayer>& presentationLayer)
 : Fsm(fsmName, maxInput, maxOutput, lst, presentationLayer)
 {
@@ -1009,9 +1048,22 @@ void Dfsm::calcPkTables() {
     dfsmTable = toDFSMTable();
     
     pktblLst.clear();
+    pkRefinement = nullptr;
+    pkCursor = PartitionRefinement::Cursor();
     shared_ptr<PkTable> p1 = dfsmTable->getP1Table();
     pktblLst.push_back(p1);
     
+    if ( minimisationMode == MinimisationMode::PartitionRefinement ) {
+        shared_ptr<PartitionRefinement> pr = calcPartitionRefinement();
+        if ( pr != nullptr ) {
+            // Partition 0 of the refinement coincides with P1, the
+            // remaining tables are created by getPkTable() on demand
+            pkRefinement = pr;
+            pkCursor = PartitionRefinement::Cursor(*pkRefinement);
+            return;
+        }
+    }
+    
     for (shared_ptr<PkTable> pk = p1->getPkPlusOneTable();
          pk != nullptr;
          pk = pk->getPkPlusOneTable())
@@ -1041,15 +1093,35 @@ Dfsm Dfsm::minimise()
     removeUnreachableNodes(uNodes);
     
     calcPkTables();
-    shared_ptr<PkTable> pMin = pktblLst[pktblLst.size()-1];
+    shared_ptr<PkTable> pMin = getPkTable(getNumPkTables() - 1);
     
     auto dfsm = pMin->toFsm(name, maxOutput);
+    dfsm.minimisationMode = minimisationMode;
     dfsm.calcPkTables();
     return dfsm;
 }
 
-void Dfsm::printTables() const
+shared_ptr<PartitionRefinement> Dfsm::calcPartitionRefinement() const
+{
+    shared_ptr<TransitionTable> tbl = getTransitionTable();
+    if ( tbl == nullptr ) return nullptr;
+    
+    // The Pk-tables only consider the first transition for
+    // each input, so that the refinement is only applicable
+    // if this DFSM really is deterministic.
+    for ( int s = 0; s < tbl->getNumStates(); s++ ) {
+        for ( int x = 0; x < tbl->getNumInputs(); x++ ) {
+            if ( tbl->count(s,x) > 1 ) return nullptr;
+        }
+    }
+    
+    shared_ptr<PartitionRefinement> pr = make_shared<PartitionRefinement>(*tbl);
+    return pr->isValid() ? pr : nullptr;
+}
+
+void Dfsm::printTables()
 {
+    createAllPkTables();
     ofstream file("tables.tex");
     if (dfsmTable != nullptr)
     {
@@ -1065,23 +1137,13 @@ void Dfsm::printTables() const
 IOListContainer Dfsm::getCharacterisationSet()
 {
     /*Create Pk-tables for the minimised FSM*/
-    dfsmTable = toDFSMTable();
-    pktblLst.clear();
-    shared_ptr<PkTable> p1 = dfsmTable->getP1Table();
-    pktblLst.push_back(p1);
-    
-    for (shared_ptr<PkTable> pk = p1->getPkPlusOneTable();
-         pk != nullptr;
-         pk = pk->getPkPlusOneTable())
-    {
-        pktblLst.push_back(pk);
-    }
+    calcPkTables();
     
     
 #if 0
     
     cout << "Dfsm::getCharacterisationSet()" << endl;
-    cout << *p1 << endl;
+    cout << *pktblLst.front() << endl;
     for (auto p : pktblLst) {
         
         cout << *p << endl;
@@ -1111,7 +1173,7 @@ IOListContainer Dfsm::getCharacterisationSet()
              leftNode and rightNode are not distinguished by the current
              input traces contained in w. This step is performed
              according to Gill's algorithm.*/
-            InputTrace i = leftNode->calcDistinguishingTrace(rightNode, pktblLst, maxInput);
+            InputTrace i = leftNode->calcDistinguishingTrace(rightNode, createAllPkTables(), maxInput);
             shared_ptr<vector<vector<int>>> lli = make_shared<vector<vector<int>>>();
             lli->push_back(i.get());
             IOListContainer tcli = IOListContainer(lli, presentationLayer);
@@ -1157,11 +1219,24 @@ IOTrace Dfsm::applyDet(const InputTrace & i)
     OutputTrace o = OutputTrace(presentationLayer);
     
     shared_ptr<FsmNode> currentNode = nodes.at(initStateIdx);
+    shared_ptr<TransitionTable> tbl = getTransitionTable();
     
     // Apply input trace to FSM, as far as possible
-    for ( int input : i.get() ) {
-        if ( currentNode == nullptr ) break;
-        currentNode = currentNode->apply(input, o);
+    if ( tbl != nullptr ) {
+        int s = initStateIdx;
+        int y;
+        for ( auto it = i.cbegin(); it != i.cend(); ++it ) {
+            s = tbl->apply(s, *it, y);
+            if ( s < 0 ) break;
+            o.add(y);
+        }
+        if ( s < 0 ) currentNode = nullptr;
+    }
+    else {
+        for ( int input : i.get() ) {
+            if ( currentNode == nullptr ) break;
+            currentNode = currentNode->apply(input, o);
+        }
     }
     
     // Handle the case where the very first input is not accpeted
@@ -1209,6 +1284,72 @@ bool Dfsm::pass(const IOTrace & io)
     return myIO.getOutputTrace() == io.getOutputTrace();
 }
 
+vector<IOTrace> Dfsm::applyDet(const vector<InputTrace> & inputs)
+{
+    vector<IOTrace> result;
+    result.reserve(inputs.size());
+    
+    shared_ptr<TransitionTable> tbl = getTransitionTable();
+    if ( tbl == nullptr ) {
+        for ( const auto& i : inputs ) result.push_back(applyDet(i));
+        return result;
+    }
+    
+    InputTrie trie(presentationLayer);
+    vector<InputTrie::NodeId> tcNodes;
+    tcNodes.reserve(inputs.size());
+    for ( const auto& i : inputs ) {
+        tcNodes.push_back(trie.addToRoot(i.get()));
+    }
+    
+    // Every node of the trie is created after its parent, so that the
+    // state reached by the path to each node (or -1, if the path is not
+    // accepted) and the last output on the path are calculated in a single
+    // pass through the nodes, applying a single input per node
+    vector<int> state(trie.size());
+    vector<int> output(trie.size(), 0);
+    state[InputTrie::ROOT] = initStateIdx;
+    for ( InputTrie::NodeId n = InputTrie::ROOT + 1; n < trie.size(); ++n ) {
+        int s = state[trie.getParent(n)];
+        state[n] = ( s < 0 ) ? -1 : tbl->apply(s, trie.getLabel(n), output[n]);
+    }
+    
+    // The accepted inputs of a trace form a prefix of the trace,
+    // consisting of the inputs of the nodes with a defined state
+    vector<int> o;
+    for ( size_t k = 0; k < inputs.size(); ++k ) {
+        o.clear();
+        for ( InputTrie::NodeId n = tcNodes[k]; n != InputTrie::ROOT; n = trie.getParent(n) ) {
+            if ( state[n] >= 0 ) o.push_back(output[n]);
+        }
+        reverse(o.begin(), o.end());
+        
+        vector<int> i = inputs[k].get();
+        i.resize(o.size());
+        result.push_back(IOTrace(InputTrace(i, presentationLayer),
+                                 OutputTrace(o, presentationLayer)));
+    }
+    
+    return result;
+}
+
+vector<bool> Dfsm::pass(const vector<IOTrace> & ios)
+{
+    vector<InputTrace> inputs;
+    inputs.reserve(ios.size());
+    for ( const auto& io : ios ) {
+        inputs.push_back(io.getInputTrace());
+    }
+    
+    vector<IOTrace> myIOs = applyDet(inputs);
+    vector<bool> verdicts;
+    verdicts.reserve(ios.size());
+    for ( size_t k = 0; k < ios.size(); ++k ) {
+        verdicts.push_back(myIOs[k].getOutputTrace() == ios[k].getOutputTrace());
+    }
+    return verdicts;
+}
+
 
 
 IOListContainer Dfsm::wMethod(const unsigned int numAddStates) {
@@ -1238,6 +1379,23 @@ IOListContainer Dfsm::wMethodOnMinimisedDfsm(const unsigned int numAddStates)
     return iTree->getIOLists();
 }
 
+void Dfsm::wMethod(const unsigned int numAddStates, TestCaseSink& sink) {
+
+    Dfsm dfsmMin = minimise();
+    dfsmMin.wMethodOnMinimisedDfsm(numAddStates, sink);
+
+}
+
+void Dfsm::wMethodOnMinimisedDfsm(const unsigned int numAddStates, TestCaseSink& sink)
+{
+    shared_ptr<Tree> iTree = getTransitionCover();
+    IOListContainer w = getCharacterisationSet();
+
+    LazyTestSuite testSuite(maxInput);
+    testSuite.addProduct(*iTree, numAddStates, w);
+    testSuite.enumerate(sink);
+}
+
 IOListContainer Dfsm::wpMethod(const unsigned int numAddStates)
 {
     Dfsm dfsmMin = minimise();
@@ -1284,6 +1442,30 @@ IOListContainer Dfsm::wpMethodOnMinimisedDfsm(const unsigned int numAddStates)
     return Wp1->getIOLists();
 }
 
+void Dfsm::wpMethod(const unsigned int numAddStates, TestCaseSink& sink)
+{
+    Dfsm dfsmMin = minimise();
+    dfsmMin.wpMethodOnMinimisedDfsm(numAddStates, sink);
+}
+
+void Dfsm::wpMethodOnMinimisedDfsm(const unsigned int numAddStates, TestCaseSink& sink)
+{
+    shared_ptr<Tree> scov = getStateCover();
+
+    shared_ptr<Tree> tcov = getTransitionCover();
+
+    tcov->remove(scov);
+
+    IOListContainer w = getCharacterisationSet();
+
+    calcStateIdentificationSetsFast();
+
+    LazyTestSuite testSuite(maxInput);
+    testSuite.addProduct(*scov, numAddStates, w);
+    testSuite.addProduct(*tcov, numAddStates, getInitialState(), stateIdentificationSets);
+    testSuite.enumerate(sink);
+}
+
 IOListContainer Dfsm::hsiMethod(const unsigned int numAddStates)
 {
     Fsm fMin = minimiseObservableFSM();
@@ -1352,7 +1534,7 @@ InputTrace Dfsm::calcDistinguishingTrace(
         return gamma2;
 
     return s1->calcDistinguishingTrace(s2,
-                                       pktblLst,
+                                       createAllPkTables(),
                                        maxInput);
 }
 
@@ -1376,7 +1558,7 @@ vector<int> Dfsm::calcDistinguishingTrace(shared_ptr<SegmentedTrace> alpha,
         return gamma2.get();
     
     return s1->calcDistinguishingTrace(s2,
-                                       pktblLst,
+                                       createAllPkTables(),
                                        maxInput).get();
     
 }
@@ -1454,7 +1636,7 @@ InputTrace Dfsm::calcDistinguishingTraceAfterTree(
         // Since we are dealing with a minimised DFSM, a distinguishing
         // trace can ALWAYS be found, if s_i_after_input != s_j_after_input
         InputTrace gamma = s_i_after_input->calcDistinguishingTrace(s_j_after_input ,
-                                                                        pktblLst,
+                                                                        createAllPkTables(),
                                                                         maxInput);
 
         itrc->append(gamma.get());
@@ -1467,6 +1649,89 @@ InputTrace Dfsm::calcDistinguishingTraceAfterTree(
     return InputTrace(presentationLayer);
 }
 
+InputTrace Dfsm::calcDistinguishingTrace(
+        const shared_ptr<InputTrace> iAlpha,
+        const shared_ptr<InputTrace> iBeta,
+        const InputTrie& tree)
+{
+    shared_ptr<FsmNode> s0 = getInitialState();
+    shared_ptr<FsmNode> s1 = *s0->after(*iAlpha).begin();
+    shared_ptr<FsmNode> s2 = *s0->after(*iBeta).begin();
+
+    InputTrace gamma = calcDistinguishingTraceInTree(s1, s2, tree);
+    if (!gamma.get().empty())
+        return gamma;
+
+    InputTrace gamma2 = calcDistinguishingTraceAfterTree(s1, s2, tree);
+    if (!gamma2.get().empty())
+        return gamma2;
+
+    return s1->calcDistinguishingTrace(s2,
+                                       createAllPkTables(),
+                                       maxInput);
+}
+
+InputTrace Dfsm::calcDistinguishingTraceInTree(
+        const shared_ptr<FsmNode> s_i,
+        const shared_ptr<FsmNode> s_j,
+        const InputTrie& tree)
+{
+    deque<InputTrie::NodeId> q1;
+
+    /* initialize queue */
+    for ( InputTrie::NodeId c = tree.getFirstChild(InputTrie::ROOT);
+          c != InputTrie::NONE; c = tree.getNextSibling(c) ) {
+        q1.push_back(c);
+    }
+
+    /* Breadth-first search */
+    while(!q1.empty())
+    {
+        InputTrie::NodeId n = q1.front();
+        q1.pop_front();
+
+        vector<int> path = tree.getPath(n);
+        if(s_i->distinguished(s_j, path))
+        {
+            return InputTrace(path, presentationLayer);
+        }
+
+        for ( InputTrie::NodeId c = tree.getFirstChild(n);
+              c != InputTrie::NONE; c = tree.getNextSibling(c) ) {
+            q1.push_back(c);
+        }
+    }
+    // Return empty trace: no distinguishing trace found in tree
+    return InputTrace(presentationLayer);
+}
+
+InputTrace Dfsm::calcDistinguishingTraceAfterTree(
+        const shared_ptr<FsmNode> s_i,
+        const shared_ptr<FsmNode> s_j,
+        const InputTrie& tree)
+{
+    for ( InputTrie::NodeId leaf : tree.getLeaves() )
+    {
+        InputTrace itrc(tree.getPath(leaf), presentationLayer);
+        shared_ptr<FsmNode> s_i_after_input = *(s_i->after(itrc)).begin();
+        shared_ptr<FsmNode> s_j_after_input = *(s_j->after(itrc)).begin();
+
+        if(s_i_after_input == s_j_after_input ) continue;
+
+        InputTrace gamma = s_i_after_input->calcDistinguishingTrace(s_j_after_input ,
+                                                                        createAllPkTables(),
+                                                                        maxInput);
+
+        itrc.append(gamma.get());
+
+        return itrc;
+    }
+
+    // Return empty trace: could not find a tree extension
+    // distinguishing s_i and s_j
+    return InputTrace(presentationLayer);
+}
+
 IOListContainer Dfsm::hMethodOnMinimisedDfsm(const unsigned int numAddStates) {
     
     // Our initial state
@@ -1481,7 +1746,7 @@ IOListContainer Dfsm::hMethodOnMinimisedDfsm(const unsigned int numAddStates) {
     shared_ptr<Tree> V = getStateCover();
     
     // Test suite is initialised with the state cover
-    shared_ptr<Tree> iTree = getStateCover();
+    InputTrie iTree(*getStateCover());
     
     IOListContainer inputEnum = IOListContainer(maxInput,
                                                 (int)numAddStates+1,
@@ -1489,7 +1754,7 @@ IOListContainer Dfsm::hMethodOnMinimisedDfsm(const unsigned int numAddStates) {
                                                 presentationLayer);
     
     // Initial test suite set is V.Sigma^{m-n+1}, m-n = numAddStates
-    iTree->add(inputEnum);
+    iTree.add(inputEnum);
     
     // Step 1.
     // Add all alpha.gamma, beta.gamma where alpha, beta in V
@@ -1509,11 +1774,12 @@ IOListContainer Dfsm::hMethodOnMinimisedDfsm(const unsigned int numAddStates) {
             shared_ptr<InputTrace> beta =
             make_shared<InputTrace>(iolV->at(j),presentationLayer);
 
-            shared_ptr<Tree> alphaTree = iTree->getSubTree(alpha);
-            shared_ptr<Tree> betaTree = iTree->getSubTree(beta);
-            shared_ptr<Tree> prefixRelationTree = alphaTree->getPrefixRelationTree(betaTree);
+            shared_ptr<InputTrie> prefixRelationTree =
+                iTree.getPrefixRelationTree(iTree.after(InputTrie::ROOT, alpha->cbegin(), alpha->cend()),
+                                            iTree,
+                                            iTree.after(InputTrie::ROOT, beta->cbegin(), beta->cend()));
 
-            InputTrace gamma = calcDistinguishingTrace(alpha, beta, prefixRelationTree);
+            InputTrace gamma = calcDistinguishingTrace(alpha, beta, *prefixRelationTree);
 
             shared_ptr<InputTrace> iAlphaGamma = make_shared<InputTrace>(alpha->get(), presentationLayer);
             iAlphaGamma->append(gamma.get());
@@ -1521,8 +1787,8 @@ IOListContainer Dfsm::hMethodOnMinimisedDfsm(const unsigned int numAddStates) {
             shared_ptr<InputTrace> iBetaGamma = make_shared<InputTrace>(beta->get(), presentationLayer);
             iBetaGamma->append(gamma.get());
 
-            iTree->addToRoot(iAlphaGamma->get());
-            iTree->addToRoot(iBetaGamma->get());
+            iTree.addToRoot(iAlphaGamma->get());
+            iTree.addToRoot(iBetaGamma->get());
         }
         
     }
@@ -1560,11 +1826,12 @@ IOListContainer Dfsm::hMethodOnMinimisedDfsm(const unsigned int numAddStates) {
 
                 if ( s_alpha_beta == s_omega ) continue;
 
-                shared_ptr<Tree> alphaBetaTree = iTree->getSubTree(iAlphaBeta);
-                shared_ptr<Tree> trAfterOmega = iTree->getSubTree(iOmega);
-                shared_ptr<Tree> prefixRelationTree = alphaBetaTree->getPrefixRelationTree(trAfterOmega);
+                shared_ptr<InputTrie> prefixRelationTree =
+                    iTree.getPrefixRelationTree(iTree.after(InputTrie::ROOT, iAlphaBeta->cbegin(), iAlphaBeta->cend()),
+                                                iTree,
+                                                iTree.after(InputTrie::ROOT, iOmega->cbegin(), iOmega->cend()));
 
-                InputTrace gamma = calcDistinguishingTrace(iAlphaBeta, iOmega, prefixRelationTree);
+                InputTrace gamma = calcDistinguishingTrace(iAlphaBeta, iOmega, *prefixRelationTree);
 
                 shared_ptr<InputTrace> iAlphaBetaGamma = make_shared<InputTrace>(iAlphaBeta->get(), presentationLayer);
                 iAlphaBetaGamma->append(gamma.get());
@@ -1572,8 +1839,8 @@ IOListContainer Dfsm::hMethodOnMinimisedDfsm(const unsigned int numAddStates) {
                 shared_ptr<InputTrace> iOmegaGamma = make_shared<InputTrace>(iOmega->get(), presentationLayer);
                 iOmegaGamma->append(gamma.get());
 
-                iTree->addToRoot(iAlphaBetaGamma->get());
-                iTree->addToRoot(iOmegaGamma->get());
+                iTree.addToRoot(iAlphaBetaGamma->get());
+                iTree.addToRoot(iOmegaGamma->get());
             }
             
         }
@@ -1628,11 +1895,12 @@ IOListContainer Dfsm::hMethodOnMinimisedDfsm(const unsigned int numAddStates) {
                     
                     if ( s1 == s2 ) continue;
 
-                    shared_ptr<Tree> afterAlphaBeta1Tree = iTree->getSubTree(iAlphaBeta_1);
-                    shared_ptr<Tree> afterAlphaBeta2Tree = iTree->getSubTree(iAlphaBeta_2);
-                    shared_ptr<Tree> prefixRelationTree = afterAlphaBeta1Tree->getPrefixRelationTree(afterAlphaBeta2Tree);
+                    shared_ptr<InputTrie> prefixRelationTree =
+                        iTree.getPrefixRelationTree(iTree.after(InputTrie::ROOT, iAlphaBeta_1->cbegin(), iAlphaBeta_1->cend()),
+                                                    iTree,
+                                                    iTree.after(InputTrie::ROOT, iAlphaBeta_2->cbegin(), iAlphaBeta_2->cend()));
 
-                    InputTrace gamma = calcDistinguishingTrace(iAlphaBeta_1, iAlphaBeta_2, prefixRelationTree);
+                    InputTrace gamma = calcDistinguishingTrace(iAlphaBeta_1, iAlphaBeta_2, *prefixRelationTree);
 
                     shared_ptr<InputTrace> iAlphaBeta_1Gamma = make_shared<InputTrace>(iAlphaBeta_1->get(), presentationLayer);
                     iAlphaBeta_1Gamma->append(gamma.get());
@@ -1640,15 +1908,15 @@ IOListContainer Dfsm::hMethodOnMinimisedDfsm(const unsigned int numAddStates) {
                     shared_ptr<InputTrace> iAlphaBeta_2Gamma = make_shared<InputTrace>(iAlphaBeta_2->get(), presentationLayer);
                     iAlphaBeta_2Gamma->append(gamma.get());
 
-                    iTree->addToRoot(iAlphaBeta_1Gamma->get());
-                    iTree->addToRoot(iAlphaBeta_2Gamma->get());
+                    iTree.addToRoot(iAlphaBeta_1Gamma->get());
+                    iTree.addToRoot(iAlphaBeta_2Gamma->get());
                 }
             }
         
         }
     }
 
-    return iTree->getIOLists();
+    return iTree.getIOLists();
 
 }
 
@@ -1659,103 +1927,44 @@ bool Dfsm::distinguishable(const FsmNode& s1, const FsmNode& s2) {
         calcPkTables();
     }
     
-    shared_ptr<PkTable> p = pktblLst.back();
+    shared_ptr<PkTable> p = getPkTable(getNumPkTables() - 1);
     
     return ( p->getClass(s1.getId()) != p->getClass(s2.getId()) );
     
 }
 
-void Dfsm::calculateDistMatrix() {
-    initDistTraces();
+void Dfsm::calculateDistMatrix(const unsigned int numThreads) {
     calcPkTables();
     
-    for ( size_t n = 0; n < size(); n++ ) {
-        for ( size_t m = n+1; m < size(); m++ ) {
-            // Skip indistinguishable nodes
-            if ( not distinguishable(*nodes[n], *nodes[m]) ) continue;
-            
-            vector< shared_ptr< vector<int> > > u = calcDistTraces(*nodes[n],*nodes[m]);
-            distTraces[n][m] = u;
-            distTraces[m][n] = u;
-            
-        }
+    shared_ptr<TransitionTable> tbl = getTransitionTable();
+    if ( tbl == nullptr ) {
+        throw runtime_error("Dfsm::calculateDistMatrix(): states are not numbered consecutively");
     }
     
-    
-}
-
-vector< shared_ptr< vector<int> > >  Dfsm::calcDistTraces(shared_ptr< vector<int> > trc,
-                                                          int id1,
-                                                          int id2) {
-    
-    vector< shared_ptr< vector<int> > > v;
-    
-    for ( int x = 0; x <= maxInput; x++ ) {
-        int y1 = dfsmTable->getRow(id1)->getioSection()[x];
-        int y2 = dfsmTable->getRow(id2)->getioSection()[x];
-        
-        if ( y1 != y2 ) {
-            shared_ptr< vector<int> > newTrc = make_shared< vector<int> >(*trc);
-            newTrc->push_back(x);
-            v.push_back(newTrc);
-        }
-    }
-    
-    return v;
-    
-}
-
-vector< shared_ptr< vector<int> > > Dfsm::calcDistTraces(size_t l,
-                                                         shared_ptr< vector<int> > trc,
-                                                         int id1,
-                                                         int id2) {
-    if ( l == 0 ) return calcDistTraces(trc,id1,id2);
-    
-    vector< shared_ptr< vector<int> > > v;
-    shared_ptr<PkTable> thisPkTbl = pktblLst[l];
-    shared_ptr<PkTable> prevPkTbl = pktblLst[l-1];
-    
-    for ( int x = 0; x <= maxInput; x++ ) {
-        int idNext1 = thisPkTbl->getRow(id1)->getI2PMap()[x];
-        int idNext2 = thisPkTbl->getRow(id2)->getI2PMap()[x];
-
-        if ( prevPkTbl->getClass(idNext1) != prevPkTbl->getClass(idNext2) ) {
-            shared_ptr< vector<int> > newTrc = make_shared< vector<int> >(*trc);
-            newTrc->push_back(x);
-            vector< shared_ptr< vector<int> > > w = calcDistTraces(l-1,newTrc,idNext1,idNext2);
-            v.insert(v.end(),w.begin(),w.end());
+    // Class of each state in each Pk-table
+    vector< vector<int> > classes;
+    for ( const auto& pk : createAllPkTables() ) {
+        vector<int> c(size());
+        for ( size_t n = 0; n < size(); n++ ) {
+            c[n] = pk->getClass(static_cast<int>(n));
         }
-        
+        classes.push_back(c);
     }
     
-    return v;
+    distTraceMatrix = make_shared<DistTraceMatrix>(*tbl, classes, maxInput, numThreads);
+    distTraceMatrixTable = tbl;
     
 }
 
-
-vector< shared_ptr< vector<int> > > Dfsm::calcDistTraces(FsmNode& s1,
-                                                         FsmNode& s2) {
-    
-    int id1 = s1.getId();
-    int id2 = s2.getId();
-    
-    // Find first Pk-table distPkTbl,  where s1 and s2 are distinguished
-    size_t l = 0;
-    shared_ptr<PkTable> distPkTbl = nullptr;
-    for ( ; l < pktblLst.size(); l++ ) {
-        distPkTbl = pktblLst[l];
-        if ( distPkTbl->getClass(id1) != distPkTbl->getClass(id2) )
-            break;
-    }
-    
-    return calcDistTraces(l,make_shared< vector<int> >(),id1,id2);
+bool Dfsm::hasCurrentDistMatrix() const {
+    return distTraceMatrix != nullptr and getTransitionTable() == distTraceMatrixTable;
 }
 
-
 vector< shared_ptr< vector<int> > > Dfsm::getDistTraces(FsmNode& s1,
                                                                   FsmNode& s2) {
     
-    return distTraces[s1.getId()][s2.getId()];
+    if ( not hasCurrentDistMatrix() ) return vector< shared_ptr< vector<int> > >();
+    return distTraceMatrix->getTraces(s1.getId(),s2.getId());
     
 }
 
@@ -1782,20 +1991,20 @@ size_t Dfsm::spyhEstimateGrowthOfTestSuite(const std::shared_ptr<FsmNode> u, con
         return 2 * size();
 
     // otherwise compute and use the shortest distinguishing trace of u and v
-    auto distTraces = getDistTraces(*u,*v);
-    size_t minEst = distTraces[0]->size();
-    for (auto & trace : distTraces) {
-        if (trace->size() < minEst) {
-            minEst = trace->size();
-        }
-    }
+    size_t minEst = distTraceMatrix->getMinTraceLength(u->getId(),v->getId());
     return minEst * 2 + 1;
+}
+
 
-    // TODO: avoid recomputation of minimal length dist-traces
+Dfsm::SpyhState::SpyhState(std::shared_ptr<Tree> testSuite, ConvergenceGraph& graph, const WorkStealingPool* pool)
+: testSuite(testSuite), graph(graph), pool(pool)
+{
+    if (pool != nullptr)
+        workerCaches.resize(pool->getNumThreads());
 }
 
 
-std::pair<size_t,std::stack<int>> Dfsm::spyhGetPrefixOfSeparatingTrace(const std::vector<int>& trace1, const std::vector<int>& trace2, std::shared_ptr<Tree> testSuite, ConvergenceGraph& graph) {
+std::pair<size_t,std::stack<int>> Dfsm::spyhGetPrefixOfSeparatingTrace(const std::vector<int>& trace1, const std::vector<int>& trace2, const ConvergenceGraph& graph, SpyhCache& cache) {
     
     // get shortest sequences in each class
     std::vector<int> u = trace1;
@@ -1811,24 +2020,47 @@ std::pair<size_t,std::stack<int>> Dfsm::spyhGetPrefixOfSeparatingTrace(const std
         }
     }
 
+    // the result only depends on u and v, as long as the test suite
+    // and the convergence graph remain unchanged
+    if (cache.graphVersion != graph.getVersion()) {
+        cache.prefixes.clear();
+        cache.graphVersion = graph.getVersion();
+    }
+    auto key = std::make_pair(u,v);
+    auto cached = cache.prefixes.find(key);
+    if (cached != cache.prefixes.end())
+        return cached->second;
+
+    auto result = spyhCalcPrefixOfSeparatingTrace(u,v,graph,cache);
+    cache.prefixes.emplace(std::move(key),result);
+    return result;
+}
+
+
+std::pair<size_t,std::stack<int>> Dfsm::spyhCalcPrefixOfSeparatingTrace(const std::vector<int>& u, const std::vector<int>& v, const ConvergenceGraph& graph, SpyhCache& cache) {
+
     std::shared_ptr<FsmNode> stateU = *getInitialState()->after(u).begin();
     std::shared_ptr<FsmNode> stateV = *getInitialState()->after(v).begin();
 
     // get shortest distinguishing trace and use double its size as minEst
-    auto distTraces = getDistTraces(*stateU,*stateV);
-
-    
-    size_t minEst = distTraces[0]->size();
-    for (auto & trace : distTraces) {
-        if (trace->size() < minEst) {
-            minEst = trace->size();
-        }
-    }
+    size_t minEst = distTraceMatrix->getMinTraceLength(stateU->getId(),stateV->getId());
     minEst = 2 * minEst;
 
     // start with the empty prefix
     std::stack<int> bestPrefix;
 
+    // growth estimates only depend on the states reached by u and v
+    auto estimateGrowth = [&](int x) {
+        size_t k = (static_cast<size_t>(stateU->getId()) * size() + static_cast<size_t>(stateV->getId()))
+                   * static_cast<size_t>(getMaxInput() + 1) + static_cast<size_t>(x);
+        auto it = cache.growth.find(k);
+        if (it != cache.growth.end())
+            return it->second;
+        size_t e = spyhEstimateGrowthOfTestSuite(stateU,stateV,x);
+        cache.growth.emplace(k,e);
+        return e;
+    };
+
     if (!graph.hasLeaf(u)) 
         minEst = minEst + u.size();
     if (!graph.hasLeaf(v)) 
@@ -1875,7 +2107,7 @@ std::pair<size_t,std::stack<int>> Dfsm::spyhGetPrefixOfSeparatingTrace(const std
                 nextV.push_back(x);
 
                 // recursive call on u'x and v'x
-                auto targetPair = spyhGetPrefixOfSeparatingTrace(nextU, nextV, testSuite, graph);
+                auto targetPair = spyhGetPrefixOfSeparatingTrace(nextU, nextV, graph, cache);
 
                 // if u'x and v'x are already distinguished, then so are u' and v'
                 if (targetPair.first == 0)
@@ -1892,7 +2124,7 @@ std::pair<size_t,std::stack<int>> Dfsm::spyhGetPrefixOfSeparatingTrace(const std
 
             // if no such v' has been found, estimate growth on u and v
             if (!foundExtensionForV) {
-                size_t e = spyhEstimateGrowthOfTestSuite(stateU,stateV,x);   
+                size_t e = estimateGrowth(x);   
                 if (e != 1) {
                     if (graph.hasLeaf(u)) {
                        e = e+1; 
@@ -1931,7 +2163,7 @@ std::pair<size_t,std::stack<int>> Dfsm::spyhGetPrefixOfSeparatingTrace(const std
             }
 
             if (foundExtensionForV) {
-                size_t e = spyhEstimateGrowthOfTestSuite(stateU,stateV,x);   
+                size_t e = estimateGrowth(x);   
                 if (e != 1) {
                     if (graph.hasLeaf(v)) {
                        e = e+1; 
@@ -2001,17 +2233,38 @@ void Dfsm::spyhAppendSeparatingSequence(const std::vector<int>& traceToAppendTo,
 }
 
 
-void Dfsm::spyhDistinguish(const std::vector<int>& trace, const std::unordered_set<std::shared_ptr<InputTrace>> traces, std::shared_ptr<Tree> testSuite, ConvergenceGraph& graph) {
+void Dfsm::spyhDistinguish(const std::vector<int>& trace, const std::vector<std::shared_ptr<InputTrace>>& traces, SpyhState& spyh) {
     std::shared_ptr<FsmNode> u = *getInitialState()->after(trace).begin();
-    
+
+    // trace needs to be distinguished only from traces reaching other states
+    std::vector<std::vector<int>> otherTraces;
     for (auto & other : traces) {
         std::vector<int> otherTrace = other->get();
         std::shared_ptr<FsmNode> v = *getInitialState()->after(otherTrace).begin();
-        
-        // trace needs to be distinguished only from traces reaching other states
         if ( *u == *v) continue;
+        otherTraces.push_back(otherTrace);
+    }
+
+    // Evaluate the candidate separators for all other traces in parallel
+    // on the current test suite. A precomputed result is only used as long
+    // as the test suite has not been extended, so that the test suite is
+    // the same as if all candidates were evaluated sequentially.
+    std::vector<std::pair<size_t,std::stack<int>>> precomputed;
+    size_t precomputedVersion = spyh.graph.getVersion();
+    if (spyh.pool != nullptr && otherTraces.size() > 1) {
+        precomputed.resize(otherTraces.size());
+        const ConvergenceGraph& graph = spyh.graph;
+        spyh.pool->run(otherTraces.size(), [&](size_t i, unsigned int worker) {
+            precomputed[i] = spyhGetPrefixOfSeparatingTrace(trace,otherTraces[i],graph,spyh.workerCaches[worker]);
+        });
+    }
+
+    for (size_t i = 0; i < otherTraces.size(); ++i) {
+        const std::vector<int>& otherTrace = otherTraces[i];
 
-        auto distPair = spyhGetPrefixOfSeparatingTrace(trace,otherTrace,testSuite,graph);
+        auto distPair = (!precomputed.empty() && spyh.graph.getVersion() == precomputedVersion)
+            ? precomputed[i]
+            : spyhGetPrefixOfSeparatingTrace(trace,otherTrace,spyh.graph,spyh.cache);
         std::vector<int> w;
         while (!distPair.second.empty()) {
             int x = distPair.second.top();
@@ -2041,25 +2294,26 @@ void Dfsm::spyhDistinguish(const std::vector<int>& trace, const std::unordered_s
 
             } else {
                 // always chooses the first shortest distinguishing trace
-                auto distTrace = getDistTraces(*uwState,*vwState)[0];  
-                traceToAppend.insert(traceToAppend.end(), distTrace->begin(), distTrace->end());     
+                traceToAppend.insert(traceToAppend.end(),
+                                     distTraceMatrix->traceBegin(uwState->getId(),vwState->getId(),0),
+                                     distTraceMatrix->traceEnd(uwState->getId(),vwState->getId(),0));
             }
 
             // append separating sequences to 
-            spyhAppendSeparatingSequence(trace,traceToAppend,testSuite,graph);
-            spyhAppendSeparatingSequence(otherTrace,traceToAppend,testSuite,graph);
+            spyhAppendSeparatingSequence(trace,traceToAppend,spyh.testSuite,spyh.graph);
+            spyhAppendSeparatingSequence(otherTrace,traceToAppend,spyh.testSuite,spyh.graph);
         }
     }    
 }
 
-void Dfsm::spyhDistinguishFromSet(const std::vector<int>& u, const std::vector<int>& v, const std::unordered_set<std::shared_ptr<InputTrace>> stateCover, std::unordered_set<std::shared_ptr<InputTrace>> tracesToDistFrom, std::shared_ptr<Tree> testSuite, ConvergenceGraph& graph, unsigned int depth) {
+void Dfsm::spyhDistinguishFromSet(const std::vector<int>& u, const std::vector<int>& v, const std::vector<std::shared_ptr<InputTrace>>& stateCover, std::vector<std::shared_ptr<InputTrace>>& tracesToDistFrom, SpyhState& spyh, unsigned int depth) {
     
     // dist u 
-    spyhDistinguish(u,tracesToDistFrom,testSuite,graph);
+    spyhDistinguish(u,tracesToDistFrom,spyh);
 
     // check whether [v] contains no traces from the state cover
     bool notReferenced = true;
-    auto tracesConvergentToV = graph.getConvergentTraces(v);
+    const auto& tracesConvergentToV = spyh.graph.getConvergentTraces(v);
     for (auto & coverTrace : stateCover) {
         auto s = coverTrace->get();
         for (auto & traceConvergentToV : tracesConvergentToV) {
@@ -2074,63 +2328,62 @@ void Dfsm::spyhDistinguishFromSet(const std::vector<int>& u, const std::vector<i
 
     // if v has not been referenced already, distinguish it too
     if (notReferenced) {
-        spyhDistinguish(v,tracesToDistFrom,testSuite,graph);
+        spyhDistinguish(v,tracesToDistFrom,spyh);
     }
 
     if (depth > 0) {
-        std::shared_ptr<InputTrace> uTrace = std::make_shared<InputTrace>(u,presentationLayer);
-        std::shared_ptr<InputTrace> vTrace = std::make_shared<InputTrace>(v,presentationLayer);
-        
-        tracesToDistFrom.insert(uTrace);
+        // u and v are pushed onto tracesToDistFrom for the recursive calls
+        // and removed afterwards, so that no copy of the traces is needed
+        size_t numTracesToDistFrom = tracesToDistFrom.size();
+        tracesToDistFrom.push_back(std::make_shared<InputTrace>(u,presentationLayer));
         if (notReferenced) 
-            tracesToDistFrom.insert(vTrace);
+            tracesToDistFrom.push_back(std::make_shared<InputTrace>(v,presentationLayer));
 
         for (int x = 0; x <= getMaxInput(); ++x) {
-            spyhAppendSeparatingSequence(u,{x},testSuite,graph);
-            spyhAppendSeparatingSequence(v,{x},testSuite,graph);
+            spyhAppendSeparatingSequence(u,{x},spyh.testSuite,spyh.graph);
+            spyhAppendSeparatingSequence(v,{x},spyh.testSuite,spyh.graph);
             std::vector<int> ux = u;
             ux.push_back(x);
             std::vector<int> vx = v;
             vx.push_back(x);
-            spyhDistinguishFromSet(ux,vx,stateCover,tracesToDistFrom,testSuite,graph,depth-1);
+            spyhDistinguishFromSet(ux,vx,stateCover,tracesToDistFrom,spyh,depth-1);
         }
 
-
-        if (notReferenced) 
-            tracesToDistFrom.erase(vTrace);
-        tracesToDistFrom.erase(uTrace);
+        tracesToDistFrom.resize(numTracesToDistFrom);
     }
 }
 
 
 
-IOListContainer Dfsm::spyhMethodOnMinimisedCompleteDfsm(const unsigned int numAddStates) {
+IOListContainer Dfsm::spyhMethodOnMinimisedCompleteDfsm(const unsigned int numAddStates, const unsigned int numThreads) {
     // Our initial state
     shared_ptr<FsmNode> s0 = getInitialState();
     
     // We need a valid set of DFSM table, Pk-Tables, and dist-traces for this method
     calcPkTables();
-    calculateDistMatrix();
+    calculateDistMatrix(numThreads);
     
-    // collect all transitions to be verified
-    std::unordered_set<std::shared_ptr<FsmTransition>> transitions;
+    // collect all transitions to be verified, in the order of the nodes
+    // and their transition lists, so that the test suite does not depend
+    // on the addresses of the transitions
+    std::vector<std::shared_ptr<FsmTransition>> transitions;
     for (auto & node : nodes) {
         for (auto & t : node->getTransitions()) {
-            transitions.insert(t);
+            transitions.push_back(t);
         }
     }
 
-    // State Cover
+    // State Cover, in the order of its traces
     shared_ptr<Tree> V = getStateCover();
     IOListContainer iolcV = V->getIOListsWithPrefixes();
     shared_ptr<vector<vector<int>>> iolV = iolcV.getIOLists();
-    std::unordered_set<std::shared_ptr<InputTrace>> stateCover;
+    std::vector<std::shared_ptr<InputTrace>> stateCover;
     std::vector<std::shared_ptr<InputTrace>> stateCoverAssignment(size());
     //stateCoverAssignment.reserve(size());
     //stateCoverAssignment.resize(size(),std::make_shared<InputTrace>(presentationLayer));
     for ( size_t i = 0; i < iolV->size(); i++ ) {
         shared_ptr<InputTrace> alpha = make_shared<InputTrace>(iolV->at(i),presentationLayer);
-        stateCover.insert(alpha);
+        stateCover.push_back(alpha);
         std::shared_ptr<FsmNode> reachedState = *getInitialState()->after(iolV->at(i)).begin();
 
         stateCoverAssignment[reachedState->getId()] = alpha;
@@ -2140,11 +2393,22 @@ IOListContainer Dfsm::spyhMethodOnMinimisedCompleteDfsm(const unsigned int numAd
     shared_ptr<Tree> testSuite = getStateCover();
 
     ConvergenceGraph graph(*this, testSuite);
-    
+
+    // candidate separating traces are evaluated in parallel only if more than one thread is requested
+    std::unique_ptr<WorkStealingPool> pool;
+    if (numThreads != 1) {
+        pool.reset(new WorkStealingPool(numThreads));
+        if (pool->getNumThreads() <= 1) pool.reset();
+    }
+    SpyhState spyh(testSuite, graph, pool.get());
+
+    // the traces to be distinguished from are appended to the
+    // state cover traces in spyhDistinguishFromSet()
+    std::vector<std::shared_ptr<InputTrace>> tracesToDistFrom(stateCover);
 
     // distinguish traces in state cover and note already verified nodes
     for ( auto & trace : stateCover ) {
-        spyhDistinguish(trace->get(),stateCover,testSuite,graph);
+        spyhDistinguish(trace->get(),tracesToDistFrom,spyh);
     }
 
     // filter all already verified transitions - i.e. all transitions
@@ -2153,13 +2417,14 @@ IOListContainer Dfsm::spyhMethodOnMinimisedCompleteDfsm(const unsigned int numAd
     // As the state cover generated by getStateCover() is minimal,
     // this holds for all transitions along prefixes of traces in the
     // state cover.
+    std::unordered_set<std::shared_ptr<FsmTransition>> verified;
     for (auto & trace : stateCover) {
         auto u = trace->get();
         std::shared_ptr<FsmNode> state = getInitialState();
         for (auto x : u) {
             for (auto & t : state->getTransitions()) {
                 if (t->getLabel()->getInput() == x) {
-                    transitions.erase(t);
+                    verified.insert(t);
                     state = t->getTarget();
                     break;
                 }
@@ -2167,15 +2432,16 @@ IOListContainer Dfsm::spyhMethodOnMinimisedCompleteDfsm(const unsigned int numAd
         }
     }
 
-    // sort remaining transitions
+    // sort remaining transitions, keeping the order of transitions of equal weight
     std::vector<std::shared_ptr<FsmTransition>> sortedTransitions;
     std::vector<std::pair<std::shared_ptr<FsmTransition>,size_t>> sortedTransitionsWithWeights;
     for (auto & t : transitions) {
+        if (verified.count(t) > 0) continue;
         size_t size = stateCoverAssignment[t->getSource()->getId()]->size() + stateCoverAssignment[t->getTarget()->getId()]->size();
         sortedTransitionsWithWeights.push_back(std::make_pair(t,size));
 
     }
-    std::sort(sortedTransitionsWithWeights.begin(), sortedTransitionsWithWeights.end(), [](const std::pair<std::shared_ptr<FsmTransition>,size_t>& t1, const std::pair<std::shared_ptr<FsmTransition>,size_t>& t2) {
+    std::stable_sort(sortedTransitionsWithWeights.begin(), sortedTransitionsWithWeights.end(), [](const std::pair<std::shared_ptr<FsmTransition>,size_t>& t1, const std::pair<std::shared_ptr<FsmTransition>,size_t>& t2) {
         return t1.second < t2.second;
     });
     for (auto & ts : sortedTransitionsWithWeights) {
@@ -2201,13 +2467,7 @@ IOListContainer Dfsm::spyhMethodOnMinimisedCompleteDfsm(const unsigned int numAd
 
         auto v = targetTrace->get();
 
-        // create a copy of the state cover 
-        std::unordered_set<std::shared_ptr<InputTrace>> stateCoverCopy;
-        for (auto & elem : stateCover) {
-            stateCoverCopy.insert(elem);
-        }
-
-        spyhDistinguishFromSet(ux,v,stateCover,stateCoverCopy,testSuite,graph,numAddStates);
+        spyhDistinguishFromSet(ux,v,stateCover,tracesToDistFrom,spyh,numAddStates);
 
         graph.merge(sourceTrace->get(),x,v);
     }
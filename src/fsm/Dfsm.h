@@ -10,15 +10,21 @@
 #include <string>
 #include <vector>
 #include <stack>
+#include <map>
+#include <unordered_map>
 
 #include "fsm/Fsm.h"
 #include "fsm/ConvergenceGraph.h"
+#include "fsm/PartitionRefinement.h"
 
 class PkTable;
 class IOTrace;
 class TreeNode;
 class DFSMTable;
 class SegmentedTrace;
+class DistTraceMatrix;
+class InputTrie;
+class WorkStealingPool;
 
 
 namespace Json {
@@ -34,50 +40,101 @@ private:
 	//TODO
 	std::vector<std::shared_ptr<PkTable>> pktblLst;
 
+	/**
+	Partitions of the Pk-tables, if they have been calculated by a
+	PartitionRefinement. In this case, pktblLst only contains the
+	tables requested so far, and pkCursor is positioned at the
+	partition of its last table (see getPkTable()).
+	*/
+	std::shared_ptr<PartitionRefinement> pkRefinement;
+	PartitionRefinement::Cursor pkCursor;
+
+	/**
+	Create all Pk-tables not created so far
+	@return pktblLst
+	*/
+	const std::vector<std::shared_ptr<PkTable>>& createAllPkTables();
+
 	/**
 	Create a DFSMTable from the DFSM
 	@return The DFSMTable created
 	*/
 	std::shared_ptr<DFSMTable> toDFSMTable() const;
+
+	/**
+	Calculate the partitions corresponding to the Pk-tables
+	by means of a PartitionRefinement.
+	@return nullptr if this DFSM cannot be represented by a
+	TransitionTable or is not deterministic
+	*/
+	std::shared_ptr<PartitionRefinement> calcPartitionRefinement() const;
     
     std::shared_ptr<FsmPresentationLayer> createPresentationLayerFromCsvFormat(const std::string& fname);
     
     std::shared_ptr<FsmPresentationLayer> createPresentationLayerFromCsvFormat(const std::string& fname,const std::shared_ptr<FsmPresentationLayer>& pl);
     
     void createDfsmTransitionGraph(const std::string& fname);
+
+    /** Create the transitions at random, drawing all random numbers from rnd */
+    void createAtRandom(RandomSource& rnd);
     
     /**
-     *   distTraces[n][m] contains a vector of pointers to
-     *   traces distinguishing this from FsmNode number n
+     *   Traces distinguishing the states of this DFSM,
+     *   calculated by calculateDistMatrix()
      */
-    std::vector< std::vector< std::vector< std::shared_ptr< std::vector<int> > > > > distTraces;
-    
-    void initDistTraces();
-    
-    std::vector< std::shared_ptr< std::vector<int> > > calcDistTraces(FsmNode& s1,
-                                                                      FsmNode& s2);
-    
-    std::vector< std::shared_ptr< std::vector<int> > > calcDistTraces(size_t l,
-                                                                      std::shared_ptr< std::vector<int> > trc,
-                                                                      int id1,
-                                                                      int id2);
-    
-    std::vector< std::shared_ptr< std::vector<int> > > calcDistTraces(std::shared_ptr< std::vector<int> > trc,
-                                                                      int id1,
-                                                                      int id2);
+    std::shared_ptr<DistTraceMatrix> distTraceMatrix;
 
+    /**
+     *   Transition table distTraceMatrix has been calculated from.
+     *   As getTransitionTable() creates a new table whenever the
+     *   FSM has been modified, the matrix is stale if the current
+     *   table is a different one.
+     */
+    std::shared_ptr<TransitionTable> distTraceMatrixTable;
 
 
+
+    /**
+     *  Results of spyhCalcPrefixOfSeparatingTrace() and spyhEstimateGrowthOfTestSuite().
+     *  The prefixes depend on the test suite and the convergence graph and
+     *  are all discarded as soon as the version of the graph changes, that is,
+     *  after every add() or merge(). They are not invalidated per node, as a
+     *  prefix depends on the classes of all pairs visited by the recursion.
+     *  The cache pays off within a single evaluation of candidate separators,
+     *  where the recursion reaches the same class pairs many times.
+     *  The growth estimates only depend on this DFSM.
+     */
+    struct SpyhCache {
+        size_t graphVersion = 0;
+        std::map<std::pair<std::vector<int>,std::vector<int>>,std::pair<size_t,std::stack<int>>> prefixes;
+        std::unordered_map<size_t,size_t> growth;
+    };
+
+    /** State of a run of the SPYH method */
+    struct SpyhState {
+        std::shared_ptr<Tree> testSuite;
+        ConvergenceGraph& graph;
+        SpyhCache cache;
+        /** Pool evaluating candidate separators in parallel, nullptr if sequential */
+        const WorkStealingPool* pool;
+        /** Cache of each worker of the pool */
+        std::vector<SpyhCache> workerCaches;
+
+        SpyhState(std::shared_ptr<Tree> testSuite, ConvergenceGraph& graph, const WorkStealingPool* pool);
+    };
+
     // corresponds to method Distinguish of the original description of the SPYH method
-    void spyhDistinguish(const std::vector<int>& trace, const std::unordered_set<std::shared_ptr<InputTrace>> traces, std::shared_ptr<Tree> testSuite, ConvergenceGraph& graph);
+    void spyhDistinguish(const std::vector<int>& trace, const std::vector<std::shared_ptr<InputTrace>>& traces, SpyhState& spyh);
     // corresponds to method GetPrefixOfSepSeq of the original description of the SPYH method
-    std::pair<size_t,std::stack<int>> spyhGetPrefixOfSeparatingTrace(const std::vector<int>& trace1, const std::vector<int>& trace2, std::shared_ptr<Tree> testSuite, ConvergenceGraph& graph);
+    std::pair<size_t,std::stack<int>> spyhGetPrefixOfSeparatingTrace(const std::vector<int>& trace1, const std::vector<int>& trace2, const ConvergenceGraph& graph, SpyhCache& cache);
+    // GetPrefixOfSepSeq for the shortest representatives u and v of the classes of the traces
+    std::pair<size_t,std::stack<int>> spyhCalcPrefixOfSeparatingTrace(const std::vector<int>& u, const std::vector<int>& v, const ConvergenceGraph& graph, SpyhCache& cache);
     // corresponds to method EstimateGrowthOfT of the original description of the SPYH method
     size_t spyhEstimateGrowthOfTestSuite(const std::shared_ptr<FsmNode> u, const std::shared_ptr<FsmNode> v, int input);
     // corresponds to method AppendSeparatingSequence of the original description of the SPYH method
     void spyhAppendSeparatingSequence(const std::vector<int>& traceToAppendTo, const std::vector<int>& traceToAppend, std::shared_ptr<Tree> testSuite, ConvergenceGraph& graph);
     // corresponds to method DistinguishFromSet of the original description of the SPYH method
-    void spyhDistinguishFromSet(const std::vector<int>& trace1, const std::vector<int>& trace2, const std::unordered_set<std::shared_ptr<InputTrace>> stateCover, std::unordered_set<std::shared_ptr<InputTrace>> tracesToDistFrom, std::shared_ptr<Tree> testSuite, ConvergenceGraph& graph, unsigned int depth);
+    void spyhDistinguishFromSet(const std::vector<int>& trace1, const std::vector<int>& trace2, const std::vector<std::shared_ptr<InputTrace>>& stateCover, std::vector<std::shared_ptr<InputTrace>>& tracesToDistFrom, SpyhState& spyh, unsigned int depth);
 public:
 	/**
 	Create a DFSM from a file description
@@ -117,6 +174,9 @@ public:
      Create a random mutant of this DFSM
      */
     void createAtRandom();
+
+    /** Variant of createAtRandom() drawing all random numbers from gen */
+    void createAtRandom(std::mt19937& gen);
     
 	/**
 	Random creation of a completely defined deterministic FSM
@@ -134,6 +194,18 @@ public:
          const int maxOutput,
          const std::shared_ptr<FsmPresentationLayer>& presentationLayer);
 
+    /**
+     Variant of the constructor above drawing all random numbers from gen.
+     Unlike the constructor above, the DFSM is not written to a file, so
+     that DFSMs can be created concurrently, using one generator per thread.
+     */
+    Dfsm(const std::string & fsmName,
+         const int maxNodes,
+         const int maxInput,
+         const int maxOutput,
+         const std::shared_ptr<FsmPresentationLayer>& presentationLayer,
+         std::mt19937& gen);
+
 	/**
 	Create a DFSM from a list of nodes
 	@param fsmName The name of the DFSM
@@ -230,6 +302,8 @@ public:
 	/**
 	Minimise this DFSM
 	As a side effect, create the DFSM table and all Pk tables needed.
+	The Pk tables are calculated according to the minimisation mode
+	(see Fsm::setMinimisationMode() and calcPkTables()).
 	@return the new minimised DFSM
 	*/
 	Dfsm minimise();
@@ -239,10 +313,31 @@ public:
 	The output file name is hard-coded as tables.tex.
 	\note This requires that the operation minimise() has been called before.
 	*/
-	void printTables() const;
+	void printTables();
 
+	/**
+	Calculate the DFSM table and the Pk-tables. In minimisation mode
+	MinimisationMode::Tables, all Pk-tables are created immediately.
+	In mode MinimisationMode::PartitionRefinement, only the partitions
+	are calculated, and each table is created when it is requested by
+	getPkTable() for the first time.
+	*/
     void calcPkTables();
 
+	/**
+	Number of Pk-tables P1, P2, ..., including the tables not created yet
+	\pre calcPkTables() has been called
+	*/
+	size_t getNumPkTables() const;
+
+	/**
+	Return the Pk-table P(k+1). If it does not exist yet, it is created
+	from its predecessor, which is created in the same way.
+	\pre calcPkTables() has been called
+	@return nullptr if k >= getNumPkTables()
+	*/
+	std::shared_ptr<PkTable> getPkTable(const size_t k);
+
 	/**
 	Calculate characterisation set according to Gill's algorithm
 	based on Pk-tables
@@ -270,6 +365,23 @@ public:
 	*/
 	bool pass(const IOTrace & io);
 
+	/**
+	Apply every input trace of a list to the initial state of the DFSM,
+	see applyDet(const InputTrace&). The traces are loaded into a prefix trie,
+	so that the inputs of a prefix shared by several traces are applied only once.
+	@param inputs input traces
+	@return the IOTrace of each input trace, in the order of the input traces
+	*/
+	std::vector<IOTrace> applyDet(const std::vector<InputTrace> & inputs);
+
+	/**
+	Check every IOTrace of a list, see pass(const IOTrace&).
+	The traces are applied by applyDet(const std::vector<InputTrace>&).
+	@param ios IOTraces to be checked against the DFSM
+	@return the verdict of each IOTrace, in the order of the IOTraces
+	*/
+	std::vector<bool> pass(const std::vector<IOTrace> & ios);
+
    /**
 	* Perform test generation by means of the W-Method.
     * The DFSM this method is applied to is regarded as the reference
@@ -302,6 +414,13 @@ public:
      */
     IOListContainer wMethodOnMinimisedDfsm(const unsigned int numAddStates);
 
+    /**
+     *  Streaming variants of wMethod() and wMethodOnMinimisedDfsm(),
+     *  see Fsm::wMethod(numAddStates,sink)
+     */
+    void wMethod(const unsigned int numAddStates, TestCaseSink& sink);
+    void wMethodOnMinimisedDfsm(const unsigned int numAddStates, TestCaseSink& sink);
+
 
 	/**
 	* Perform test generation by means of the Wp Method. The algorithm
@@ -324,6 +443,13 @@ public:
      */
     IOListContainer wpMethodOnMinimisedDfsm(const unsigned int numAddStates);
 
+    /**
+     *  Streaming variants of wpMethod() and wpMethodOnMinimisedDfsm(),
+     *  see Fsm::wMethod(numAddStates,sink)
+     */
+    void wpMethod(const unsigned int numAddStates, TestCaseSink& sink);
+    void wpMethodOnMinimisedDfsm(const unsigned int numAddStates, TestCaseSink& sink);
+
     /**
      * WORK IN PROGRESS
      * Perform test generation by means of the HSI-Method. The algorithm
@@ -398,6 +524,13 @@ public:
     std::vector<int> calcDistinguishingTrace(std::shared_ptr<SegmentedTrace> alpha,
                                              std::shared_ptr<SegmentedTrace> beta, const std::shared_ptr<TreeNode> treeNode);
 
+    /**
+     *  Same as calcDistinguishingTrace() above, searching the paths of
+     *  an InputTrie. Since the children in a trie are sorted by their
+     *  input, the paths are searched in lexicographic order.
+     */
+    InputTrace calcDistinguishingTrace(const std::shared_ptr<InputTrace> iAlpha, const std::shared_ptr<InputTrace> iBeta, const InputTrie& tree);
+
     /**
      *  Breadth-first search in a given Tree for a Trace that
      *  distinguishes the states s_i=s0->after(alpha) and s_j=s0->after(beta)
@@ -413,6 +546,7 @@ public:
      */
     InputTrace calcDistinguishingTraceInTree(const std::shared_ptr<FsmNode> s_i, const std::shared_ptr<FsmNode> s_j, const std::shared_ptr<Tree> tree);
     InputTrace calcDistinguishingTraceInTree(const std::shared_ptr<InputTrace> alpha, const std::shared_ptr<InputTrace> beta, const std::shared_ptr<Tree> tree);
+    InputTrace calcDistinguishingTraceInTree(const std::shared_ptr<FsmNode> s_i, const std::shared_ptr<FsmNode> s_j, const InputTrie& tree);
 
     /**
      *  Calculate trace that distinguishes the states s_i=s0->after(alpha) and
@@ -428,8 +562,10 @@ public:
      *   returns an empty InputTrace if no distinguishing trace could be found
      */
     InputTrace calcDistinguishingTraceAfterTree(const std::shared_ptr<FsmNode> s_i, const std::shared_ptr<FsmNode> s_j, const std::shared_ptr<Tree> tree);
+    InputTrace calcDistinguishingTraceAfterTree(const std::shared_ptr<FsmNode> s_i, const std::shared_ptr<FsmNode> s_j, const InputTrie& tree);
 
-    std::vector<std::shared_ptr<PkTable> > getPktblLst() const;
+    /** Return all Pk-tables, creating those not created so far */
+    std::vector<std::shared_ptr<PkTable> > getPktblLst();
     std::shared_ptr<DFSMTable> getDFSMTable() const { return dfsmTable; }
     
     
@@ -440,11 +576,21 @@ public:
     
     /**
      *   Calculate the distinguishability matrix
+     *   @param numThreads Number of threads used for the calculation,
+     *          0 means one thread per hardware thread
+     */
+    void calculateDistMatrix(const unsigned int numThreads = 1);
+
+    /**
+     *   Return true if the distinguishability matrix has been calculated
+     *   and the DFSM has not been modified since
      */
-    void calculateDistMatrix();
+    bool hasCurrentDistMatrix() const;
     
     /**
-     * Return the vector of shortest traces distinguishing s1 and s2
+     * Return the vector of shortest traces distinguishing s1 and s2,
+     * or an empty vector if the states are equivalent or there is no
+     * current distinguishability matrix, see hasCurrentDistMatrix()
      */
     std::vector< std::shared_ptr< std::vector<int> > > getDistTraces(FsmNode& s1,
                                                                      FsmNode& s2);
@@ -461,9 +607,12 @@ public:
      *                     generated test suite is complete for testing
      *                     against SUTs containing up to 
      *                     (numAddStates + size of this fsm) states.
+     * @param numThreads Number of threads evaluating candidate separating
+     *                   traces, 0 means one thread per hardware thread.
+     *                   The test suite does not depend on this number.
      * 
      * @return A complete test suite.
      */
-    IOListContainer spyhMethodOnMinimisedCompleteDfsm(const unsigned int numAddStates);
+    IOListContainer spyhMethodOnMinimisedCompleteDfsm(const unsigned int numAddStates, const unsigned int numThreads = 1);
 };
 #endif //FSM_FSM_DFSM_H_
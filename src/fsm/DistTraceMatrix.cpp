@@ -0,0 +1,144 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include "fsm/DistTraceMatrix.h"
+#include "fsm/TransitionTable.h"
+#include "utils/WorkStealingPool.hpp"
+
+using namespace std;
+
+namespace {
+
+/** Traces calculated for all pairs {n,m}, n < m, of one state m */
+struct RowResult
+{
+    vector<size_t> numTraces;
+    vector<size_t> traceLengths;
+    vector<int> inputs;
+};
+
+/** Read-only data shared by all tasks */
+struct DistTraceInput
+{
+    int numInputs;
+    vector<int> outputs;
+    vector<int> targets;
+    const vector<vector<int>>* classes;
+
+    /**
+     *  Collect the traces distinguishing s1 and s2 with respect to
+     *  table P(l+1), each one prefixed by prefix
+     */
+    void collect(const size_t l, const int s1, const int s2,
+                 vector<int>& prefix, RowResult& res) const
+    {
+        for ( int x = 0; x < numInputs; x++ ) {
+            size_t i1 = static_cast<size_t>(s1) * numInputs + x;
+            size_t i2 = static_cast<size_t>(s2) * numInputs + x;
+            if ( l == 0 ) {
+                if ( outputs[i1] == outputs[i2] ) continue;
+                prefix.push_back(x);
+                res.inputs.insert(res.inputs.end(), prefix.begin(), prefix.end());
+                res.traceLengths.push_back(prefix.size());
+                prefix.pop_back();
+            }
+            else {
+                int t1 = targets[i1];
+                int t2 = targets[i2];
+                if ( t1 < 0 or t2 < 0 ) continue;
+                const vector<int>& prev = (*classes)[l-1];
+                if ( prev[t1] == prev[t2] ) continue;
+                prefix.push_back(x);
+                collect(l - 1, t1, t2, prefix, res);
+                prefix.pop_back();
+            }
+        }
+    }
+};
+
+}
+
+DistTraceMatrix::DistTraceMatrix(const TransitionTable& tbl,
+                                 const vector<vector<int>>& classes,
+                                 const int maxInput,
+                                 const unsigned int numThreads):
+numStates(static_cast<size_t>(tbl.getNumStates()))
+{
+    DistTraceInput in;
+    in.numInputs = maxInput + 1;
+    in.classes = &classes;
+    in.outputs.assign(numStates * in.numInputs, -1);
+    in.targets.assign(numStates * in.numInputs, -1);
+    for ( size_t s = 0; s < numStates; s++ ) {
+        for ( int x = 0; x < in.numInputs; x++ ) {
+            int y = -1;
+            int t = tbl.apply(static_cast<int>(s), x, y);
+            in.outputs[s * in.numInputs + x] = ( t < 0 ) ? -1 : y;
+            in.targets[s * in.numInputs + x] = t;
+        }
+    }
+
+    vector<RowResult> rows(numStates);
+    WorkStealingPool pool(numThreads);
+    pool.run(numStates, [&](const size_t m, const unsigned int) {
+        RowResult& res = rows[m];
+        res.numTraces.assign(m, 0);
+        vector<int> prefix;
+        for ( size_t n = 0; n < m; n++ ) {
+            // Find the first Pk-table distinguishing n and m
+            size_t l = 0;
+            while ( l < classes.size() and classes[l][n] == classes[l][m] ) l++;
+            if ( l == classes.size() ) continue;
+
+            size_t before = res.traceLengths.size();
+            in.collect(l, static_cast<int>(n), static_cast<int>(m), prefix, res);
+            res.numTraces[n] = res.traceLengths.size() - before;
+        }
+    });
+
+    // Concatenate the results in the order of the pair numbers
+    size_t numPairs = numStates * (numStates - (numStates > 0 ? 1 : 0)) / 2;
+    size_t totalTraces = 0;
+    size_t totalInputs = 0;
+    for ( const auto& res : rows ) {
+        totalTraces += res.traceLengths.size();
+        totalInputs += res.inputs.size();
+    }
+    pairOffsets.reserve(numPairs + 1);
+    traceOffsets.reserve(totalTraces + 1);
+    arena.reserve(totalInputs);
+
+    pairOffsets.push_back(0);
+    traceOffsets.push_back(0);
+    for ( auto& res : rows ) {
+        for ( size_t k : res.numTraces ) pairOffsets.push_back(pairOffsets.back() + k);
+        for ( size_t len : res.traceLengths ) traceOffsets.push_back(traceOffsets.back() + len);
+        arena.insert(arena.end(), res.inputs.begin(), res.inputs.end());
+        res = RowResult();
+    }
+}
+
+size_t DistTraceMatrix::getMinTraceLength(const size_t n, const size_t m) const
+{
+    size_t k = getNumTraces(n,m);
+    if ( k == 0 ) return 0;
+    size_t minLen = traceEnd(n,m,0) - traceBegin(n,m,0);
+    for ( size_t i = 1; i < k; i++ ) {
+        size_t len = traceEnd(n,m,i) - traceBegin(n,m,i);
+        if ( len < minLen ) minLen = len;
+    }
+    return minLen;
+}
+
+vector< shared_ptr< vector<int> > > DistTraceMatrix::getTraces(const size_t n,
+                                                               const size_t m) const
+{
+    vector< shared_ptr< vector<int> > > v;
+    size_t k = getNumTraces(n,m);
+    for ( size_t i = 0; i < k; i++ ) {
+        v.push_back(make_shared< vector<int> >(traceBegin(n,m,i), traceEnd(n,m,i)));
+    }
+    return v;
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_FSM_DISTTRACEMATRIX_H_
+#define FSM_FSM_DISTTRACEMATRIX_H_
+
+#include <memory>
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+class TransitionTable;
+
+/**
+ *  Shortest distinguishing traces for all pairs of states of a DFSM,
+ *  as calculated by Dfsm::calculateDistMatrix().
+ *
+ *  The traces are stored for the unordered pairs {n,m}, n < m only,
+ *  in a triangular layout: the pairs are numbered m*(m-1)/2 + n, and
+ *  the traces of all pairs are stored consecutively in a single
+ *  integer array (trace arena), in the order of the pair numbers.
+ *
+ *  The matrix is calculated in parallel, each task calculating the
+ *  traces for all pairs {n,m} with n < m of some state m. The tasks
+ *  only read the integer arrays passed to the constructor, so that
+ *  they never touch the FsmNode instances of the DFSM.
+ */
+class DistTraceMatrix
+{
+private:
+
+    /** Number of states */
+    size_t numStates;
+
+    /** The traces of pair p are traceOffsets[pairOffsets[p]]..traceOffsets[pairOffsets[p+1]]-1 */
+    std::vector<size_t> pairOffsets;
+
+    /** Trace t occupies positions traceOffsets[t]..traceOffsets[t+1]-1 of the arena */
+    std::vector<size_t> traceOffsets;
+
+    /** All traces, concatenated */
+    std::vector<int> arena;
+
+    size_t pairIndex(size_t n, size_t m) const
+    {
+        if ( n > m ) std::swap(n,m);
+        return m * (m - 1) / 2 + n;
+    }
+
+public:
+
+    /**
+     *  Calculate the distinguishing traces.
+     *  @param tbl Transition table of a deterministic FSM
+     *  @param classes classes[l][s] is the class of state s in the
+     *         Pk-table P(l+1); the last table must contain the final classes
+     *  @param maxInput input alphabet is in range 0..maxInput
+     *  @param numThreads Number of threads to be used, 0 means one thread per hardware thread
+     *
+     *  For each pair of distinguishable states, all traces are collected
+     *  that are found by descending along the Pk-tables from the first
+     *  table distinguishing the states to P1, in the same order as
+     *  Dfsm::calcDistTraces().
+     */
+    DistTraceMatrix(const TransitionTable& tbl,
+                    const std::vector<std::vector<int>>& classes,
+                    const int maxInput,
+                    const unsigned int numThreads = 1);
+
+    /** Number of states */
+    size_t size() const { return numStates; }
+
+    /** Number of distinguishing traces for states n and m, 0 if n == m or n, m are equivalent */
+    size_t getNumTraces(const size_t n, const size_t m) const
+    {
+        if ( n == m ) return 0;
+        size_t p = pairIndex(n,m);
+        return pairOffsets[p+1] - pairOffsets[p];
+    }
+
+    /** Pointer to the first input of the i-th trace distinguishing n and m */
+    const int* traceBegin(const size_t n, const size_t m, const size_t i) const
+    {
+        return arena.data() + traceOffsets[pairOffsets[pairIndex(n,m)] + i];
+    }
+
+    /** Pointer behind the last input of the i-th trace distinguishing n and m */
+    const int* traceEnd(const size_t n, const size_t m, const size_t i) const
+    {
+        return arena.data() + traceOffsets[pairOffsets[pairIndex(n,m)] + i + 1];
+    }
+
+    /** Length of the shortest trace distinguishing n and m, 0 if there is none */
+    size_t getMinTraceLength(const size_t n, const size_t m) const;
+
+    /** Return copies of all traces distinguishing n and m */
+    std::vector< std::shared_ptr< std::vector<int> > > getTraces(const size_t n,
+                                                                 const size_t m) const;
+
+};
+
+#endif //FSM_FSM_DISTTRACEMATRIX_H_
@@ -16,6 +16,7 @@
 #include <fstream>
 #include <iostream>
 #include <functional>
+#include <atomic>
 
 #include "fsm/Fsm.h"
 #include "fsm/FsmTransition.h"
@@ -25,17 +26,24 @@
 #include "fsm/FsmVisitor.h"
 #include "fsm/RDistinguishability.h"
 #include "fsm/VPrimeLazy.h"
+#include "fsm/AdaptiveResponseCache.h"
 #include "fsm/IOTrace.h"
+#include "fsm/TransitionTable.h"
+#include "fsm/PartitionRefinement.h"
+#include "fsm/LazyTestSuite.h"
+#include "fsm/SubsetConstruction.h"
 #include "sets/HittingSet.h"
 #include "trees/AdaptiveTreeNode.h"
 #include "trees/TreeNode.h"
 #include "trees/TreeEdge.h"
 #include "trees/IOListContainer.h"
 #include "utils/Logger.hpp"
+#include "utils/WorkStealingPool.hpp"
 #include "utils/generic-equivalence-class-calculation.hpp"
 #include "trees/TestSuite.h"
 #include "trees/InputOutputTree.h"
 #include "trees/InputTree.h"
+#include "trees/InputTrie.h"
 #include "trees/IOTreeContainer.h"
 #include "fsm/IOTraceContainer.h"
 #include "interface/FsmPresentationLayer.h"
@@ -504,9 +512,11 @@ Fsm::Fsm(const Fsm& other,
     maxState = other.maxState;
     initStateIdx = other.initStateIdx;
     minimal = other.minimal;
+    minimisationMode = other.minimisationMode;
 
+    // Gaps in the state ids of other remain null
     for ( int n = 0; n <= maxState; n++ ) {
-        nodes.push_back(make_shared<FsmNode>(n,name,presentationLayer));
+        nodes.push_back(other.nodes[n] == nullptr ? nullptr : make_shared<FsmNode>(n,name,presentationLayer));
     }
 
     // Now add transitions that correspond exactly to the transitions in
@@ -514,9 +524,12 @@ Fsm::Fsm(const Fsm& other,
     for ( int n = 0; n <= maxState; n++ ) {
         auto theNewFsmNodeSrc = nodes[n];
         auto theOldFsmNodeSrc = other.nodes[n];
+        if ( theOldFsmNodeSrc == nullptr ) continue;
         for ( auto tr : theOldFsmNodeSrc->getTransitions() ) {
             int tgtId = tr->getTarget()->getId();
-            auto newLbl = make_shared<FsmLabel>(*tr->getLabel());
+            auto newLbl = make_shared<FsmLabel>(tr->getLabel()->getInput(),
+                                                tr->getLabel()->getOutput(),
+                                                presentationLayer);
             shared_ptr<FsmTransition> newTr =
             make_shared<FsmTransition>(theNewFsmNodeSrc,nodes[tgtId],newLbl);
             theNewFsmNodeSrc->addTransition(newTr);
@@ -617,6 +630,7 @@ presentationLayer(presentationLayer)
     
     // reset all nodes as 'white' and 'unvisited'
     for ( auto n : nodes ) {
+        if ( n == nullptr ) continue;
         n->setColor(FsmNode::white);
         n->setUnvisited();
     }
@@ -645,6 +659,7 @@ Fsm::Fsm(const string & fsmName,
         // reset all nodes as 'white' and 'unvisited'
 
         for ( auto n : nodes ) {
+            if ( n == nullptr ) continue;
             n->setColor(FsmNode::white);
             n->setUnvisited();
         }
@@ -845,6 +860,22 @@ int Fsm::getInitStateIdx() const
     return initStateIdx;
 }
 
+shared_ptr<TransitionTable> Fsm::getTransitionTable() const
+{
+    if ( nodes.empty() ) return nullptr;
+    shared_ptr<TransitionTable> tbl = atomic_load(&transitionTable);
+    if ( tbl == nullptr or not tbl->isCurrent(nodes) ) {
+        tbl = make_shared<TransitionTable>(nodes,maxInput);
+        atomic_store(&transitionTable,tbl);
+    }
+    return ( tbl != nullptr and tbl->isValid() ) ? tbl : nullptr;
+}
+
+void Fsm::invalidateTransitionTable()
+{
+    atomic_store(&transitionTable,shared_ptr<TransitionTable>());
+}
+
 void Fsm::resetColor()
 {
     for (auto node : nodes)
@@ -1062,24 +1093,48 @@ int Fsm::getNumberOfDifferentInputTransitions(vector<shared_ptr<FsmNode>> nodePo
     return result;
 }
 
+/**
+ *  Index of the states of a product FSM, identified by the pair of
+ *  states they have been created from. If the states of both FSMs are
+ *  numbered by their position in the node lists, a dense n1 x n2 array
+ *  is used, otherwise a hash map over the node addresses.
+ */
+class ProductStateIndex
+{
+private:
+    size_t n2;
+    vector<int> dense;
+    unordered_map<const FsmNode*, unordered_map<const FsmNode*, int>> sparse;
+
+public:
+    ProductStateIndex(const size_t n1, const size_t n2, const bool useDense)
+    : n2(n2)
+    {
+        if ( useDense ) dense.assign(n1 * n2, -1);
+    }
+
+    /** Return a reference to the id of the pair (a,b), -1 if not yet created */
+    int& at(const FsmNode* a, const FsmNode* b)
+    {
+        if ( not dense.empty() ) {
+            return dense[static_cast<size_t>(a->getId()) * n2 + static_cast<size_t>(b->getId())];
+        }
+        auto it = sparse[a].insert(make_pair(b, -1)).first;
+        return it->second;
+    }
+};
+
 Fsm Fsm::intersect(const Fsm & f, string name)
 {
-    // A list of node pairs which is used to
-    // control the breath-first search (BFS)
-    deque<shared_ptr<pair<shared_ptr<FsmNode>, shared_ptr<FsmNode>>>> nodeList;
-    
     // A list of new FSM states, each state created from a pair of
     // this-nodes and f-nodes. At the end of this operation,
     // the new FSM will be created from this list.
+    // Every state is created when its pair is reached for the first
+    // time, so the list is at the same time the queue controlling the
+    // breadth-first search (BFS): fsmInterNodes[k] is processed in the
+    // k-th loop cycle.
     vector<shared_ptr<FsmNode>> fsmInterNodes;
-    int id = 0;
     
-    // Initially, add the pair of initial this-node and f-node
-    // into the BFS list.
-    nodeList.push_back(make_shared<pair<shared_ptr<FsmNode>, shared_ptr<FsmNode>>>(getInitialState(), f.getInitialState()));
-
-    bool isInitialState = true;
-
     // We need a new presentation layer. It has the same inputs and
     // outputs as this Fsm, but the state names will be pairs of
     // state names from this FSM and f
@@ -1089,50 +1144,54 @@ Fsm Fsm::intersect(const Fsm & f, string name)
                                       presentationLayer->getOut2String(),
                                       stateNames);
     
+    // If both FSMs can be represented by transition tables, the
+    // node ids coincide with the positions in the node lists, and
+    // matching transitions of f are found by input in the table
+    shared_ptr<TransitionTable> myTbl = getTransitionTable();
+    shared_ptr<TransitionTable> theirTbl = f.getTransitionTable();
+    bool useTables = ( myTbl != nullptr and theirTbl != nullptr );
+    
+    // The dense index is limited to 2^24 pairs (64MB)
+    bool useDense = useTables and
+        static_cast<uint64_t>(nodes.size()) * f.nodes.size() <= (uint64_t(1) << 24);
+    ProductStateIndex index(nodes.size(), f.nodes.size(), useDense);
+    
+    // Return the FSM state associated with the pair (a,b),
+    // create it if it does not exist yet
+    auto getOrCreate = [&](const shared_ptr<FsmNode>& a,
+                           const shared_ptr<FsmNode>& b,
+                           bool& created) -> shared_ptr<FsmNode> {
+        int& id = index.at(a.get(), b.get());
+        created = ( id < 0 );
+        if ( created ) {
+            id = static_cast<int>(fsmInterNodes.size());
+            
+            // Register the node name as pair of the individual
+            // node names in the new presentation layer
+            newPl->addState2String("(" + a->getName() + "," + b->getName() + ")");
+            
+            fsmInterNodes.push_back(newNode(id, make_shared<pair<shared_ptr<FsmNode>, shared_ptr<FsmNode>>>(a, b), newPl));
+        }
+        return fsmInterNodes[id];
+    };
+    
+    // Initially, create the pair of initial this-node and f-node
+    bool created;
+    getOrCreate(getInitialState(), f.getInitialState(), created)
+        ->setReachTrace(IOTrace::getEmptyTrace(newPl));
+    
     // This is the BFS loop, running over the (this,f)-node pairs
-    while (!nodeList.empty())
+    for (size_t k = 0; k < fsmInterNodes.size(); ++k)
     {
-        // Remove the head of the list and use p to refer to it
-        // p refers to the SOURCE node pair, from where all
+        // nSource refers to the SOURCE node pair, from where all
         // outgoing transitions are investigated in this loop cycle
-        shared_ptr<pair<shared_ptr<FsmNode>, shared_ptr<FsmNode>>>
-            p = nodeList.front();
-        nodeList.pop_front();
+        shared_ptr<FsmNode> nSource = fsmInterNodes[k];
         
         // current node of this FSM
-        shared_ptr<FsmNode> myCurrentNode = p->first;
+        shared_ptr<FsmNode> myCurrentNode = nSource->getPair()->first;
         
         // current node of the f-FSM
-        shared_ptr<FsmNode> theirCurrentNode = p->second;
-        
-        // Do we already have an FSM state for the new FSM
-        // stored in fsmInterNodes, which is associated
-        // with the current pair p?
-        shared_ptr<FsmNode> nSource = findp(fsmInterNodes, p);
-        
-        if (nSource == nullptr)
-        {
-            // Set the node name as pair of the individual node names
-            string newNodeName("(" + myCurrentNode->getName() + "," +
-                               theirCurrentNode->getName() + ")");
-            
-            // Register node name in new presentation layer
-            newPl->addState2String(newNodeName);
-            
-            // We create the new FSM state associated with p:
-            // nSource is created from the state
-            // pair(myCurrentNode,theirCurrentNode)
-            // which is identified by p.
-            nSource = newNode(id++, p, newPl);
-            // Adding the trace that reaches the new state.
-            if (isInitialState)
-            {
-                isInitialState = false;
-                nSource->setReachTrace(IOTrace::getEmptyTrace(newPl));
-            }
-            fsmInterNodes.push_back(nSource);
-            
-        }
+        shared_ptr<FsmNode> theirCurrentNode = nSource->getPair()->second;
         
         // Mark this node: now all of its outgoing transitions are constructed
         nSource->setVisited();
@@ -1140,68 +1199,60 @@ Fsm Fsm::intersect(const Fsm & f, string name)
         // Loop over all transitions emanating from myCurrentNode
         for (auto tr : myCurrentNode->getTransitions())
         {
-            // Loop over all transitions emanating from theirCurrentNode
-            for (auto trOther : theirCurrentNode->getTransitions())
+            const int x = tr->getLabel()->getInput();
+            const int y = tr->getLabel()->getOutput();
+            
+            /* Collect the targets of the transitions of theirCurrentNode
+               with identical labels, in the order of their transition list.
+               For each of them, we can create a transition for the new FSM.
+               The transition has source node (myCurrentNode,theirCurrentNode)
+               and label tr.getLabel(), which is the same as
+               the label associated with the other transition,
+               and target node (tr.getTarget(),trOther.getTarget()),
+               which is the pair of the target nodes
+               of each transition.*/
+            vector<shared_ptr<FsmNode>> theirTargets;
+            if (useTables)
             {
-                /* If tr and trOther have identical labels, we can create a
-                   transition for the new FSM to be created.
-                   The transition has source node (myCurrentNode,theirCurrentNode)
-                   and label tr.getLabel(), which is the same as
-                   the label associated with the other transition,
-                   and target node (tr.getTarget(),trOther.getTarget()),
-                   which is the pair of the target nodes
-                   of each transition.*/
-                
-                if (*tr->getLabel() == *trOther->getLabel())
+                const int s2 = theirCurrentNode->getId();
+                for (auto e = theirTbl->begin(s2, x); e != theirTbl->end(s2, x); ++e)
                 {
-                    // New target node represented as a pair (this-node,f-node)
-                    auto pTarget = make_shared<pair<shared_ptr<FsmNode>, shared_ptr<FsmNode>>>(tr->getTarget(), trOther->getTarget());
-                    
-                    // If the target node does not yet exist in the list
-                    // of state for the new FSM, then create it now
-                    shared_ptr<FsmNode> nTarget = findp(fsmInterNodes, pTarget);
-                    if (nTarget == nullptr)
-                    {
-                        // Set the node name as pair of the individual node names
-                        string newNodeName("(" + tr->getTarget()->getName() +
-                                           "," +
-                                           trOther->getTarget()->getName() + ")");
-                        
-                        // Register node name in new presentation layer
-                        newPl->addState2String(newNodeName);
-                        
-                        nTarget = newNode(id++, pTarget, newPl);
-
-                        // Adding the trace that reaches the new state.
-                        shared_ptr<IOTrace> nSourceReachTrace = nSource->getReachTrace();
-                        shared_ptr<IOTrace> nTargetReachTrace = make_shared<IOTrace>(*tr->getLabel()->toIOTrace());
-                        nTargetReachTrace->prepend(*nSourceReachTrace);
-                        nTarget->setReachTrace(nTargetReachTrace);
-
-                        fsmInterNodes.push_back(nTarget);
-                    }
-                    
-                    // Add transition from nSource to nTarget
-                    auto newTr = make_shared<FsmTransition>(nSource,
-                                                            nTarget,
-                                                            tr->getLabel());
-
-                    nSource->addTransition(newTr);
-                    
-                    /* Conditions for insertion of the target pair
-                       into the nodeList:
-                     1. the target node corresponding to the pair
-                        has not yet been processed
-                        (that is,  nTarget.hasBeenVisited() == false)
-                     2. The target pair is not already entered into the nodeList
-                     */
-                    if (not (nTarget->hasBeenVisited() or
-                             contains(nodeList, pTarget)))
+                    if (e->output == y) theirTargets.push_back(f.nodes[e->target]);
+                }
+            }
+            else
+            {
+                for (auto trOther : theirCurrentNode->getTransitions())
+                {
+                    if (*tr->getLabel() == *trOther->getLabel())
                     {
-                        nodeList.push_back(pTarget);
+                        theirTargets.push_back(trOther->getTarget());
                     }
                 }
             }
+            
+            for (const auto& theirTarget : theirTargets)
+            {
+                // If the target node does not yet exist in the list
+                // of state for the new FSM, then create it now;
+                // it will be processed in a later cycle of the BFS loop
+                shared_ptr<FsmNode> nTarget = getOrCreate(tr->getTarget(), theirTarget, created);
+                if (created)
+                {
+                    // Adding the trace that reaches the new state.
+                    shared_ptr<IOTrace> nSourceReachTrace = nSource->getReachTrace();
+                    shared_ptr<IOTrace> nTargetReachTrace = make_shared<IOTrace>(*tr->getLabel()->toIOTrace());
+                    nTargetReachTrace->prepend(*nSourceReachTrace);
+                    nTarget->setReachTrace(nTargetReachTrace);
+                }
+                
+                // Add transition from nSource to nTarget
+                auto newTr = make_shared<FsmTransition>(nSource,
+                                                        nTarget,
+                                                        tr->getLabel());
+                
+                nSource->addTransition(newTr);
+            }
         }
     }
     
@@ -1276,37 +1327,182 @@ shared_ptr<Tree> Fsm::getTransitionCover()
 
 OutputTree Fsm::apply(const InputTrace & itrc, bool markAsVisited)
 {
-    return getInitialState()->apply(itrc,markAsVisited);
+    shared_ptr<TransitionTable> tbl = getTransitionTable();
+    if ( tbl == nullptr ) {
+        return getInitialState()->apply(itrc,markAsVisited);
+    }
+    
+    // Same breadth-first expansion as in FsmNode::apply(), but
+    // following the transitions in the transition table
+    shared_ptr<TreeNode> root = make_shared<TreeNode>();
+    OutputTree ot = OutputTree(root, itrc, getInitialState()->getPresentationLayer());
+    
+    if (itrc.get().size() == 0)
+    {
+        return ot;
+    }
+    
+    unordered_map<TreeNode*, int> t2s;
+    t2s[root.get()] = initStateIdx;
+    
+    for (auto it = itrc.cbegin(); it != itrc.cend(); ++ it)
+    {
+        int x = *it;
+        
+        for ( auto thisTreeNode : ot.getLeaves() ) {
+            
+            int thisState = t2s.at(thisTreeNode.get());
+            if ( markAsVisited ) nodes[thisState]->setVisited();
+            
+            for ( auto e = tbl->begin(thisState,x); e != tbl->end(thisState,x); ++e ) {
+                shared_ptr<TreeNode> tgtNode = make_shared<TreeNode>();
+                thisTreeNode->add(make_shared<TreeEdge>(e->output, tgtNode));
+                t2s[tgtNode.get()] = e->target;
+                if ( markAsVisited ) nodes[e->target]->setVisited();
+            }
+        }
+    }
+    return ot;
 }
 
 void Fsm::apply(const InputTrace& input, vector<shared_ptr<OutputTrace>>& producedOutputs, vector<shared_ptr<FsmNode>>& reachedNodes) const
 {
-    return getInitialState()->getPossibleOutputs(input, producedOutputs, reachedNodes);
+    shared_ptr<TransitionTable> tbl = getTransitionTable();
+    if ( tbl == nullptr ) {
+        return getInitialState()->getPossibleOutputs(input, producedOutputs, reachedNodes);
+    }
+    
+    const vector<int> inputs = input.get();
+    if ( inputs.empty() ) {
+        reachedNodes.push_back(getInitialState());
+        return;
+    }
+    
+    // Depth-first enumeration of all paths labelled by the complete
+    // input trace. The output traces are collected in the same order as
+    // in FsmNode::getPossibleOutputs(): grouped by the first transition,
+    // and each group is prefixed by every output trace already
+    // contained in producedOutputs.
+    auto pl = getInitialState()->getPresentationLayer();
+    vector<shared_ptr<OutputTrace>> result;
+    vector<int> outputs(inputs.size());
+    vector<vector<int>> suffixes;
+    
+    std::function<void(int,size_t)> dfs = [&](int s, size_t pos) {
+        if ( pos == inputs.size() ) {
+            reachedNodes.push_back(nodes[s]);
+            suffixes.push_back(outputs);
+            return;
+        }
+        int x = inputs[pos];
+        if ( x == FsmLabel::EPSILON ) {
+            outputs[pos] = FsmLabel::EPSILON;
+            dfs(s,pos+1);
+            return;
+        }
+        for ( auto e = tbl->begin(s,x); e != tbl->end(s,x); ++e ) {
+            outputs[pos] = e->output;
+            dfs(e->target,pos+1);
+        }
+    };
+    
+    int s0 = initStateIdx;
+    auto processGroup = [&]() {
+        if ( producedOutputs.empty() ) {
+            for ( auto& sfx : suffixes ) {
+                result.push_back(make_shared<OutputTrace>(sfx, pl));
+            }
+        }
+        else {
+            for ( auto& oldTrace : producedOutputs ) {
+                for ( auto& sfx : suffixes ) {
+                    auto t = make_shared<OutputTrace>(*oldTrace);
+                    t->append(sfx);
+                    result.push_back(t);
+                }
+            }
+        }
+        suffixes.clear();
+    };
+    
+    int x = inputs[0];
+    if ( x == FsmLabel::EPSILON ) {
+        outputs[0] = FsmLabel::EPSILON;
+        dfs(s0,1);
+        processGroup();
+    }
+    else {
+        for ( auto e = tbl->begin(s0,x); e != tbl->end(s0,x); ++e ) {
+            outputs[0] = e->output;
+            dfs(e->target,1);
+            processGroup();
+        }
+    }
+    
+    producedOutputs = result;
 }
 
-Fsm Fsm::transformToObservableFSM(const string& nameSuffix) const
+unordered_set<shared_ptr<FsmNode>> Fsm::after(const InputTrace& itrc) const
 {
-    // List to be filled with the new states to be created
-    // for the observable FSM
-    vector<shared_ptr<FsmNode>> nodeLst;
-    
-    // Breadth first search list, containing the
-    // new FSM nodes, still to be processed by the algorithm
-    vector<shared_ptr<FsmNode>> bfsLst;
+    shared_ptr<TransitionTable> tbl = getTransitionTable();
+    if ( tbl == nullptr ) {
+        return getInitialState()->after(itrc);
+    }
     
-    // Map a newly created node to the set of nodes from the
-    // original FSM, comprised in the new FSM state
-    unordered_map<shared_ptr<FsmNode>, unordered_set<shared_ptr<FsmNode>>> node2NodeLabel;
+    vector<int> states { initStateIdx };
+    vector<int> newStates;
+    vector<bool> mark(nodes.size(),false);
+    for ( auto it = itrc.cbegin(); it != itrc.cend(); ++it ) {
+        if ( *it == FsmLabel::EPSILON ) continue;
+        tbl->after(states,*it,FsmLabel::EPSILON,newStates,mark);
+        states.swap(newStates);
+    }
     
-    // Set of nodes from the original FSM, comprised in the
-    // current new node
-    unordered_set<shared_ptr<FsmNode>> theNodeLabel;
+    unordered_set<shared_ptr<FsmNode>> nodeSet;
+    for ( int s : states ) nodeSet.insert(nodes[s]);
+    return nodeSet;
+}
+
+unordered_set<shared_ptr<FsmNode>> Fsm::after(const IOTrace& trace) const
+{
+    shared_ptr<TransitionTable> tbl = getTransitionTable();
+    if ( tbl == nullptr ) {
+        return getInitialState()->after(trace);
+    }
+    
+    const vector<int> inputs = trace.getInputTrace().get();
+    const vector<int> outputs = trace.getOutputTrace().get();
+    unordered_set<shared_ptr<FsmNode>> nodeSet;
+    if ( inputs.size() != outputs.size() ) {
+        return nodeSet;
+    }
+    
+    vector<int> states { initStateIdx };
+    vector<int> newStates;
+    vector<bool> mark(nodes.size(),false);
+    for ( size_t i = 0; i < inputs.size(); ++i ) {
+        if ( inputs[i] == FsmLabel::EPSILON and outputs[i] == FsmLabel::EPSILON ) continue;
+        if ( outputs[i] == FsmLabel::EPSILON ) {
+            // FsmNode::afterAsSet(x,y) requires an exact output match
+            states.clear();
+            break;
+        }
+        tbl->after(states,inputs[i],outputs[i],newStates,mark);
+        states.swap(newStates);
+    }
     
-    // For the first step of the algorithm, the initial
-    // state of the original FSM is the only state comprised
-    // in the initial state of the new FSM
-    theNodeLabel.insert(getInitialState());
+    for ( int s : states ) nodeSet.insert(nodes[s]);
+    return nodeSet;
+}
 
+Fsm Fsm::transformToObservableFSM(const string& nameSuffix) const
+{
+    // The subset construction identifies each state of the observable
+    // FSM by the set of states of this FSM comprised in it. Its state ids
+    // are assigned in breadth-first order, starting with the initial
+    // state {initial state of this FSM}.
+    SubsetConstruction sc(*this);
+    sc.exploreAll();
     
     // Create a new presentation layer which has
     // the same names for the inputs and outputs as
@@ -1318,109 +1514,40 @@ Fsm Fsm::transformToObservableFSM(const string& nameSuffix) const
                                       presentationLayer->getOut2String(),
                                       obsState2String);
     
-    
-    // id to be taken for the next state of the new
-    // observable FSM to be created.
-    int id = 0;
-    
-    // The initial state of the new FSM is labelled with
-    // the set containing just the initial state of the old FSM
-    string nodeName = labelString(theNodeLabel);
-    shared_ptr<FsmNode> q0 = make_shared<FsmNode>(id++, nodeName, obsPl);
-    nodeLst.push_back(q0);
-    bfsLst.push_back(q0);
-    node2NodeLabel[q0] = theNodeLabel;
-    
-    // The node label is added to the presentation layer,
-    // as name of the initial state
-    obsPl->addState2String(nodeName);
-    
-    // Loop while there is at least one node in the BFS list.
-    // Initially, the list contains just the new initial state
-    // of the new FSM.
-    while (!bfsLst.empty())
+    // List to be filled with the new states to be created
+    // for the observable FSM. Each node is named by the set
+    // of nodes of this FSM it comprises.
+    vector<shared_ptr<FsmNode>> nodeLst;
+    for (int q = 0; q < sc.size(); ++ q)
     {
-        // Pop the first node from the list
-        shared_ptr<FsmNode> q = bfsLst.front();
-        bfsLst.erase(bfsLst.begin());
-        
-        // Nested loop over all input/output labels that
-        // might be associated with one or more outgoing transitions
-        for (int x = 0; x <= maxInput; ++ x)
+        string nodeName = "{ ";
+        bool isFirst = true;
+        for (int s : sc.getStateSet(q))
         {
-            for (int y = 0; y <= maxOutput; ++ y)
+            if (!isFirst)
             {
-                // This is the transition label currently processed
-                shared_ptr<FsmLabel> lbl =
-                make_shared<FsmLabel>(x, y, obsPl);
-                
-                // Clear the set of node labels that may
-                // serve as node name for the target node to be
-                // created (or already exists). This target node
-                // comprises all nodes of the original FSM that
-                // can be reached from q under a transition labelled
-                // with lbl
-                theNodeLabel.clear();
-                
-                // Loop over all nodes of the original FSM which
-                // are comprised by q
-                for (shared_ptr<FsmNode> n : node2NodeLabel.at(q))
-                {
-                    // For each node comprised by q, check
-                    // its outgoing transitions, whether they are
-                    // labelled by lbl
-                    for (auto tr : n->getTransitions())
-                    {
-                        if (*tr->getLabel() == *lbl)
-                        {
-                            // If so, insert the target node
-                            // into the node label set
-                            theNodeLabel.insert(tr->getTarget());
-                        }
-                    }
-                }
-                
-                // Process only non-empty label sets.
-                // An empty label set means that no transition labelled
-                // by lbl exists.
-                if (!theNodeLabel.empty())
-                {
-                    
-                    shared_ptr<FsmNode> tgtNode = nullptr;
-                    
-                    // Loop over the node-2-label map and check
-                    // if there exists already a node labelled
-                    // by theNodeLabel. If this is the case,
-                    // it will become the target node reached from q
-                    // under lbl
-                    for ( auto u : node2NodeLabel ) {
-                        
-                        if ( u.second == theNodeLabel ) {
-                            tgtNode = u.first;
-                            break;
-                        }
-                        
-                    }
-                    
-                    if (tgtNode == nullptr)
-                    {
-                        // We need to create a new target node, to be reached
-                        // from q under lbl
-                        nodeName = labelString(theNodeLabel);
-                        tgtNode = make_shared<FsmNode>(id++, nodeName, obsPl);
-                        nodeLst.push_back(tgtNode);
-                        bfsLst.push_back(tgtNode);
-                        node2NodeLabel[tgtNode] = theNodeLabel;
-                        obsPl->addState2String(nodeName);
-                    }
-                    
-                    // Create the transition from q to tgtNode
-                    auto trNew = make_shared<FsmTransition>(q, tgtNode, lbl);
-                    q->addTransition(trNew);
-                }
+                nodeName += ",";
             }
+            isFirst = false;
+            nodeName += nodes[s]->getName() + "(" + to_string(nodes[s]->getId()) + ")";
         }
+        nodeName += " }";
+        
+        nodeLst.push_back(make_shared<FsmNode>(q, nodeName, obsPl));
+        obsPl->addState2String(nodeName);
     }
+    
+    // Create the transitions, in the order of their labels
+    for (int q = 0; q < sc.size(); ++ q)
+    {
+        for (const SubsetConstruction::Transition& t : sc.getTransitions(q))
+        {
+            auto lbl = make_shared<FsmLabel>(t.input, t.output, obsPl);
+            auto trNew = make_shared<FsmTransition>(nodeLst[q], nodeLst[t.target], lbl);
+            nodeLst[q]->addTransition(trNew);
+        }
+    }
+    
     Fsm obsFsm(name + nameSuffix, maxInput, maxOutput, nodeLst, obsPl);
     return obsFsm;
 }
@@ -1447,11 +1574,28 @@ Minimal Fsm::isMinimal() const
 void Fsm::calcOFSMTables() {
     
     ofsmTableLst.clear();
+    ofsmRefinement = nullptr;
+    ofsmCursor = PartitionRefinement::Cursor();
     
     // Create the initial OFSMTable representing the FSM,
     //  where all FSM states belong to the same class
     shared_ptr<OFSMTable> tbl = make_shared<OFSMTable>(nodes, maxInput, maxOutput, presentationLayer);
     
+    if ( minimisationMode == MinimisationMode::PartitionRefinement ) {
+        shared_ptr<TransitionTable> trTbl = getTransitionTable();
+        if ( trTbl != nullptr ) {
+            shared_ptr<PartitionRefinement> pr = make_shared<PartitionRefinement>(*trTbl);
+            if ( pr->isValid() ) {
+                // The remaining tables are created by getOFSMTable() on demand
+                ofsmTableLst.push_back(tbl);
+                ofsmRefinement = pr;
+                ofsmCursor = PartitionRefinement::Cursor(*ofsmRefinement);
+                return;
+            }
+        }
+        // Not observable: use the tables
+    }
+    
     // Create all possible OFSMTables, each new one from its
     // predecessor, and add them to the ofsmTableLst
     while (tbl != nullptr)
@@ -1462,18 +1606,45 @@ void Fsm::calcOFSMTables() {
 
 }
 
+size_t Fsm::getNumOFSMTables() const
+{
+    return ( ofsmRefinement != nullptr ) ?
+    ofsmRefinement->getNumPartitions() + 1 : ofsmTableLst.size();
+}
+
+shared_ptr<OFSMTable> Fsm::getOFSMTable(const size_t k)
+{
+    if ( k >= getNumOFSMTables() ) return nullptr;
+    
+    // Partition j of the refinement corresponds to the OFSMTable with
+    // tblId j+1, and ofsmCursor is positioned at the partition of
+    // ofsmTableLst.back(), unless this is the initial table
+    while ( ofsmTableLst.size() <= k ) {
+        if ( ofsmTableLst.size() > 1 ) ofsmCursor.next();
+        ofsmTableLst.push_back(ofsmTableLst.back()->next(ofsmCursor.getPartition()));
+    }
+    return ofsmTableLst[k];
+}
+
+const vector<shared_ptr<OFSMTable>>& Fsm::createAllOFSMTables()
+{
+    if ( not ofsmTableLst.empty() ) getOFSMTable(getNumOFSMTables() - 1);
+    return ofsmTableLst;
+}
+
 Fsm Fsm::minimiseObservableFSM(const std::string& nameSuffix, bool prependFsmName)
 {
     calcOFSMTables();
 
     // The last OFSMTable defined has classes corresponding to
     // the minimised FSM to be constructed*/
-    shared_ptr<OFSMTable> tbl = ofsmTableLst.back();
+    shared_ptr<OFSMTable> tbl = getOFSMTable(getNumOFSMTables() - 1);
     
     // Create the minimised FSM from tbl and return it
     Fsm fsm = tbl->toFsm(name + nameSuffix, prependFsmName);
 
     fsm.minimal = True;
+    fsm.minimisationMode = minimisationMode;
     return fsm;
 }
 
@@ -1580,7 +1751,7 @@ throw ss.str();
              leftNode and rightNode are not distinguished by the current
              input traces contained in w. */
             InputTrace i = leftNode->calcDistinguishingTrace(rightNode,
-                                                             ofsmTableLst,
+                                                             createAllOFSMTables(),
                                                              maxInput,
                                                              maxOutput);
             shared_ptr<vector<vector<int>>> lli = make_shared<vector<vector<int>>>();
@@ -1631,271 +1802,200 @@ shared_ptr<FsmNode> Fsm::getNode(int id) const
     return nullptr;
 }
 
-void Fsm::calcROneDistinguishableStates()
+void Fsm::calcRDistinguishableStates()
 {
-    for (size_t i = 0; i < nodes.size(); ++i)
+    LOG("VERBOSE_2") << "calcRDistinguishableStates():" << std::endl;
+
+    // Two states are r(1)-distinguishable if some input x has no common output,
+    // and r(l)-distinguishable if for some input x every common output leads to
+    // different r(l-1)-distinguishable states. Instead of sweeping over all pairs
+    // for each l, every pair of states is registered as dependent of the pairs
+    // reached by its common outputs, and the number of these pairs not yet
+    // r-distinguished is counted per input. The pairs r-distinguished in round l
+    // then only visit their dependents to find the pairs r-distinguished in round l+1.
+
+    const size_t n = nodes.size();
+    const size_t numInputs = static_cast<size_t>(maxInput + 1);
+
+    unordered_map<int, size_t> indexOf;
+    for (size_t k = 0; k < n; ++k)
     {
-        nodes.at(i)->getRDistinguishability()->initRDistinguishable(1);
-        for (size_t j = i + 1; j < nodes.size(); ++j)
-        {
-            nodes.at(i)->getRDistinguishability()->addNotRDistinguishable(1, nodes.at(j));
-        }
+        indexOf[nodes[k]->getId()] = k;
     }
-    nodes.at(nodes.size() - 1)->getRDistinguishability()->addNotRDistinguishable(1);
 
-    for (size_t k = 0; k < nodes.size(); ++k)
+    // Outputs and target indices of each state for each input, in the order of the transitions
+    vector<vector<vector<pair<int, size_t>>>> outputs(n, vector<vector<pair<int, size_t>>>(numInputs));
+    for (size_t k = 0; k < n; ++k)
     {
-        shared_ptr<FsmNode> q1 = nodes.at(k);
-        vector<int> notROneDist = q1->getRDistinguishability()->getNotRDistinguishableWith(1);
+        for (const shared_ptr<FsmTransition>& transition : nodes[k]->getTransitions())
+        {
+            int x = transition->getLabel()->getInput();
+            if (x < 0 || x > maxInput) continue;
+            outputs[k][static_cast<size_t>(x)].push_back(make_pair(transition->getLabel()->getOutput(),
+                                                                   indexOf.at(transition->getTarget()->getId())));
+        }
+    }
 
-        for (auto it = notROneDist.begin(); it != notROneDist.end(); ++it)
+    // Pairs {a,b} with a < b are numbered consecutively
+    const size_t numPairs = n * (n - 1) / 2;
+    auto pairIndex = [n](size_t a, size_t b) {
+        if (a > b) swap(a, b);
+        return a * (2 * n - a - 1) / 2 + (b - a - 1);
+    };
+    vector<size_t> firstOf(numPairs);
+    vector<size_t> secondOf(numPairs);
+
+    // Smallest l such that the pair is r(l)-distinguishable, 0 if not (yet) known
+    vector<size_t> level(numPairs, 0);
+    // Smallest input r(l)-distinguishing the pair for this l
+    vector<int> distinguishingInput(numPairs, -1);
+    // For each pair and input the number of common outputs leading to pairs that
+    // are not yet r-distinguished, -1 if some common output leads to the same state
+    vector<int> pending(numPairs * numInputs, 0);
+    // For each pair the entries (pair * numInputs + x) of pending that depend on it
+    vector<vector<size_t>> dependents(numPairs);
+
+    vector<size_t> frontier;
+    for (size_t a = 0; a < n; ++a)
+    {
+        for (size_t b = a + 1; b < n; ++b)
         {
-            int q2Id = *it;
-            for (int x = 0; x <= maxInput; ++ x)
+            size_t p = pairIndex(a, b);
+            firstOf[p] = a;
+            secondOf[p] = b;
+            for (size_t x = 0; x < numInputs; ++x)
             {
-                InputTrace input = InputTrace(vector<int>({x}), presentationLayer);
-                shared_ptr<FsmNode> q2 = getNode(q2Id);
-                vector<shared_ptr<OutputTrace>> intersection = getOutputIntersection(q1, q2, x);
-                if (intersection.size() == 0)
+                int& count = pending[p * numInputs + x];
+                bool sameTarget = false;
+                for (const auto& out1 : outputs[a][x])
                 {
-                    vector<shared_ptr<OutputTrace>> q1Output;
-                    vector<shared_ptr<OutputTrace>> q2Output;
-                    q1->getPossibleOutputs(x, q1Output);
-                    q2->getPossibleOutputs(x, q2Output);
-                    shared_ptr<AdaptiveTreeNode> q1Root = make_shared<AdaptiveTreeNode>(x);
-                    shared_ptr<AdaptiveTreeNode> q2Root = make_shared<AdaptiveTreeNode>(x);
-
-                    for (shared_ptr<OutputTrace> trace : q1Output)
-                    {
-                        shared_ptr<AdaptiveTreeNode> target = make_shared<AdaptiveTreeNode>();
-                        shared_ptr<TreeEdge> edge = make_shared<TreeEdge>(trace->get()[0], target);
-                        q1Root->add(edge);
-                    }
-                    for (shared_ptr<OutputTrace> trace : q2Output)
+                    for (const auto& out2 : outputs[b][x])
                     {
-                        shared_ptr<AdaptiveTreeNode> target = make_shared<AdaptiveTreeNode>();
-                        shared_ptr<TreeEdge> edge = make_shared<TreeEdge>(trace->get()[0], target);
-                        q2Root->add(edge);
+                        if (out1.first != out2.first) continue;
+                        if (out1.second == out2.second)
+                        {
+                            sameTarget = true;
+                            continue;
+                        }
+                        ++count;
+                        dependents[pairIndex(out1.second, out2.second)].push_back(p * numInputs + x);
                     }
-
-                    shared_ptr<InputOutputTree> q1Tree = make_shared<InputOutputTree>(q1Root, presentationLayer);
-                    shared_ptr<InputOutputTree> q2Tree = make_shared<InputOutputTree>(q2Root, presentationLayer);
-                    q1->getRDistinguishability()->addAdaptiveIOSequence(q2, q1Tree);
-                    q2->getRDistinguishability()->addAdaptiveIOSequence(q1, q2Tree);
-
-                    q1->getRDistinguishability()->addRDistinguishable(1, q2);
-                    q2->getRDistinguishability()->addRDistinguishable(1, q1);
-
-                    q1->getRDistinguishability()->removeNotRDistinguishable(1, q2);
-                    break;
                 }
+                if (sameTarget)
+                {
+                    count = -1;
+                }
+                else if (count == 0 && distinguishingInput[p] < 0)
+                {
+                    distinguishingInput[p] = static_cast<int>(x);
+                }
+            }
+            if (distinguishingInput[p] >= 0)
+            {
+                level[p] = 1;
+                frontier.push_back(p);
             }
         }
     }
 
-    for (size_t i = 0; i < nodes.size(); ++i)
+    // Pairs in the order they have been r-distinguished, so that the
+    // trees of their successors are built before their own trees
+    vector<size_t> distinguishedPairs;
+    for (size_t l = 1; !frontier.empty(); ++l)
     {
-        for (size_t j = 0; j < nodes.size(); ++j)
+        LOG("VERBOSE_2") << "l = " << l << ": " << frontier.size() << " newly r-distinguished pairs" << std::endl;
+        distinguishedPairs.insert(distinguishedPairs.end(), frontier.begin(), frontier.end());
+        vector<size_t> nextFrontier;
+        for (size_t p : frontier)
         {
-            try {
-                shared_ptr<InputOutputTree> tree = nodes.at(i)->getRDistinguishability()->getAdaptiveIOSequence(nodes.at(j));
-                if (tree->getRoot()->isLeaf())
+            for (size_t entry : dependents[p])
+            {
+                size_t q = entry / numInputs;
+                int x = static_cast<int>(entry % numInputs);
+                if (pending[entry] < 0 || (level[q] != 0 && level[q] <= l)) continue;
+                if (--pending[entry] > 0) continue;
+                if (level[q] == 0)
                 {
-                    continue;
+                    level[q] = l + 1;
+                    distinguishingInput[q] = x;
+                    nextFrontier.push_back(q);
+                }
+                else if (x < distinguishingInput[q])
+                {
+                    distinguishingInput[q] = x;
                 }
-                std::stringstream ss;
-                ss << "σ(" << nodes.at(i)->getName() << "," << nodes.at(j)->getName() << ") = " << *tree;
-                LOG("VERBOSE_2") << ss.str() << std::endl;
-            } catch (std::out_of_range &e) {
-               // Do nothing.
             }
-
         }
-
+        frontier.swap(nextFrontier);
     }
-}
 
-void Fsm::calcRDistinguishableStates()
-{
-    LOG("VERBOSE_2") << "calcRDistinguishableStates():" << std::endl;
-    calcROneDistinguishableStates();
-
-    size_t limit = nodes.size() * (nodes.size() - 1) / 2;
-    bool allRDistinguishable = false;
-    bool newDistinguishabilityCalculated = true;
-    size_t maxL = 0;
-    for (size_t l = 2; !allRDistinguishable && newDistinguishabilityCalculated && l <= limit; ++l)
-    {
-        maxL = l;
-        LOG("VERBOSE_2") << "################ l = " << l << " (max " << limit << ") ################" << std::endl;
-        allRDistinguishable = true;
-        newDistinguishabilityCalculated = false;
-        for (size_t k = 0; k < nodes.size(); ++k)
+    for (size_t k = 0; k < n; ++k)
+    {
+        vector<shared_ptr<FsmNode>> otherNodes;
+        otherNodes.reserve(n - 1);
+        for (size_t j = 0; j < n; ++j)
         {
-            nodes.at(k)->getRDistinguishability()->inheritDistinguishability(l);
+            if (j != k) otherNodes.push_back(nodes[j]);
         }
-        for (size_t k = 0; k < nodes.size(); ++k)
+        nodes[k]->getRDistinguishability()->initRDistinguishability(otherNodes);
+    }
+
+    auto addDisjointOutputs = [](const shared_ptr<AdaptiveTreeNode>& root,
+                                 const vector<pair<int, size_t>>& own,
+                                 const vector<pair<int, size_t>>& other) {
+        for (const auto& out : own)
         {
-            shared_ptr<FsmNode> q1 = nodes.at(k);
-            LOG("VERBOSE_3") << "q1 = " << q1->getName() << ":" << std::endl;
-            vector<int> notROneDist = q1->getRDistinguishability()->getNotRDistinguishableWith(l);
-            for (auto it = notROneDist.begin(); it != notROneDist.end(); ++it)
+            if (none_of(other.begin(), other.end(), [&out](const pair<int, size_t>& o) { return o.first == out.first; }))
             {
-                // There are still nodes that can not be r-distuinguisehd from each other. Do one more iteration.
-                allRDistinguishable = false;
-                int q2Id = *it;
-                shared_ptr<FsmNode> q2 = getNode(q2Id);
-                LOG("VERBOSE_3") << "  q2 = " << q2->getName() << ":" << std::endl;
-                for (int x = 0; x <= maxInput; ++ x)
-                {
-                    vector<shared_ptr<OutputTrace>> intersection = getOutputIntersection(q1, q2, x);
-
-                    shared_ptr<AdaptiveTreeNode> q1Root = make_shared<AdaptiveTreeNode>(x);
-                    shared_ptr<AdaptiveTreeNode> q2Root = make_shared<AdaptiveTreeNode>(x);
-                    vector<shared_ptr<TreeEdge>> q1Edges;
-                    vector<shared_ptr<TreeEdge>> q2Edges;
-
-                    bool isDistinguishable = true;
-                    for (shared_ptr<OutputTrace> inter : intersection)
-                    {
-                        int y = inter->get()[0];
-                        unordered_set<shared_ptr<FsmNode>> afterQ1 = q1->afterAsSet(x, y);
-                        unordered_set<shared_ptr<FsmNode>> afterQ2 = q2->afterAsSet(x, y);
-                        shared_ptr<FsmNode> afterNode1 = *afterQ1.begin();
-                        shared_ptr<FsmNode> afterNode2 = *afterQ2.begin();
-                        if (afterNode1 == afterNode2 || !afterNode1->getRDistinguishability()->isRDistinguishableWith(l - 1, afterNode2))
-                        {
-
-                            isDistinguishable = false;
-                            break;
-                        }
-                        else
-                        {
-                            LOG("VERBOSE_3") << "    x = " << presentationLayer->getInId(x) << ":    "
-                            << afterNode1->getName() << " != " << afterNode2->getName()
-                            << "  ->  " << q1->getName() << " != " << q2->getName();
-
-                            //shared_ptr<TreeNode> target1 = make_shared<TreeNode>();
-                            shared_ptr<InputOutputTree> childTree1 = afterNode1->getRDistinguishability()->getAdaptiveIOSequence(afterNode2);
-                            // TODO Fix
-                            //      can't find linker symbol for virtual table for `TreeEdge' value
-                            // messages when debugging.
-                            // Put breakpoint at following line and debug.
-                            stringstream ss;
-                            ss << "      childIO1(" << afterNode1->getName() << "," << afterNode2->getName() << "): " << *childTree1;
-                            LOG("VERBOSE_3") << ss.str() << std::endl;
-                            ss.str(std::string());
-
-                            shared_ptr<AdaptiveTreeNode> childNode1 = static_pointer_cast<AdaptiveTreeNode>(childTree1->getRoot());
-                            shared_ptr<TreeEdge> edge1 = make_shared<TreeEdge>(y, childNode1);
-                            q1Edges.push_back(edge1);
-
-                            //shared_ptr<TreeNode> target2 = make_shared<TreeNode>();
-                            shared_ptr<InputOutputTree> childTree2 = afterNode2->getRDistinguishability()->getAdaptiveIOSequence(afterNode1);
-                            ss << "      childIO2(" << afterNode2->getName() << "," << afterNode1->getName() << "): " << *childTree2 << endl;
-                            LOG("VERBOSE_3") << ss.str() << std::endl;
-                            shared_ptr<AdaptiveTreeNode> childNode2 = static_pointer_cast<AdaptiveTreeNode>(childTree2->getRoot());
-                            shared_ptr<TreeEdge> edge2 = make_shared<TreeEdge>(y, childNode2);
-                            q2Edges.push_back(edge2);
-                        }
-                    }
-                    if (isDistinguishable)
-                    {
-                        for (shared_ptr<TreeEdge> edge : q1Edges)
-                        {
-                            q1Root->add(edge);
-                        }
-                        for (shared_ptr<TreeEdge> edge : q2Edges)
-                        {
-                            q2Root->add(edge);
-                        }
-                        vector<shared_ptr<OutputTrace>> q1Outputs;
-                        vector<shared_ptr<OutputTrace>> q2Outputs;
-                        q1->getPossibleOutputs(x, q1Outputs);
-                        q2->getPossibleOutputs(x, q2Outputs);
-
-                        for (auto it = q1Outputs.begin(); it != q1Outputs.end(); ++it)
-                        {
-                            bool disjunct = true;
-                            for (shared_ptr<OutputTrace> inter : intersection)
-                            {
-                                if (**it == *inter)
-                                {
-                                    disjunct = false;
-                                    break;
-                                }
-                            }
-                            if (disjunct)
-                            {
-                                shared_ptr<AdaptiveTreeNode> target = make_shared<AdaptiveTreeNode>();
-                                shared_ptr<TreeEdge> edge = make_shared<TreeEdge>((*it)->get()[0], target);
-                                q1Root->add(edge);
-                            }
-                        }
-
-                        for (auto it = q2Outputs.begin(); it != q2Outputs.end(); ++it)
-                        {
-                            bool disjunct = true;
-                            for (shared_ptr<OutputTrace> inter : intersection)
-                            {
-                                if (**it == *inter)
-                                {
-                                    disjunct = false;
-                                    break;
-                                }
-                            }
-                            if (disjunct)
-                            {
-                                shared_ptr<AdaptiveTreeNode> target = make_shared<AdaptiveTreeNode>();
-                                shared_ptr<TreeEdge> edge = make_shared<TreeEdge>((*it)->get()[0], target);
-                                q2Root->add(edge);
-                            }
-                        }
-
-                        //InputTrace input = InputTrace(vector<int>({x}), presentationLayer);
-                        shared_ptr<InputOutputTree> q1Tree = make_shared<InputOutputTree>(q1Root, presentationLayer);
-                        shared_ptr<InputOutputTree> q2Tree = make_shared<InputOutputTree>(q2Root, presentationLayer);
-
-                        stringstream ss;
-                        ss << "    q1Tree: " << *q1Tree;
-                        LOG("VERBOSE_2") << ss.str() << std::endl;
-                        ss.str(std::string());
-                        ss << "    q2Tree: " << *q2Tree;
-                        LOG("VERBOSE_2") << ss.str() << std::endl;
-
-                        q1->getRDistinguishability()->addAdaptiveIOSequence(q2, q1Tree);
-                        q2->getRDistinguishability()->addAdaptiveIOSequence(q1, q2Tree);
-
-
-                        q1->getRDistinguishability()->addRDistinguishable(l, q2);
-                        q2->getRDistinguishability()->addRDistinguishable(l, q1);
-                        q1->getRDistinguishability()->removeNotRDistinguishable(l, q2);
-                        q2->getRDistinguishability()->removeNotRDistinguishable(l, q1);
-                        newDistinguishabilityCalculated = true;
-                        break;
-                    }
-                }
+                root->add(make_shared<TreeEdge>(out.first, make_shared<AdaptiveTreeNode>()));
             }
         }
-    }
-    // Deducing non-r-distinguishability from r-distinguishability.
-    for (auto node : nodes)
+    };
+
+    // Build the adaptive input sequences once per pair
+    for (size_t p : distinguishedPairs)
     {
-        for (size_t l = 1; l <= maxL; ++l)
+        size_t a = firstOf[p];
+        size_t b = secondOf[p];
+        size_t x = static_cast<size_t>(distinguishingInput[p]);
+        shared_ptr<FsmNode> q1 = nodes[a];
+        shared_ptr<FsmNode> q2 = nodes[b];
+
+        // Common outputs, in the order of the outputs of q1, continue with the
+        // sequences of the reached pair, the remaining outputs end the sequences
+        shared_ptr<AdaptiveTreeNode> q1Root = make_shared<AdaptiveTreeNode>(static_cast<int>(x));
+        shared_ptr<AdaptiveTreeNode> q2Root = make_shared<AdaptiveTreeNode>(static_cast<int>(x));
+        for (const auto& out1 : outputs[a][x])
         {
-            node->getRDistinguishability()->addNotRDistinguishable(l);
-            vector<int> dist = node->getRDistinguishability()->getRDistinguishableWith(l);
-            for (auto n : nodes)
+            for (const auto& out2 : outputs[b][x])
             {
-                if(node != n && find(dist.begin(), dist.end(), n->getId()) == dist.end()) {
-                    node->getRDistinguishability()->addNotRDistinguishable(l, n);
-                }
+                if (out1.first != out2.first) continue;
+                shared_ptr<FsmNode> afterNode1 = nodes[out1.second];
+                shared_ptr<FsmNode> afterNode2 = nodes[out2.second];
+                shared_ptr<InputOutputTree> childTree1 = afterNode1->getRDistinguishability()->getAdaptiveIOSequence(afterNode2);
+                shared_ptr<InputOutputTree> childTree2 = afterNode2->getRDistinguishability()->getAdaptiveIOSequence(afterNode1);
+                q1Root->add(make_shared<TreeEdge>(out1.first, static_pointer_cast<AdaptiveTreeNode>(childTree1->getRoot())));
+                q2Root->add(make_shared<TreeEdge>(out1.first, static_pointer_cast<AdaptiveTreeNode>(childTree2->getRoot())));
             }
         }
-        // Setting flag for every node.
+        addDisjointOutputs(q1Root, outputs[a][x], outputs[b][x]);
+        addDisjointOutputs(q2Root, outputs[b][x], outputs[a][x]);
+
+        shared_ptr<InputOutputTree> q1Tree = make_shared<InputOutputTree>(q1Root, presentationLayer);
+        shared_ptr<InputOutputTree> q2Tree = make_shared<InputOutputTree>(q2Root, presentationLayer);
+        LOG("VERBOSE_2") << "σ(" << q1->getName() << "," << q2->getName() << ") = " << *q1Tree << std::endl;
+        LOG("VERBOSE_2") << "σ(" << q2->getName() << "," << q1->getName() << ") = " << *q2Tree << std::endl;
+
+        q1->getRDistinguishability()->addAdaptiveIOSequence(q2, q1Tree);
+        q2->getRDistinguishability()->addAdaptiveIOSequence(q1, q2Tree);
+        q1->getRDistinguishability()->addRDistinguishable(level[p], q2);
+        q2->getRDistinguishability()->addRDistinguishable(level[p], q1);
+    }
+
+    for (auto node : nodes)
+    {
         node->getRDistinguishability()->hasBeenCalculated(true);
     }
-    return;
 }
 
 IOListContainer Fsm::getRStateCharacterisationSet(shared_ptr<FsmNode> node) const
@@ -2110,6 +2210,41 @@ void Fsm::addPossibleIOTraces(std::shared_ptr<FsmNode> node,
     }
 }
 
+bool Fsm::isReductionOf(const Fsm & spec) const
+{
+    SubsetConstruction specObs(spec);
+
+    unordered_map<const FsmNode*, uint64_t> node2Pos;
+    for ( size_t s = 0; s < nodes.size(); s++ ) {
+        if ( nodes[s] != nullptr ) node2Pos[nodes[s].get()] = s;
+    }
+
+    // Breadth-first search over the pairs (state of this FSM,
+    // state of the observable form of spec), encoded as
+    // position * 2^32 + observable state id
+    unordered_set<uint64_t> visited;
+    deque<pair<const FsmNode*, int>> queue;
+    visited.insert(node2Pos.at(nodes[initStateIdx].get()) << 32 |
+                   static_cast<uint32_t>(specObs.getInitialState()));
+    queue.push_back(make_pair(nodes[initStateIdx].get(), specObs.getInitialState()));
+
+    while ( not queue.empty() ) {
+        const FsmNode* n = queue.front().first;
+        int q = queue.front().second;
+        queue.pop_front();
+
+        for ( const auto& tr : n->getTransitions() ) {
+            int qNext = specObs.after(q, tr->getLabel()->getInput(), tr->getLabel()->getOutput());
+            if ( qNext < 0 ) return false;
+            const FsmNode* nNext = tr->getTarget().get();
+            if ( visited.insert(node2Pos.at(nNext) << 32 | static_cast<uint32_t>(qNext)).second ) {
+                queue.push_back(make_pair(nNext, qNext));
+            }
+        }
+    }
+    return true;
+}
+
 bool Fsm::hasFailure() const
 {
     for (const shared_ptr<FsmNode>& node : nodes)
@@ -2298,13 +2433,14 @@ bool Fsm::exceedsBound(const size_t m,
                        const IOTrace& suffix,
                        const vector<shared_ptr<FsmNode>>& states,
                        const IOTreeContainer& adaptiveTestCases,
-                       unordered_set<IOTraceContainer> bOmegaT,
+                       const unordered_set<IOTraceContainer>& bOmegaT,
                        const IOTraceContainer& vDoublePrime,
                        const vector<shared_ptr<FsmNode>>& dReachableStates,
                        const Fsm& spec,
-                       const Fsm& iut)
+                       const Fsm& iut,
+                       AdaptiveResponseCache* iutResponses)
 {
-    size_t lB = Fsm::lowerBound(base, suffix, states, adaptiveTestCases, bOmegaT, vDoublePrime, dReachableStates, spec, iut);
+    size_t lB = Fsm::lowerBound(base, suffix, states, adaptiveTestCases, bOmegaT, vDoublePrime, dReachableStates, spec, iut, iutResponses);
     LOG("VERBOSE_1") << "lB: " << lB << std::endl;
     return lB > m;
 }
@@ -2313,11 +2449,12 @@ size_t Fsm::lowerBound(const IOTrace& base,
                        const IOTrace& suffix,
                        const vector<shared_ptr<FsmNode>>& states,
                        const IOTreeContainer& adaptiveTestCases,
-                       unordered_set<IOTraceContainer> bOmegaT,
+                       const unordered_set<IOTraceContainer>& bOmegaT,
                        const IOTraceContainer& vDoublePrime,
                        const vector<shared_ptr<FsmNode>>& dReachableStates,
                        const Fsm& spec,
-                       const Fsm& iut)
+                       const Fsm& iut,
+                       AdaptiveResponseCache* iutResponses)
 {
     LOG("VERBOSE_1") << "lowerBound()" << std::endl;
     LOG("VERBOSE_1") << "base: " << base << std::endl;
@@ -2343,6 +2480,7 @@ size_t Fsm::lowerBound(const IOTrace& base,
         LOG("VERBOSE_1") << "  " << cont << std::endl;
     }
 
+    unordered_set<IOTraceContainer> removed;
     for (shared_ptr<FsmNode> state : states)
     {
         const IOTraceContainer& rResult = spec.r(state, base, suffix);
@@ -2362,25 +2500,19 @@ size_t Fsm::lowerBound(const IOTrace& base,
         for (auto traceIt = rPlusResult.cbegin(); traceIt != rPlusResult.cend(); ++traceIt)
         {
             const shared_ptr<const IOTrace>& trace = *traceIt;
-            IOTraceContainer traces = iut.bOmega(adaptiveTestCases, *trace);
+            IOTraceContainer traces = (iutResponses != nullptr) ? iutResponses->bOmega(*trace) : iut.bOmega(adaptiveTestCases, *trace);
             LOG("VERBOSE_1") << "Removing " << traces << " from testTraces." << std::endl;
 
-            IOTraceContainer::remove(bOmegaT, traces);
-
-            LOG("VERBOSE_1") << "testTraces:" << std::endl;
-            for (const auto& cont : bOmegaT)
+            // Instead of removing the traces from a copy of bOmegaT,
+            // the removed elements of bOmegaT are collected
+            if (bOmegaT.find(traces) != bOmegaT.end())
             {
-                LOG("VERBOSE_1") << "  " << cont << std::endl;
+                removed.insert(traces);
             }
         }
     }
-    LOG("VERBOSE_1") << "bOmegaT size: " << bOmegaT.size() << std::endl;
-    LOG("VERBOSE_1") << "bOmegaT:" << std::endl;
-    for (const auto& cont : bOmegaT)
-    {
-        LOG("VERBOSE_1") << "  " << cont << std::endl;
-    }
-    result += bOmegaT.size();
+    LOG("VERBOSE_1") << "bOmegaT size: " << bOmegaT.size() << ", removed: " << removed.size() << std::endl;
+    result += bOmegaT.size() - removed.size();
     LOG("VERBOSE_1") << "lowerBound() result: " << result << std::endl;
     return result;
 }
@@ -2388,7 +2520,8 @@ size_t Fsm::lowerBound(const IOTrace& base,
 bool Fsm::adaptiveStateCounting(Fsm& spec, Fsm& iut, const size_t m,
                                 IOTraceContainer& observedTraces,
                                 shared_ptr<IOTrace>& failTrace,
-                                int& iterations)
+                                int& iterations,
+                                unsigned int numThreads)
 {
     LOG("VERBOSE_1")<< "adaptiveStateCounting()" << std::endl;
     if (spec.isMinimal() != True)
@@ -2438,6 +2571,28 @@ throw ss.str();
         LOG("VERBOSE_1") << ss.str() << std::endl;
     }
 
+    // Responses to the adaptive test cases are calculated once per state
+    AdaptiveResponseCache iutResponses(iut, adaptiveTestCases);
+    AdaptiveResponseCache specResponses(spec, adaptiveTestCases);
+
+    // Traces of T_c and candidates of V'' are evaluated in parallel only if more than one thread is requested
+    unique_ptr<WorkStealingPool> pool;
+    if (numThreads != 1)
+    {
+        pool.reset(new WorkStealingPool(numThreads));
+        if (pool->getNumThreads() <= 1) pool.reset();
+    }
+    auto runTasks = [&pool](size_t numTasks, const function<void(size_t)>& task) {
+        if (pool)
+        {
+            pool->run(numTasks, [&task](size_t i, unsigned int) { task(i); });
+        }
+        else
+        {
+            for (size_t i = 0; i < numTasks; ++i) task(i);
+        }
+    };
+
     InputTraceSet detStateCover;
     const vector<shared_ptr<FsmNode>>& dReachableStates = spec.calcDReachableStates(detStateCover);
 
@@ -2462,7 +2617,28 @@ throw ss.str();
      * Holds all B_Ω(T) for the current t.
      */
     unordered_set<IOTraceContainer> bOmegaT;
-    iut.bOmega(adaptiveTestCases, t, bOmegaT);
+    // Same as iut.bOmega(adaptiveTestCases, inputTraces, bOmegaT), using the cached IUT responses
+    auto addBOmega = [&](const InputTraceSet& inputTraces) {
+        if (adaptiveTestCases.size() == 0 || !iut.getInitialState())
+        {
+            return;
+        }
+        vector<shared_ptr<InputTrace>> traces(inputTraces.begin(), inputTraces.end());
+        vector<vector<IOTraceContainer>> produced(traces.size());
+        runTasks(traces.size(), [&](size_t i) {
+            vector<shared_ptr<OutputTrace>> producedOutputs;
+            iut.getInitialState()->getPossibleOutputs(*traces[i], producedOutputs);
+            for (const shared_ptr<OutputTrace>& outputTrace : producedOutputs)
+            {
+                produced[i].push_back(iutResponses.bOmega(IOTrace(*traces[i], *outputTrace)));
+            }
+        });
+        for (const vector<IOTraceContainer>& containers : produced)
+        {
+            bOmegaT.insert(containers.begin(), containers.end());
+        }
+    };
+    addBOmega(t);
     /**
      * T_c - set of current elements of T: those that are being considered in the search
      * through state space. The elements in T_c are the maximal sequences considered that
@@ -2495,26 +2671,42 @@ throw ss.str();
         map<shared_ptr<InputTrace>, vector<shared_ptr<OutputTrace>>> observedOutputsTCElements;
         size_t numberInputTraces = tC.size();
         size_t inputTraceCount = 0;
-        // Applying all input traces from T_c to this FSM.
+        vector<shared_ptr<InputTrace>> tCTraces(tC.begin(), tC.end());
+
+        /**
+         * Hold the produced output traces and the reached nodes for each input trace of T_c.
+         */
+        vector<vector<shared_ptr<OutputTrace>>> producedOutputsSpecOf(tCTraces.size());
+        vector<vector<shared_ptr<OutputTrace>>> producedOutputsIutOf(tCTraces.size());
+        vector<vector<shared_ptr<FsmNode>>> reachedNodesSpecOf(tCTraces.size());
+        vector<vector<shared_ptr<FsmNode>>> reachedNodesIutOf(tCTraces.size());
+
+        // The input traces are applied independently, together with the adaptive
+        // test cases in the reached states. Failures are checked afterwards in
+        // the order of T_c, so that the first failure does not depend on the
+        // number of threads.
+        runTasks(tCTraces.size(), [&](size_t k) {
+            spec.apply(*tCTraces[k], producedOutputsSpecOf[k], reachedNodesSpecOf[k]);
+            iut.apply(*tCTraces[k], producedOutputsIutOf[k], reachedNodesIutOf[k]);
+            if (adaptiveTestCases.size() > 0)
+            {
+                for (const shared_ptr<FsmNode>& node : reachedNodesIutOf[k]) iutResponses.get(node);
+                for (const shared_ptr<FsmNode>& node : reachedNodesSpecOf[k]) specResponses.get(node);
+            }
+        });
+
+        // Checking the outputs observed for all input traces from T_c.
         // All observed outputs are bein recorded.
         // If the FSM observes a failure, adaptive state counting terminates.
-        for (const shared_ptr<InputTrace>& inputTrace : tC)
+        for (size_t k = 0; k < tCTraces.size(); ++k)
         {
+            const shared_ptr<InputTrace>& inputTrace = tCTraces[k];
             LOG("VERBOSE_1") << "############################################################" << std::endl;
             LOG("VERBOSE_1") << "  Applying inputTrace " << ++inputTraceCount << " of " << numberInputTraces << ": " << *inputTrace << std::endl;
-            /**
-             * Hold the produced output traces for the current input trace.
-             */
-            vector<shared_ptr<OutputTrace>> producedOutputsSpec;
-            vector<shared_ptr<OutputTrace>> producedOutputsIut;
-            /**
-             * Hold the reached nodes for the current input trace.
-             */
-            vector<shared_ptr<FsmNode>> reachedNodesSpec;
-            vector<shared_ptr<FsmNode>> reachedNodesIut;
-
-            spec.apply(*inputTrace, producedOutputsSpec, reachedNodesSpec);
-            iut.apply(*inputTrace, producedOutputsIut, reachedNodesIut);
+            const vector<shared_ptr<OutputTrace>>& producedOutputsSpec = producedOutputsSpecOf[k];
+            const vector<shared_ptr<OutputTrace>>& producedOutputsIut = producedOutputsIutOf[k];
+            const vector<shared_ptr<FsmNode>>& reachedNodesSpec = reachedNodesSpecOf[k];
+            const vector<shared_ptr<FsmNode>>& reachedNodesIut = reachedNodesIutOf[k];
 #ifdef ENABLE_DEBUG_MACRO
             ss << "    producedOutputs spec: ";
             for (size_t i = 0; i < producedOutputsSpec.size(); ++i)
@@ -2585,13 +2777,12 @@ throw ss.str();
                         {
                             // Applying adaptive test cases to every node reached by the current input/output trace.
                             LOG("VERBOSE_1") << "----------------- Getting adaptive traces -----------------" << std::endl;
-                            IOTraceContainer observedAdaptiveTracesIut;
-                            IOTraceContainer observedAdaptiveTracesSpec;
                             const shared_ptr<FsmNode>& nodeIut = reachedNodesIut.at(i);
                             const shared_ptr<FsmNode>& nodeSpec = reachedNodesSpec.at(j);
 
-                            iut.addPossibleIOTraces(nodeIut, adaptiveTestCases, observedAdaptiveTracesIut);
-                            spec.addPossibleIOTraces(nodeSpec, adaptiveTestCases, observedAdaptiveTracesSpec);
+                            IOTraceContainer observedAdaptiveTracesIut = *iutResponses.get(nodeIut);
+                            shared_ptr<const IOTraceContainer> specTraces = specResponses.get(nodeSpec);
+                            const IOTraceContainer& observedAdaptiveTracesSpec = *specTraces;
 
                             LOG("VERBOSE_1") << "  observedAdaptiveTracesIut (" << nodeIut->getName() << "): " << observedAdaptiveTracesIut << std::endl;
                             LOG("VERBOSE_1") << "  observedAdaptiveTracesSpec (" << nodeSpec->getName() << "): " << observedAdaptiveTracesSpec << std::endl;
@@ -2700,9 +2891,20 @@ throw ss.str();
         InputTraceSet newT = t;
         InputTraceSet newTC;
         inputTraceCount = 0;
-        for (shared_ptr<InputTrace> inputTrace : tC)
+
+        // Each output trace observed for an input trace of T_c is a check that is met
+        // if some V'' and some maximal set of r-distinguishable states exceed the bound.
+        struct Check
         {
-            bool inputTraceMeetsCriteria = true;
+            size_t traceIndex;
+            shared_ptr<OutputTrace> outputTrace;
+            shared_ptr<const IOTrace> maxIOPrefixInV;
+            IOTrace suffix;
+        };
+        vector<Check> checks;
+        for (size_t k = 0; k < tCTraces.size(); ++k)
+        {
+            const shared_ptr<InputTrace>& inputTrace = tCTraces[k];
             LOG("INFO") << "check inputTrace: " << *inputTrace << " (" << ++inputTraceCount << " of " << numberInputTraces << ")" << std::endl;
             vector<shared_ptr<OutputTrace>>& producedOutputs = observedOutputsTCElements.at(inputTrace);
             LOG("VERBOSE_1") << "producedOutputs:" << std::endl;
@@ -2710,8 +2912,6 @@ throw ss.str();
             {
                 LOG("VERBOSE_1") << "  " << *outputTrace << std::endl;
             }
-            long outputTraceCount = 0;
-            size_t numberOutputTraces = producedOutputs.size();
 
             shared_ptr<const InputTrace> maxInputPrefixInV = nullptr;
             for (const shared_ptr<InputTrace>& detStateTransition : detStateCover)
@@ -2733,76 +2933,92 @@ throw ss.str();
 
             for (shared_ptr<OutputTrace> outputTrace : producedOutputs)
             {
-                if (!inputTraceMeetsCriteria)
-                {
-                    break;
-                }
-                LOG("INFO") << "outputTrace: " << *outputTrace << " (" << ++outputTraceCount << " of " << numberOutputTraces << ")" << std::endl;
                 IOTrace currentTrace(*inputTrace, *outputTrace);
                 LOG("VERBOSE_1") << "currentTrace (x_1/y_1): " << currentTrace << std::endl;
-                bool outputTraceMeetsCriteria = false;
-                vPrimeLazy.reset();
-
-                LOG("VERBOSE_1") << "maxInputPrefixInV.size(): " << maxInputPrefixInV->size() << std::endl;
                 shared_ptr<const IOTrace> maxIOPrefixInV = make_shared<const IOTrace>(*static_pointer_cast<const Trace>(maxInputPrefixInV),
                                                                                       *outputTrace->getPrefix(maxInputPrefixInV->size(), true));
                 LOG("VERBOSE_1") << "maxIOPrefixInV (v/v'): " << *maxIOPrefixInV << std::endl;
-                IOTrace suffix(InputTrace(spec.presentationLayer), OutputTrace(spec.presentationLayer));
-                suffix = currentTrace.getSuffix(*maxIOPrefixInV);
+                IOTrace suffix = currentTrace.getSuffix(*maxIOPrefixInV);
                 LOG("VERBOSE_1") << "suffix (x/y): " << suffix << std::endl;
+                checks.push_back(Check { k, outputTrace, maxIOPrefixInV, suffix });
+            }
+        }
 
-                LOG("VERBOSE_1") << "vPrimeLazy.hasNext(): " << vPrimeLazy.hasNext() << std::endl;
-                while (vPrimeLazy.hasNext())
+        // The candidates V'' are enumerated in the order of VPrimeLazy::getNext() and
+        // split into blocks, so that the blocks of all checks can be evaluated in
+        // parallel. Evaluation of a check stops as soon as it is met, and the checks
+        // of an input trace are skipped as soon as one of them has failed. Whether
+        // an input trace meets the criteria does not depend on the evaluation order.
+        const size_t candidatesPerTask = 16;
+        const size_t numCandidates = vPrimeLazy.size();
+        const size_t tasksPerCheck = (numCandidates + candidatesPerTask - 1) / candidatesPerTask;
+        unique_ptr<atomic<bool>[]> checkMet(new atomic<bool>[checks.size()]);
+        unique_ptr<atomic<size_t>[]> remainingTasks(new atomic<size_t>[checks.size()]);
+        unique_ptr<atomic<bool>[]> traceFailed(new atomic<bool>[tCTraces.size()]);
+        for (size_t c = 0; c < checks.size(); ++c)
+        {
+            checkMet[c] = false;
+            remainingTasks[c] = tasksPerCheck;
+        }
+        for (size_t k = 0; k < tCTraces.size(); ++k)
+        {
+            traceFailed[k] = false;
+        }
+
+        runTasks(checks.size() * tasksPerCheck, [&](size_t task) {
+            size_t c = task / tasksPerCheck;
+            const Check& check = checks[c];
+            if (!traceFailed[check.traceIndex] && !checkMet[c])
+            {
+                size_t end = min(numCandidates, (task % tasksPerCheck + 1) * candidatesPerTask);
+                for (size_t n = (task % tasksPerCheck) * candidatesPerTask; n < end && !checkMet[c]; ++n)
                 {
-                    const IOTraceContainer& vDoublePrime = vPrimeLazy.getNext();
-                    if (outputTraceMeetsCriteria)
-                    {
-                        break;
-                    }
+                    // getNext() enumerates getVDoublePrime(1), ..., getVDoublePrime(size())
+                    const IOTraceContainer& vDoublePrime = vPrimeLazy.getVDoublePrime(n + 1);
                     LOG("VERBOSE_1") << "vDoublePrime: " << vDoublePrime << std::endl;
-
-                    if (!vDoublePrime.contains(maxIOPrefixInV))
+                    if (!vDoublePrime.contains(check.maxIOPrefixInV))
                     {
-                        LOG("VERBOSE_1") << "vDoublePrime does not contain prefix " << *maxIOPrefixInV << ". Skipping." << std::endl;
-                        LOG("VERBOSE_1") << "vPrimeLazy.hasNext(): " << vPrimeLazy.hasNext() << std::endl;
+                        LOG("VERBOSE_1") << "vDoublePrime does not contain prefix " << *check.maxIOPrefixInV << ". Skipping." << std::endl;
                         continue;
                     }
                     for (const vector<shared_ptr<FsmNode>>& rDistStates : maximalSetsOfRDistinguishableStates)
                     {
-                        LOG("VERBOSE_1") << "rDistStates:" << std::endl;
-                        for (auto r : rDistStates)
-                        {
-                            LOG("VERBOSE_1") << "  " << r->getName() << std::endl;
-                        }
-                         //size_t lB = Fsm::lowerBound(*maxPrefix, suffix, t, rDistStates, adaptiveTestCases, vDoublePrime, dReachableStates, spec, iut);
-                        //LOG("VERBOSE_1") << "lB: " << lB << std::endl;
-                        bool exceedsBound = Fsm::exceedsBound(m, *maxIOPrefixInV, suffix, rDistStates, adaptiveTestCases, bOmegaT, vDoublePrime, dReachableStates, spec, iut);
+                        bool exceedsBound = Fsm::exceedsBound(m, *check.maxIOPrefixInV, check.suffix, rDistStates, adaptiveTestCases, bOmegaT, vDoublePrime, dReachableStates, spec, iut, &iutResponses);
                         LOG("VERBOSE_1") << "exceedsBound: " << exceedsBound << std::endl;
                         if (exceedsBound)
                         {
-                            LOG("VERBOSE_1") << "Exceeded lower bound. Output trace " << *outputTrace << " meets criteria." << std::endl;
-                            outputTraceMeetsCriteria = true;
+                            LOG("VERBOSE_1") << "Exceeded lower bound. Output trace " << *check.outputTrace << " meets criteria." << std::endl;
+                            checkMet[c] = true;
                             break;
                         }
                     }
                 }
-                if (outputTraceMeetsCriteria == false)
-                {
-                    inputTraceMeetsCriteria = false;
-                }
             }
+            if (remainingTasks[c].fetch_sub(1) == 1 && !checkMet[c])
+            {
+                traceFailed[check.traceIndex] = true;
+            }
+        });
 
-            if (!inputTraceMeetsCriteria)
+        vector<bool> inputTraceMeetsCriteria(tCTraces.size(), true);
+        for (size_t c = 0; c < checks.size(); ++c)
+        {
+            if (!checkMet[c])
+            {
+                inputTraceMeetsCriteria[checks[c].traceIndex] = false;
+            }
+        }
+        for (size_t k = 0; k < tCTraces.size(); ++k)
+        {
+            if (!inputTraceMeetsCriteria[k])
             {
                 // Keeping current input trace in T_C
-                LOG("VERBOSE_1") << "Keeping " << *inputTrace << " in T_C." << std::endl;
-                newTC.insert(inputTrace);
-                // Next input trace.
-                continue;
+                LOG("VERBOSE_1") << "Keeping " << *tCTraces[k] << " in T_C." << std::endl;
+                newTC.insert(tCTraces[k]);
             }
             else
             {
-                LOG("VERBOSE_1") << "Removing " << *inputTrace << " from T_C." << std::endl;
+                LOG("VERBOSE_1") << "Removing " << *tCTraces[k] << " from T_C." << std::endl;
             }
         }
         ss << "newTC: ";
@@ -2844,7 +3060,7 @@ throw ss.str();
             }
         }
         LOG("INFO") << "Finished expansion." << std::endl;
-        iut.bOmega(adaptiveTestCases, tracesAddedToT, bOmegaT);
+        addBOmega(tracesAddedToT);
         LOG("INFO") << "Finished calculating bOmega." << std::endl;
 
         ss << "expandedTC: ";
@@ -3332,6 +3548,25 @@ IOListContainer Fsm::wMethodOnMinimisedFsm(const unsigned int numAddStates) {
     
 }
 
+void Fsm::wMethod(const unsigned int numAddStates, TestCaseSink& sink) {
+
+    Fsm fo = transformToObservableFSM();
+    Fsm fom = fo.minimise();
+
+    fom.wMethodOnMinimisedFsm(numAddStates, sink);
+}
+
+
+void Fsm::wMethodOnMinimisedFsm(const unsigned int numAddStates, TestCaseSink& sink) {
+
+    shared_ptr<Tree> iTree = getTransitionCover();
+    IOListContainer w = getCharacterisationSet();
+
+    LazyTestSuite testSuite(maxInput);
+    testSuite.addProduct(*iTree, numAddStates, w);
+    testSuite.enumerate(sink);
+}
+
 IOListContainer Fsm::wpMethod(const unsigned int numAddStates)
 {
     
@@ -3374,6 +3609,26 @@ IOListContainer Fsm::wpMethod(const unsigned int numAddStates)
 }
 
 
+void Fsm::wpMethod(const unsigned int numAddStates, TestCaseSink& sink)
+{
+
+    shared_ptr<Tree> scov = getStateCover();
+
+    shared_ptr<Tree> tcov = getTransitionCover();
+
+    tcov->remove(scov);
+
+    IOListContainer w = getCharacterisationSet();
+
+    calcStateIdentificationSetsFast();
+
+    LazyTestSuite testSuite(maxInput);
+    testSuite.addProduct(*scov, numAddStates, w);
+    testSuite.addProduct(*tcov, numAddStates, getInitialState(), stateIdentificationSets);
+    testSuite.enumerate(sink);
+}
+
+
 IOListContainer Fsm::hsiMethod(const unsigned int numAddStates)
 {
 
@@ -3464,10 +3719,125 @@ TestSuite Fsm::createTestSuite(const IOListContainer & testCases)
     shared_ptr<vector<vector<int>>> tcLst = testCases.getIOLists();
     TestSuite theSuite;
     
-    for (unsigned int i = 0; i < tcLst->size(); ++ i)
+    shared_ptr<TransitionTable> tbl = getTransitionTable();
+    if ( tbl == nullptr ) {
+        for (unsigned int i = 0; i < tcLst->size(); ++ i)
+        {
+            OutputTree ot = apply(InputTrace(tcLst->at(i), presentationLayer));
+            theSuite.push_back(ot);
+        }
+        return theSuite;
+    }
+    
+    // Load the test cases into a prefix trie, so that the inputs of
+    // a prefix shared by several test cases are applied only once
+    InputTrie trie(presentationLayer);
+    vector<InputTrie::NodeId> tcNodes;
+    for (size_t i = 0; i < tcLst->size(); ++ i)
+    {
+        tcNodes.push_back(trie.addToRoot(tcLst->at(i)));
+    }
+    vector<vector<size_t>> casesAt(trie.size());
+    for (size_t i = 0; i < tcNodes.size(); ++ i)
     {
-        OutputTree ot = apply(InputTrace(tcLst->at(i), presentationLayer));
-        theSuite.push_back(ot);
+        casesAt[tcNodes[i]].push_back(i);
+    }
+    
+    // The paths of the FSM labelled by the prefixes in the trie
+    // form a single forest shared by all test cases. Every path
+    // is stored as its last transition and a reference to its
+    // longest proper prefix, path 0 is the empty path.
+    struct Path {
+        int state;
+        int output;
+        size_t prefix;
+    };
+    vector<Path> paths;
+    paths.push_back(Path{initStateIdx, 0, 0});
+    
+    auto pl = getInitialState()->getPresentationLayer();
+    vector<unique_ptr<OutputTree>> trees(tcLst->size());
+    
+    // Create the output tree of each test case ending at a trie node,
+    // given the leaves of the tree, in the order of Tree::getLeaves(),
+    // as paths. Every path is the last child of its prefix when it
+    // is first encountered in this order, so that the edges are added
+    // in the same order as by apply().
+    vector<shared_ptr<TreeNode>> treeNodes;
+    vector<size_t> chain;
+    vector<size_t> created;
+    auto createTrees = [&](InputTrie::NodeId n, const vector<size_t>& leaves) {
+        if ( treeNodes.size() < paths.size() ) treeNodes.resize(paths.size());
+        for ( size_t i : casesAt[n] ) {
+            shared_ptr<TreeNode> root = make_shared<TreeNode>();
+            treeNodes[0] = root;
+            for ( size_t l : leaves ) {
+                chain.clear();
+                size_t p = l;
+                while ( treeNodes[p] == nullptr ) {
+                    chain.push_back(p);
+                    p = paths[p].prefix;
+                }
+                shared_ptr<TreeNode> treeNode = treeNodes[p];
+                for ( auto it = chain.rbegin(); it != chain.rend(); ++it ) {
+                    shared_ptr<TreeNode> tgtNode = make_shared<TreeNode>();
+                    treeNode->add(make_shared<TreeEdge>(paths[*it].output, tgtNode));
+                    treeNodes[*it] = tgtNode;
+                    created.push_back(*it);
+                    treeNode = tgtNode;
+                }
+            }
+            trees[i].reset(new OutputTree(root, InputTrace(tcLst->at(i), presentationLayer), pl));
+            
+            for ( size_t p : created ) treeNodes[p] = nullptr;
+            created.clear();
+            treeNodes[0] = nullptr;
+        }
+    };
+    
+    // Depth-first walk through the trie, where every frame holds the
+    // leaves of the output tree of the input trace leading to its node.
+    // As in apply(), a leaf without transitions for an input remains
+    // a leaf and is extended by the subsequent inputs.
+    struct Frame {
+        InputTrie::NodeId node;
+        InputTrie::NodeId nextChild;
+        vector<size_t> leaves;
+    };
+    vector<Frame> stack;
+    stack.push_back(Frame{InputTrie::ROOT, trie.getFirstChild(InputTrie::ROOT), vector<size_t>(1, 0)});
+    createTrees(InputTrie::ROOT, stack.back().leaves);
+    
+    while ( not stack.empty() ) {
+        Frame& top = stack.back();
+        if ( top.nextChild == InputTrie::NONE ) {
+            stack.pop_back();
+            continue;
+        }
+        InputTrie::NodeId c = top.nextChild;
+        top.nextChild = trie.getNextSibling(c);
+        int x = trie.getLabel(c);
+        
+        vector<size_t> leaves;
+        for ( size_t l : top.leaves ) {
+            int s = paths[l].state;
+            if ( tbl->begin(s,x) == tbl->end(s,x) ) {
+                leaves.push_back(l);
+                continue;
+            }
+            for ( auto e = tbl->begin(s,x); e != tbl->end(s,x); ++e ) {
+                leaves.push_back(paths.size());
+                paths.push_back(Path{e->target, e->output, l});
+            }
+        }
+        
+        createTrees(c, leaves);
+        stack.push_back(Frame{c, trie.getFirstChild(c), std::move(leaves)});
+    }
+    
+    theSuite.reserve(trees.size());
+    for ( const auto& ot : trees ) {
+        theSuite.push_back(*ot);
     }
     
     return theSuite;
@@ -3577,6 +3947,30 @@ Fsm::createRandomFsm(const string & fsmName,
         srand(seed);
         LOG("DEBUG") << "createRandomFsm seed: " << seed << std::endl;
     }
+    RandomSource rnd;
+    return createRandomFsm(rnd,fsmName,maxInput,maxOutput,maxState,pl,observable);
+}
+
+shared_ptr<Fsm>
+Fsm::createRandomFsm(const string & fsmName,
+                     const int maxInput,
+                     const int maxOutput,
+                     const int maxState,
+                     const shared_ptr<FsmPresentationLayer>& pl,
+                     const bool observable,
+                     mt19937& gen) {
+    RandomSource rnd(gen);
+    return createRandomFsm(rnd,fsmName,maxInput,maxOutput,maxState,pl,observable);
+}
+
+shared_ptr<Fsm>
+Fsm::createRandomFsm(RandomSource& rnd,
+                     const string & fsmName,
+                     const int maxInput,
+                     const int maxOutput,
+                     const int maxState,
+                     const shared_ptr<FsmPresentationLayer>& pl,
+                     const bool observable) {
 
     // Produce the nodes and put them into a vector.
     // All nodes are marked 'white' by the costructor - this is now
@@ -3602,7 +3996,7 @@ Fsm::createRandomFsm(const string & fsmName,
         
         // Generation part 1.
         // Select an uncovered node at random
-        int whiteNodeIndex = rand() % (maxState+1);
+        int whiteNodeIndex = rnd() % (maxState+1);
         shared_ptr<FsmNode> whiteNode = nullptr;
         shared_ptr<FsmNode> startNode = lst[whiteNodeIndex];
         shared_ptr<FsmNode> thisNode = startNode;
@@ -3625,8 +4019,8 @@ Fsm::createRandomFsm(const string & fsmName,
         int y0 = -1;
         
         if ( whiteNode != nullptr ) {
-            x0 = rand() % (maxInput+1);
-            y0 = rand() % (maxOutput+1);
+            x0 = rnd() % (maxInput+1);
+            y0 = rnd() % (maxOutput+1);
             auto theTrans =
             make_shared<FsmTransition>(srcNode,whiteNode,
                                        make_shared<FsmLabel>(x0,y0,pl));
@@ -3643,20 +4037,20 @@ Fsm::createRandomFsm(const string & fsmName,
         for ( int x = 0; x <= maxInput; x++ ) {
             // If x equals x0 produced already above,
             // we may skip it at random
-            if ( x == x0 and (rand() % 2) ) continue;
+            if ( x == x0 and (rnd() % 2) ) continue;
             
             // How many transitions do we want for input x?
             // We construct at most 2 of these transitions
-            int numTrans = rand() % 2;
+            int numTrans = rnd() % 2;
             for ( int t = 0; t <= numTrans; t++ ) {
                 // Which output do we want?
-                int y = rand() % (maxOutput+1);
+                int y = rnd() % (maxOutput+1);
                 if (observable && srcNode->hasTransition(x, y))
                 {
                     continue;
                 }
                 // Which target node?
-                int tgtNodeId = rand() % (maxState+1);
+                int tgtNodeId = rnd() % (maxState+1);
                 auto tgtNode = lst[tgtNodeId];
                 if ( tgtNode->getColor() == FsmNode::white ) {
                     tgtNode->setColor(FsmNode::black);
@@ -3689,10 +4083,6 @@ shared_ptr<Fsm> Fsm::createRandomFsm(const std::string& fsmName,
                                      const bool& observable,
                                      const unsigned& seed)
 {
-    LOG("VERBOSE_1") << "**createRandomFsm()" << std::endl;
-    LOG("VERBOSE_1") << "maxInput: " << maxInput << std::endl;
-    LOG("VERBOSE_1") << "maxOutput: " << maxOutput << std::endl;
-    LOG("VERBOSE_1") << "maxState: " << maxState << std::endl;
     // Initialisation of random number generation
     if ( seed == 0 ) {
         unsigned int s = getRandomSeed();
@@ -3703,6 +4093,44 @@ shared_ptr<Fsm> Fsm::createRandomFsm(const std::string& fsmName,
         srand(seed);
         LOG("DEBUG") << "createRandomFsm seed: " << seed << std::endl;
     }
+    RandomSource rnd;
+    return createRandomFsm(rnd, fsmName, maxInput, maxOutput, maxState, pl, degreeOfCompleteness,
+                           maxDegreeOfNonDeterminism, forceNonDeterminism, minimal, observable);
+}
+
+shared_ptr<Fsm> Fsm::createRandomFsm(const std::string& fsmName,
+                                     const int& maxInput,
+                                     const int& maxOutput,
+                                     const int& maxState,
+                                     const std::shared_ptr<FsmPresentationLayer>& pl,
+                                     const float& degreeOfCompleteness,
+                                     const float& maxDegreeOfNonDeterminism,
+                                     const bool& forceNonDeterminism,
+                                     const bool& minimal,
+                                     const bool& observable,
+                                     mt19937& gen)
+{
+    RandomSource rnd(gen);
+    return createRandomFsm(rnd, fsmName, maxInput, maxOutput, maxState, pl, degreeOfCompleteness,
+                           maxDegreeOfNonDeterminism, forceNonDeterminism, minimal, observable);
+}
+
+shared_ptr<Fsm> Fsm::createRandomFsm(RandomSource& rnd,
+                                     const std::string& fsmName,
+                                     const int& maxInput,
+                                     const int& maxOutput,
+                                     const int& maxState,
+                                     const std::shared_ptr<FsmPresentationLayer>& pl,
+                                     const float& degreeOfCompleteness,
+                                     const float& maxDegreeOfNonDeterminism,
+                                     const bool& forceNonDeterminism,
+                                     const bool& minimal,
+                                     const bool& observable)
+{
+    LOG("VERBOSE_1") << "**createRandomFsm()" << std::endl;
+    LOG("VERBOSE_1") << "maxInput: " << maxInput << std::endl;
+    LOG("VERBOSE_1") << "maxOutput: " << maxOutput << std::endl;
+    LOG("VERBOSE_1") << "maxState: " << maxState << std::endl;
 
     int numIn = maxInput + 1;
     int numOut = maxOutput + 1;
@@ -3751,7 +4179,7 @@ throw ss.str();
         shared_ptr<FsmNode> srcNode;
         shared_ptr<FsmLabel> label;
 
-        fsm->selectRandomNodeAndCreateLabel(reachedNodes, maxDegreeOfNonDeterminism, false, observable, srcNode, label);
+        fsm->selectRandomNodeAndCreateLabel(rnd, reachedNodes, maxDegreeOfNonDeterminism, false, observable, srcNode, label);
 
         // We could not find a source node or a valid label.
         if (!srcNode || !label)
@@ -3770,17 +4198,17 @@ throw ss.str();
     }
     LOG("VERBOSE_2") << "Connected all nodes." << std::endl;
 
-    fsm->addRandomTransitions(maxDegreeOfNonDeterminism, false, observable, 1.0f);
+    fsm->addRandomTransitions(rnd, maxDegreeOfNonDeterminism, false, observable, 1.0f);
 
     if (degreeOfCompletenessRequired)
     {
         LOG("VERBOSE_2") << "Creating or removing transitions to comply with the given degree of completeness." << std::endl;
-        fsm->meetDegreeOfCompleteness(degreeOfCompleteness, maxDegreeOfNonDeterminism, observable);
+        fsm->meetDegreeOfCompleteness(rnd, degreeOfCompleteness, maxDegreeOfNonDeterminism, observable);
     }
 
     if(forceNonDeterminism && fsm->getNumberOfNonDeterministicTransitions() < 1)
     {
-        fsm->addRandomTransitions(maxDegreeOfNonDeterminism, true, observable, 1.0f);
+        fsm->addRandomTransitions(rnd, maxDegreeOfNonDeterminism, true, observable, 1.0f);
     }
 
     if (minimal)
@@ -3808,9 +4236,9 @@ throw ss.str();
             if (retryCount > 15)
             {
                 LOG("WARNING") << "Could not create the requested FSM. Trying new seed." << std::endl;
-                const unsigned int newSeed = static_cast<unsigned int>(rand());
-                return createRandomFsm(fsmName, maxInput, maxOutput, maxState, pl, degreeOfCompleteness, maxDegreeOfNonDeterminism,
-                                       forceNonDeterminism, minimal, observable, newSeed);
+                rnd.reseed();
+                return createRandomFsm(rnd, fsmName, maxInput, maxOutput, maxState, pl, degreeOfCompleteness, maxDegreeOfNonDeterminism,
+                                       forceNonDeterminism, minimal, observable);
 
             }
             LOG("VERBOSE_2") << "FSM does not meet all criteria yet:" << std::endl;
@@ -3820,19 +4248,19 @@ throw ss.str();
                 LOG("VERBOSE_1") << "Minimal FSM does not contain requested number of states: "
                         << numStatesMin << " < " << numStates;
                 vector<shared_ptr<FsmNode>> newNodes;
-                fsmMin.meetNumberOfStates(maxState, maxDegreeOfNonDeterminism, observable, newNodes);
-                fsmMin.addRandomTransitions(maxDegreeOfNonDeterminism, false, observable, 1.0f, newNodes);
+                fsmMin.meetNumberOfStates(rnd, maxState, maxDegreeOfNonDeterminism, observable, newNodes);
+                fsmMin.addRandomTransitions(rnd, maxDegreeOfNonDeterminism, false, observable, 1.0f, newNodes);
             }
             else if (!metDegreeOfCompleteness)
             {
                 LOG("VERBOSE_1") << "Minimal FSM does not meet degree of completeness: "
                         << degreeOfCompletenessMin << " != " << degreeOfCompleteness;
-                fsmMin.meetDegreeOfCompleteness(degreeOfCompleteness, maxDegreeOfNonDeterminism, observable);
+                fsmMin.meetDegreeOfCompleteness(rnd, degreeOfCompleteness, maxDegreeOfNonDeterminism, observable);
             }
             else if (!metNonDeterminism)
             {
                 LOG("VERBOSE_1") << "Minimal FSM is not non-deterministic." << std::endl;
-                fsm->addRandomTransitions(maxDegreeOfNonDeterminism, true, observable, 1.0f);
+                fsm->addRandomTransitions(rnd, maxDegreeOfNonDeterminism, true, observable, 1.0f);
             }
 
             fsmMin = fsmMin.minimise("", "", false);
@@ -3862,6 +4290,35 @@ shared_ptr<Fsm> Fsm::createMutant(const std::string & fsmName,
                                   const bool keepObservability,
                                   const unsigned seed,
                                   const shared_ptr<FsmPresentationLayer>& pLayer){
+    if ( seed == 0 ) {
+        unsigned int s = getRandomSeed();
+        srand(s);
+        LOG("DEBUG") << "createMutant seed: " << s << std::endl;
+    }
+    else {
+        srand(seed);
+        LOG("DEBUG") << "createMutant seed: " << seed << std::endl;
+    }
+    RandomSource rnd;
+    return createMutant(rnd,fsmName,numOutputFaults,numTransitionFaults,keepObservability,pLayer);
+}
+
+shared_ptr<Fsm> Fsm::createMutant(const std::string & fsmName,
+                                  const int numOutputFaults,
+                                  const int numTransitionFaults,
+                                  const bool keepObservability,
+                                  mt19937& gen,
+                                  const shared_ptr<FsmPresentationLayer>& pLayer){
+    RandomSource rnd(gen);
+    return createMutant(rnd,fsmName,numOutputFaults,numTransitionFaults,keepObservability,pLayer);
+}
+
+shared_ptr<Fsm> Fsm::createMutant(RandomSource& rnd,
+                                  const std::string & fsmName,
+                                  const int numOutputFaults,
+                                  const int numTransitionFaults,
+                                  const bool keepObservability,
+                                  const shared_ptr<FsmPresentationLayer>& pLayer){
     if (keepObservability && !isObservable())
     {
         stringstream ss;
@@ -3875,16 +4332,6 @@ throw ss.str();
         throw too_many_output_faults("Can not create output faults on FSMs with output alphabet size < 2");
     }
 
-    if ( seed == 0 ) {
-        unsigned int s = getRandomSeed();
-        srand(s);
-        LOG("DEBUG") << "createMutant seed: " << s << std::endl;
-    }
-    else {
-        srand(seed);
-        LOG("DEBUG") << "createMutant seed: " << seed << std::endl;
-    }
-
     LOG("DEBUG") << "numOutputFaults: " << numOutputFaults << std::endl;
     LOG("DEBUG") << "numTransitionFaults: " << numTransitionFaults << std::endl;
 
@@ -3938,7 +4385,7 @@ throw ss.str();
             {
                 break;
             }
-            std::vector<int>::iterator srcNodeIt = srcNodeIdsCpy.begin() + (rand() % srcNodeIdsCpy.size());
+            std::vector<int>::iterator srcNodeIt = srcNodeIdsCpy.begin() + (rnd() % srcNodeIdsCpy.size());
             size_t srcNodeId = static_cast<size_t>(*srcNodeIt);
             LOG("VERBOSE_2") << "srcNodeId: " << srcNodeId << std::endl;
             srcNodeIdsCpy.erase(srcNodeIt);
@@ -3951,7 +4398,7 @@ throw ss.str();
                 {
                     break;
                 }
-                std::vector<int>::iterator tgtNodeIt = tgtNodeIdsCpy.begin() + (rand() % tgtNodeIdsCpy.size());
+                std::vector<int>::iterator tgtNodeIt = tgtNodeIdsCpy.begin() + (rnd() % tgtNodeIdsCpy.size());
                 size_t newTgtNodeId = static_cast<size_t>(*tgtNodeIt);
                 LOG("VERBOSE_2") << "  newTgtNodeId: " << newTgtNodeId << std::endl;
                 tgtNodeIdsCpy.erase(tgtNodeIt);
@@ -3960,7 +4407,7 @@ throw ss.str();
                 transitions = lst[srcNodeId]->getTransitions();
                 while (transitions.size() > 0)
                 {
-                    std::vector<shared_ptr<FsmTransition>>::iterator transitionIt = transitions.begin() + (rand() % transitions.size());
+                    std::vector<shared_ptr<FsmTransition>>::iterator transitionIt = transitions.begin() + (rnd() % transitions.size());
                     shared_ptr<FsmTransition> tr = *transitionIt;
                     LOG("VERBOSE_2") << "    tr: " << tr->str() << std::endl;
                     transitions.erase(transitionIt);
@@ -4008,14 +4455,14 @@ throw ss.str();
             {
                 break;
             }
-            std::vector<int>::iterator srcNodeIt = srcNodeIdsCpy.begin() + (rand() % srcNodeIdsCpy.size());
+            std::vector<int>::iterator srcNodeIt = srcNodeIdsCpy.begin() + (rnd() % srcNodeIdsCpy.size());
             size_t srcNodeId = static_cast<size_t>(*srcNodeIt);
             srcNodeIdsCpy.erase(srcNodeIt);
 
             transitions = lst[srcNodeId]->getTransitions();
             while (transitions.size() > 0)
             {
-                std::vector<shared_ptr<FsmTransition>>::iterator transitionIt = transitions.begin() + (rand() % transitions.size());
+                std::vector<shared_ptr<FsmTransition>>::iterator transitionIt = transitions.begin() + (rnd() % transitions.size());
                 shared_ptr<FsmTransition> tr = *transitionIt;
                 transitions.erase(transitionIt);
 
@@ -4028,7 +4475,7 @@ throw ss.str();
                 int theInput = tr->getLabel()->getInput();
                 int originalOutVal = tr->getLabel()->getOutput();
 
-                int newOutVal = rand() % (maxOutput+1);
+                int newOutVal = rnd() % (maxOutput+1);
                 int originalNewOutVal = newOutVal;
 
                 if (newOutVal == originalOutVal)
@@ -4117,7 +4564,6 @@ shared_ptr<Fsm> Fsm::createReduction(const string& fsmName,
                                      const unsigned seed,
                                      const std::shared_ptr<FsmPresentationLayer>& pLayer) const
 {
-    LOG("VERBOSE_1") << "**createReduction()" << std::endl;
     if ( seed == 0 ) {
         unsigned int s = getRandomSeed();
         srand(s);
@@ -4127,6 +4573,27 @@ shared_ptr<Fsm> Fsm::createReduction(const string& fsmName,
         srand(seed);
         LOG("DEBUG") << "createReduction seed: " << seed << std::endl;
     }
+    RandomSource rnd;
+    return createReduction(rnd, fsmName, force, removedTransitions, pLayer);
+}
+
+shared_ptr<Fsm> Fsm::createReduction(const string& fsmName,
+                                     const bool& force,
+                                     int& removedTransitions,
+                                     mt19937& gen,
+                                     const std::shared_ptr<FsmPresentationLayer>& pLayer) const
+{
+    RandomSource rnd(gen);
+    return createReduction(rnd, fsmName, force, removedTransitions, pLayer);
+}
+
+shared_ptr<Fsm> Fsm::createReduction(RandomSource& rnd,
+                                     const string& fsmName,
+                                     const bool& force,
+                                     int& removedTransitions,
+                                     const std::shared_ptr<FsmPresentationLayer>& pLayer) const
+{
+    LOG("VERBOSE_1") << "**createReduction()" << std::endl;
 
     LOG("VERBOSE_2") << "Fsm:" << std::endl;
     LOG("VERBOSE_2") << *this << std::endl;
@@ -4156,7 +4623,7 @@ shared_ptr<Fsm> Fsm::createReduction(const string& fsmName,
     bool keepGoing = true;
     while (!nonDetTransitions.empty() && keepGoing)
     {
-        size_t idx = static_cast<size_t>(rand()) % nonDetTransitions.size();
+        size_t idx = static_cast<size_t>(rnd()) % nonDetTransitions.size();
         const shared_ptr<FsmTransition>& transition = nonDetTransitions.at(idx);
         LOG("VERBOSE_2") << "Removing transition " << transition->str() << std::endl;
         transition->getSource()->removeTransition(transition);
@@ -4167,7 +4634,7 @@ shared_ptr<Fsm> Fsm::createReduction(const string& fsmName,
         int mod = 10 * static_cast<int>(ceil(size * size / 2.0f));
         LOG("VERBOSE_2") << "size: " << size << std::endl;
         LOG("VERBOSE_2") << "mod: " << mod << std::endl;
-        keepGoing = (mod == 0) ? false : (rand() % mod) > 7;
+        keepGoing = (mod == 0) ? false : (rnd() % mod) > 7;
         LOG("VERBOSE_2") << "keepGoing: " << boolalpha << keepGoing << std::endl;
     }
 
@@ -4270,7 +4737,8 @@ bool Fsm::moreTransitionsPossible(const float& maxDegreeOfNonDeterminism,
     return false;
 }
 
-void Fsm::addRandomTransitions(const float& maxDegreeOfNonDeterminism,
+void Fsm::addRandomTransitions(RandomSource& rnd,
+                               const float& maxDegreeOfNonDeterminism,
                                const bool& onlyNonDeterministic,
                                const bool& observable,
                                const float& factor,
@@ -4314,12 +4782,12 @@ void Fsm::addRandomTransitions(const float& maxDegreeOfNonDeterminism,
 
         while (!allowedTargetNodes.empty() && (!srcNode || !label))
         {
-            size_t targetNodeIndex = static_cast<size_t>(rand()) % (allowedTargetNodes.size());
+            size_t targetNodeIndex = static_cast<size_t>(rnd()) % (allowedTargetNodes.size());
             targetNode = allowedTargetNodes.at(targetNodeIndex);
 
             LOG("VERBOSE_2") << "Trying to create transition to target node " << targetNode->getName() << std::endl;
 
-            selectRandomNodeAndCreateLabel(nodePool, maxDegreeOfNonDeterminism, onlyNonDeterministic, observable, srcNode, label);
+            selectRandomNodeAndCreateLabel(rnd, nodePool, maxDegreeOfNonDeterminism, onlyNonDeterministic, observable, srcNode, label);
 
             // We could not find a source node or a valid label.
             if (!srcNode || !label)
@@ -4350,14 +4818,15 @@ void Fsm::addRandomTransitions(const float& maxDegreeOfNonDeterminism,
         if (keepGoing)
         {
             float observableFactor = (observable) ? 1.0f : 1.75f;
-            keepGoing = (rand() % static_cast<int>(round((10.0f * numStates * observableFactor * factor)))) >= numStates * 2;
+            keepGoing = (rnd() % static_cast<int>(round((10.0f * numStates * observableFactor * factor)))) >= numStates * 2;
         }
         LOG("VERBOSE_2") << "keepGoing: " << boolalpha << keepGoing << std::endl;
     }
 
 }
 
-bool Fsm::meetDegreeOfCompleteness(const float& degreeOfCompleteness,
+bool Fsm::meetDegreeOfCompleteness(RandomSource& rnd,
+                                   const float& degreeOfCompleteness,
                                    const float& maxDegreeOfNonDeterminism,
                                    const bool& observable,
                                    vector<shared_ptr<FsmNode>> nodePool)
@@ -4379,13 +4848,13 @@ bool Fsm::meetDegreeOfCompleteness(const float& degreeOfCompleteness,
         LOG("VERBOSE_2") << "Going to add transitions." << std::endl;
         while (actualDegreeOfCompleteness < degreeOfCompleteness)
         {
-            size_t targetNodeIndex = static_cast<size_t>(rand()) % (nodes.size());
+            size_t targetNodeIndex = static_cast<size_t>(rnd()) % (nodes.size());
             const shared_ptr<FsmNode>& targetNode = nodes.at(targetNodeIndex);
 
             shared_ptr<FsmNode> srcNode;
             shared_ptr<FsmLabel> label;
 
-            selectRandomNodeAndCreateLabel(nodePool, maxDegreeOfNonDeterminism, false, observable, srcNode, label);
+            selectRandomNodeAndCreateLabel(rnd, nodePool, maxDegreeOfNonDeterminism, false, observable, srcNode, label);
 
             // We could not find a source node or a valid label.
             if (!srcNode || !label)
@@ -4431,14 +4900,14 @@ throw ss.str();
             bool removedTransition = false;
             while (!selectFrom.empty() && !removedTransition)
             {
-                nodeIdx = static_cast<size_t>(rand()) % selectFrom.size();
+                nodeIdx = static_cast<size_t>(rnd()) % selectFrom.size();
                 node = selectFrom.at(nodeIdx);
                 LOG("VERBOSE_2") << "Selected node " << node->getName() << std::endl;
                 vector<shared_ptr<FsmTransition>> detTrans = node->getDeterminisitcTransitions();
                 LOG("VERBOSE_2") << "Found " << detTrans.size() << " deterministic transitions." << std::endl;
                 if (!detTrans.empty())
                 {
-                    size_t transIndex = static_cast<size_t>(rand()) % detTrans.size();
+                    size_t transIndex = static_cast<size_t>(rnd()) % detTrans.size();
                     const shared_ptr<FsmTransition>& tr = detTrans.at(transIndex);
                     LOG("VERBOSE_2") << "Removing transition " << tr->str() << std::endl;
                     if (!node->removeTransition(tr))
@@ -4475,14 +4944,14 @@ throw ss.str();
             removedTransition = false;
             while (!selectFrom.empty() && !removedTransition)
             {
-                nodeIdx = static_cast<size_t>(rand()) % selectFrom.size();
+                nodeIdx = static_cast<size_t>(rnd()) % selectFrom.size();
                 node = selectFrom.at(nodeIdx);
                 LOG("VERBOSE_2") << "Selected node " << node->getName() << std::endl;
                 vector<shared_ptr<FsmTransition>> transitions = node->getTransitions();
                 LOG("VERBOSE_2") << "Found " << transitions.size() << " transitions." << std::endl;
                 if (!transitions.empty())
                 {
-                    const shared_ptr<FsmTransition>& trans = transitions.at(static_cast<size_t>(rand()) % transitions.size());
+                    const shared_ptr<FsmTransition>& trans = transitions.at(static_cast<size_t>(rnd()) % transitions.size());
                     int input = trans->getLabel()->getInput();
                     LOG("VERBOSE_2") << "Removing all transitions with input " << input << std::endl;
 
@@ -4569,7 +5038,8 @@ bool Fsm::doesMeetDegreeOfCompleteness(const float& degreeOfCompleteness, vector
     return yes;
 }
 
-void Fsm::meetNumberOfStates(const int& maxState,
+void Fsm::meetNumberOfStates(RandomSource& rnd,
+                             const int& maxState,
                              const float& maxDegreeOfNonDeterminism,
                              const bool& observable,
                              vector<shared_ptr<FsmNode>>& createdNodes)
@@ -4615,7 +5085,7 @@ void Fsm::meetNumberOfStates(const int& maxState,
         shared_ptr<FsmNode> srcNode;
         shared_ptr<FsmLabel> label;
 
-        selectRandomNodeAndCreateLabel(nodes, maxDegreeOfNonDeterminism, false, observable, srcNode, label);
+        selectRandomNodeAndCreateLabel(rnd, nodes, maxDegreeOfNonDeterminism, false, observable, srcNode, label);
 
         // We could not find a source node or a valid label.
         if (!srcNode || !label)
@@ -4625,7 +5095,7 @@ void Fsm::meetNumberOfStates(const int& maxState,
                 LOG("VERBOSE_1") << "Could not create requested number of transitions." << std::endl;
                 LOG("VERBOSE_1") << "Going to change the target of an existing one instead" << std::endl;
                 const vector<shared_ptr<FsmTransition>>& transitions = srcNode->getTransitions();
-                shared_ptr<FsmTransition> transition = transitions.at(static_cast<size_t>(rand()) % transitions.size());
+                shared_ptr<FsmTransition> transition = transitions.at(static_cast<size_t>(rnd()) % transitions.size());
                 LOG("VERBOSE_2") << "Selected transition: " << transition->str() << std::endl;
                 LOG("VERBOSE_2") << "Replacing target node " << transition->getTarget()->getName() << " with node " << targetNode->getName() << std::endl;
                 transition->setTarget(targetNode);
@@ -4669,7 +5139,8 @@ throw ss.str();
     LOG("VERBOSE_2") << "Connected all nodes." << std::endl;
 }
 
-shared_ptr<FsmLabel> Fsm::createRandomLabel(const shared_ptr<FsmNode>& srcNode,
+shared_ptr<FsmLabel> Fsm::createRandomLabel(RandomSource& rnd,
+                                            const shared_ptr<FsmNode>& srcNode,
                                             const float& maxDegreeOfNonDeterminism,
                                             const bool& onlyNonDeterministic,
                                             const bool& observable) const
@@ -4737,8 +5208,8 @@ throw ss.str();
                 LOG("VERBOSE_2") << "  " << presentationLayer->getOutId(static_cast<unsigned int>(o)) << std::endl;
                 allowedOutputs.push_back(o);
             }
-            int input = allowedInputs.at(static_cast<size_t>(rand()) % allowedInputs.size());
-            int output = allowedOutputs.at(static_cast<size_t>(rand()) % allowedOutputs.size());
+            int input = allowedInputs.at(static_cast<size_t>(rnd()) % allowedInputs.size());
+            int output = allowedOutputs.at(static_cast<size_t>(rnd()) % allowedOutputs.size());
             LOG("VERBOSE_2") << "Selected input: " << presentationLayer->getInId(static_cast<unsigned int>(input)) << std::endl;
             LOG("VERBOSE_2") << "Selected output: " << presentationLayer->getOutId(static_cast<unsigned int>(output)) << std::endl;
             label = make_shared<FsmLabel>(input, output, presentationLayer);
@@ -4765,7 +5236,7 @@ throw ss.str();
                 while (!allowedInputs.empty())
                 {
                     LOG("VERBOSE_2") << "Still inputs left." << std::endl;
-                    size_t inputIndex = static_cast<size_t>(rand()) % allowedInputs.size();
+                    size_t inputIndex = static_cast<size_t>(rnd()) % allowedInputs.size();
                     int input = allowedInputs.at(inputIndex);
                     LOG("VERBOSE_2") << "Getting allowed outputs for input "
                             << presentationLayer->getInId(static_cast<unsigned int>(input));
@@ -4782,7 +5253,7 @@ throw ss.str();
                     }
                     else
                     {
-                        int output = allowedOutputs.at(static_cast<size_t>(rand()) % allowedOutputs.size());
+                        int output = allowedOutputs.at(static_cast<size_t>(rnd()) % allowedOutputs.size());
                         LOG("VERBOSE_2") << "Selected output: " << presentationLayer->getOutId(static_cast<unsigned int>(output)) << std::endl;
                         label = make_shared<FsmLabel>(input, output, presentationLayer);
                         break;
@@ -4806,8 +5277,8 @@ throw ss.str();
                     LOG("VERBOSE_2") << "  " << presentationLayer->getOutId(static_cast<unsigned int>(o)) << std::endl;
                     allowedOutputs.push_back(o);
                 }
-                int input = allowedInputs.at(static_cast<size_t>(rand()) % allowedInputs.size());
-                int output = allowedOutputs.at(static_cast<size_t>(rand()) % allowedOutputs.size());
+                int input = allowedInputs.at(static_cast<size_t>(rnd()) % allowedInputs.size());
+                int output = allowedOutputs.at(static_cast<size_t>(rnd()) % allowedOutputs.size());
                 label = make_shared<FsmLabel>(input, output, presentationLayer);
             }
         }
@@ -4824,6 +5295,7 @@ throw ss.str();
 }
 
 void Fsm::selectRandomNodeAndCreateLabel(
+        RandomSource& rnd,
         const vector<shared_ptr<FsmNode>> srcNodePool,
         const float& maxDegreeOfNonDeterminism,
         const bool& onlyNonDeterministic,
@@ -4849,10 +5321,10 @@ void Fsm::selectRandomNodeAndCreateLabel(
     }
     while ((!node || !label) && !allowedSourceNodes.empty())
     {
-        size_t srcNodeIndex = static_cast<size_t>(rand()) % (allowedSourceNodes.size());
+        size_t srcNodeIndex = static_cast<size_t>(rnd()) % (allowedSourceNodes.size());
         node = allowedSourceNodes.at(srcNodeIndex);
         LOG("VERBOSE_2") << "Trying node " << node->getName() << std::endl;
-        label = createRandomLabel(node, maxDegreeOfNonDeterminism, onlyNonDeterministic, observable);
+        label = createRandomLabel(rnd, node, maxDegreeOfNonDeterminism, onlyNonDeterministic, observable);
         if (!label)
         {
             // No label found. We have to try another source node
@@ -4943,15 +5415,18 @@ bool Fsm::distinguishable(const FsmNode& s1, const FsmNode& s2) {
         calcOFSMTables();
     }
     
-    shared_ptr<OFSMTable> p = ofsmTableLst.back();
+    shared_ptr<OFSMTable> p = getOFSMTable(getNumOFSMTables() - 1);
     
     return ( p->getS2C().at(s1.getId()) != p->getS2C().at(s2.getId()) );
     
 }
 
 
-InputTrace Fsm::calculateDistinguishingTrace(std::shared_ptr<FsmNode> const &s1, std::shared_ptr<FsmNode> const &s2) const {
-    return s1->calcDistinguishingTrace(s2, this->ofsmTableLst, maxInput, maxOutput);
+InputTrace Fsm::calculateDistinguishingTrace(std::shared_ptr<FsmNode> const &s1, std::shared_ptr<FsmNode> const &s2) {
+    if ( ofsmTableLst.empty() ) {
+        calcOFSMTables();
+    }
+    return s1->calcDistinguishingTrace(s2, createAllOFSMTables(), maxInput, maxOutput);
 }
 
 bool Fsm::isHarmonized() const {
@@ -4973,9 +5448,7 @@ bool Fsm::isHarmonized() const {
     auto transitionFunction = [](std::decay<decltype(*this->nodes.begin())>::type const &state, int symbol) {
         return state->after(symbol);
     };
-    auto refinedPartitioning = fixpoint([&symbolSet,&transitionFunction](decltype(equivalencePartitioning) const &partitioning) {
-        return refineStatePartitioning(partitioning, symbolSet, transitionFunction);
-    }, equivalencePartitioning);
+    auto refinedPartitioning = refineStatePartitioningIndexed(equivalencePartitioning, symbolSet, transitionFunction);
 
     return std::all_of(refinedPartitioning.begin(), refinedPartitioning.end(), [&symbolSet,&transitionFunction,&refinedPartitioning](std::decay<decltype(*refinedPartitioning.begin())>::type const &partition) {
         auto const &firstState = *partition.begin();
@@ -5003,6 +5476,35 @@ std::shared_ptr<FsmNode> Fsm::addNode(const std::string & name) {
 
 std::vector<IOTrace> Fsm::getResponses(std::deque<int>& input) const {
     
+    shared_ptr<TransitionTable> tbl = getTransitionTable();
+    if ( tbl != nullptr ) {
+        
+        // Depth-first enumeration on the transition table, a response
+        // ends as soon as the next input is undefined in the current state
+        std::vector<IOTrace> result;
+        std::vector<int> inputs(input.begin(), input.end());
+        std::vector<int> outputs;
+        
+        std::function<void(int,size_t)> dfs = [&](int s, size_t pos) {
+            if ( pos == inputs.size() or tbl->count(s,inputs[pos]) == 0 ) {
+                std::vector<int> inPrefix(inputs.begin(), inputs.begin() + pos);
+                result.push_back(IOTrace(InputTrace(inPrefix,presentationLayer),
+                                         OutputTrace(outputs,presentationLayer),
+                                         nodes[s]));
+                return;
+            }
+            int x = inputs[pos];
+            for ( auto e = tbl->begin(s,x); e != tbl->end(s,x); ++e ) {
+                outputs.push_back(e->output);
+                dfs(e->target, pos + 1);
+                outputs.pop_back();
+            }
+        };
+        
+        dfs(initStateIdx, 0);
+        return result;
+    }
+    
     std::function<std::vector<IOTrace>(std::shared_ptr<FsmNode>,std::deque<int>)> helper = [this,&helper](std::shared_ptr<FsmNode>node, std::deque<int> inputs)->std::vector<IOTrace> {
         std::vector<IOTrace> result;
         // empty input sequence
@@ -5052,7 +5554,24 @@ std::vector<IOTrace> Fsm::getResponses(const InputTrace& input) const {
 }
 
 bool Fsm::exhibitsBehaviour(const IOTrace& trace) const {
-    return getInitialState()->exhibitsBehaviour(trace);
+    
+    shared_ptr<TransitionTable> tbl = getTransitionTable();
+    if ( tbl == nullptr ) {
+        return getInitialState()->exhibitsBehaviour(trace);
+    }
+    
+    // As in FsmNode::exhibitsBehaviour(), observability is assumed
+    // and only the first transition matching x/y is followed
+    const vector<int> inputs = trace.getInputTrace().get();
+    const vector<int> outputs = trace.getOutputTrace().get();
+    if ( outputs.size() < inputs.size() ) return false;
+    
+    int s = initStateIdx;
+    for ( size_t i = 0; i < inputs.size(); ++i ) {
+        s = tbl->after(s, inputs[i], outputs[i]);
+        if ( s < 0 ) return false;
+    }
+    return true;
 }
 
 
@@ -5097,7 +5616,7 @@ bool Fsm::passesStrongSemiReductionTestSuite(Fsm& spec, InputTree& testSuite) {
 
             // check that the targets of response in this and spec 
             // have the same defined inputs
-            auto targets = spec.getInitialState()->after(response);
+            auto targets = spec.after(response);
             // as observability is assumed, we simply pick the first state in the
             // set of targets as the target of the response in spec
             auto specTarget = *targets.cbegin();
@@ -13,8 +13,11 @@
 #include <vector>
 #include <deque>
 #include <stdexcept>
+#include <random>
 
 #include "fsm/InputTraceSet.h"
+#include "fsm/PartitionRefinement.h"
+#include "utils/RandomSource.hpp"
 
 
 class FsmVisitor;
@@ -34,12 +37,27 @@ class IOTreeContainer;
 class IOListContainer;
 class InputTrace;
 class IOTraceContainer;
+class TransitionTable;
+class AdaptiveResponseCache;
+class TestCaseSink;
 
 enum Minimal
 {
     True, False, Maybe
 };
 
+/**
+ *  Algorithm used for calculating the OFSM-tables (Fsm) and
+ *  Pk-tables (Dfsm), and therefore for minimisation.
+ */
+enum class MinimisationMode
+{
+    /** Refine the classes table by table (OFSMTable::next(), PkTable::getPkPlusOneTable()) */
+    Tables,
+    /** Calculate the classes by PartitionRefinement and create the tables from them */
+    PartitionRefinement
+};
+
 class too_many_transition_faults : public std::runtime_error
 {
 public:
@@ -98,9 +116,32 @@ protected:
     std::vector<std::shared_ptr<FsmNode>> dReachableStates;
     Minimal minimal;
 
+    /** Algorithm used by calcOFSMTables() and Dfsm::calcPkTables() */
+    MinimisationMode minimisationMode = MinimisationMode::Tables;
+
     std::vector<std::shared_ptr<OFSMTable>> ofsmTableLst;
+
+    /**
+     *  Partitions of the OFSM tables, if they have been calculated by a
+     *  PartitionRefinement. In this case, ofsmTableLst only contains the
+     *  tables requested so far, and ofsmCursor is positioned at the
+     *  partition of its last table (see getOFSMTable()).
+     */
+    std::shared_ptr<PartitionRefinement> ofsmRefinement;
+    PartitionRefinement::Cursor ofsmCursor;
+
     std::vector<std::shared_ptr<Tree>> stateIdentificationSets;
     std::shared_ptr<FsmPresentationLayer> presentationLayer;
+
+    /**
+     *  Compact transition table used by the query operations
+     *  (apply(), after(), getResponses(), exhibitsBehaviour(), ...),
+     *  created on demand from the nodes of this FSM and recreated
+     *  whenever it is no longer current.
+     *  \note Access only via getTransitionTable().
+     */
+    mutable std::shared_ptr<TransitionTable> transitionTable;
+
     std::shared_ptr<FsmNode> newNode(const int id, const std::shared_ptr<std::pair<std::shared_ptr<FsmNode>, std::shared_ptr<FsmNode>>>& p,
                                      const std::shared_ptr<FsmPresentationLayer>& pl);
     bool contains(const std::deque<std::shared_ptr<std::pair<std::shared_ptr<FsmNode>, std::shared_ptr<FsmNode>>>>& lst, const std::shared_ptr<std::pair<std::shared_ptr<FsmNode>, std::shared_ptr<FsmNode>>>& p);
@@ -141,29 +182,56 @@ protected:
     std::vector< std::unordered_set<int> > getEquivalentInputsFromPrimeMachine();
 
     /**
-     *   Calculate OFSM tables and store them in ofsmTableLst
+     *   Calculate OFSM tables and store them in ofsmTableLst. In minimisation
+     *   mode MinimisationMode::PartitionRefinement, only the partitions and
+     *   the initial table are calculated, and each other table is created
+     *   when it is requested by getOFSMTable() for the first time.
      */
     void calcOFSMTables();
+
+    /**
+     *   Number of OFSM tables, including the tables not created yet
+     *   \pre calcOFSMTables() has been called
+     */
+    size_t getNumOFSMTables() const;
+
+    /**
+     *   Return the OFSM table with tblId k. If it does not exist yet,
+     *   it is created from its predecessor, which is created in the same way.
+     *   \pre calcOFSMTables() has been called
+     *   @return nullptr if k >= getNumOFSMTables()
+     */
+    std::shared_ptr<OFSMTable> getOFSMTable(const size_t k);
+
+    /**
+     *   Create all OFSM tables not created so far
+     *   @return ofsmTableLst
+     */
+    const std::vector<std::shared_ptr<OFSMTable>>& createAllOFSMTables();
     
-    void addRandomTransitions(const float& maxDegreeOfNonDeterminism,
+    void addRandomTransitions(RandomSource& rnd,
+                              const float& maxDegreeOfNonDeterminism,
                               const bool& onlyNonDeterministic,
                               const bool& observable,
                               const float& factor,
                               std::vector<std::shared_ptr<FsmNode>> nodePool = std::vector<std::shared_ptr<FsmNode>>());
-    bool meetDegreeOfCompleteness(const float& degreeOfCompleteness,
+    bool meetDegreeOfCompleteness(RandomSource& rnd,
+                                  const float& degreeOfCompleteness,
                                   const float& maxDegreeOfNonDeterminism,
                                   const bool& observable,
                                   std::vector<std::shared_ptr<FsmNode>> nodePool = std::vector<std::shared_ptr<FsmNode>>());
     bool doesMeetDegreeOfCompleteness(const float& degreeOfCompleteness, std::vector<std::shared_ptr<FsmNode>> nodePool = std::vector<std::shared_ptr<FsmNode>>()) const;
-    void meetNumberOfStates(const int& maxState, const float& maxDegreeOfNonDeterminism, const bool& observable,
+    void meetNumberOfStates(RandomSource& rnd, const int& maxState, const float& maxDegreeOfNonDeterminism, const bool& observable,
                             std::vector<std::shared_ptr<FsmNode>>& createdNodes);
     std::shared_ptr<FsmLabel> createRandomLabel(
+            RandomSource& rnd,
             const std::shared_ptr<FsmNode>& srcNode,
             const float& maxDegreeOfNonDeterminism,
             const bool& onlyNonDeterministic,
             const bool& observable) const;
 
     void selectRandomNodeAndCreateLabel(
+            RandomSource& rnd,
             const std::vector<std::shared_ptr<FsmNode>> srcNodePool,
             const float& maxDegreeOfNonDeterminism,
             const bool& onlyNonDeterministic,
@@ -182,6 +250,45 @@ protected:
 
     std::vector<std::shared_ptr<FsmTransition>> getNonDeterministicTransitions() const;    
 
+    /**
+     *  Implementations of the public random generation methods,
+     *  drawing all random numbers from rnd
+     */
+    static std::shared_ptr<Fsm>
+    createRandomFsm(RandomSource& rnd,
+                    const std::string & fsmName,
+                    const int maxInput,
+                    const int maxOutput,
+                    const int maxState,
+                    const std::shared_ptr<FsmPresentationLayer>& presentationLayer,
+                    const bool observable);
+
+    static std::shared_ptr<Fsm>
+    createRandomFsm(RandomSource& rnd,
+                    const std::string & fsmName,
+                    const int& maxInput,
+                    const int& maxOutput,
+                    const int& maxState,
+                    const std::shared_ptr<FsmPresentationLayer>& presentationLayer,
+                    const float& degreeOfCompleteness,
+                    const float& maxDegreeOfNonDeterminism,
+                    const bool& forceNonDeterminism,
+                    const bool& minimal,
+                    const bool& observable);
+
+    std::shared_ptr<Fsm> createMutant(RandomSource& rnd,
+                                      const std::string & fsmName,
+                                      const int numOutputFaults,
+                                      const int numTransitionFaults,
+                                      const bool keepObservability,
+                                      const std::shared_ptr<FsmPresentationLayer>& pLayer);
+
+    std::shared_ptr<Fsm> createReduction(RandomSource& rnd,
+                                         const std::string& fsmName,
+                                         const bool& force,
+                                         int& removedTransitions,
+                                         const std::shared_ptr<FsmPresentationLayer>& pLayer) const;
+
 public:
     
     
@@ -318,6 +425,33 @@ public:
                     const bool& observable,
                     const unsigned& seed = 0);
 
+    /**
+     *  Variants of createRandomFsm() drawing all random numbers from gen
+     *  instead of the global generator of rand(), so that FSMs can be
+     *  created concurrently, using one generator per thread.
+     */
+    static std::shared_ptr<Fsm>
+    createRandomFsm(const std::string & fsmName,
+                    const int maxInput,
+                    const int maxOutput,
+                    const int maxState,
+                    const std::shared_ptr<FsmPresentationLayer>& presentationLayer,
+                    const bool observable,
+                    std::mt19937& gen);
+
+    static std::shared_ptr<Fsm>
+    createRandomFsm(const std::string & fsmName,
+                    const int& maxInput,
+                    const int& maxOutput,
+                    const int& maxState,
+                    const std::shared_ptr<FsmPresentationLayer>& presentationLayer,
+                    const float& degreeOfCompleteness,
+                    const float& maxDegreeOfNonDeterminism,
+                    const bool& forceNonDeterminism,
+                    const bool& minimal,
+                    const bool& observable,
+                    std::mt19937& gen);
+
 
     /**
      * Generate an observable, possibly partial and possibly non-deterministic FSM.
@@ -362,12 +496,27 @@ public:
                                       const unsigned seed = 0,
                                       const std::shared_ptr<FsmPresentationLayer>& pLayer = nullptr);
 
+    /** Variant of createMutant() drawing all random numbers from gen */
+    std::shared_ptr<Fsm> createMutant(const std::string & fsmName,
+                                      const int numOutputFaults,
+                                      const int numTransitionFaults,
+                                      const bool keepObservability,
+                                      std::mt19937& gen,
+                                      const std::shared_ptr<FsmPresentationLayer>& pLayer = nullptr);
+
     std::shared_ptr<Fsm> createReduction(const std::string& fsmName,
                                          const bool& force,
                                          int& removedTransitions,
                                          const unsigned seed = 0,
                                          const std::shared_ptr<FsmPresentationLayer>& pLayer = nullptr) const;
 
+    /** Variant of createReduction() drawing all random numbers from gen */
+    std::shared_ptr<Fsm> createReduction(const std::string& fsmName,
+                                         const bool& force,
+                                         int& removedTransitions,
+                                         std::mt19937& gen,
+                                         const std::shared_ptr<FsmPresentationLayer>& pLayer = nullptr) const;
+
     /**
      * Create a mutant from this fsm by randomly choosing states and
      * inputs in these states and removing all transitions for this
@@ -410,6 +559,26 @@ public:
     std::shared_ptr<FsmPresentationLayer> getPresentationLayer() const;
     int getInitStateIdx() const;
     void resetColor();
+
+    /**
+     *  Return the compact transition table of this FSM, which is
+     *  created from the FsmNode graph on first use and shared by
+     *  all subsequent queries. If the nodes of this FSM, their
+     *  transitions, or their ids have changed since the table has
+     *  been created, a new table is created (see TransitionTable::isCurrent()).
+     *
+     *  @return the transition table, or nullptr if the FSM
+     *          cannot be represented by a table (for example,
+     *          because its state ids are not numbered consecutively).
+     */
+    std::shared_ptr<TransitionTable> getTransitionTable() const;
+
+    /**
+     *  Discard the transition table, for example to release its memory.
+     *  This is not required after modifications of the FSM, since
+     *  getTransitionTable() detects them itself.
+     */
+    void invalidateTransitionTable();
     
     /**
      * Create a dot (GraphViz)-File from this FSM and store it in the
@@ -437,6 +606,19 @@ public:
      */
     Fsm intersect(const Fsm & f, std::string name = "");
 
+    /**
+     Check whether this FSM is a reduction of spec, that is, whether
+     every transition x/y of this FSM, taken after an IO-trace that
+     spec can also perform, can be taken by spec after that trace
+     as well. For observable spec, this is the check performed by
+     hasFailure() on intersect(spec), but spec is determinised on the fly with a
+     SubsetConstruction, and the search stops at the first failure,
+     without building the intersection or the observable form of spec.
+     @param spec the specification FSM, which may be non-observable
+     @return true if no failure is reachable
+     */
+    bool isReductionOf(const Fsm & spec) const;
+
     /**
      * Generate the state cover of an arbitrary FSM
      * (deterministic or nondeterministic, completely specified 
@@ -472,6 +654,18 @@ public:
      * @param reachedNodes The calculated nodes that can be reached by the given input trace.
      */
     void apply(const InputTrace& input, std::vector<std::shared_ptr<OutputTrace>>& producedOutputs, std::vector<std::shared_ptr<FsmNode>>& reachedNodes) const;
+
+    /**
+     *  Return the set of states reachable from the initial state
+     *  by applying the input trace itrc.
+     */
+    std::unordered_set<std::shared_ptr<FsmNode>> after(const InputTrace& itrc) const;
+
+    /**
+     *  Return the set of states reachable from the initial state
+     *  by the input/output trace trace.
+     */
+    std::unordered_set<std::shared_ptr<FsmNode>> after(const IOTrace& trace) const;
     
     /**
      *  Transform an FSM to its observable equivalent.
@@ -504,6 +698,14 @@ public:
      @return minimal observable FSM which is equivalent to this FSM
      */
     Fsm minimiseObservableFSM(const std::string& nameSuffix = "_MIN", bool prependFsmName = true);
+
+    /**
+     *  Select the algorithm used for minimisation. The minimised
+     *  machines created by this FSM use the same algorithm.
+     *  Both algorithms create identical tables and minimised machines.
+     */
+    void setMinimisationMode(const MinimisationMode mode) { minimisationMode = mode; }
+    MinimisationMode getMinimisationMode() const { return minimisationMode; }
     
     /**
      Create the minimal observable FSM which is equivalent to this FSM.
@@ -543,12 +745,10 @@ public:
     std::vector<std::shared_ptr<OutputTrace>> getOutputIntersection(std::shared_ptr<FsmNode> q1, std::shared_ptr<FsmNode> q2, int x) const;
 
     /**
-     * Calculates for every state the r(1)-distinguishable states.
-     */
-    void calcROneDistinguishableStates();
-
-    /**
-     * Calculates for every state the r-distinguishable states.
+     * Calculates for every state the r-distinguishable states and the adaptive
+     * input sequences r-distinguishing them. Newly r-distinguished pairs of states
+     * are only propagated to the pairs depending on them, so that the effort is
+     * proportional to the number of pairs times the number of transitions per state.
      */
     void calcRDistinguishableStates();
 
@@ -675,6 +875,8 @@ public:
      * possible combination of all input traces from the deterministic state cover
      * and theirs corresponding output sequences.
      * @param dReachableStates All d-reachable states.
+     * @param iutResponses If not null, the responses of the IUT to `adaptiveTestCases`
+     * are taken from this cache instead of being calculated by `iut.bOmega()`.
      * @return The lower bound that may be placed on the number of states
      * of the FSM if there has been no repetition in the states of the product
      * machine for a given input/output sequence.
@@ -683,22 +885,24 @@ public:
                              const IOTrace& suffix,
                              const std::vector<std::shared_ptr<FsmNode>>& states,
                              const IOTreeContainer& adaptiveTestCases,
-                             std::unordered_set<IOTraceContainer> bOmegaT,
+                             const std::unordered_set<IOTraceContainer>& bOmegaT,
                              const IOTraceContainer& vDoublePrime,
                              const std::vector<std::shared_ptr<FsmNode>>& dReachableStates,
                              const Fsm& spec,
-                             const Fsm& iut);
+                             const Fsm& iut,
+                             AdaptiveResponseCache* iutResponses = nullptr);
 
     static bool exceedsBound(const size_t m,
                              const IOTrace& base,
                              const IOTrace& suffix,
                              const std::vector<std::shared_ptr<FsmNode>>& states,
                              const IOTreeContainer& adaptiveTestCases,
-                             std::unordered_set<IOTraceContainer> bOmegaT,
+                             const std::unordered_set<IOTraceContainer>& bOmegaT,
                              const IOTraceContainer& vDoublePrime,
                              const std::vector<std::shared_ptr<FsmNode>>& dReachableStates,
                              const Fsm& spec,
-                             const Fsm& iut);
+                             const Fsm& iut,
+                             AdaptiveResponseCache* iutResponses = nullptr);
 
     /**
      * Calculates a test suite that determines if a given IUT is a reduction of the given
@@ -713,13 +917,18 @@ public:
      * suite creation.
      * @param observedTraces Return parameter for the trace that caused a failure during the test
      * suite creation.
+     * @param numThreads Number of threads applying the traces of T_c and evaluating the
+     * candidates of V''; if 0, the number of hardware threads is used. The responses of
+     * the IUT to the adaptive test cases are calculated once per IUT state. The verdict
+     * and the fail trace do not depend on the number of threads.
      * @return `true`, if no failure has been observed during the creation of the test suite,
      * `false`, otherwise.
      */
     static bool adaptiveStateCounting(Fsm& spec, Fsm& iut, const size_t m,
                                       IOTraceContainer& observedTraces,
                                       std::shared_ptr<IOTrace>& failTrace,
-                                      int& iterations);
+                                      int& iterations,
+                                      unsigned int numThreads = 1);
 
     /**
      * Determines if the given adaptive test cases distinguish all states from
@@ -857,6 +1066,15 @@ public:
      *
      */
     IOListContainer wMethodOnMinimisedFsm(const unsigned int m);
+
+    /**
+     * Streaming variants of wMethod() and wMethodOnMinimisedFsm():
+     * the test cases are passed to sink one by one, in lexicographic
+     * order, instead of being collected in an IOListContainer. The
+     * memory needed does not depend on the size of the test suite.
+     */
+    void wMethod(const unsigned int numAddStates, TestCaseSink& sink);
+    void wMethodOnMinimisedFsm(const unsigned int m, TestCaseSink& sink);
     
     
     /**
@@ -875,6 +1093,11 @@ public:
      */
     IOListContainer wpMethod(const unsigned int numAddStates);
 
+    /**
+     * Streaming variant of wpMethod(), see wMethod(numAddStates,sink)
+     */
+    void wpMethod(const unsigned int numAddStates, TestCaseSink& sink);
+
     /**
      * WORK IN PROGRESS
      * Perform test generation by means of the HSI-Method. The algorithm
@@ -976,7 +1199,7 @@ public:
     /**
      * Calculates and returns the OFSM tables.
      */
-    InputTrace calculateDistinguishingTrace(std::shared_ptr<FsmNode> const &s1, std::shared_ptr<FsmNode> const &s2) const;
+    InputTrace calculateDistinguishingTrace(std::shared_ptr<FsmNode> const &s1, std::shared_ptr<FsmNode> const &s2);
 
     /**
      * Calculates whether the FSM is harmonized, i.e. whether for every state
@@ -1,6 +1,7 @@
 #include "FsmEnumerator.h"
 
-#include <iostream>
+#include <algorithm>
+#include <deque>
 
 #include "fsm/Fsm.h"
 #include "fsm/FsmNode.h"
@@ -28,18 +29,6 @@ FsmEnumerator::FsmEnumerator(int maxInput, int maxOutput, int maxState, const st
 
 bool FsmEnumerator::updateTable() {
 
-    std::cout << "update table:" << std::endl;    
-    for (int i = 0; i <= maxState; ++i) {
-        std::cout << i << ": [ ";
-        for (int x = 0; x <= maxInput; ++x) {
-            for (int y = 0; y <= maxOutput; ++y) {
-                std::cout << " " << x << "/" << y << "->" << currentTable[i][x][y];
-            }
-        }
-        std::cout << " ]" << std::endl;
-    }
-
-
     int i;
     int x;
     int y;
@@ -96,23 +85,38 @@ Fsm FsmEnumerator::generateFsmFromTable() {
     return Fsm(std::to_string(candidateNum),maxInput,maxOutput,nodes,fsm.getPresentationLayer());
 }
 
+bool FsmEnumerator::allStatesReachable() const {
+    std::vector<bool> reached(maxState + 1, false);
+    std::deque<int> bfsLst;
+    reached[0] = true;
+    bfsLst.push_back(0);
+    while (!bfsLst.empty()) {
+        int i = bfsLst.front();
+        bfsLst.pop_front();
+        for (int x = 0; x <= maxInput; ++x) {
+            for (int y = 0; y <= maxOutput; ++y) {
+                int tgt = currentTable[i][x][y];
+                if (tgt >= 0 && !reached[tgt]) {
+                    reached[tgt] = true;
+                    bfsLst.push_back(tgt);
+                }
+            }
+        }
+    }
+    return std::find(reached.begin(), reached.end(), false) == reached.end();
+}
+
 bool FsmEnumerator::hasNext() {
     
     while (updateTable()) {
-        fsm = generateFsmFromTable();
 
-        // early exit if reachability is not to be checked
-        if (generateSmallerFsms) {
-            ++candidateNum;
-            return true;
-        }
+        // reachability is checked on the table, so that no Fsm
+        // is created for candidates with unreachable states
+        if (!generateSmallerFsms && !allStatesReachable()) continue;
 
-        std::vector<std::shared_ptr<FsmNode>> unreachableNodes;
-        fsm.removeUnreachableNodes(unreachableNodes);
-        if (unreachableNodes.empty()) {
-            ++candidateNum;
-            return true;
-        }
+        fsm = generateFsmFromTable();
+        ++candidateNum;
+        return true;
     }
 
     // no new Fsm could be generated
@@ -16,6 +16,9 @@
  * 
  * A flag in the constructor defines whether all states of the generated FSMs must be reachable.
  * The generated FSMs may use fewer inputs than the maximum numbers given.
+ *
+ * Every relabelling of the states of an FSM is generated separately. Use
+ * CanonicalFsmEnumerator to obtain a single FSM of each isomorphism class.
  */
 class FsmEnumerator
 {
@@ -31,6 +34,7 @@ private:
     std::vector<std::vector<std::vector<int>>> currentTable;
 
     bool updateTable();
+    bool allStatesReachable() const;
     Fsm generateFsmFromTable();
 
 public:
@@ -32,6 +32,8 @@
 
 using namespace std;
 
+atomic<uint64_t> FsmNode::modificationCounter(0);
+
 FsmNode::FsmNode(const int id, const shared_ptr<FsmPresentationLayer>& presentationLayer)
 : id(id),
 visited(false),
@@ -39,7 +41,8 @@ color(white),
 presentationLayer(presentationLayer),
 derivedFromPair(nullptr),
 isInitialNode(false),
-dReachTrace(nullptr)
+dReachTrace(nullptr),
+modificationStamp(++modificationCounter)
 {
     rDistinguishability = make_shared<RDistinguishability>(presentationLayer);
 }
@@ -65,6 +68,7 @@ void FsmNode::addTransition(std::shared_ptr<FsmTransition> transition)
     }
     
     transitions.push_back(transition);
+    touch();
 }
 
 bool FsmNode::removeTransition(const std::shared_ptr<FsmTransition>& t)
@@ -73,6 +77,7 @@ bool FsmNode::removeTransition(const std::shared_ptr<FsmTransition>& t)
     if (it != transitions.end())
     {
         transitions.erase(it);
+        touch();
         return true;
     }
     return false;
@@ -81,9 +86,10 @@ bool FsmNode::removeTransition(const std::shared_ptr<FsmTransition>& t)
 void FsmNode::setTransitions(std::vector<std::shared_ptr<FsmTransition>> transitions)
 {
     this->transitions = transitions;
+    touch();
 }
 
-vector<shared_ptr<FsmTransition> >& FsmNode::getTransitions()
+const vector<shared_ptr<FsmTransition> >& FsmNode::getTransitions() const
 {
     return transitions;
 }
@@ -6,6 +6,8 @@
 #ifndef FSM_FSM_FSMNODE_H_
 #define FSM_FSM_FSMNODE_H_
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <unordered_set>
@@ -49,6 +51,15 @@ private:
      *  List of requirements satisfied by the node
      */
     std::vector<std::string> satisfies;
+
+    /**
+     *  Value of modificationCounter after the last modification
+     *  of the transitions or the id of this node
+     */
+    uint64_t modificationStamp;
+
+    /** Number of modifications of all nodes, see touch() */
+    static std::atomic<uint64_t> modificationCounter;
     
 public:
 	const static int white = 0;
@@ -71,13 +82,31 @@ public:
 
     void setTransitions(std::vector<std::shared_ptr<FsmTransition>> transitions);
     
-    
-    std::vector<std::shared_ptr<FsmTransition> >& getTransitions();
+    /**
+     *  The transitions of this node. They can only be changed by means
+     *  of the operations of FsmNode and FsmTransition, which record
+     *  every change by calling touch().
+     */
+    const std::vector<std::shared_ptr<FsmTransition> >& getTransitions() const;
     std::vector<std::shared_ptr<FsmTransition>> getDeterminisitcTransitions() const;
     std::vector<std::shared_ptr<FsmTransition>> getNonDeterminisitcTransitions() const;
     int getId() const;
-    void setId(const int id) { this->id = id; }
+    void setId(const int id) { this->id = id; touch(); }
+
+    /**
+     *  Record a modification of the transitions or the id of this node,
+     *  so that tables derived from the node, like the TransitionTable
+     *  of an Fsm, can detect that they are out of date.
+     */
+    void touch() { modificationStamp = ++modificationCounter; }
+
+    /** Value of getModificationCount() after the last touch() of this node */
+    uint64_t getModificationStamp() const { return modificationStamp; }
+
+    /** Number of modifications of all nodes so far */
+    static uint64_t getModificationCount() { return modificationCounter.load(); }
 	std::string getName() const;
+    std::shared_ptr<FsmPresentationLayer> getPresentationLayer() const { return presentationLayer; }
 	bool hasBeenVisited() const;
 	void setVisited();
     void setUnvisited();
@@ -292,9 +321,15 @@ namespace std
 	public:
 		size_t operator()(const std::unordered_set<std::shared_ptr<FsmNode>> & set) const noexcept
 		{
-            size_t hash = 0;
+            // The sum is independent of the iteration order; each
+            // element hash is mixed first, since pointer hashes of
+            // nodes allocated in sequence differ only in a few bits
+            size_t hash = set.size();
             for (auto elem : set) {
-                hash+= std::hash<std::shared_ptr<FsmNode>>{}(elem);
+                uint64_t h = std::hash<std::shared_ptr<FsmNode>>{}(elem);
+                h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+                hash += static_cast<size_t>(h ^ (h >> 31));
             }
 			return hash;
 		}
@@ -39,7 +39,9 @@ shared_ptr<FsmNode> FsmTransition::getSource()
 }
 
 void FsmTransition::setSource(shared_ptr<FsmNode> src) {
+    if ( auto oldSrc = source.lock() ) oldSrc->touch();
     source = src;
+    if ( src != nullptr ) src->touch();
 }
 
 shared_ptr<FsmNode> FsmTransition::getTarget()
@@ -49,10 +51,12 @@ shared_ptr<FsmNode> FsmTransition::getTarget()
 
 void FsmTransition::setTarget(shared_ptr<FsmNode> tgt) {
     target = tgt;
+    if ( auto src = source.lock() ) src->touch();
 }
 
 void FsmTransition::setLabel(std::shared_ptr<FsmLabel> lbl) {
     label = lbl;
+    if ( auto src = source.lock() ) src->touch();
 }
 
 
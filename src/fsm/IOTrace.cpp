@@ -16,7 +16,7 @@ using namespace std;
 IOTrace::IOTrace(const InputTrace & i, const OutputTrace & o, std::shared_ptr<FsmNode> targetNode)
     : inputTrace(i), outputTrace(o), targetNode(targetNode)
 {
-    if (i.get().size() != o.get().size())
+    if (i.cend() - i.cbegin() != o.cend() - o.cbegin())
     {
         cerr << "Input trace length and output trace length differ." << endl;
         exit(EXIT_FAILURE);
@@ -52,18 +52,18 @@ IOTrace::IOTrace(const IOTrace& ioTrace, const IOTrace& append, bool prepend):
 {
     if (prepend)
     {
-        inputTrace.prepend(append.getInputTrace());
-        outputTrace.prepend(append.getOutputTrace());
+        inputTrace.prepend(append.inputTrace);
+        outputTrace.prepend(append.outputTrace);
     }
     else
     {
-        inputTrace.append(append.getInputTrace());
-        outputTrace.append(append.getOutputTrace());
+        inputTrace.append(append.inputTrace);
+        outputTrace.append(append.outputTrace);
     }
 }
 
 IOTrace::IOTrace(const IOTrace & ioTrace, int n, std::shared_ptr<FsmNode> targetNode):
-    inputTrace(ioTrace.getInputTrace()), outputTrace(ioTrace.getOutputTrace()), targetNode(targetNode)
+    inputTrace(ioTrace.inputTrace), outputTrace(ioTrace.outputTrace), targetNode(targetNode)
 {
     inputTrace.removeElements(n);
     outputTrace.removeElements(n);
@@ -125,19 +125,30 @@ vector<IOTrace> IOTrace::getPrefixes(bool proper) const
 
 size_t IOTrace::size() const
 {
-    return inputTrace.get().size();
+    return static_cast<size_t>(inputTrace.cend() - inputTrace.cbegin());
+}
+
+size_t IOTrace::getHash() const
+{
+    size_t seed = 0;
+    std::hash<size_t> hasher;
+
+    seed ^= hasher(inputTrace.getHash()) + 0x9e3779b9 + (seed<<6) + (seed>>2);
+    seed ^= hasher(outputTrace.getHash()) + 0x9e3779b9 + (seed<<6) + (seed>>2);
+
+    return seed;
 }
 
 void IOTrace::append(IOTrace& other)
 {
-    inputTrace.append(other.getInputTrace());
-    outputTrace.append(other.getOutputTrace());
+    inputTrace.append(other.inputTrace);
+    outputTrace.append(other.outputTrace);
 }
 
 void IOTrace::prepend(IOTrace& other)
 {
-    inputTrace.prepend(other.getInputTrace());
-    outputTrace.prepend(other.getOutputTrace());
+    inputTrace.prepend(other.inputTrace);
+    outputTrace.prepend(other.outputTrace);
 }
 
 void IOTrace::append(int input, int output)
@@ -209,7 +220,7 @@ ostream & operator<<(ostream & out, const IOTrace & trace)
 
 bool operator==(IOTrace const & iOTrace1, IOTrace const & iOTrace2)
 {
-    return iOTrace1.getInputTrace() == iOTrace2.getInputTrace() && iOTrace1.getOutputTrace() == iOTrace2.getOutputTrace();
+    return iOTrace1.inputTrace == iOTrace2.inputTrace && iOTrace1.outputTrace == iOTrace2.outputTrace;
 }
 
 bool operator<=(IOTrace const & trace1, IOTrace const & trace2)
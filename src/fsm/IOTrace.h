@@ -72,6 +72,12 @@ public:
 
     size_t size() const;
 
+    /**
+     * @return The hash value of the trace, combined from the hash values
+     * of its input and output traces (constant time).
+     */
+    size_t getHash() const;
+
     /**
      * Appends the given trace to this trace.
      * @param other The given trace
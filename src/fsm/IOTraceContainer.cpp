@@ -6,25 +6,54 @@
 
 using namespace std;
 
-IOTraceContainer::IOTraceContainer()
+IOTraceContainer::IOTraceContainer():
+    hashValue(0)
 {
 
 }
 
 IOTraceContainer::IOTraceContainer(const shared_ptr<IOTraceCont>& list):
-    list(*list)
+    list(*list), hashValue(0)
 {
+    for (const shared_ptr<const IOTrace>& trc : this->list)
+    {
+        hashValue += trc->getHash();
+    }
+}
 
+IOTraceContainer::IOTraceContainer(const shared_ptr<IOTrace>& trace):
+    hashValue(0)
+{
+    insert(trace);
 }
 
-IOTraceContainer::IOTraceContainer(const shared_ptr<IOTrace>& trace)
+void IOTraceContainer::insert(const shared_ptr<const IOTrace>& trc)
 {
-    list.insert(trace);
+    if (list.insert(trc).second)
+    {
+        hashValue += trc->getHash();
+    }
+}
+
+IOTraceCont::iterator IOTraceContainer::erase(IOTraceCont::const_iterator it)
+{
+    hashValue -= (*it)->getHash();
+    return list.erase(it);
+}
+
+void IOTraceContainer::assign(IOTraceCont&& newList)
+{
+    list = std::move(newList);
+    hashValue = 0;
+    for (const shared_ptr<const IOTrace>& trc : list)
+    {
+        hashValue += trc->getHash();
+    }
 }
 
 void IOTraceContainer::add(const shared_ptr<const IOTrace>& trc)
 {
-    list.insert(trc);
+    insert(trc);
 }
 
 void IOTraceContainer::addRemovePrefixes(const shared_ptr<const IOTrace>& trc)
@@ -48,7 +77,7 @@ void IOTraceContainer::removePrefixes(const shared_ptr<const IOTrace>& trc)
     {
         if ((*it)->isPrefixOf(*trc))
         {
-            it = list.erase(it);
+            it = erase(it);
         }
         else
         {
@@ -60,14 +89,20 @@ void IOTraceContainer::removePrefixes(const shared_ptr<const IOTrace>& trc)
 
 void IOTraceContainer::add(const IOTraceContainer& container)
 {
-    list.insert(container.cbegin(), container.cend());
+    for (auto it = container.cbegin(); it != container.cend(); ++it)
+    {
+        insert(*it);
+    }
 }
 
 void IOTraceContainer::add(OutputTree& tree)
 {
     std::vector<shared_ptr<IOTrace>> iOTraces;
     tree.toIOTrace(iOTraces);
-    list.insert(iOTraces.begin(), iOTraces.end());
+    for (const shared_ptr<IOTrace>& trc : iOTraces)
+    {
+        insert(trc);
+    }
 }
 
 bool IOTraceContainer::contains(const shared_ptr<const IOTrace>& trace) const
@@ -89,27 +124,25 @@ IOTraceCont::const_iterator IOTraceContainer::get(const InputTrace& inputTrace)
 
 void IOTraceContainer::concatenate(IOTrace& trace)
 {
-    IOTraceCont newList;
+    IOTraceCont newList(list.size());
     for (const shared_ptr<const IOTrace>& t : list)
     {
-        shared_ptr<const IOTrace> newTrace = make_shared<const IOTrace>(*t, trace);
-        newList.insert(newTrace);
+        newList.insert(make_shared<const IOTrace>(*t, trace));
     }
-    list = newList;
+    assign(std::move(newList));
 }
 
 void IOTraceContainer::concatenate(IOTraceContainer& container)
 {
-    IOTraceCont newList;
+    IOTraceCont newList(list.size() * container.size());
     for (const shared_ptr<const IOTrace>& thisTrace : list)
     {
         for (auto it = container.cbegin(); it != container.cend(); ++it)
         {
-            shared_ptr<const IOTrace> newTrace = make_shared<const IOTrace>(*thisTrace, **it);
-            newList.insert(newTrace);
+            newList.insert(make_shared<const IOTrace>(*thisTrace, **it));
         }
     }
-    list = newList;
+    assign(std::move(newList));
 }
 
 void IOTraceContainer::concatenateToFront(const shared_ptr<InputTrace>& inputTrace, const shared_ptr<OutputTrace>& outputTrace)
@@ -120,23 +153,29 @@ void IOTraceContainer::concatenateToFront(const shared_ptr<InputTrace>& inputTra
 
 void IOTraceContainer::concatenateToFront(const shared_ptr<const IOTrace>& iOTrace)
 {
-    IOTraceCont newList;
+    IOTraceCont newList(list.size());
     for (const shared_ptr<const IOTrace>& iOT : list)
     {
-        shared_ptr<const IOTrace> newTrace = make_shared<const IOTrace>(*iOT, *iOTrace, true);
-        newList.insert(newTrace);
+        newList.insert(make_shared<const IOTrace>(*iOT, *iOTrace, true));
     }
-    list = newList;
+    assign(std::move(newList));
 }
 
 void IOTraceContainer::clear()
 {
     list = IOTraceCont();
+    hashValue = 0;
 }
 
 bool IOTraceContainer::remove(const shared_ptr<const IOTrace>& trace)
 {
-    return list.erase(trace) > 0;
+    auto it = list.find(trace);
+    if (it == list.end())
+    {
+        return false;
+    }
+    erase(it);
+    return true;
 }
 
 vector<OutputTrace> IOTraceContainer::getOutputTraces() const
@@ -208,6 +247,10 @@ std::ostream & operator<<(std::ostream & out, const IOTraceContainer & iot)
 
 bool operator==(IOTraceContainer const & cont1, IOTraceContainer const & cont2)
 {
+    if (cont1.hashValue != cont2.hashValue)
+    {
+        return false;
+    }
     return cont1.list == cont2.list;
 }
 
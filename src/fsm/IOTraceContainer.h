@@ -37,6 +37,17 @@ class IOTraceContainer
 {
 private:
     IOTraceCont list;
+
+    /**
+     * Sum of the hash values of the traces in the container. It does not
+     * depend on the order of iteration, so that equal containers have equal
+     * hash values, and is updated whenever a trace is added or removed.
+     */
+    size_t hashValue;
+
+    void insert(const std::shared_ptr<const IOTrace>& trc);
+    IOTraceCont::iterator erase(IOTraceCont::const_iterator it);
+    void assign(IOTraceCont&& newList);
     void removePrefixes(const std::shared_ptr<const IOTrace>& trc);
 public:
     IOTraceContainer();
@@ -147,6 +158,12 @@ public:
      */
     size_t size() const { return list.size(); }
 
+    /**
+     * Returns the hash value of the container, without iterating over its traces.
+     * @return The hash value of the container
+     */
+    size_t getHash() const { return hashValue; }
+
     /**
      * Determines wether the container is empty.
      * @return `true`, if the container is empty, `false`, otherwise.
@@ -191,17 +208,7 @@ namespace std {
     {
       size_t operator()(const IOTraceContainer& container) const
       {
-
-          size_t seed = 0;
-          std::hash<IOTrace> hasher;
-
-          for (auto it = container.cbegin(); it != container.cend(); ++it)
-          {
-            const shared_ptr<const IOTrace>& trace = *it;
-            seed ^= hasher(*trace) + 0x9e3779b9 + (seed<<6) + (seed>>2);
-          }
-
-          return seed;
+          return container.getHash();
       }
     };
 }
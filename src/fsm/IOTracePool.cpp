@@ -0,0 +1,114 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include <vector>
+#include <algorithm>
+
+#include "fsm/IOTracePool.h"
+#include "fsm/IOTrace.h"
+#include "fsm/InputTrace.h"
+#include "fsm/OutputTrace.h"
+
+using namespace std;
+
+size_t IOTracePool::StepHash::operator()(const Step& step) const
+{
+    size_t seed = std::hash<size_t>()(step.parent);
+    seed ^= std::hash<int>()(step.input) + 0x9e3779b9 + (seed<<6) + (seed>>2);
+    seed ^= std::hash<int>()(step.output) + 0x9e3779b9 + (seed<<6) + (seed>>2);
+    return seed;
+}
+
+IOTracePool::IOTracePool(const shared_ptr<FsmPresentationLayer const>& presentationLayer):
+    presentationLayer(presentationLayer)
+{
+    Node root;
+    root.parent = emptyTraceId;
+    root.input = 0;
+    root.output = 0;
+    root.length = 0;
+    nodes.push_back(root);
+}
+
+size_t IOTracePool::extendLocked(size_t id, int input, int output)
+{
+    Step step;
+    step.parent = id;
+    step.input = input;
+    step.output = output;
+
+    auto it = children.find(step);
+    if (it != children.end())
+    {
+        return it->second;
+    }
+
+    Node node;
+    node.parent = id;
+    node.input = input;
+    node.output = output;
+    node.length = nodes[id].length + 1;
+    nodes.push_back(node);
+
+    size_t child = nodes.size() - 1;
+    children.emplace(step, child);
+    return child;
+}
+
+size_t IOTracePool::extend(size_t id, int input, int output)
+{
+    lock_guard<mutex> lock(mtx);
+    return extendLocked(id, input, output);
+}
+
+size_t IOTracePool::getId(const IOTrace& trace)
+{
+    const InputTrace& inputTrace = trace.getInputTrace();
+    const OutputTrace& outputTrace = trace.getOutputTrace();
+
+    lock_guard<mutex> lock(mtx);
+    size_t id = emptyTraceId;
+    auto itOut = outputTrace.cbegin();
+    for (auto itIn = inputTrace.cbegin(); itIn != inputTrace.cend(); ++itIn, ++itOut)
+    {
+        id = extendLocked(id, *itIn, *itOut);
+    }
+    return id;
+}
+
+shared_ptr<const IOTrace> IOTracePool::getTrace(size_t id)
+{
+    lock_guard<mutex> lock(mtx);
+    Node& node = nodes[id];
+    if (!node.trace)
+    {
+        vector<int> inputs;
+        vector<int> outputs;
+        inputs.reserve(node.length);
+        outputs.reserve(node.length);
+        for (size_t n = id; n != emptyTraceId; n = nodes[n].parent)
+        {
+            inputs.push_back(nodes[n].input);
+            outputs.push_back(nodes[n].output);
+        }
+        reverse(inputs.begin(), inputs.end());
+        reverse(outputs.begin(), outputs.end());
+        node.trace = make_shared<const IOTrace>(InputTrace(inputs, presentationLayer),
+                                                OutputTrace(outputs, presentationLayer));
+    }
+    return node.trace;
+}
+
+size_t IOTracePool::length(size_t id) const
+{
+    lock_guard<mutex> lock(mtx);
+    return nodes[id].length;
+}
+
+size_t IOTracePool::size() const
+{
+    lock_guard<mutex> lock(mtx);
+    return nodes.size();
+}
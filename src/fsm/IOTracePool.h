@@ -0,0 +1,103 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_FSM_IOTRACEPOOL_H_
+#define FSM_FSM_IOTRACEPOOL_H_
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+class FsmPresentationLayer;
+class IOTrace;
+
+/**
+ *  Pool of interned input/output traces.
+ *
+ *  The traces are stored in a prefix tree: each trace is represented by
+ *  the id of its node, which refers to the node of its longest proper
+ *  prefix and to its last input/output pair. Traces sharing a prefix share
+ *  the nodes of that prefix, and two traces are equal if and only if
+ *  their ids are equal, so that ids may be used as keys of hash maps
+ *  without hashing or comparing the traces themselves.
+ *
+ *  Ids are never invalidated. The pool may be used concurrently.
+ */
+class IOTracePool
+{
+private:
+    struct Node
+    {
+        size_t parent;
+        int input;
+        int output;
+        size_t length;
+
+        /** Canonical trace of the node, created when first requested */
+        std::shared_ptr<const IOTrace> trace;
+    };
+
+    struct Step
+    {
+        size_t parent;
+        int input;
+        int output;
+
+        bool operator==(const Step& other) const
+        {
+            return parent == other.parent && input == other.input && output == other.output;
+        }
+    };
+
+    struct StepHash
+    {
+        size_t operator()(const Step& step) const;
+    };
+
+    std::shared_ptr<FsmPresentationLayer const> presentationLayer;
+
+    /** A deque does not move its elements when growing */
+    std::deque<Node> nodes;
+    std::unordered_map<Step, size_t, StepHash> children;
+    mutable std::mutex mtx;
+
+    size_t extendLocked(size_t id, int input, int output);
+
+public:
+    /** Id of the empty trace */
+    static const size_t emptyTraceId = 0;
+
+    IOTracePool(const std::shared_ptr<FsmPresentationLayer const>& presentationLayer);
+
+    /**
+     *  @return the id of the trace with id `id`, extended by the
+     *          given input/output pair
+     */
+    size_t extend(size_t id, int input, int output);
+
+    /**
+     *  @return the id of the given trace. Its target node is ignored.
+     */
+    size_t getId(const IOTrace& trace);
+
+    /**
+     *  @return the canonical trace of the given id, which has no target
+     *          node. The same object is returned for every call with an id.
+     */
+    std::shared_ptr<const IOTrace> getTrace(size_t id);
+
+    /**
+     *  @return the length of the trace with the given id
+     */
+    size_t length(size_t id) const;
+
+    /**
+     *  @return the number of traces (including all prefixes) in the pool
+     */
+    size_t size() const;
+};
+
+#endif //FSM_FSM_IOTRACEPOOL_H_
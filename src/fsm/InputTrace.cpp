@@ -82,6 +82,7 @@ InputTrace& InputTrace::operator=(InputTrace& other)
     if (this != &other)
     {
         trace = other.trace;
+        hashValue = other.hashValue;
     }
     return *this;
 }
@@ -0,0 +1,187 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include <algorithm>
+#include <unordered_set>
+
+#include "fsm/LazyTestSuite.h"
+#include "fsm/FsmNode.h"
+#include "trees/Tree.h"
+#include "trees/IOListContainer.h"
+#include "trees/TestCaseSink.h"
+
+using namespace std;
+
+bool LazyTestSuite::Config::operator<(const Config& other) const
+{
+    if ( product != other.product ) return product < other.product;
+    if ( phase != other.phase ) return phase < other.phase;
+    if ( a != other.a ) return a < other.a;
+    return b < other.b;
+}
+
+bool LazyTestSuite::Config::operator==(const Config& other) const
+{
+    return product == other.product and phase == other.phase and
+           a == other.a and b == other.b;
+}
+
+LazyTestSuite::LazyTestSuite(const int maxInput)
+: maxInput(maxInput)
+{
+}
+
+void LazyTestSuite::addProduct(const Tree& prefixes,
+                               const unsigned int k,
+                               const IOListContainer& suffixes)
+{
+    Product p(InputTrie(prefixes), k);
+    p.suffixes = make_shared<InputTrie>(prefixes.getPresentationLayer());
+    p.suffixes->addToRoot(suffixes);
+    products.push_back(p);
+}
+
+void LazyTestSuite::addProduct(const Tree& prefixes,
+                               const unsigned int k,
+                               const shared_ptr<FsmNode>& initialState,
+                               const vector<shared_ptr<Tree>>& stateIdentificationSets)
+{
+    Product p(InputTrie(prefixes), k);
+    for ( const auto& w : stateIdentificationSets ) {
+        p.stateSuffixes.push_back(InputTrie(*w));
+    }
+    products.push_back(p);
+    this->initialState = initialState;
+}
+
+void LazyTestSuite::close(vector<Config>& configs) const
+{
+    // Every node of prefixes is the start of the input enumeration,
+    // every node of prefixes.Sigma^{0..k} the start of the common suffixes
+    size_t numConfigs = configs.size();
+    for ( size_t i = 0; i < numConfigs; i++ ) {
+        Config c = configs[i];
+        if ( c.phase == PREFIX ) {
+            c.phase = ENUM;
+            c.a = 0;
+            configs.push_back(c);
+        }
+        if ( c.phase == ENUM and products[c.product].suffixes != nullptr ) {
+            c.phase = SUFFIX;
+            c.a = 0;
+            c.b = InputTrie::ROOT;
+            configs.push_back(c);
+        }
+    }
+    sort(configs.begin(),configs.end());
+    configs.erase(unique(configs.begin(),configs.end()),configs.end());
+}
+
+vector<LazyTestSuite::Config> LazyTestSuite::step(const vector<Config>& configs,
+                                                  const int x) const
+{
+    vector<Config> result;
+    for ( Config c : configs ) {
+        const Product& p = products[c.product];
+        switch ( c.phase ) {
+            case PREFIX:
+                c.a = p.prefixes.after(c.a,x);
+                if ( c.a != InputTrie::NONE ) result.push_back(c);
+                break;
+            case ENUM:
+                if ( c.a < p.k ) {
+                    c.a++;
+                    result.push_back(c);
+                }
+                break;
+            case SUFFIX:
+                c.b = (p.suffixes != nullptr) ?
+                      p.suffixes->after(c.b,x) : p.stateSuffixes[c.a].after(c.b,x);
+                if ( c.b != InputTrie::NONE ) result.push_back(c);
+                break;
+        }
+    }
+    close(result);
+    return result;
+}
+
+void LazyTestSuite::enumerate(vector<int>& path,
+                              const vector<Config>& configs,
+                              TestCaseSink& sink) const
+{
+    vector< vector<Config> > children;
+    for ( int x = 0; x <= maxInput; x++ ) {
+        children.push_back(step(configs,x));
+    }
+
+    // Is this node a leaf of prefixes.Sigma^{0..k} of a product
+    // with state identification sets?
+    auto inBase = [](const vector<Config>& cfg, const uint32_t p) {
+        for ( const Config& c : cfg ) {
+            if ( c.product == p and c.phase != SUFFIX ) return true;
+        }
+        return false;
+    };
+
+    for ( uint32_t p = 0; p < products.size(); p++ ) {
+        if ( products[p].suffixes != nullptr or not inBase(configs,p) ) continue;
+
+        bool isBaseLeaf = true;
+        for ( const auto& cfg : children ) {
+            if ( inBase(cfg,p) ) {
+                isBaseLeaf = false;
+                break;
+            }
+        }
+        if ( not isBaseLeaf ) continue;
+
+        vector<Config> suffixStart;
+        for ( const auto& n : initialState->after(path) ) {
+            Config c;
+            c.product = p;
+            c.phase = SUFFIX;
+            c.a = static_cast<uint32_t>(n->getId());
+            c.b = InputTrie::ROOT;
+            suffixStart.push_back(c);
+        }
+        for ( int x = 0; x <= maxInput; x++ ) {
+            vector<Config> cfg = step(suffixStart,x);
+            children[x].insert(children[x].end(),cfg.begin(),cfg.end());
+            sort(children[x].begin(),children[x].end());
+            children[x].erase(unique(children[x].begin(),children[x].end()),children[x].end());
+        }
+    }
+
+    bool isLeaf = true;
+    for ( int x = 0; x <= maxInput; x++ ) {
+        if ( children[x].empty() ) continue;
+        isLeaf = false;
+        path.push_back(x);
+        enumerate(path,children[x],sink);
+        path.pop_back();
+        vector<Config>().swap(children[x]);
+    }
+
+    if ( isLeaf ) sink.push(path);
+}
+
+void LazyTestSuite::enumerate(TestCaseSink& sink) const
+{
+    if ( products.empty() ) return;
+
+    vector<Config> configs;
+    for ( uint32_t p = 0; p < products.size(); p++ ) {
+        Config c;
+        c.product = p;
+        c.phase = PREFIX;
+        c.a = InputTrie::ROOT;
+        c.b = InputTrie::ROOT;
+        configs.push_back(c);
+    }
+    close(configs);
+
+    vector<int> path;
+    enumerate(path,configs,sink);
+}
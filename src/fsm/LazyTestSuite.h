@@ -0,0 +1,127 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_FSM_LAZYTESTSUITE_H_
+#define FSM_FSM_LAZYTESTSUITE_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "trees/InputTrie.h"
+
+class Tree;
+class IOListContainer;
+class FsmNode;
+class TestCaseSink;
+
+/**
+ *  Test suite given as a union of products P.Sigma^{0..k}.W, as
+ *  constructed by the W-Method and the Wp-Method with the Tree
+ *  operations add(), addAfter() and unionTree(), but without
+ *  materialising the suite.
+ *
+ *  Only the (small) factors of each product are stored. The test
+ *  cases are enumerated by a depth-first traversal of the trie that
+ *  the Tree operations would have constructed, where the children
+ *  of every node are calculated on demand from the factors. Memory
+ *  consumption therefore only depends on the length of the test
+ *  cases, but not on the size of the test suite.
+ *
+ *  The test cases are enumerated in lexicographic order. They are
+ *  the same as the paths of the corresponding Tree, but the Tree
+ *  lists them in the order of their insertion.
+ */
+class LazyTestSuite
+{
+private:
+
+    /** A product prefixes.Sigma^{0..k}.suffixes */
+    struct Product
+    {
+        InputTrie prefixes;
+        unsigned int k;
+
+        /** Suffixes appended to every node of prefixes.Sigma^{0..k} */
+        std::shared_ptr<InputTrie> suffixes;
+
+        /**
+         *  If suffixes is null: state identification sets, by state id,
+         *  appended to every leaf of prefixes.Sigma^{0..k}
+         */
+        std::vector<InputTrie> stateSuffixes;
+
+        Product(const InputTrie& prefixes, const unsigned int k)
+        : prefixes(prefixes), k(k) { }
+    };
+
+    enum Phase : uint32_t
+    {
+        /** Reading a sequence of the prefixes, a = node of prefixes */
+        PREFIX,
+        /** Reading Sigma^{0..k}, a = number of inputs read */
+        ENUM,
+        /** Reading a suffix, a = state id (0 for common suffixes), b = node of suffix */
+        SUFFIX
+    };
+
+    /** Position reached by an input sequence in one of the products */
+    struct Config
+    {
+        uint32_t product;
+        Phase phase;
+        uint32_t a;
+        uint32_t b;
+
+        bool operator<(const Config& other) const;
+        bool operator==(const Config& other) const;
+    };
+
+    int maxInput;
+    std::vector<Product> products;
+    std::shared_ptr<FsmNode> initialState;
+
+    void close(std::vector<Config>& configs) const;
+    std::vector<Config> step(const std::vector<Config>& configs, const int x) const;
+    void enumerate(std::vector<int>& path,
+                   const std::vector<Config>& configs,
+                   TestCaseSink& sink) const;
+
+public:
+
+    /**
+     *  Create an empty test suite
+     *  @param maxInput Input alphabet is 0..maxInput
+     */
+    explicit LazyTestSuite(const int maxInput);
+
+    /**
+     *  Add the sequences of the tree obtained from prefixes by
+     *  Tree::add() of Sigma^{1..k} (if k > 0) and Tree::add() of suffixes.
+     */
+    void addProduct(const Tree& prefixes,
+                    const unsigned int k,
+                    const IOListContainer& suffixes);
+
+    /**
+     *  Add the sequences of the tree obtained from prefixes by
+     *  Tree::add() of Sigma^{k} (if k > 0), followed by appending the
+     *  state identification set of every state reached by a path to
+     *  the corresponding leaf, see Fsm::appendStateIdentificationSets().
+     *  @param initialState Initial state of the FSM whose state ids are
+     *         the indices of stateIdentificationSets
+     *  @note The FSM must be alive when enumerate() is called.
+     */
+    void addProduct(const Tree& prefixes,
+                    const unsigned int k,
+                    const std::shared_ptr<FsmNode>& initialState,
+                    const std::vector<std::shared_ptr<Tree>>& stateIdentificationSets);
+
+    /** Pass every test case to the sink, in lexicographic order */
+    void enumerate(TestCaseSink& sink) const;
+
+};
+
+#endif //FSM_FSM_LAZYTESTSUITE_H_
@@ -0,0 +1,295 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include <algorithm>
+#include <bitset>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "fsm/MutationAnalysis.h"
+#include "fsm/Dfsm.h"
+#include "fsm/Fsm.h"
+#include "fsm/TransitionTable.h"
+#include "trees/InputTrie.h"
+#include "trees/IOListContainer.h"
+#include "utils/WorkStealingPool.hpp"
+
+using namespace std;
+
+namespace {
+
+/** Number of mutants per batch, a multiple of 64, so that batches do not share words of the kill matrix */
+const size_t batchSize = 256;
+
+}
+
+MutationAnalysis::MutationAnalysis(const Dfsm& spec)
+: table(spec.getTransitionTable()),
+  initState(0),
+  maxOutput(spec.getMaxOutput()),
+  numTestCases(0),
+  numWords(0)
+{
+    if ( table == nullptr ) {
+        stringstream ss;
+        ss << "Mutation analysis requires a reference model represented by its transition table." << endl;
+        std::cerr << ss.str();
+        throw ss.str();
+    }
+    initState = spec.getInitStateIdx();
+}
+
+int MutationAnalysis::apply(const Mutant& mutant, const int s, const int x, int& y) const
+{
+    for ( const Fault& f : mutant ) {
+        if ( f.state == s and f.input == x ) {
+            y = f.output;
+            return f.target;
+        }
+    }
+    return table->apply(s, x, y);
+}
+
+size_t MutationAnalysis::addMutant(const Mutant& mutant)
+{
+    for ( const Fault& f : mutant ) {
+        if ( f.state < 0 or f.state >= table->getNumStates() or
+             f.input < 0 or f.input >= table->getNumInputs() or
+             f.target < 0 or f.target >= table->getNumStates() ) {
+            stringstream ss;
+            ss << "Fault " << f.state << " --" << f.input << "/" << f.output << "--> " << f.target
+            << " is not in the range of the reference model." << endl;
+            std::cerr << ss.str();
+            throw ss.str();
+        }
+    }
+    mutants.push_back(mutant);
+    return mutants.size() - 1;
+}
+
+size_t MutationAnalysis::addMutant(const Fsm& mutant)
+{
+    shared_ptr<TransitionTable> mTable = mutant.getTransitionTable();
+    if ( mTable == nullptr or
+         mTable->getNumStates() != table->getNumStates() or
+         mTable->getNumInputs() != table->getNumInputs() ) {
+        stringstream ss;
+        ss << "Mutant " << mutant.getName()
+        << " does not have the same states and inputs as the reference model." << endl;
+        std::cerr << ss.str();
+        throw ss.str();
+    }
+
+    Mutant faults;
+    for ( int s = 0; s < table->getNumStates(); s++ ) {
+        for ( int x = 0; x < table->getNumInputs(); x++ ) {
+            int y = 0;
+            int mY = 0;
+            int t = table->apply(s, x, y);
+            int mT = mTable->apply(s, x, mY);
+            if ( (t < 0) != (mT < 0) ) {
+                stringstream ss;
+                ss << "Mutant " << mutant.getName() << " differs from the reference model"
+                << " in the inputs defined in state " << s << "." << endl;
+                std::cerr << ss.str();
+                throw ss.str();
+            }
+            if ( t >= 0 and (t != mT or y != mY) ) {
+                faults.push_back(Fault{s, x, mY, mT});
+            }
+        }
+    }
+    return addMutant(faults);
+}
+
+void MutationAnalysis::createMutants(const size_t numMutants,
+                                     const int numOutputFaults,
+                                     const int numTransitionFaults,
+                                     mt19937& gen)
+{
+    if ( numOutputFaults > 0 and maxOutput < 1 ) {
+        throw too_many_output_faults("Can not create output faults on FSMs with output alphabet size < 2");
+    }
+
+    // The transitions of the reference model as faults reproducing them
+    vector<Fault> transitions;
+    for ( int s = 0; s < table->getNumStates(); s++ ) {
+        for ( int x = 0; x < table->getNumInputs(); x++ ) {
+            int y = 0;
+            int t = table->apply(s, x, y);
+            if ( t >= 0 ) transitions.push_back(Fault{s, x, y, t});
+        }
+    }
+
+    size_t numFaults = static_cast<size_t>(numOutputFaults + numTransitionFaults);
+    if ( numFaults > transitions.size() or
+         (numTransitionFaults > 0 and table->getNumStates() < 2) ) {
+        throw too_many_transition_faults("Could not create all requested transition faults.");
+    }
+
+    for ( size_t m = 0; m < numMutants; m++ ) {
+        // Draw the transitions to be changed without repetitions,
+        // by a partial Fisher-Yates shuffle
+        Mutant mutant;
+        for ( size_t i = 0; i < numFaults; i++ ) {
+            uniform_int_distribution<size_t> pick(i, transitions.size() - 1);
+            swap(transitions[i], transitions[pick(gen)]);
+            Fault f = transitions[i];
+            if ( i < static_cast<size_t>(numOutputFaults) ) {
+                uniform_int_distribution<int> out(0, maxOutput - 1);
+                int y = out(gen);
+                f.output = ( y >= f.output ) ? y + 1 : y;
+            }
+            else {
+                uniform_int_distribution<int> tgt(0, table->getNumStates() - 2);
+                int t = tgt(gen);
+                f.target = ( t >= f.target ) ? t + 1 : t;
+            }
+            mutant.push_back(f);
+        }
+        mutants.push_back(mutant);
+    }
+}
+
+void MutationAnalysis::run(const IOListContainer& testSuite, const unsigned int numThreads)
+{
+    shared_ptr<vector<vector<int>>> tcLst = testSuite.getIOLists();
+
+    InputTrie trie(nullptr);
+    vector<InputTrie::NodeId> tcNodes;
+    for ( const auto& tc : *tcLst ) {
+        tcNodes.push_back(trie.addToRoot(tc));
+    }
+    vector<vector<size_t>> casesAt(trie.size());
+    for ( size_t i = 0; i < tcNodes.size(); i++ ) {
+        casesAt[tcNodes[i]].push_back(i);
+    }
+
+    numTestCases = tcLst->size();
+    numWords = (mutants.size() + 63) / 64;
+    killMatrix.assign(numTestCases * numWords, 0);
+
+    // Depth-first walk through the trie for the mutants first..last-1.
+    // The mutants alive at a node and their states are stored in a single
+    // vector, where the entries of every frame follow those of its parent,
+    // and the mutants killed on the current path are stored in the same way.
+    struct Frame {
+        InputTrie::NodeId node;
+        InputTrie::NodeId nextChild;
+        int specState;
+        size_t aliveBegin;
+        size_t killedBegin;
+    };
+
+    auto runBatch = [&](const size_t b, const unsigned int) {
+        size_t first = b * batchSize;
+        size_t last = min(first + batchSize, mutants.size());
+
+        vector<pair<size_t,int>> alive;
+        vector<size_t> killed;
+        vector<Frame> stack;
+
+        for ( size_t m = first; m < last; m++ ) {
+            alive.push_back(make_pair(m, initState));
+        }
+        stack.push_back(Frame{InputTrie::ROOT, trie.getFirstChild(InputTrie::ROOT), initState, 0, 0});
+
+        while ( not stack.empty() ) {
+            Frame& top = stack.back();
+            if ( top.nextChild == InputTrie::NONE ) {
+                alive.resize(top.aliveBegin);
+                killed.resize(top.killedBegin);
+                stack.pop_back();
+                continue;
+            }
+            InputTrie::NodeId c = top.nextChild;
+            top.nextChild = trie.getNextSibling(c);
+            int x = trie.getLabel(c);
+
+            // Once the reference model does not accept an input, the rest
+            // of the test case is not applied, so that it does not kill
+            // any further mutants
+            Frame child{c, trie.getFirstChild(c), -1, alive.size(), killed.size()};
+            if ( top.specState >= 0 ) {
+                int y = 0;
+                child.specState = table->apply(top.specState, x, y);
+                size_t aliveEnd = ( child.specState >= 0 ) ? child.aliveBegin : top.aliveBegin;
+                for ( size_t i = top.aliveBegin; i < aliveEnd; i++ ) {
+                    int mY = 0;
+                    int mT = apply(mutants[alive[i].first], alive[i].second, x, mY);
+                    if ( mT < 0 or mY != y ) {
+                        killed.push_back(alive[i].first);
+                    }
+                    else {
+                        alive.push_back(make_pair(alive[i].first, mT));
+                    }
+                }
+            }
+
+            for ( size_t i : casesAt[c] ) {
+                uint64_t* row = killMatrix.data() + i * numWords;
+                for ( size_t m : killed ) {
+                    row[m / 64] |= uint64_t(1) << (m % 64);
+                }
+            }
+
+            stack.push_back(child);
+        }
+    };
+
+    size_t numBatches = (mutants.size() + batchSize - 1) / batchSize;
+    unique_ptr<WorkStealingPool> pool;
+    if ( numThreads != 1 ) {
+        pool.reset(new WorkStealingPool(numThreads));
+    }
+    if ( pool and pool->getNumThreads() > 1 ) {
+        pool->run(numBatches, runBatch);
+    }
+    else {
+        for ( size_t b = 0; b < numBatches; b++ ) runBatch(b, 0);
+    }
+}
+
+bool MutationAnalysis::isKilled(const size_t m) const
+{
+    if ( m / 64 >= numWords ) return false;
+    for ( size_t t = 0; t < numTestCases; t++ ) {
+        if ( isKilled(t, m) ) return true;
+    }
+    return false;
+}
+
+size_t MutationAnalysis::getNumKilledMutants() const
+{
+    vector<uint64_t> any(numWords, 0);
+    for ( size_t t = 0; t < numTestCases; t++ ) {
+        for ( size_t w = 0; w < numWords; w++ ) {
+            any[w] |= killMatrix[t * numWords + w];
+        }
+    }
+    size_t n = 0;
+    for ( uint64_t word : any ) {
+        n += bitset<64>(word).count();
+    }
+    return n;
+}
+
+void MutationAnalysis::writeKillMatrix(ostream& out) const
+{
+    size_t numMutants = min(mutants.size(), numWords * 64);
+    out << "testcase";
+    for ( size_t m = 0; m < numMutants; m++ ) {
+        out << ",M" << m;
+    }
+    out << endl;
+    for ( size_t t = 0; t < numTestCases; t++ ) {
+        out << "TC-" << (t + 1);
+        for ( size_t m = 0; m < numMutants; m++ ) {
+            out << "," << (isKilled(t, m) ? 1 : 0);
+        }
+        out << endl;
+    }
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_FSM_MUTATIONANALYSIS_H_
+#define FSM_FSM_MUTATIONANALYSIS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <vector>
+
+class Dfsm;
+class Fsm;
+class IOListContainer;
+class TransitionTable;
+
+/**
+ *  Mutation analysis of test suites for a deterministic reference model.
+ *
+ *  Mutants are not represented as Fsm instances, but as short lists of
+ *  faults over the transition table of the reference model: each fault
+ *  replaces the output and target of the transition of one state for one
+ *  input. All other transitions of a mutant are looked up in the table
+ *  of the reference model.
+ *
+ *  A test case kills a mutant if the mutant does not pass the I/O trace
+ *  produced by the reference model for the inputs of the test case (see
+ *  Dfsm::pass()). To calculate this for all test cases and mutants, the
+ *  test cases are loaded into a prefix trie, which is walked depth-first
+ *  with a stack of the states reached by the mutants not yet killed on
+ *  the current path. Every prefix is therefore applied once to every
+ *  mutant, and a mutant is no longer simulated in the subtree of the node
+ *  where it has been killed. The mutants are processed in batches that
+ *  may be distributed over several threads.
+ */
+class MutationAnalysis
+{
+public:
+
+    /**
+     *  A single fault: the transition of state for input is
+     *  replaced by a transition with the given output and target
+     */
+    struct Fault
+    {
+        int state;
+        int input;
+        int output;
+        int target;
+    };
+
+    /** A mutant, given by faults affecting pairwise different transitions */
+    typedef std::vector<Fault> Mutant;
+
+private:
+
+    /** Transition table of the reference model */
+    std::shared_ptr<TransitionTable> table;
+
+    int initState;
+    int maxOutput;
+
+    std::vector<Mutant> mutants;
+
+    /** Number of test cases of the last run */
+    size_t numTestCases;
+
+    /** Number of 64 bit words of a row of the kill matrix */
+    size_t numWords;
+
+    /**
+     *  Bit m of row t, stored at killMatrix[t*numWords + m/64],
+     *  is set if test case t kills mutant m
+     */
+    std::vector<uint64_t> killMatrix;
+
+    /**
+     *  Apply input x to mutant in state s
+     *  @param y On return, the output of the transition, if it exists
+     *  @return target state, or -1 if no transition is defined
+     */
+    int apply(const Mutant& mutant, const int s, const int x, int& y) const;
+
+public:
+
+    /**
+     *  Prepare the mutation analysis for the reference model spec.
+     *  The reference model must be representable by its transition table.
+     */
+    explicit MutationAnalysis(const Dfsm& spec);
+
+    /**
+     *  Add a mutant given by its faults
+     *  @return the index of the mutant
+     */
+    size_t addMutant(const Mutant& mutant);
+
+    /**
+     *  Add a deterministic FSM with the same states and inputs as the
+     *  reference model as mutant, for example one created by
+     *  Fsm::createMutant(). Its transitions must be defined for the same
+     *  states and inputs as those of the reference model.
+     *  @return the index of the mutant
+     */
+    size_t addMutant(const Fsm& mutant);
+
+    /**
+     *  Add numMutants random mutants, each of them with numOutputFaults
+     *  output faults and numTransitionFaults transition faults, like
+     *  the mutants created by Fsm::createMutant().
+     */
+    void createMutants(const size_t numMutants,
+                       const int numOutputFaults,
+                       const int numTransitionFaults,
+                       std::mt19937& gen);
+
+    size_t getNumMutants() const { return mutants.size(); }
+
+    const Mutant& getMutant(const size_t m) const { return mutants.at(m); }
+
+    /**
+     *  Execute the test suite against all mutants and calculate the
+     *  kill matrix. The results of previous runs are discarded.
+     *  @param numThreads Number of worker threads; if 0, the number
+     *         of hardware threads is used.
+     */
+    void run(const IOListContainer& testSuite, const unsigned int numThreads = 1);
+
+    /** Number of test cases of the last run */
+    size_t getNumTestCases() const { return numTestCases; }
+
+    /** true if test case t of the last run kills mutant m */
+    bool isKilled(const size_t t, const size_t m) const
+    {
+        return ((killMatrix[t * numWords + m / 64] >> (m % 64)) & 1) != 0;
+    }
+
+    /** true if some test case of the last run kills mutant m */
+    bool isKilled(const size_t m) const;
+
+    /** Number of mutants killed by the test suite of the last run */
+    size_t getNumKilledMutants() const;
+
+    /**
+     *  Write the kill matrix of the last run in CSV format: a header
+     *  line naming the mutants, followed by one line per test case,
+     *  containing 1 for every mutant killed by the test case and 0
+     *  for every other mutant.
+     */
+    void writeKillMatrix(std::ostream& out) const;
+};
+
+#endif //FSM_FSM_MUTATIONANALYSIS_H_
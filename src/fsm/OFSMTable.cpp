@@ -212,6 +212,21 @@ shared_ptr<OFSMTable> OFSMTable::next()
 	return haveNewClasses ? next : nullptr;
 }
 
+shared_ptr<OFSMTable> OFSMTable::next(const vector<int>& nextS2C)
+{
+	shared_ptr<OFSMTable> next = make_shared<OFSMTable>(numStates, maxInput, maxOutput, rows, presentationLayer);
+	next->tblId = tblId + 1;
+
+	S2CMap newS2C = next->getS2C();
+	for (int n = 0; n < numStates; ++ n)
+	{
+		newS2C [n] = nextS2C.at(n);
+	}
+
+	next->setS2C(newS2C);
+	return next;
+}
+
 string OFSMTable::getMembers(const int c) const
 {
 	string memSet = "{";
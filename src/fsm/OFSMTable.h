@@ -123,6 +123,15 @@ public:
 	*/
 	std::shared_ptr<OFSMTable> next();
 
+	/**
+	Create the next OFSMTable on the basis of the current table,
+	using a class mapping that has already been calculated elsewhere
+	(e.g. by PartitionRefinement), instead of comparing the rows.
+	@param nextS2C nextS2C[n] is the class of state n in the next table
+	@return The next OFSMTable, sharing the rows with this table
+	*/
+	std::shared_ptr<OFSMTable> next(const std::vector<int>& nextS2C);
+
 	/**
 	Return members of an equivalence class c as set string
 	*/
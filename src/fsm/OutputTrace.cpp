@@ -74,6 +74,7 @@ OutputTrace& OutputTrace::operator=(OutputTrace& other)
     if (this != &other)
     {
         trace = other.trace;
+        hashValue = other.hashValue;
     }
     return *this;
 }
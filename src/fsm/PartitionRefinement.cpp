@@ -0,0 +1,362 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include <algorithm>
+#include <map>
+
+#include "fsm/PartitionRefinement.h"
+#include "fsm/TransitionTable.h"
+
+using namespace std;
+
+PartitionRefinement::PartitionRefinement(const TransitionTable& tbl):
+numStates(tbl.getNumStates()),
+valid(tbl.isValid() and tbl.getNumStates() > 0),
+numBlocks(0)
+{
+    if ( not valid ) return;
+
+    // Collect the transitions of each state, sorted by input and output
+    trOffsets.push_back(0);
+    for ( int s = 0; s < numStates; s++ ) {
+        for ( int x = 0; x < tbl.getNumInputs(); x++ ) {
+            size_t first = trOutput.size();
+            for ( auto e = tbl.begin(s,x); e != tbl.end(s,x); ++e ) {
+                trInput.push_back(x);
+                trOutput.push_back(e->output);
+                trTarget.push_back(e->target);
+            }
+            // Sort the outputs of this input, keeping the targets aligned
+            for ( size_t i = first + 1; i < trOutput.size(); i++ ) {
+                for ( size_t j = i; j > first and trOutput[j-1] > trOutput[j]; j-- ) {
+                    swap(trOutput[j-1],trOutput[j]);
+                    swap(trTarget[j-1],trTarget[j]);
+                }
+            }
+            // The label x/y must not occur twice (observability)
+            for ( size_t i = first + 1; i < trOutput.size(); i++ ) {
+                if ( trOutput[i-1] == trOutput[i] ) {
+                    valid = false;
+                    return;
+                }
+            }
+        }
+        trOffsets.push_back(trTarget.size());
+    }
+
+    // Pre-states of each state
+    predOffsets.assign(numStates + 1, 0);
+    for ( int t : trTarget ) predOffsets[t + 1]++;
+    for ( int s = 0; s < numStates; s++ ) predOffsets[s + 1] += predOffsets[s];
+    preds.resize(trTarget.size());
+    vector<size_t> fill(predOffsets.begin(), predOffsets.end() - 1);
+    for ( int s = 0; s < numStates; s++ ) {
+        for ( size_t i = trOffsets[s]; i < trOffsets[s+1]; i++ ) {
+            preds[fill[trTarget[i]]++] = s;
+        }
+    }
+
+    calcInitialPartition();
+    refine();
+}
+
+void PartitionRefinement::calcInitialPartition()
+{
+    // States with identical sets of input/output labels
+    // get the same class; class ids are assigned in the order
+    // of the first state belonging to the class.
+    map<vector<int>,int> label2Class;
+    initialClasses.resize(numStates);
+
+    for ( int s = 0; s < numStates; s++ ) {
+        vector<int> labels;
+        for ( size_t i = trOffsets[s]; i < trOffsets[s+1]; i++ ) {
+            labels.push_back(trInput[i]);
+            labels.push_back(trOutput[i]);
+        }
+        auto ins = label2Class.insert(make_pair(labels,
+                                                static_cast<int>(label2Class.size())));
+        initialClasses[s] = ins.first->second;
+    }
+
+    numClasses.push_back(static_cast<int>(label2Class.size()));
+}
+
+void PartitionRefinement::refine()
+{
+    vector<int> blk(initialClasses);
+    numBlocks = numClasses.back();
+
+    // Class id of each block
+    vector<int> cls(numBlocks);
+    for ( int b = 0; b < numBlocks; b++ ) cls[b] = b;
+
+    // The states of each block are kept in a doubly linked list,
+    // sorted in ascending order, so that the smallest state of
+    // a block is always found at its head.
+    vector<int> head(numBlocks,-1);
+    vector<int> tail(numBlocks,-1);
+    vector<int> blkSize(numBlocks,0);
+    vector<int> nxt(numStates,-1);
+    vector<int> prv(numStates,-1);
+
+    auto append = [&](const int s, const int b) {
+        prv[s] = tail[b];
+        nxt[s] = -1;
+        if ( tail[b] >= 0 ) nxt[tail[b]] = s; else head[b] = s;
+        tail[b] = s;
+        blkSize[b]++;
+    };
+
+    auto remove = [&](const int s, const int b) {
+        if ( prv[s] >= 0 ) nxt[prv[s]] = nxt[s]; else head[b] = nxt[s];
+        if ( nxt[s] >= 0 ) prv[nxt[s]] = prv[s]; else tail[b] = prv[s];
+        blkSize[b]--;
+    };
+
+    for ( int s = 0; s < numStates; s++ ) append(s,blk[s]);
+
+    // Compare the post-state blocks of two states of the same block
+    auto sigLess = [&](const int s1, const int s2) {
+        size_t len = trOffsets[s1+1] - trOffsets[s1];
+        for ( size_t i = 0; i < len; i++ ) {
+            int b1 = blk[trTarget[trOffsets[s1] + i]];
+            int b2 = blk[trTarget[trOffsets[s2] + i]];
+            if ( b1 != b2 ) return b1 < b2;
+        }
+        return false;
+    };
+    auto sigEquals = [&](const int s1, const int s2) {
+        return not sigLess(s1,s2) and not sigLess(s2,s1);
+    };
+
+    // A sub-block of a block to be split
+    struct Group
+    {
+        /** Range in touched states of the block, or begin == end for the untouched states */
+        size_t begin;
+        size_t end;
+        int minState;
+        int size;
+        bool untouched;
+    };
+
+    // A block to be split, together with its sub-blocks
+    struct Split
+    {
+        int block;
+        vector<int> touched;
+        vector<Group> groups;
+    };
+
+    vector<vector<int>> touchedOfBlock(numBlocks);
+    vector<bool> isTouched(numStates,false);
+    vector<bool> mark(numStates,false);
+
+    // In the first round, all states are examined
+    vector<int> touched(numStates);
+    for ( int s = 0; s < numStates; s++ ) touched[s] = s;
+
+    while ( not touched.empty() ) {
+
+        // Assign touched states to their blocks
+        vector<int> candidates;
+        for ( int s : touched ) {
+            int b = blk[s];
+            if ( touchedOfBlock[b].empty() ) candidates.push_back(b);
+            touchedOfBlock[b].push_back(s);
+        }
+
+        // Calculate the sub-blocks of each candidate block,
+        // based on the blocks of this round
+        vector<Split> splits;
+        for ( int b : candidates ) {
+            Split sp;
+            sp.block = b;
+            sp.touched.swap(touchedOfBlock[b]);
+            vector<int>& t = sp.touched;
+
+            sort(t.begin(),t.end(),[&](const int s1, const int s2) {
+                if ( sigLess(s1,s2) ) return true;
+                if ( sigLess(s2,s1) ) return false;
+                return s1 < s2;
+            });
+
+            for ( size_t i = 0; i < t.size(); i++ ) {
+                if ( i == 0 or not sigEquals(t[i-1],t[i]) ) {
+                    if ( not sp.groups.empty() ) sp.groups.back().end = i;
+                    Group g;
+                    g.begin = i;
+                    g.end = t.size();
+                    g.minState = t[i];
+                    g.untouched = false;
+                    sp.groups.push_back(g);
+                }
+            }
+            for ( auto& g : sp.groups ) g.size = static_cast<int>(g.end - g.begin);
+
+            int numUntouched = blkSize[b] - static_cast<int>(t.size());
+            if ( numUntouched == 0 and sp.groups.size() == 1 ) continue;
+
+            if ( numUntouched > 0 ) {
+                // The smallest untouched state is found by skipping
+                // the touched states at the head of the block
+                for ( int s : t ) isTouched[s] = true;
+                int s = head[b];
+                while ( isTouched[s] ) s = nxt[s];
+                for ( int u : t ) isTouched[u] = false;
+
+                Group g;
+                g.begin = g.end = 0;
+                g.minState = s;
+                g.size = numUntouched;
+                g.untouched = true;
+                sp.groups.push_back(g);
+            }
+
+            splits.push_back(move(sp));
+        }
+
+        if ( splits.empty() ) break;
+
+        // New class ids are assigned in ascending order of the
+        // class ids of the blocks to be split
+        sort(splits.begin(),splits.end(),[&](const Split& a, const Split& b) {
+            return cls[a.block] < cls[b.block];
+        });
+
+        Round r;
+        vector<int> moved;
+        int nextClass = numClasses.back();
+
+        for ( auto& sp : splits ) {
+            int b = sp.block;
+            vector<Group>& groups = sp.groups;
+
+            // The largest sub-block keeps the block, preferring
+            // the untouched states in case of a tie.
+            size_t keep = 0;
+            for ( size_t g = 1; g < groups.size(); g++ ) {
+                if ( groups[g].size > groups[keep].size
+                    or (groups[g].size == groups[keep].size and groups[g].untouched) ) {
+                    keep = g;
+                }
+            }
+
+            // Collect the states of each group to be moved
+            vector<vector<int>> members(groups.size());
+            for ( size_t g = 0; g < groups.size(); g++ ) {
+                if ( g == keep ) continue;
+                if ( groups[g].untouched ) {
+                    for ( int s : sp.touched ) isTouched[s] = true;
+                    for ( int s = head[b]; s >= 0; s = nxt[s] ) {
+                        if ( not isTouched[s] ) members[g].push_back(s);
+                    }
+                    for ( int s : sp.touched ) isTouched[s] = false;
+                }
+                else {
+                    members[g].assign(sp.touched.begin() + groups[g].begin,
+                                      sp.touched.begin() + groups[g].end);
+                }
+            }
+
+            // Move the states to new blocks
+            vector<int> grpBlock(groups.size(),b);
+            for ( size_t g = 0; g < groups.size(); g++ ) {
+                if ( g == keep ) continue;
+                int nb = numBlocks++;
+                head.push_back(-1);
+                tail.push_back(-1);
+                blkSize.push_back(0);
+                cls.push_back(-1);
+                touchedOfBlock.emplace_back();
+                grpBlock[g] = nb;
+                for ( int s : members[g] ) {
+                    remove(s,b);
+                    append(s,nb);
+                    blk[s] = nb;
+                    r.moves.push_back(make_pair(s,nb));
+                    moved.push_back(s);
+                }
+            }
+
+            // The sub-block containing the smallest state keeps the
+            // class id; the others get new ids, ordered by their smallest states.
+            int oldClass = cls[b];
+            vector<size_t> order(groups.size());
+            for ( size_t g = 0; g < groups.size(); g++ ) order[g] = g;
+            sort(order.begin(),order.end(),[&](const size_t g1, const size_t g2) {
+                return groups[g1].minState < groups[g2].minState;
+            });
+            for ( size_t i = 0; i < order.size(); i++ ) {
+                int c = ( i == 0 ) ? oldClass : nextClass++;
+                int gb = grpBlock[order[i]];
+                if ( cls[gb] != c ) {
+                    cls[gb] = c;
+                    r.relabels.push_back(make_pair(gb,c));
+                }
+            }
+        }
+
+        numClasses.push_back(nextClass);
+        rounds.push_back(move(r));
+
+        // States with a moved post-state are examined in the next round
+        touched.clear();
+        for ( int t : moved ) {
+            for ( size_t i = predOffsets[t]; i < predOffsets[t+1]; i++ ) {
+                int s = preds[i];
+                if ( mark[s] ) continue;
+                mark[s] = true;
+                touched.push_back(s);
+            }
+        }
+        for ( int s : touched ) mark[s] = false;
+    }
+
+    finalClasses.resize(numStates);
+    for ( int s = 0; s < numStates; s++ ) finalClasses[s] = cls[blk[s]];
+}
+
+vector<int> PartitionRefinement::getPartition(const size_t k) const
+{
+    if ( k == rounds.size() ) return finalClasses;
+
+    Cursor c(*this);
+    while ( c.getIndex() < k ) {
+        if ( not c.next() ) break;
+    }
+    return c.getPartition();
+}
+
+PartitionRefinement::Cursor::Cursor(const PartitionRefinement& pr):
+pr(&pr),
+k(0),
+blk(pr.initialClasses),
+cls(pr.numBlocks,-1)
+{
+    if ( not pr.valid ) return;
+    for ( int b = 0; b < pr.numClasses.front(); b++ ) cls[b] = b;
+}
+
+bool PartitionRefinement::Cursor::next()
+{
+    if ( pr == nullptr or k >= pr->rounds.size() ) return false;
+    const Round& r = pr->rounds[k];
+    for ( const auto& m : r.moves ) blk[m.first] = m.second;
+    for ( const auto& l : r.relabels ) cls[l.first] = l.second;
+    k++;
+    return true;
+}
+
+vector<int> PartitionRefinement::Cursor::getPartition() const
+{
+    if ( pr == nullptr ) return vector<int>();
+    if ( k == pr->rounds.size() ) return pr->finalClasses;
+
+    vector<int> s2c(blk.size());
+    for ( size_t s = 0; s < blk.size(); s++ ) s2c[s] = cls[blk[s]];
+    return s2c;
+}
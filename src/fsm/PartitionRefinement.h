@@ -0,0 +1,175 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_FSM_PARTITIONREFINEMENT_H_
+#define FSM_FSM_PARTITIONREFINEMENT_H_
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+class TransitionTable;
+
+/**
+ *  Partition refinement on the states of an observable FSM (in particular,
+ *  a DFSM), operating on the integer arrays of a TransitionTable.
+ *
+ *  The refinement proceeds in rounds, exactly like the sequence of
+ *  Pk-tables (DFSM) or OFSM-tables (observable FSM):
+ *
+ *  - Partition 0 groups the states with identical sets of
+ *    defined input/output labels (P1 for DFSMs, OFSM table 1 for OFSMs).
+ *  - Partition k+1 splits each class of partition k according to the
+ *    classes of the post-states reached by each input/output label.
+ *  - The refinement stops as soon as a round does not split any class.
+ *
+ *  In contrast to the table-based algorithms, a round only re-examines
+ *  the states having a post-state that has been moved to a new block in
+ *  the previous round. When a block splits, the largest sub-block keeps
+ *  the block, and only the states of the other sub-blocks are moved
+ *  (Hopcroft's "process the smaller half" strategy). Therefore, every
+ *  state is moved at most O(log n) times.
+ *
+ *  The class ids of every partition coincide with the ids calculated by
+ *  PkTable::getPkPlusOneTable() and OFSMTable::next(): when a class c
+ *  splits, the sub-class containing the smallest state of c keeps id c,
+ *  and the remaining sub-classes get fresh ids in the order of their
+ *  smallest states, where the classes are processed in ascending order
+ *  of their ids.
+ *
+ *  Only the final partition is stored explicitly. Each intermediate
+ *  partition is recorded as the list of changes performed in its round
+ *  and re-constructed on demand, either by getPartition() or, when the
+ *  partitions are visited in ascending order, by a Cursor.
+ */
+class PartitionRefinement
+{
+private:
+
+    /** Changes performed in one refinement round */
+    struct Round
+    {
+        /** (state, new block) for each state moved to another block */
+        std::vector<std::pair<int,int>> moves;
+
+        /** (block, class id) for each block whose class id has changed */
+        std::vector<std::pair<int,int>> relabels;
+    };
+
+    /** Number of states */
+    int numStates;
+
+    /** false, if the transition relation is not observable */
+    bool valid;
+
+    /**
+     *  Outgoing transitions of state s, sorted by input and output,
+     *  are stored at positions trOffsets[s]..trOffsets[s+1]-1
+     */
+    std::vector<size_t> trOffsets;
+    std::vector<int> trInput;
+    std::vector<int> trOutput;
+    std::vector<int> trTarget;
+
+    /**
+     *  Pre-states of state s are stored at positions
+     *  predOffsets[s]..predOffsets[s+1]-1 of preds
+     */
+    std::vector<size_t> predOffsets;
+    std::vector<int> preds;
+
+    /** Class ids of partition 0 (these are also the initial block ids) */
+    std::vector<int> initialClasses;
+
+    /** Changes leading from partition k-1 to partition k are stored in rounds[k-1] */
+    std::vector<Round> rounds;
+
+    /** Number of classes of each partition */
+    std::vector<int> numClasses;
+
+    /** Total number of blocks created during the refinement */
+    int numBlocks;
+
+    /** Class ids of the last partition */
+    std::vector<int> finalClasses;
+
+    void calcInitialPartition();
+    void refine();
+
+public:
+
+    /**
+     *  Visits the partitions in ascending order. Advancing to the next
+     *  partition only applies the changes of a single round, so that
+     *  the earlier rounds are not replayed for every partition.
+     */
+    class Cursor
+    {
+    private:
+        const PartitionRefinement* pr;
+
+        /** Index of the current partition */
+        size_t k;
+
+        /** Block of each state and class id of each block in partition k */
+        std::vector<int> blk;
+        std::vector<int> cls;
+
+    public:
+
+        /** A cursor not associated with any refinement */
+        Cursor() : pr(nullptr), k(0) { }
+
+        /**
+         *  Create a cursor at partition 0 of pr,
+         *  which must outlive the cursor
+         */
+        explicit Cursor(const PartitionRefinement& pr);
+
+        /** Index of the current partition */
+        size_t getIndex() const { return k; }
+
+        /**
+         *  Advance to the next partition.
+         *  @return false if the current partition is the last one
+         */
+        bool next();
+
+        /**
+         *  Return the class ids of the current partition, where s2c[s]
+         *  is the class of state s.
+         */
+        std::vector<int> getPartition() const;
+    };
+
+    /**
+     *  Calculate all partitions for the FSM represented by tbl.
+     *  If the FSM is not observable, no partitions are calculated
+     *  and isValid() returns false.
+     *  @param tbl Transition table of the FSM, must be valid
+     */
+    explicit PartitionRefinement(const TransitionTable& tbl);
+
+    /** Return true if and only if the partitions have been calculated */
+    bool isValid() const { return valid; }
+
+    /** Number of partitions, including the initial one */
+    size_t getNumPartitions() const { return rounds.size() + 1; }
+
+    /** Number of classes in partition k */
+    int getNumClasses(const size_t k) const { return numClasses.at(k); }
+
+    /**
+     *  Return the class ids of partition k, where s2c[s]
+     *  is the class of state s.
+     */
+    std::vector<int> getPartition(const size_t k) const;
+
+    /** Return the class ids of the last partition */
+    const std::vector<int>& getFinalPartition() const { return finalClasses; }
+
+};
+
+#endif //FSM_FSM_PARTITIONREFINEMENT_H_
@@ -183,6 +183,16 @@ shared_ptr<PkTable> PkTable::getPkPlusOneTable() const
     return haveNewClasses ? pkp1 : nullptr;
 }
 
+shared_ptr<PkTable> PkTable::getPkPlusOneTable(const vector<int>& nextS2C) const
+{
+    shared_ptr<PkTable> pkp1 = make_shared<PkTable>(rows.size(), maxInput, rows, presentationLayer);
+    for (unsigned int i = 0; i < rows.size(); ++i)
+    {
+        pkp1->setClass(i, nextS2C.at(i));
+    }
+    return pkp1;
+}
+
 Dfsm PkTable::toFsm(string name, const int maxOutput)
 {
     string minFsmName("");
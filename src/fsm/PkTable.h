@@ -99,6 +99,15 @@ public:
      * the P(k+1)-Table otherwise
      */
     std::shared_ptr<PkTable> getPkPlusOneTable() const;
+
+    /**
+     * Generate the P(k+1) table from this Pk-Table, using a class
+     * mapping that has already been calculated elsewhere
+     * (e.g. by PartitionRefinement), instead of comparing the rows.
+     * @param nextS2C nextS2C[s] is the Pk+1-equivalence class of state s
+     * @return the P(k+1)-Table, sharing the rows with this table
+     */
+    std::shared_ptr<PkTable> getPkPlusOneTable(const std::vector<int>& nextS2C) const;
     
     /**
      * Generate a DFSM form thus pktable
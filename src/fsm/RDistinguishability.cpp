@@ -1,11 +1,11 @@
 #include <utility>
 #include <algorithm>
+#include <limits>
 
 #include "RDistinguishability.h"
 #include "trees/InputOutputTree.h"
 #include "trees/AdaptiveTreeNode.h"
 #include "fsm/FsmNode.h"
-#include "utils/Logger.hpp"
 
 using namespace std;
 RDistinguishability::RDistinguishability(const shared_ptr<FsmPresentationLayer>& presentationLayer) : presentationLayer(presentationLayer)
@@ -13,63 +13,27 @@ RDistinguishability::RDistinguishability(const shared_ptr<FsmPresentationLayer>&
     hBeenCalculated = false;
 }
 
-vector<int>::iterator RDistinguishability::removeNotRDistinguishable(size_t i, std::shared_ptr<FsmNode> node)
+void RDistinguishability::initRDistinguishability(const vector<shared_ptr<FsmNode>>& otherNodes)
 {
-    vector<int>& notDist = notRDistinguishableWith.at(i);
-    for (vector<int>::iterator it = notDist.begin(); it != notDist.end(); ++it)
+    rDistinguishabilityLevel.clear();
+    rDistinguishabilityLevel.reserve(otherNodes.size());
+    for (const shared_ptr<FsmNode>& node : otherNodes)
     {
-        if (*it == node->getId()) {
-            return notDist.erase(it);
-        }
-    }
-    return notDist.end();
-}
-
-void RDistinguishability::initRDistinguishable(size_t i)
-{
-    auto it = rDistinguishableWith.find(i);
-    if (it == rDistinguishableWith.end())
-    {
-        rDistinguishableWith.insert(pair<size_t, std::vector<int>>(i, {}));
-    }
-    else
-    {
-        LOG("WARNING") << "Overwriting r-distinguishability." << std::endl;
-        rDistinguishableWith[i] = {};
+        rDistinguishabilityLevel[node->getId()] = 0;
     }
+    adaptiveIOSequences.clear();
+    hBeenCalculated = false;
 }
 
 void RDistinguishability::addRDistinguishable(size_t i, std::shared_ptr<FsmNode> node)
 {
-    auto it = rDistinguishableWith.find(i);
-    if (it == rDistinguishableWith.end())
-    {
-        rDistinguishableWith.insert(pair<size_t, std::vector<int>>(i, {node->getId()}));
-    }
-    else
+    size_t& level = rDistinguishabilityLevel[node->getId()];
+    if (level == 0 || i < level)
     {
-        it->second.push_back(node->getId());
+        level = i;
     }
 }
 
-void RDistinguishability::addNotRDistinguishable(size_t i, std::shared_ptr<FsmNode> node)
-{
-    auto it = notRDistinguishableWith.find(i);
-    if (it == notRDistinguishableWith.end())
-    {
-        notRDistinguishableWith.insert(pair<size_t, std::vector<int>>(i, {node->getId()}));
-    }
-    else
-    {
-        it->second.push_back(node->getId());
-    }
-}
-
-void RDistinguishability::addNotRDistinguishable(size_t i)
-{
-    notRDistinguishableWith[i] = {};
-}
-
 void RDistinguishability::addAdaptiveIOSequence(std::shared_ptr<FsmNode> otherNode, std::shared_ptr<InputOutputTree> tree)
 {
     adaptiveIOSequences.insert(pair<int, shared_ptr<InputOutputTree>>(otherNode->getId(), tree));
@@ -77,56 +41,42 @@ void RDistinguishability::addAdaptiveIOSequence(std::shared_ptr<FsmNode> otherNo
 
 vector<int> RDistinguishability::getRDistinguishableWith(size_t i)
 {
-    return rDistinguishableWith.at(i);
-}
-
-vector<int> RDistinguishability::getRDistinguishableWith()
-{
-    if (rDistinguishableWith.rbegin() != rDistinguishableWith.rend())
+    vector<int> result;
+    for (const auto& entry : rDistinguishabilityLevel)
     {
-        return rDistinguishableWith.rbegin()->second;
-    }
-    else
-    {
-        return vector<int>();
+        if (entry.second != 0 && entry.second <= i)
+        {
+            result.push_back(entry.first);
+        }
     }
-
-}
-
-vector<int> RDistinguishability::getNotRDistinguishableWith(size_t i)
-{
-    return notRDistinguishableWith.at(i);
+    sort(result.begin(), result.end());
+    return result;
 }
 
-bool RDistinguishability::isNotRDistinguishable()
+vector<int> RDistinguishability::getRDistinguishableWith()
 {
-    return notRDistinguishableWith.rbegin()->second.size() != 0;
+    return getRDistinguishableWith(std::numeric_limits<size_t>::max());
 }
 
-bool RDistinguishability::isRDistinguishableWith(size_t i, std::shared_ptr<FsmNode> node)
+vector<int> RDistinguishability::getNotRDistinguishableWith(size_t i)
 {
-    for (; i > 0; --i)
+    vector<int> result;
+    for (const auto& entry : rDistinguishabilityLevel)
     {
-        try {
-            auto dist = rDistinguishableWith.at(i);
-            if ( std::find(dist.begin(), dist.end(), node->getId()) != dist.end() )
-            {
-                return true;
-            }
-        } catch (out_of_range &e) {
-            continue;
+        if (entry.second == 0 || entry.second > i)
+        {
+            result.push_back(entry.first);
         }
-
     }
-    return false;
+    sort(result.begin(), result.end());
+    return result;
 }
 
-bool RDistinguishability::isRDistinguishableWith(std::shared_ptr<FsmNode> node)
+bool RDistinguishability::isNotRDistinguishable()
 {
-    for (auto it = rDistinguishableWith.rbegin(); it != rDistinguishableWith.rend(); ++it)
+    for (const auto& entry : rDistinguishabilityLevel)
     {
-        vector<int> dist = it->second;
-        if ( std::find(dist.begin(), dist.end(), node->getId()) != dist.end() )
+        if (entry.second == 0)
         {
             return true;
         }
@@ -134,6 +84,18 @@ bool RDistinguishability::isRDistinguishableWith(std::shared_ptr<FsmNode> node)
     return false;
 }
 
+bool RDistinguishability::isRDistinguishableWith(size_t i, std::shared_ptr<FsmNode> node)
+{
+    auto it = rDistinguishabilityLevel.find(node->getId());
+    return it != rDistinguishabilityLevel.end() && it->second != 0 && it->second <= i;
+}
+
+bool RDistinguishability::isRDistinguishableWith(std::shared_ptr<FsmNode> node)
+{
+    auto it = rDistinguishabilityLevel.find(node->getId());
+    return it != rDistinguishabilityLevel.end() && it->second != 0;
+}
+
 bool RDistinguishability::isRDistinguishableWith(vector<shared_ptr<FsmNode>> nodes)
 {
     for (shared_ptr<FsmNode> node : nodes)
@@ -156,20 +118,6 @@ shared_ptr<InputOutputTree> RDistinguishability::getAdaptiveIOSequence(shared_pt
     return it->second->Clone();
 }
 
-void RDistinguishability::inheritDistinguishability(size_t i)
-{
-    auto it = rDistinguishableWith.find(i - 1);
-    if (it != rDistinguishableWith.end())
-    {
-        rDistinguishableWith.insert(make_pair(i, it->second));
-    }
-    it = notRDistinguishableWith.find(i - 1);
-    if (it != notRDistinguishableWith.end())
-    {
-        notRDistinguishableWith.insert(make_pair(i, it->second));
-    }
-}
-
 bool RDistinguishability::hasBeenCalculated() const
 {
     return hBeenCalculated;
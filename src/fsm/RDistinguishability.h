@@ -4,6 +4,7 @@
 #include <vector>
 #include <memory>
 #include <map>
+#include <unordered_map>
 
 class FsmNode;
 class InputOutputTree;
@@ -23,15 +24,11 @@ public:
 
 protected:
     /**
-     * This maps holds for every `i` the states that are r(i)-distinguishable from the state
-     * that corresponds to the `RDistinguishability` instance.
+     * This map holds for every other state the smallest `i` such that the state is
+     * r(i)-distinguishable from the state that corresponds to the `RDistinguishability`
+     * instance, or 0 if the states are not r-distinguishable.
      */
-    std::map<size_t, std::vector<int>> rDistinguishableWith;
-    /**
-     * This maps holds for every `i` the states that are not r(i)-distinguishable from the state
-     * that corresponds to the `RDistinguishability` instance.
-     */
-    std::map<size_t, std::vector<int>> notRDistinguishableWith;
+    std::unordered_map<int, size_t> rDistinguishabilityLevel;
 
     /**
      * This map holds for every state an adaptive input sequence, that r-distinguishes
@@ -40,40 +37,20 @@ protected:
     std::map<int, std::shared_ptr<InputOutputTree>> adaptiveIOSequences;
 public:
     /**
-     * Removes a given state from the set that holds the states that are not r(i)-distinguishable
-     * for a given `i`.
-     * @param i The given non-r(i)-distinguishability index
-     * @param node The given node to be removed
-     * @return An iterator, pointing to the removed node, if the node has been found in the
-     * non-r(i)-distinguisability set, an iterator, pointing to the end of the non-r(i)-distinguisability set,
-     * if the node has not beend found.
+     * Resets the r-distinguishability, such that none of the given states is
+     * r-distinguishable from the state that corresponds to the `RDistinguishability` instance.
+     * @param otherNodes All states except the one that corresponds to the instance
      */
-    std::vector<int>::iterator removeNotRDistinguishable(size_t i, std::shared_ptr<FsmNode> node);
-
-    void initRDistinguishable(size_t i);
+    void initRDistinguishability(const std::vector<std::shared_ptr<FsmNode>>& otherNodes);
 
     /**
-     * Adds a node to the set that holds the states that are r(i)-distinguishable
-     * for a given `i`.
-     * @param i The given r(i)-distinguishability index
-     * @param node The given node to be added
+     * Marks a node as r(i)-distinguishable for a given `i`, and thus as
+     * r(j)-distinguishable for every `j >= i`.
+     * @param i The smallest r(i)-distinguishability index of the node
+     * @param node The given node
      */
     void addRDistinguishable(size_t i, std::shared_ptr<FsmNode> node);
 
-    /**
-     * Adds a node to the set that holds the states that are not r(i)-distinguishable
-     * for a given `i`.
-     * @param i The given non-r(i)-distinguishability index
-     * @param node The given node to be added
-     */
-    void addNotRDistinguishable(size_t i, std::shared_ptr<FsmNode> node);
-
-    /**
-     * Sets an empty set as non-r(i)-distinguishability set for a given index `i`.
-     * @param i The given non-r(i)-distinguishability index
-     */
-    void addNotRDistinguishable(size_t i);
-
     /**
      * Sets the r-distinguishing adaptive input sequence for a given state.
      * @param otherNode The goven state
@@ -149,14 +126,6 @@ public:
      */
     std::shared_ptr<InputOutputTree> getAdaptiveIOSequence(std::shared_ptr<FsmNode> otherNode);
 
-    /**
-     * Sets the r(i)-distinguishability and the non-r(i)-distinguishability sets for a given
-     * index `i` to the same values as the r(i-1)-distinguishability and the
-     * non-r(i-1)-distinguishability.
-     * @param i The given r(i)-distinguishability index
-     */
-    void inheritDistinguishability(size_t i);
-
     /**
      * States wether the r-distinguishability has been calculated or not.
      * @return `true`, if the r-distinguishability has been calculated, `false`,
@@ -26,12 +26,15 @@
 #include "fsm/RDistinguishability.h"
 #include "fsm/VPrimeLazy.h"
 #include "fsm/IOTrace.h"
+#include "fsm/SubsetConstruction.h"
 #include "sets/HittingSet.h"
 #include "trees/AdaptiveTreeNode.h"
 #include "trees/TreeNode.h"
 #include "trees/TreeEdge.h"
 #include "trees/IOListContainer.h"
 #include "utils/Logger.hpp"
+#include "utils/MaximalCliqueEnumerator.hpp"
+#include "utils/WorkStealingPool.hpp"
 #include "utils/generic-equivalence-class-calculation.hpp"
 #include "trees/TestSuite.h"
 #include "trees/InputOutputTree.h"
@@ -73,49 +76,39 @@ void StrongReductionTestSuiteGenerator::calcDeterministicallyReachingSequences()
         }        
     }
 
-    // make m observable, which effectively determinises the automaton obtained by dropping the outputs, as all outputs are 0
-    Fsm mObs = m.transformToObservableFSM();
+    // make m observable, which effectively determinises the automaton obtained by dropping the outputs, as all outputs are 0.
+    // The states of the observable FSM are only created as far as the breadth first search below needs them.
+    SubsetConstruction mObs(m);
 
-    // labels of states of mObs corresponding to singletons of states in fsm
-    unordered_map<int, string> node2AutomatonLabel;
-    for ( int n = 0; n <= maxState; ++n) {
-
-        auto node = nodes[n];
-        unordered_set<shared_ptr<FsmNode>> expectedLabel;
-        expectedLabel.insert(node);
-        string nodeName = Fsm::labelString(expectedLabel);
-        node2AutomatonLabel[n] = nodeName;
-    }
-        
     // get deterministically reaching sequences via breadth first search,
     // where a sequence reaching {q} in mObs d-reaches q in fsm
-    std::queue<std::shared_ptr<FsmNode>> todo;
+    std::queue<int> todo;
     std::queue<std::vector<int>> prevSequences;
+    std::vector<bool> visited(1, true);
+    int numUnreached = maxState + 1;
     todo.push(mObs.getInitialState());
     prevSequences.push(std::vector<int> ());
-    while (!todo.empty()) {
-        std::shared_ptr<FsmNode> curNode = todo.front();
+    while (!todo.empty() && numUnreached > 0) {
+        int curNode = todo.front();
         todo.pop();
         std::vector<int> dReachingSequence = prevSequences.front();
         prevSequences.pop();
 
-        if (curNode->getColor() == curNode->black) {
-            continue;
-        }
-        curNode->setColor(curNode->black);
-
-        // check if current node is a singleton
-        for ( int n = 0; n <= fsm->getMaxNodes(); ++n) {
-            if (curNode->getName().compare(node2AutomatonLabel[n]) == 0) {
-                dReachingSequences[nodes[n]] = dReachingSequence;
-                break;
-            } 
+        // check if current node is a singleton {n}, where n is not the sink state
+        const std::vector<int>& curSet = mObs.getStateSet(curNode);
+        if (curSet.size() == 1 && curSet[0] <= maxState) {
+            dReachingSequences[nodes[curSet[0]]] = dReachingSequence;
+            --numUnreached;
         }
 
-        for (auto transition : curNode->getTransitions()) {
-            todo.push(transition->getTarget());
+        std::vector<SubsetConstruction::Transition> transitions = mObs.getTransitions(curNode);
+        visited.resize(mObs.size(), false);
+        for (const auto& transition : transitions) {
+            if (visited[transition.target]) continue;
+            visited[transition.target] = true;
+            todo.push(transition.target);
             std::vector<int> nextSeq(dReachingSequence);
-            nextSeq.push_back(transition->getLabel()->getInput());
+            nextSeq.push_back(transition.input);
             prevSequences.push(nextSeq);
         }
         
@@ -311,67 +304,28 @@ void StrongReductionTestSuiteGenerator::calcAllMaximalRDistinguishableSets() {
 
     vector<shared_ptr<FsmNode>> nodes = fsm->getNodes();
 
-    std::function<std::unordered_set<std::unordered_set<std::shared_ptr<FsmNode>>>(unsigned int)> helper = [this,nodes,&helper](unsigned int n)->std::unordered_set<std::unordered_set<std::shared_ptr<FsmNode>>> {
-        if (n == 0) {
-            std::unordered_set<std::unordered_set<std::shared_ptr<FsmNode>>> result;
-            std::unordered_set<std::shared_ptr<FsmNode>> emptySet;
-            std::unordered_set<std::shared_ptr<FsmNode>> singleton;
-            singleton.insert(nodes[n]);
-            result.insert(singleton);
-            result.insert(emptySet);
-            return result;
-        }
-
-        auto node = nodes[n];
-        auto sets = helper(n-1);
-
-        auto result = std::unordered_set<std::unordered_set<std::shared_ptr<FsmNode>>>(sets);
-        for (auto set : sets) {
-            bool isRdFromAllCurrentNodes = true;
-            for (auto otherNode : set) {
-                auto pair = std::pair<std::shared_ptr<FsmNode>,std::shared_ptr<FsmNode>>(node,otherNode);
-                if (rDistTrees.count(pair) == 0) {
-                    isRdFromAllCurrentNodes = false;
-                    break;
-                }
-                           
+    // maximal sets of pairwise r-distinguishable states are the maximal cliques
+    // of the graph relating all pairs of states that have an r-distinguishing tree
+    MaximalCliqueEnumerator cliques(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        for (size_t j = i + 1; j < nodes.size(); ++j) {
+            if (rDistTrees.count(std::make_pair(nodes[i],nodes[j])) != 0) {
+                cliques.addEdge(i,j);
             }
-            if (isRdFromAllCurrentNodes) {
-                auto setWithNode = std::unordered_set<std::shared_ptr<FsmNode>>(set);
-                setWithNode.insert(node);
-                result.insert(setWithNode);
-            } 
         }
-        return result;
-    };
-
-    auto candidates = helper(nodes.size()-1);
+    }
 
-    for (auto candidate : candidates) {
-        bool isMaximal = true;
-        for (auto otherCandidate : candidates) {
-            if (candidate == otherCandidate) continue;
-            
-            bool isProperSubset = true;
-            for (auto elem : candidate) {
-                if (otherCandidate.count(elem) == 0) {
-                    isProperSubset = false;
-                    break;
-                }
-            }
-            if (isProperSubset) {
-                isMaximal = false;
-                break;
-            }
-        }
-        if (isMaximal) {
-            maximalRDistSets.insert(candidate);
+    cliques.enumerate([this,&nodes](const std::vector<size_t>& clique) {
+        std::unordered_set<std::shared_ptr<FsmNode>> set;
+        for (size_t i : clique) {
+            set.insert(nodes[i]);
         }
-    }
+        maximalRDistSets.insert(set);
+    }, numThreads);
 }
 
 
-StrongReductionTestSuiteGenerator::StrongReductionTestSuiteGenerator(const std::shared_ptr<Fsm> fsm, bool calculateAllMaximalRDistinguishableSets) : fsm(fsm)
+StrongReductionTestSuiteGenerator::StrongReductionTestSuiteGenerator(const std::shared_ptr<Fsm> fsm, bool calculateAllMaximalRDistinguishableSets, unsigned int numThreads) : fsm(fsm), numThreads(numThreads)
 {
     calcDeterministicallyReachingSequences();
     calcRDistinguishingTrees();
@@ -416,8 +370,7 @@ std::vector<std::pair<std::shared_ptr<std::unordered_set<std::shared_ptr<FsmNode
 }
 
 
-std::vector<std::pair<IOTrace, std::vector<std::shared_ptr<std::unordered_set<std::shared_ptr<FsmNode>>>>>> StrongReductionTestSuiteGenerator::calcTraversalSet(std::shared_ptr<FsmNode> node, int m) {
-    std::vector<std::pair<IOTrace, std::vector<std::shared_ptr<std::unordered_set<std::shared_ptr<FsmNode>>>>>> result;
+void StrongReductionTestSuiteGenerator::forEachTraversalPath(std::shared_ptr<FsmNode> node, int m, const std::function<void(const std::pair<IOTrace, std::vector<std::shared_ptr<std::unordered_set<std::shared_ptr<FsmNode>>>>>&)>& visit) {
 
     std::vector<std::pair<std::shared_ptr<std::unordered_set<std::shared_ptr<FsmNode>>>,int>> terminationTuples = getTerminationTuples(m);
     std::vector<int> initialMissingVisits;
@@ -425,9 +378,22 @@ std::vector<std::pair<IOTrace, std::vector<std::shared_ptr<std::unordered_set<st
         initialMissingVisits.push_back(terminationTuples[i].second);
     }
 
-    std::function<std::vector<std::pair<IOTrace, std::vector<std::shared_ptr<std::unordered_set<std::shared_ptr<FsmNode>>>>>>(std::shared_ptr<FsmNode>, std::vector<int>)> helper = [this,terminationTuples,&helper](std::shared_ptr<FsmNode> node, std::vector<int> missingVisits)->std::vector<std::pair<IOTrace, std::vector<std::shared_ptr<std::unordered_set<std::shared_ptr<FsmNode>>>>>> {
+    // a frame of the depth-first search: the node reached by the current path,
+    // the index of its next transition to be followed and the visits still
+    // required for each termination tuple
+    struct Frame {
+        std::shared_ptr<FsmNode> node;
+        size_t nextTransition;
+        std::vector<int> missingVisits;
+    };
+    std::vector<Frame> stack;
 
-        std::vector<std::pair<IOTrace, std::vector<std::shared_ptr<std::unordered_set<std::shared_ptr<FsmNode>>>>>> result;
+    // inputs and outputs of the path to the node of the topmost frame
+    std::vector<int> inputs;
+    std::vector<int> outputs;
+
+    // either visit the current path if it terminates in the given node, or push a frame for the node
+    auto enter = [&](const std::shared_ptr<FsmNode>& target, std::vector<int>&& missingVisits)->bool {
         std::vector<std::shared_ptr<std::unordered_set<std::shared_ptr<FsmNode>>>> terminatingSets;
         for (unsigned int i = 0; i < missingVisits.size(); ++i) {
             if (missingVisits[i] <= 0) {
@@ -437,36 +403,64 @@ std::vector<std::pair<IOTrace, std::vector<std::shared_ptr<std::unordered_set<st
 
         // terminate if all required visits have been performed for some set
         if (!terminatingSets.empty()) {
-            IOTrace emptyTrace = IOTrace(InputTrace(fsm->getPresentationLayer()), OutputTrace(fsm->getPresentationLayer()), node);
-            std::pair<IOTrace, std::vector<std::shared_ptr<std::unordered_set<std::shared_ptr<FsmNode>>>>> singleEntry = std::make_pair(emptyTrace,terminatingSets);
-            result.push_back(singleEntry);
-            return result;
+            IOTrace trace = IOTrace(InputTrace(inputs,fsm->getPresentationLayer()), OutputTrace(outputs,fsm->getPresentationLayer()), target);
+            visit(std::make_pair(trace,terminatingSets));
+            return false;
         }
 
-        for (auto transition : node->getTransitions()) {            
-            // update visits based on current target
-            std::vector<int> nextMissingVisits;
-            for (unsigned int i = 0; i < missingVisits.size(); ++i) {
-                if (terminationTuples[i].first->count(transition->getTarget()) == 0) {
-                    nextMissingVisits.push_back(missingVisits[i]);
-                } else {
-                    nextMissingVisits.push_back(missingVisits[i]-1);
-                }
+        Frame frame;
+        frame.node = target;
+        frame.nextTransition = 0;
+        frame.missingVisits = std::move(missingVisits);
+        stack.push_back(std::move(frame));
+        return true;
+    };
+
+    enter(node, std::move(initialMissingVisits));
+    while (!stack.empty()) {
+        Frame& frame = stack.back();
+        auto& transitions = frame.node->getTransitions();
+
+        if (frame.nextTransition == transitions.size()) {
+            stack.pop_back();
+            if (!inputs.empty()) {
+                inputs.pop_back();
+                outputs.pop_back();
             }
+            continue;
+        }
+
+        auto transition = transitions[frame.nextTransition++];
 
-            auto targetResult = helper(transition->getTarget(), nextMissingVisits);
-            for (auto entry : targetResult) {
-                // prepend results for the transition target by the transitions IO
-                IOTrace curTrace = IOTrace(entry.first);
-                IOTrace transitionTrace = IOTrace(transition->getLabel()->getInput(), transition->getLabel()->getOutput(), fsm->getPresentationLayer());
-                curTrace.prepend(transitionTrace);
-                result.push_back(std::make_pair(curTrace,entry.second));
+        // update visits based on current target
+        std::vector<int> nextMissingVisits;
+        nextMissingVisits.reserve(frame.missingVisits.size());
+        for (unsigned int i = 0; i < frame.missingVisits.size(); ++i) {
+            if (terminationTuples[i].first->count(transition->getTarget()) == 0) {
+                nextMissingVisits.push_back(frame.missingVisits[i]);
+            } else {
+                nextMissingVisits.push_back(frame.missingVisits[i]-1);
             }
         }
-        return result;    
-    };
 
-    return helper(node,initialMissingVisits);
+        inputs.push_back(transition->getLabel()->getInput());
+        outputs.push_back(transition->getLabel()->getOutput());
+        if (!enter(transition->getTarget(), std::move(nextMissingVisits))) {
+            inputs.pop_back();
+            outputs.pop_back();
+        }
+    }
+}
+
+
+std::vector<std::pair<IOTrace, std::vector<std::shared_ptr<std::unordered_set<std::shared_ptr<FsmNode>>>>>> StrongReductionTestSuiteGenerator::calcTraversalSet(std::shared_ptr<FsmNode> node, int m) {
+    std::vector<std::pair<IOTrace, std::vector<std::shared_ptr<std::unordered_set<std::shared_ptr<FsmNode>>>>>> result;
+
+    forEachTraversalPath(node, m, [&result](const std::pair<IOTrace, std::vector<std::shared_ptr<std::unordered_set<std::shared_ptr<FsmNode>>>>>& entry) {
+        result.push_back(entry);
+    });
+
+    return result;
 }
 
 
@@ -479,7 +473,7 @@ std::shared_ptr<InputTree> StrongReductionTestSuiteGenerator::augmentToRDistSet(
     } 
 
     // this implementation currently uses no heuristic, just applied the pre-calculated r-dist set for n1 and n2
-    return rDistTrees[std::make_pair(n1,n2)];
+    return rDistTrees.at(std::make_pair(n1,n2));
 }
 
 
@@ -494,16 +488,15 @@ InputTree StrongReductionTestSuiteGenerator::initialTestSuite(int m) {
         result.addToRoot(v);
 
         auto vTrace = InputTrace(v,fsm->getPresentationLayer());
-        auto travSet = calcTraversalSet(node,m);
 
         LOG("VERBOSE_2") << "\tnode " << node->getId() << " with d-r sequence " << vTrace << endl;
 
 
         IOListContainer cont(fsm->getPresentationLayer());
-        for (auto trEntry : travSet) {
+        forEachTraversalPath(node, m, [&cont](const std::pair<IOTrace, std::vector<std::shared_ptr<std::unordered_set<std::shared_ptr<FsmNode>>>>>& trEntry) {
             cont.add(trEntry.first.getInputTrace());
             LOG("VERBOSE_2") << "\t\tadding " << trEntry.first << endl;
-        }
+        });
         result.addAfter(vTrace,cont);
 
         LOG("VERBOSE_2") << "\tintermediate result: " << endl << result << endl;        
@@ -519,7 +512,7 @@ void StrongReductionTestSuiteGenerator::updateTestSuite(const std::shared_ptr<Fs
     auto trace = nextElementOfD.first;
     auto rdSet = *nextElementOfD.second.cbegin();
     
-    auto vTrace = InputTrace(dReachingSequences[node],fsm->getPresentationLayer());
+    auto vTrace = InputTrace(dReachingSequences.at(node),fsm->getPresentationLayer());
 
     LOG("VERBOSE_2") << "update for node " << node->getId() << " (d-reached by " << vTrace << "), traversal-trace " << trace << " and set { ";
     for (auto n : *rdSet) { LOG("VERBOSE_2") << n->getId() << " "; }
@@ -582,7 +575,7 @@ void StrongReductionTestSuiteGenerator::updateTestSuite(const std::shared_ptr<Fs
         }
 
         for (auto drrdNode : drrdNodes) {
-            auto drTrace = InputTrace(dReachingSequences[drrdNode],fsm->getPresentationLayer());
+            auto drTrace = InputTrace(dReachingSequences.at(drrdNode),fsm->getPresentationLayer());
             LOG("VERBOSE_2") << "\tagainst d-r r-d node " << drrdNode->getId() << " with d-r sequence " << drTrace << endl;
 
             if (target1 == drrdNode) {
@@ -615,14 +608,14 @@ void StrongReductionTestSuiteGenerator::updateTestSuite(const std::shared_ptr<Fs
     for (auto drrdNode : drrdNodes) {
         drrdNodesVector.push_back(drrdNode);
     }
-    for (unsigned int i = 0; i < drrdNodesVector.size()-1; ++i) {
+    for (unsigned int i = 0; i + 1 < drrdNodesVector.size(); ++i) {
         auto drrdNode1 = drrdNodesVector[i];
-        auto drTrace1 = InputTrace(dReachingSequences[drrdNode1],fsm->getPresentationLayer());
+        auto drTrace1 = InputTrace(dReachingSequences.at(drrdNode1),fsm->getPresentationLayer());
         LOG("VERBOSE_2") << "\tcheck d-r node " << drrdNode1->getId() << " with d-r sequence " << drTrace1 << endl;
 
         for (unsigned int j = i+1; j < drrdNodesVector.size(); ++j) {
             auto drrdNode2 = drrdNodesVector[j];
-            auto drTrace2 = InputTrace(dReachingSequences[drrdNode2],fsm->getPresentationLayer());
+            auto drTrace2 = InputTrace(dReachingSequences.at(drrdNode2),fsm->getPresentationLayer());
             LOG("VERBOSE_2") << "\tagainst d-r node " << drrdNode2->getId() << " with d-r sequence " << drTrace2 << endl;
 
             if (drrdNode1 == drrdNode2) {
@@ -654,18 +647,51 @@ void StrongReductionTestSuiteGenerator::updateTestSuite(const std::shared_ptr<Fs
 InputTree StrongReductionTestSuiteGenerator::generateTestSuite(int m) {
     InputTree ts = initialTestSuite(m);        
 
-    // for all d-reachable states s ...
+    std::vector<std::shared_ptr<FsmNode>> drNodes;
     for (auto drEntry : dReachingSequences) {
-        auto node = drEntry.first;
-        auto travSet = calcTraversalSet(node,m);
+        drNodes.push_back(drEntry.first);
+    }
 
-        // ... and all (s,trace,rdSets) in Tr(s,m) ...
-        for (auto trEntry : travSet) {
+    std::unique_ptr<WorkStealingPool> pool;
+    if (numThreads != 1) {
+        pool.reset(new WorkStealingPool(numThreads));
+    }
 
-            // ... update the test suite via on-the-fly extension with r-distinguishing sets
-            updateTestSuite(node, trEntry, ts);
+    if (!pool || pool->getNumThreads() <= 1) {
+        // for all d-reachable states s ...
+        for (auto node : drNodes) {
+            // ... and all (s,trace,rdSets) in Tr(s,m) ...
+            forEachTraversalPath(node, m, [this,&node,&ts](const std::pair<IOTrace, std::vector<std::shared_ptr<std::unordered_set<std::shared_ptr<FsmNode>>>>>& trEntry) {
+                // ... update the test suite via on-the-fly extension with r-distinguishing sets
+                updateTestSuite(node, trEntry, ts);
+            });
+        }
+        return ts;
+    }
+
+    // The d-reachable states are distributed over the workers. Each worker
+    // extends its own copy of the initial test suite, and the copies are
+    // merged at the end. As a worker does not see the extensions added by
+    // the others, the result may contain more sequences than the one
+    // calculated sequentially, but it is complete for the same reasons:
+    // every extension r-distinguishes its pair within the worker's copy,
+    // which is contained in the union.
+    std::vector<std::shared_ptr<InputTree>> shards(pool->getNumThreads());
+    pool->run(drNodes.size(), [&](size_t i, unsigned int worker) {
+        if (!shards[worker]) {
+            shards[worker] = ts.Clone();
+        }
+        auto node = drNodes[i];
+        InputTree& shard = *shards[worker];
+        forEachTraversalPath(node, m, [this,&node,&shard](const std::pair<IOTrace, std::vector<std::shared_ptr<std::unordered_set<std::shared_ptr<FsmNode>>>>>& trEntry) {
+            updateTestSuite(node, trEntry, shard);
+        });
+    });
+
+    for (auto& shard : shards) {
+        if (shard) {
+            ts.unionTree(shard);
         }
     }
-    
     return ts;
-}
\ No newline at end of file
+}
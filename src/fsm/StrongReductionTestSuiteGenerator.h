@@ -6,6 +6,7 @@
 #ifndef FSM_FSM_StrongReductionTestSuiteGenerator_H_
 #define FSM_FSM_StrongReductionTestSuiteGenerator_H_
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_set>
@@ -36,6 +37,9 @@ protected:
     
     const std::shared_ptr<Fsm> fsm;
 
+    /** Number of threads used in the calculations, 0 for the number of hardware threads */
+    const unsigned int numThreads;
+
     std::unordered_map<std::pair<std::shared_ptr<FsmNode>,std::shared_ptr<FsmNode>>, std::pair<int,std::shared_ptr<std::unordered_set<std::pair<std::shared_ptr<FsmNode>,std::shared_ptr<FsmNode>>>>>> rDistGraph;
     std::unordered_map<std::pair<std::shared_ptr<FsmNode>,std::shared_ptr<FsmNode>>, std::shared_ptr<InputTree>> rDistTrees;
     // NOTE: as we only consider input sequences and all targets of a d-reaching sequences for state q are q, we do not explicitly store V'
@@ -82,10 +86,8 @@ protected:
     void calcMaximalRDistinguishableSets();
 
     /**
-     * Calculates the set of all maximal sets of states of fsm that are pairwise r-distinguishable.
-     * 
-     * NOTE: performs a brute force calculation that should be replaced by
-     *       a more sophisticated algorithm to calculate maximal pairwise r-distinguishable sets.
+     * Calculates the set of all maximal sets of states of fsm that are pairwise r-distinguishable,
+     * as the maximal cliques of the r-distinguishability relation (see MaximalCliqueEnumerator).
      */
     void calcAllMaximalRDistinguishableSets();
 
@@ -103,8 +105,10 @@ public:
      *                                                r-distinguishable states of the FSM are computed.
      *                                                Otherwise for each state of the FSM only a single
      *                                                such set is computed.
+     * @param numThreads Number of threads used to calculate the maximal sets and by
+     *                   generateTestSuite(); if 0, the number of hardware threads is used.
      */
-    StrongReductionTestSuiteGenerator(const std::shared_ptr<Fsm> fsm, bool calculateAllMaximalRDistinguishableSets = false);
+    StrongReductionTestSuiteGenerator(const std::shared_ptr<Fsm> fsm, bool calculateAllMaximalRDistinguishableSets = false, unsigned int numThreads = 1);
 
     std::unordered_map<std::pair<std::shared_ptr<FsmNode>,std::shared_ptr<FsmNode>>, std::shared_ptr<InputTree>> getRDistinguishingTrees() const;
     std::unordered_map<std::shared_ptr<FsmNode>, std::vector<int>> getDeterministicallyReachingSequences() const;
@@ -118,6 +122,13 @@ public:
      */
     std::vector<std::pair<std::shared_ptr<std::unordered_set<std::shared_ptr<FsmNode>>>,int>> getTerminationTuples(int m);
 
+    /**
+     * Call visit for every element of the traversal set T(s,m), in the order of
+     * calcTraversalSet(), without materialising the set. The paths are enumerated
+     * by a depth-first search on an explicit stack.
+     */
+    void forEachTraversalPath(std::shared_ptr<FsmNode> node, int m, const std::function<void(const std::pair<IOTrace, std::vector<std::shared_ptr<std::unordered_set<std::shared_ptr<FsmNode>>>>>&)>& visit);
+
     /**
      * Generate the traversal set T(s,m).
      */
@@ -143,6 +154,11 @@ public:
 
     /**
      * Generate an m-complete test suite for fsm.
+     *
+     * The traversal paths are passed to updateTestSuite() as they are enumerated.
+     * If more than one thread is used, the d-reachable states are processed
+     * concurrently on per-thread copies of the initial test suite, which are
+     * merged at the end; the result may then contain additional sequences.
      */ 
     InputTree generateTestSuite(int m);
 };
@@ -0,0 +1,137 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "fsm/SubsetConstruction.h"
+#include "fsm/Fsm.h"
+#include "fsm/FsmNode.h"
+#include "fsm/FsmLabel.h"
+#include "fsm/FsmTransition.h"
+
+using namespace std;
+
+size_t SubsetConstruction::StateSetHash::operator()(const vector<int>& set) const
+{
+    // Combine the elements with the 64-bit finaliser of splitmix64,
+    // so that sets differing in a single element get unrelated hashes
+    uint64_t h = set.size();
+    for ( int s : set ) {
+        h += 0x9e3779b97f4a7c15ULL + static_cast<uint32_t>(s);
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+        h = h ^ (h >> 31);
+    }
+    return static_cast<size_t>(h);
+}
+
+SubsetConstruction::SubsetConstruction(const Fsm& fsm)
+: numOutputs(fsm.getMaxOutput() + 1)
+{
+    vector<shared_ptr<FsmNode>> nodes = fsm.getNodes();
+
+    unordered_map<const FsmNode*, int> node2Pos;
+    for ( size_t s = 0; s < nodes.size(); s++ ) {
+        if ( nodes[s] == nullptr ) continue;
+        node2Pos[nodes[s].get()] = static_cast<int>(s);
+    }
+
+    trOffsets.push_back(0);
+    vector<pair<int,int>> trs;
+    for ( const auto& n : nodes ) {
+        // Models with gaps in their state ids have null entries in
+        // the node list, which get empty rows of transitions
+        trs.clear();
+        if ( n == nullptr ) {
+            trOffsets.push_back(trLabel.size());
+            continue;
+        }
+        for ( const auto& tr : n->getTransitions() ) {
+            int x = tr->getLabel()->getInput();
+            int y = tr->getLabel()->getOutput();
+            if ( x < 0 or x > fsm.getMaxInput() or y < 0 or y >= numOutputs ) continue;
+            trs.push_back(make_pair(x * numOutputs + y, node2Pos.at(tr->getTarget().get())));
+        }
+        sort(trs.begin(), trs.end());
+        trs.erase(unique(trs.begin(), trs.end()), trs.end());
+        for ( const auto& t : trs ) {
+            trLabel.push_back(t.first);
+            trTarget.push_back(t.second);
+        }
+        trOffsets.push_back(trLabel.size());
+    }
+
+    intern(vector<int> { fsm.getInitStateIdx() });
+}
+
+int SubsetConstruction::intern(const vector<int>& set)
+{
+    auto ins = index.insert(make_pair(set, size()));
+    if ( ins.second ) {
+        stateSets.push_back(&ins.first->first);
+        transitions.emplace_back();
+        expanded.push_back(false);
+    }
+    return ins.first->second;
+}
+
+void SubsetConstruction::expand(const int q)
+{
+    // Collect the transitions of all states comprised in q,
+    // grouped by their labels
+    vector<pair<int,int>> trs;
+    for ( int s : *stateSets[q] ) {
+        for ( size_t i = trOffsets[s]; i < trOffsets[s+1]; i++ ) {
+            trs.push_back(make_pair(trLabel[i], trTarget[i]));
+        }
+    }
+    sort(trs.begin(), trs.end());
+    trs.erase(unique(trs.begin(), trs.end()), trs.end());
+
+    vector<Transition> result;
+    vector<int> set;
+    for ( size_t i = 0; i < trs.size(); ) {
+        int lbl = trs[i].first;
+        set.clear();
+        for ( ; i < trs.size() and trs[i].first == lbl; i++ ) {
+            set.push_back(trs[i].second);
+        }
+        Transition t;
+        t.input = lbl / numOutputs;
+        t.output = lbl % numOutputs;
+        t.target = intern(set);
+        result.push_back(t);
+    }
+
+    transitions[q].swap(result);
+    expanded[q] = true;
+}
+
+const vector<SubsetConstruction::Transition>& SubsetConstruction::getTransitions(const int q)
+{
+    if ( not expanded.at(q) ) expand(q);
+    return transitions[q];
+}
+
+int SubsetConstruction::after(const int q, const int x, const int y)
+{
+    const vector<Transition>& trs = getTransitions(q);
+    auto it = lower_bound(trs.begin(), trs.end(), make_pair(x, y),
+                          [](const Transition& t, const pair<int,int>& lbl) {
+                              return make_pair(t.input, t.output) < lbl;
+                          });
+    if ( it == trs.end() or it->input != x or it->output != y ) return -1;
+    return it->target;
+}
+
+void SubsetConstruction::exploreAll()
+{
+    for ( int q = 0; q < size(); q++ ) {
+        if ( not expanded[q] ) expand(q);
+    }
+}
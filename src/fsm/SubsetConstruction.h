@@ -0,0 +1,119 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_FSM_SUBSETCONSTRUCTION_H_
+#define FSM_FSM_SUBSETCONSTRUCTION_H_
+
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+
+class Fsm;
+
+/**
+ *  Subset construction for the observable FSM accepting the same language
+ *  as a (possibly non-observable) FSM.
+ *
+ *  Every state of the observable FSM is identified by the set of states
+ *  of the original FSM comprised in it, represented as an ascending vector
+ *  of the positions of these states in the node list of the original FSM.
+ *  The sets are interned in a hash table, so that each set is stored once
+ *  and a state is found in constant expected time.
+ *
+ *  States are explored on the fly: the outgoing transitions of a state
+ *  are only calculated when they are requested by getTransitions() or
+ *  after(). Exploring the states in ascending order of their ids yields
+ *  the breadth-first numbering used by Fsm::transformToObservableFSM().
+ */
+class SubsetConstruction
+{
+public:
+
+    /** A transition of the observable FSM */
+    struct Transition
+    {
+        int input;
+        int output;
+        int target;
+    };
+
+private:
+
+    /** Hash function for sorted state sets */
+    struct StateSetHash
+    {
+        size_t operator()(const std::vector<int>& set) const;
+    };
+
+    /** Number of outputs of the original FSM */
+    int numOutputs;
+
+    /**
+     *  Transitions of state s of the original FSM, sorted by label
+     *  code x * numOutputs + y and target, are stored at positions
+     *  trOffsets[s]..trOffsets[s+1]-1
+     */
+    std::vector<size_t> trOffsets;
+    std::vector<int> trLabel;
+    std::vector<int> trTarget;
+
+    /** Interned state sets, mapped to their state ids */
+    std::unordered_map<std::vector<int>, int, StateSetHash> index;
+
+    /** State set of each state id, pointing to the keys of the index */
+    std::vector<const std::vector<int>*> stateSets;
+
+    /** Outgoing transitions of each state, sorted by input and output */
+    std::vector<std::vector<Transition>> transitions;
+
+    /** true for every state whose transitions have been calculated */
+    std::vector<bool> expanded;
+
+    /** Return the id of a state set, create a new state if necessary */
+    int intern(const std::vector<int>& set);
+
+    void expand(const int q);
+
+public:
+
+    /**
+     *  Prepare the subset construction for fsm. Only the initial
+     *  state of the observable FSM is created.
+     *  Transitions with labels outside the input and output ranges
+     *  of fsm are ignored.
+     */
+    explicit SubsetConstruction(const Fsm& fsm);
+
+    /** Id of the initial state, whose set contains just the initial state of fsm */
+    int getInitialState() const { return 0; }
+
+    /** Number of states of the observable FSM created so far */
+    int size() const { return static_cast<int>(stateSets.size()); }
+
+    /**
+     *  Positions of the states of the original FSM comprised in
+     *  state q, in ascending order
+     */
+    const std::vector<int>& getStateSet(const int q) const { return *stateSets.at(q); }
+
+    /**
+     *  Outgoing transitions of state q, sorted by input and output.
+     *  Target states are created if they do not exist yet.
+     *  The reference is only valid until the next state is expanded.
+     */
+    const std::vector<Transition>& getTransitions(const int q);
+
+    /**
+     *  Return the state reached from q by a transition labelled x/y,
+     *  or -1 if q has no such transition
+     */
+    int after(const int q, const int x, const int y);
+
+    /** Create all states reachable from the initial state */
+    void exploreAll();
+
+};
+
+#endif //FSM_FSM_SUBSETCONSTRUCTION_H_
@@ -4,13 +4,14 @@
  * Licensed under the EUPL V.1.1
  */
 #include <sstream>
+#include <algorithm>
 
 #include "fsm/Trace.h"
 #include "fsm/FsmLabel.h"
 #include "utils/Logger.hpp"
 
 Trace::Trace(const std::shared_ptr<FsmPresentationLayer const>& presentationLayer)
-	: presentationLayer(presentationLayer)
+	: presentationLayer(presentationLayer), hashValue(0)
 {
 
 }
@@ -18,11 +19,12 @@ Trace::Trace(const std::shared_ptr<FsmPresentationLayer const>& presentationLaye
 Trace::Trace(const std::vector<int>& trace, const std::shared_ptr<FsmPresentationLayer const>& presentationLayer)
 	: trace(trace), presentationLayer(presentationLayer)
 {
+    rehash();
 
 }
 
 Trace::Trace(const Trace& other):
-    trace(other.trace), presentationLayer(other.presentationLayer)
+    trace(other.trace), presentationLayer(other.presentationLayer), hashValue(other.hashValue)
 {
 
 }
@@ -33,12 +35,13 @@ Trace::Trace(const std::vector<int>::const_iterator& begin,
     : presentationLayer(presentationLayer)
 {
     trace = std::vector<int>(begin, end);
+    rehash();
 }
 
 Trace::Trace(const Trace& other, size_t n, bool defaultToEmpty):
     presentationLayer(other.presentationLayer)
 {
-    std::vector<int> otherTrace = other.get();
+    const std::vector<int>& otherTrace = other.trace;
     if (otherTrace.size() == 0)
     {
         if (defaultToEmpty)
@@ -60,31 +63,44 @@ Trace::Trace(const Trace& other, size_t n, bool defaultToEmpty):
             trace = std::vector<int>(otherTrace.begin() + static_cast<std::vector<int>::difference_type>(n), otherTrace.end());
         }
     }
+    rehash();
+}
+
+void Trace::rehash()
+{
+    hashValue = 0;
+    for (int e : trace)
+    {
+        hashValue = hashStep(hashValue, e);
+    }
 }
 
 void Trace::add(const int e)
 {
 	trace.push_back(e);
+    hashValue = hashStep(hashValue, e);
 }
 
 void Trace::append(const std::vector<int>& traceToAppend) {
     trace.reserve(trace.size() + traceToAppend.size());
     for ( size_t i = 0; i < traceToAppend.size(); i++ ) {
         trace.push_back(traceToAppend.at(i));
+        hashValue = hashStep(hashValue, traceToAppend.at(i));
     }
     
 }
 
 void Trace::prepend(const std::vector<int>& traceToPrepend) {
     trace.insert(trace.begin(), traceToPrepend.begin(), traceToPrepend.end());
+    rehash();
 }
 
 void Trace::append(const Trace& traceToAppend) {
-    append(traceToAppend.get());
+    append(traceToAppend.trace);
 }
 
 void Trace::prepend(const Trace& traceToPrepend) {
-    prepend(traceToPrepend.get());
+    prepend(traceToPrepend.trace);
 }
 
 Trace Trace::removeEpsilon() const
@@ -147,36 +163,20 @@ bool Trace::isPrefix(const Trace& other, bool proper, bool allowEmpty) const
         return false;
     }
 
-    if (otherCopy.get().size() > thisCopy.get().size())
+    if (otherCopy.trace.size() > thisCopy.trace.size())
     {
         return false;
     }
-    for (size_t i = 0; i < otherCopy.get().size(); ++i)
-    {
-        if (otherCopy.get().at(i) != thisCopy.get().at(i))
-        {
-            return false;
-        }
-    }
-    return true;
+    return std::equal(otherCopy.trace.begin(), otherCopy.trace.end(), thisCopy.trace.begin());
 }
 
 bool Trace::isSuffix(const Trace& other) const
 {
-    if (other.get().size() > trace.size())
+    if (other.trace.size() > trace.size())
     {
         return false;
     }
-    const int thisMax = static_cast<int>(get().size()) - 1;
-    const int otherMax = static_cast<int>(other.get().size()) - 1;
-    for (int i = 0; i <= otherMax ; ++i)
-    {
-        if (other.get().at(static_cast<size_t>(otherMax - i)) != trace.at(static_cast<size_t>(thisMax - i)))
-        {
-            return false;
-        }
-    }
-    return true;
+    return std::equal(other.trace.rbegin(), other.trace.rend(), trace.rbegin());
 }
 
 bool Trace::isPrefixOf(const Trace& other) const
@@ -223,7 +223,7 @@ Trace Trace::getSuffix(const Trace& prefix) const
     const Trace& thisCopy = removeEpsilon();
     const Trace& prefixCopy = prefix.removeEpsilon();
 
-    std::vector<int> newTrace(thisCopy.cbegin() + static_cast<std::vector<int>::difference_type>(prefixCopy.get().size()), thisCopy.cend());
+    std::vector<int> newTrace(thisCopy.cbegin() + static_cast<std::vector<int>::difference_type>(prefixCopy.trace.size()), thisCopy.cend());
     return Trace(newTrace, presentationLayer);
 }
 
@@ -237,6 +237,7 @@ void Trace::removeElements(int n)
     {
         trace.erase(trace.end() + n, trace.end());
     }
+    rehash();
 }
 
 std::vector<int> Trace::get() const
@@ -246,8 +247,7 @@ std::vector<int> Trace::get() const
 
 size_t Trace::size() const
 {
-    Trace tmp = this->removeEpsilon();
-    return tmp.trace.size();
+    return static_cast<size_t>(std::count_if(trace.begin(), trace.end(), [](int symbol) { return symbol != FsmLabel::EPSILON; }));
 }
 
 std::vector<int>::const_iterator Trace::cbegin() const
@@ -301,36 +301,18 @@ bool Trace::contains(const int io) const
 
 bool operator==(Trace const & trace1, Trace const & trace2)
 {
-	if (trace1.get().size() != trace2.get().size())
+    // Traces with different hash values differ, so that most
+    // comparisons of different traces take constant time
+	if (trace1.hashValue != trace2.hashValue)
 	{
 		return false;
 	}
-
-	for (unsigned int i = 0; i < trace1.get().size(); ++ i)
-	{
-		if (trace1.get().at(i) != trace2.get().at(i))
-		{
-			return false;
-		}
-	}
-	return true;
+	return trace1.trace == trace2.trace;
 }
 
 bool operator==(Trace const & trace1, std::vector<int> const & trace2)
 {
-    if (trace1.get().size() != trace2.size())
-    {
-        return false;
-    }
-
-    for (unsigned int i = 0; i < trace1.get().size(); ++ i)
-    {
-        if (trace1.get()[i] != trace2[i])
-        {
-            return false;
-        }
-    }
-    return true;
+    return trace1.trace == trace2;
 }
 
 bool Trace::operator<(Trace const &other) const {
@@ -356,6 +338,7 @@ Trace& Trace::operator=(Trace& other)
     {
         trace = other.trace;
         presentationLayer = other.presentationLayer;
+        hashValue = other.hashValue;
     }
     return *this;
 }
@@ -366,6 +349,7 @@ Trace& Trace::operator=(Trace&& other)
     {
         trace = std::move(other.trace);
         presentationLayer = std::move(other.presentationLayer);
+        hashValue = other.hashValue;
     }
     return *this;
 }
@@ -6,6 +6,7 @@
 #ifndef FSM_FSM_TRACE_H_
 #define FSM_FSM_TRACE_H_
 
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -24,6 +25,22 @@ protected:
 	*/
 	std::shared_ptr<FsmPresentationLayer const> presentationLayer;
 
+    /**
+     * Hash value of the trace, kept up-to-date by every modification.
+     * Appending symbols updates the hash in constant time per symbol.
+     */
+    size_t hashValue;
+
+    /** Combine the hash value of a trace with the next symbol */
+    static size_t hashStep(size_t seed, int e)
+    {
+        seed ^= std::hash<int>()(e) + 0x9e3779b9 + (seed<<6) + (seed>>2);
+        return seed;
+    }
+
+    /** Recalculate the hash value after the trace has been modified */
+    void rehash();
+
     Trace(const std::vector<int>::const_iterator& begin,
           const std::vector<int>::const_iterator& end,
           const std::shared_ptr<FsmPresentationLayer const>& presentationLayer);
@@ -138,6 +155,12 @@ public:
 
     size_t size() const;
 
+    /**
+     * @return The hash value of the trace, which is calculated when the trace
+     * is modified, so that hashing a trace takes constant time.
+     */
+    size_t getHash() const { return hashValue; }
+
 	/**
 	Getter for an iterator of the trace, pointing at the beginning
 	@return The iterator
@@ -199,21 +222,11 @@ namespace std {
     {
         size_t operator()(const Trace& trace) const
         {
-            std::hash<int> hasher;
-            size_t seed = 0;
-            for (int i : trace.get()) {
-                seed ^= hasher(i) + 0x9e3779b9 + (seed<<6) + (seed>>2);
-            }
-            return seed;
+            return trace.getHash();
         }
         size_t operator()(const shared_ptr<Trace>& trace) const
         {
-            std::hash<int> hasher;
-            size_t seed = 0;
-            for (int i : trace->get()) {
-                seed ^= hasher(i) + 0x9e3779b9 + (seed<<6) + (seed>>2);
-            }
-            return seed;
+            return trace->getHash();
         }
     };
     template <> struct equal_to<Trace>
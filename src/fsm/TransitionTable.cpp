@@ -0,0 +1,119 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include "fsm/TransitionTable.h"
+#include "fsm/FsmNode.h"
+#include "fsm/FsmTransition.h"
+#include "fsm/FsmLabel.h"
+
+using namespace std;
+
+TransitionTable::TransitionTable(const vector<shared_ptr<FsmNode>>& lst,
+                                 const int maxInput):
+numStates(static_cast<int>(lst.size())),
+numInputs(maxInput + 1),
+valid(true),
+createdAt(FsmNode::getModificationCount()),
+checkedAt(createdAt)
+{
+    nodes.reserve(lst.size());
+    for ( const auto& n : lst ) {
+        nodes.push_back(n.get());
+    }
+
+    // Check that the states are numbered consecutively and
+    // determine the number of inputs actually used
+    for ( int s = 0; s < numStates; s++ ) {
+        if ( lst[s] == nullptr or lst[s]->getId() != s ) {
+            valid = false;
+            break;
+        }
+        for ( auto tr : lst[s]->getTransitions() ) {
+            int x = tr->getLabel()->getInput();
+            auto tgtNode = tr->getTarget();
+            if ( x < 0 or tgtNode == nullptr
+                or tgtNode->getId() < 0 or tgtNode->getId() >= numStates ) {
+                valid = false;
+                break;
+            }
+            if ( x >= numInputs ) numInputs = x + 1;
+        }
+    }
+
+    if ( not valid or numInputs < 0 ) {
+        numStates = 0;
+        numInputs = 0;
+        offsets.push_back(0);
+        return;
+    }
+
+    // Count transitions per (state,input) and calculate the offsets
+    offsets.assign(static_cast<size_t>(numStates) * numInputs + 1, 0);
+    for ( int s = 0; s < numStates; s++ ) {
+        for ( auto tr : lst[s]->getTransitions() ) {
+            offsets[index(s,tr->getLabel()->getInput()) + 1]++;
+        }
+    }
+    for ( size_t i = 1; i < offsets.size(); i++ ) {
+        offsets[i] += offsets[i-1];
+    }
+
+    // Fill the entries, preserving the order of the transitions
+    entries.resize(offsets.back());
+    vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+    for ( int s = 0; s < numStates; s++ ) {
+        for ( auto tr : lst[s]->getTransitions() ) {
+            int x = tr->getLabel()->getInput();
+            Entry& e = entries[fill[index(s,x)]++];
+            e.output = tr->getLabel()->getOutput();
+            e.target = tr->getTarget()->getId();
+        }
+    }
+
+}
+
+bool TransitionTable::isCurrent(const vector<shared_ptr<FsmNode>>& lst) const
+{
+    if ( lst.size() != nodes.size() ) return false;
+    for ( size_t i = 0; i < lst.size(); i++ ) {
+        if ( lst[i].get() != nodes[i] ) return false;
+    }
+
+    // The stamps only need to be inspected if some node has been
+    // modified since the last check
+    uint64_t now = FsmNode::getModificationCount();
+    if ( now == checkedAt.load() ) return true;
+    for ( const auto& n : lst ) {
+        if ( n != nullptr and n->getModificationStamp() > createdAt ) return false;
+    }
+    checkedAt.store(now);
+    return true;
+}
+
+int TransitionTable::after(const int s, const int x, const int y) const
+{
+    for ( const Entry* e = begin(s,x); e != end(s,x); ++e ) {
+        if ( e->output == y ) return e->target;
+    }
+    return -1;
+}
+
+void TransitionTable::after(const vector<int>& srcStates,
+                            const int x,
+                            const int y,
+                            vector<int>& tgtStates,
+                            vector<bool>& mark) const
+{
+    tgtStates.clear();
+    for ( int s : srcStates ) {
+        for ( const Entry* e = begin(s,x); e != end(s,x); ++e ) {
+            if ( y != FsmLabel::EPSILON and e->output != y ) continue;
+            if ( mark[e->target] ) continue;
+            mark[e->target] = true;
+            tgtStates.push_back(e->target);
+        }
+    }
+    for ( int t : tgtStates ) mark[t] = false;
+}
@@ -0,0 +1,182 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_FSM_TRANSITIONTABLE_H_
+#define FSM_FSM_TRANSITIONTABLE_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+class FsmNode;
+
+/**
+ *  Compact, index-based representation of the transition relation
+ *  of an FSM. For every state s and input x, the transitions
+ *  s --x/y--> s' are stored as a contiguous range of (output, target)
+ *  pairs in a single array (compressed sparse row layout), so that
+ *  following a transition does not require any pointer chasing or
+ *  reference counting.
+ *
+ *  Within each range, the transitions occur in the same order as in
+ *  the transition list of the corresponding FsmNode. Therefore, every
+ *  algorithm iterating over the table produces its results in the same
+ *  order as the corresponding algorithm working on the FsmNode graph.
+ *
+ *  The table is a read-only snapshot: it is not updated when the
+ *  FsmNode graph it has been created from is modified afterwards.
+ *  Whether this has happened can be checked by means of isCurrent(),
+ *  which relies on the modification stamps of the nodes.
+ */
+class TransitionTable
+{
+public:
+
+    /** A single transition s --x/output--> target */
+    struct Entry
+    {
+        int output;
+        int target;
+    };
+
+private:
+
+    /** Number of states, the states are numbered 0..numStates-1 */
+    int numStates;
+
+    /** Number of inputs, the inputs are numbered 0..numInputs-1 */
+    int numInputs;
+
+    /**
+     *  offsets[s*numInputs + x] is the index of the first entry
+     *  for state s and input x; the range ends at offsets[s*numInputs + x + 1]
+     */
+    std::vector<size_t> offsets;
+
+    /** All transitions, grouped by (state, input) */
+    std::vector<Entry> entries;
+
+    /** false, if the FsmNode graph could not be represented by the table */
+    bool valid;
+
+    /** The states the table has been created from */
+    std::vector<const FsmNode*> nodes;
+
+    /** FsmNode::getModificationCount() when the table has been created */
+    uint64_t createdAt;
+
+    /**
+     *  FsmNode::getModificationCount() when isCurrent() has found
+     *  the table up to date the last time
+     */
+    mutable std::atomic<uint64_t> checkedAt;
+
+    size_t index(const int s, const int x) const
+    {
+        return static_cast<size_t>(s) * static_cast<size_t>(numInputs)
+        + static_cast<size_t>(x);
+    }
+
+public:
+
+    /**
+     *  Create the table from the FSM states in lst.
+     *  @param lst FSM states, where lst[i] is expected to have id i
+     *  @param maxInput Maximal value of the input alphabet in range 0..maxInput
+     *
+     *  If some state in lst is missing or its id does not coincide
+     *  with its position in lst, the table is marked as invalid
+     *  and must not be used.
+     */
+    TransitionTable(const std::vector<std::shared_ptr<FsmNode>>& lst,
+                    const int maxInput);
+
+    /** Return true if and only if the table represents the FSM states */
+    bool isValid() const { return valid; }
+
+    /**
+     *  Return true if the table has been created from the states in lst
+     *  and none of them has been modified since. This takes time linear
+     *  in the number of states; the modification stamps of the states are
+     *  only inspected if some FsmNode has been modified since the last check.
+     */
+    bool isCurrent(const std::vector<std::shared_ptr<FsmNode>>& lst) const;
+
+    /** Number of states represented in the table */
+    int getNumStates() const { return numStates; }
+
+    /** Number of inputs represented in the table */
+    int getNumInputs() const { return numInputs; }
+
+    /** Number of transitions represented in the table */
+    size_t getNumTransitions() const { return entries.size(); }
+
+    /**
+     *  Return pointer to first transition of state s with input x.
+     *  If the input is outside the range of the table, an empty
+     *  range is returned.
+     */
+    const Entry* begin(const int s, const int x) const
+    {
+        if ( x < 0 or x >= numInputs ) return nullptr;
+        return entries.data() + offsets[index(s,x)];
+    }
+
+    /** Return pointer behind the last transition of state s with input x */
+    const Entry* end(const int s, const int x) const
+    {
+        if ( x < 0 or x >= numInputs ) return nullptr;
+        return entries.data() + offsets[index(s,x) + 1];
+    }
+
+    /** Number of transitions of state s with input x */
+    size_t count(const int s, const int x) const
+    {
+        if ( x < 0 or x >= numInputs ) return 0;
+        return offsets[index(s,x) + 1] - offsets[index(s,x)];
+    }
+
+    /**
+     *  Apply input x in state s, using the first transition defined
+     *  for x (like FsmNode::apply()).
+     *  @param y On return, the output of the transition, if it exists
+     *  @return target state, or -1 if no transition is defined
+     */
+    int apply(const int s, const int x, int& y) const
+    {
+        if ( x < 0 or x >= numInputs ) return -1;
+        size_t i = offsets[index(s,x)];
+        if ( i == offsets[index(s,x) + 1] ) return -1;
+        y = entries[i].output;
+        return entries[i].target;
+    }
+
+    /**
+     *  Return the target of the first transition s --x/y--> s',
+     *  or -1 if no such transition exists.
+     */
+    int after(const int s, const int x, const int y) const;
+
+    /**
+     *  Calculate the set of states reachable from the states in
+     *  srcStates by applying input x. If y is not FsmLabel::EPSILON,
+     *  only transitions with output y are considered.
+     *  @param srcStates Source states, must not contain duplicates
+     *  @param tgtStates On return, the target states without duplicates,
+     *         in the order of their first occurrence
+     *  @param mark Scratch vector of size getNumStates(), initialised to false;
+     *         it is reset to false on return
+     */
+    void after(const std::vector<int>& srcStates,
+               const int x,
+               const int y,
+               std::vector<int>& tgtStates,
+               std::vector<bool>& mark) const;
+
+};
+
+#endif //FSM_FSM_TRANSITIONTABLE_H_
@@ -8,6 +8,9 @@
 #include <functional>
 #include <cassert>
 #include <algorithm>
+#include <deque>
+#include <map>
+#include <utility>
 
 //Base FSM type helper template
 //Does not provide any types, making template specialization for the FSM type necessary
@@ -71,6 +74,11 @@ std::vector<StateType> getStatesAfter(FSM &&fsm, InputTrace &&trace, struct FSM_
     return states;
 }
 
+template<typename FSM, typename StateType, typename Input>
+std::vector<typename std::decay<StateType>::type> getStatesAfterInput(FSM &&fsm, StateType &&state, Input &&input, struct FSM_t<Fsm>::tag) {
+    return state->after(input);
+}
+
 //TODO: When having template parameters setting the type for a return parameter, make sure it is a decayed type and a container type
 template<typename FSM, typename TestSuiteType>
 TestSuiteType getStateCover(FSM &&fsm, struct FSM_t<Fsm>::tag) {
@@ -115,8 +123,11 @@ bool isDistinguishingSequence(FSM &&fsm, StateType &&state1, StateType &&state2,
 template<typename FSM, typename InputTrace, typename StateType>
 InputTrace getDistinguishingSequence(FSM &&fsm, StateType &&state1, StateType &&state2, struct FSM_t<Dfsm>::tag) {
     //Assumption: There is a distinguishing sequence
-    fsm.calculateDistMatrix();
-    return *(fsm.getDistTraces(*state1, *state2).front());
+    if(!fsm.hasCurrentDistMatrix()) {
+        fsm.calculateDistMatrix();
+    }
+    auto distTraces = fsm.getDistTraces(*state1, *state2);
+    return *(distTraces.front());
 }
 template<typename FSM, typename InputTrace, typename StateType>
 std::vector<StateType> getStatesAfter(FSM &&fsm, InputTrace &&trace, struct FSM_t<Dfsm>::tag) {
@@ -126,6 +137,11 @@ std::vector<StateType> getStatesAfter(FSM &&fsm, InputTrace &&trace, struct FSM_
     return states;
 }
 
+template<typename FSM, typename StateType, typename Input>
+std::vector<typename std::decay<StateType>::type> getStatesAfterInput(FSM &&fsm, StateType &&state, Input &&input, struct FSM_t<Dfsm>::tag) {
+    return state->after(input);
+}
+
 //TODO: When having template parameters setting the type for a return parameter, make sure it is a decayed type and a container type
 template<typename FSM, typename TestSuiteType>
 TestSuiteType getStateCover(FSM &&fsm, struct FSM_t<Dfsm>::tag) {
@@ -178,6 +194,11 @@ std::vector<StateType> getStatesAfter(FSM &&fsm, InputTrace &&trace) {
     struct FSM_t<typename std::decay<FSM>::type>::tag tag;
     return getStatesAfter<FSM, InputTrace, StateType>(std::forward<FSM>(fsm), std::forward<InputTrace>(trace), tag);
 }
+template<typename FSM, typename StateType, typename Input>
+std::vector<typename std::decay<StateType>::type> getStatesAfterInput(FSM &&fsm, StateType &&state, Input &&input) {
+    struct FSM_t<typename std::decay<FSM>::type>::tag tag;
+    return getStatesAfterInput(std::forward<FSM>(fsm), std::forward<StateType>(state), std::forward<Input>(input), tag);
+}
 template<typename FSM, typename TestSuiteType = std::vector<std::vector<typename FSM_t<typename std::decay<FSM>::type>::InputType>>>
 TestSuiteType getStateCover(FSM &&fsm) {
     struct FSM_t<typename std::decay<FSM>::type>::tag tag;
@@ -326,59 +347,291 @@ void addDistinguishingSequencesIfNotAlreadyContained(FSM &&fsm,
 
 
 
-template<typename FSM, typename TestSuiteType = std::vector<std::vector<typename FSM_t<typename std::decay<FSM>::type>::InputType>>>
+//Test suite container of generateHMethodTestSuite storing the test cases in a prefix trie,
+//so that containment checks and the search for common suffixes only visit the affected subtrees
+template<typename Input>
+class HMethodSuiteTrie {
+public:
+    typedef std::vector<Input> TraceType;
+
+    HMethodSuiteTrie() : nodes(1) {}
+
+    //Insert trace, return false if it is already contained
+    bool insert(TraceType const &trace) {
+        size_t node = root;
+        for(auto const &symbol : trace) {
+            size_t next = child(node, symbol);
+            if(next == none) {
+                next = nodes.size();
+                nodes.emplace_back();
+                nodes[node].children.emplace_back(symbol, next);
+            }
+            node = next;
+        }
+        bool inserted = not nodes[node].contained;
+        nodes[node].contained = true;
+        return inserted;
+    }
+
+    bool contains(TraceType const &trace) const {
+        size_t node = find(trace);
+        return node != none and nodes[node].contained;
+    }
+
+    //Return true if predicate holds for some suffix such that both prefix1.suffix and prefix2.suffix are contained
+    template<typename Predicate>
+    bool anyCommonSuffix(TraceType const &prefix1, TraceType const &prefix2, Predicate &&predicate) const {
+        size_t node1 = find(prefix1);
+        size_t node2 = find(prefix2);
+        if(node1 == none or node2 == none) {
+            return false;
+        }
+        TraceType suffix;
+        return anyCommonSuffix(node1, node2, suffix, predicate);
+    }
+
+    //Copy the test cases that are no proper prefix of another test case, in depth-first order of the trie
+    template<typename InsertIterator>
+    void copyMaximalTraces(InsertIterator &&inserter) const {
+        TraceType trace;
+        copyMaximalTraces(root, trace, inserter);
+    }
+
+private:
+    struct Node {
+        std::vector<std::pair<Input, size_t>> children;
+        bool contained = false;
+    };
+
+    static const size_t root = 0;
+    static const size_t none = static_cast<size_t>(-1);
+
+    std::vector<Node> nodes;
+
+    size_t child(size_t node, Input const &symbol) const {
+        for(auto const &edge : nodes[node].children) {
+            if(edge.first == symbol) {
+                return edge.second;
+            }
+        }
+        return none;
+    }
+
+    size_t find(TraceType const &trace) const {
+        size_t node = root;
+        for(auto const &symbol : trace) {
+            node = child(node, symbol);
+            if(node == none) {
+                return none;
+            }
+        }
+        return node;
+    }
+
+    template<typename Predicate>
+    bool anyCommonSuffix(size_t node1, size_t node2, TraceType &suffix, Predicate &predicate) const {
+        if(nodes[node1].contained and nodes[node2].contained and predicate(suffix)) {
+            return true;
+        }
+        for(auto const &edge : nodes[node1].children) {
+            size_t next2 = child(node2, edge.first);
+            if(next2 == none) {
+                continue;
+            }
+            suffix.push_back(edge.first);
+            bool found = anyCommonSuffix(edge.second, next2, suffix, predicate);
+            suffix.pop_back();
+            if(found) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template<typename InsertIterator>
+    void copyMaximalTraces(size_t node, TraceType &trace, InsertIterator &inserter) const {
+        if(nodes[node].children.empty()) {
+            if(nodes[node].contained) {
+                *inserter = trace;
+            }
+            return;
+        }
+        for(auto const &edge : nodes[node].children) {
+            trace.push_back(edge.first);
+            copyMaximalTraces(edge.second, trace, inserter);
+            trace.pop_back();
+        }
+    }
+};
+
+//Test suite container of generateHMethodTestSuite storing the test cases in a list in order of their insertion
+template<typename Input>
+class HMethodSuiteList {
+public:
+    typedef std::vector<Input> TraceType;
+
+    bool insert(TraceType const &trace) {
+        if(contains(trace)) {
+            return false;
+        }
+        traces.push_back(trace);
+        return true;
+    }
+
+    bool contains(TraceType const &trace) const {
+        return std::find(traces.begin(), traces.end(), trace) != traces.end();
+    }
+
+    template<typename Predicate>
+    bool anyCommonSuffix(TraceType const &prefix1, TraceType const &prefix2, Predicate &&predicate) const {
+        std::vector<TraceType> commonSuffixes;
+        copyCommonSuffixesOfSequencesInTestSuitePrefixedBySequences1And2(traces.begin(), traces.end(),
+                                                                         prefix1.begin(), prefix1.end(),
+                                                                         prefix2.begin(), prefix2.end(),
+                                                                         std::back_inserter(commonSuffixes));
+        return std::any_of(commonSuffixes.begin(), commonSuffixes.end(), std::forward<Predicate>(predicate));
+    }
+
+    template<typename InsertIterator>
+    void copyMaximalTraces(InsertIterator &&inserter) const {
+        std::copy_if(traces.begin(), traces.end(), std::forward<InsertIterator>(inserter), [this](TraceType const &potentialTestCase) {
+            return 1 >= std::count_if(traces.begin(), traces.end(), [&potentialTestCase](TraceType const &potentialSupersequence) {
+                return isPrefix(potentialTestCase.begin(), potentialTestCase.end(), potentialSupersequence.begin(), potentialSupersequence.end());
+            });
+        });
+    }
+
+private:
+    std::vector<TraceType> traces;
+};
+
+//States reached by input traces, memoised per node of a prefix trie of the traces.
+//The states after a trace are calculated from the states after its longest proper prefix,
+//so that no trace is replayed from the initial state.
+template<typename FSM>
+class HMethodStateCache {
+public:
+    typedef typename FSM_t<typename std::decay<FSM>::type>::InputType Input;
+    typedef typename FSM_t<typename std::decay<FSM>::type>::StateType StateType;
+    typedef std::vector<Input> TraceType;
+
+    explicit HMethodStateCache(typename std::remove_reference<FSM>::type &fsm) : fsm(fsm), nodes(1) {
+        nodes.front().states = getStatesAfter(fsm, TraceType());
+    }
+
+    //The reference remains valid while the cache grows
+    std::vector<StateType> const &statesAfter(TraceType const &trace) {
+        size_t node = 0;
+        for(auto const &symbol : trace) {
+            node = child(node, symbol);
+        }
+        return nodes[node].states;
+    }
+
+private:
+    struct Node {
+        std::vector<std::pair<Input, size_t>> children;
+        std::vector<StateType> states;
+    };
+
+    typename std::remove_reference<FSM>::type &fsm;
+
+    //A deque does not move its elements when growing
+    std::deque<Node> nodes;
+
+    size_t child(size_t node, Input const &symbol) {
+        for(auto const &edge : nodes[node].children) {
+            if(edge.first == symbol) {
+                return edge.second;
+            }
+        }
+        size_t next = nodes.size();
+        nodes.emplace_back();
+        //States are listed in order of their first occurrence, without duplicates
+        for(auto const &state : nodes[node].states) {
+            for(auto const &target : getStatesAfterInput(fsm, state, symbol)) {
+                if(std::find(nodes[next].states.begin(), nodes[next].states.end(), target) == nodes[next].states.end()) {
+                    nodes[next].states.push_back(target);
+                }
+            }
+        }
+        nodes[node].children.emplace_back(symbol, next);
+        return next;
+    }
+};
+
+//Call function(trace) for each extension of trace by length symbols of the input alphabet
+//that is defined in the FSM, in the order of the elements of getTracePower(alphabet, length).
+//As the H-method requires harmonized FSMs, an extension is defined if and only if it reaches some state.
+//Undefined prefixes are pruned, so that the power of the alphabet is never materialised.
+template<typename StateCache, typename IterableInputAlphabet, typename TraceType, typename Function>
+void forEachDefinedExtension(StateCache &states, IterableInputAlphabet const &inputAlphabet, TraceType &trace, unsigned int length, Function &&function) {
+    if(length == 0) {
+        function(static_cast<TraceType const &>(trace));
+        return;
+    }
+    for(auto const &symbol : inputAlphabet) {
+        trace.push_back(symbol);
+        if(not states.statesAfter(trace).empty()) {
+            forEachDefinedExtension(states, inputAlphabet, trace, length - 1, function);
+        }
+        trace.pop_back();
+    }
+}
+
+
+template<typename FSM,
+         typename TestSuiteType = std::vector<std::vector<typename FSM_t<typename std::decay<FSM>::type>::InputType>>,
+         typename SuiteContainer = HMethodSuiteTrie<typename FSM_t<typename std::decay<FSM>::type>::InputType>>
 TestSuiteType generateHMethodTestSuite(FSM &&specification, unsigned int additionalStates) {
+    typedef typename FSM_t<typename std::decay<FSM>::type>::InputType Input;
+    typedef typename FSM_t<typename std::decay<FSM>::type>::StateType StateType;
+    typedef std::vector<Input> TraceType;
+
     auto stateCover = getStateCover(specification);
-    auto inputAlphabet = getSingletonTraces(getInputAlphabet(specification));
+    auto inputAlphabet = getInputAlphabet(specification);
     //TODO: Check that each trace in stateCover covers a different state
 
-    std::vector<typename std::decay<decltype(getTracePower(inputAlphabet, 0))>::type> inputAlphabetPowers;
-    static_assert(std::is_same<typename std::decay<decltype(inputAlphabet)>::type, typename std::decay<typename decltype(inputAlphabetPowers)::value_type>::type>::value, "");
-    for(unsigned int power = 0; power <= additionalStates+1; ++power) {
-        inputAlphabetPowers.push_back(getTracePower(inputAlphabet, power));
-    }
+    HMethodStateCache<FSM> states(specification);
+    SuiteContainer testSuite;
+    std::map<std::pair<StateType, StateType>, TraceType> distinguishingSequences;
+
+    //Ensure that the test suite distinguishes all pairs of different states reached by sequence1 and sequence2
+    auto distinguish = [&](TraceType const &sequence1, TraceType const &sequence2) {
+        auto const &states1 = states.statesAfter(sequence1);
+        auto const &states2 = states.statesAfter(sequence2);
+        for(auto const &state1 : states1) {
+            for(auto const &state2 : states2) {
+                if(state1 != state2) {
+                    if(not testSuite.anyCommonSuffix(sequence1, sequence2, [&specification, &state1, &state2](TraceType const &suffix) {
+                        return isDistinguishingSequence(std::forward<FSM>(specification), state1, state2, suffix);
+                    })) {
+                        auto key = std::make_pair(state1, state2);
+                        auto distinguishingSequence = distinguishingSequences.find(key);
+                        if(distinguishingSequence == distinguishingSequences.end()) {
+                            distinguishingSequence = distinguishingSequences.emplace(key, getDistinguishingSequence(std::forward<FSM>(specification), state1, state2)).first;
+                        }
+                        auto const &w = distinguishingSequence->second;
+                        testSuite.insert(concatenateTraces(sequence1.begin(), sequence1.end(), w.begin(), w.end()));
+                        testSuite.insert(concatenateTraces(sequence2.begin(), sequence2.end(), w.begin(), w.end()));
+                    }
+                }
+            }
+        }
+    };
 
-    static_assert(std::is_same<typename std::decay<typename decltype(stateCover)::value_type>::type,
-                               typename std::decay<typename std::decay<decltype(inputAlphabetPowers.back())>::type::value_type>::type
-                  >::value, "");
-    auto testSuiteComplete = getTraceProduct(stateCover, inputAlphabetPowers.back());
-    static_assert(std::is_same<typename std::decay<decltype(*stateCover.begin())>::type, typename std::decay<decltype(*testSuiteComplete.begin())>::type>::value, "");
-    static_assert(std::is_same<typename std::decay<decltype(testSuiteComplete)>::type, typename std::decay<decltype(stateCover)>::type>::value, "");
-    decltype(testSuiteComplete) testSuiteDefined;
-    static_assert(std::is_same<typename std::decay<decltype(testSuiteDefined)>::type, typename std::decay<decltype(stateCover)>::type>::value, "");
-    std::copy_if(testSuiteComplete.begin(), testSuiteComplete.end(), std::back_inserter(testSuiteDefined),
-                    [&specification](decltype(*testSuiteComplete.begin()) const &testCase) {
-                        return inputTraceDefinedOnFSM(std::forward<FSM>(specification), testCase);
-    });
+    for(auto const &stateCoverSequence : stateCover) {
+        TraceType trace(stateCoverSequence.begin(), stateCoverSequence.end());
+        forEachDefinedExtension(states, inputAlphabet, trace, additionalStates+1, [&testSuite](TraceType const &testCase) {
+            testSuite.insert(testCase);
+        });
+    }
 
     for(auto const &stateCoverSequence1 : stateCover) {
         for(auto const &stateCoverSequence2 : stateCover) {
             if(stateCoverSequence1 != stateCoverSequence2) {
-                auto const &sequence1 = stateCoverSequence1;
-                auto const &sequence2 = stateCoverSequence2;
                 //Implicit assumption: state cover finally reaches states exactly once
-                auto states1 = getStatesAfter(std::forward<FSM>(specification), stateCoverSequence1);
-                auto states2 = getStatesAfter(std::forward<FSM>(specification), stateCoverSequence2);
-                for(auto const &state1 : states1) {
-                    for(auto const &state2 : states2) {
-                        if(state1 != state2) {
-                            decltype(stateCover) commonSuffixes;
-                            copyCommonSuffixesOfSequencesInTestSuitePrefixedBySequences1And2(testSuiteDefined.begin(), testSuiteDefined.end(),
-                                                                                             sequence1.begin(), sequence1.end(),
-                                                                                             sequence2.begin(), sequence2.end(),
-                                                                                             std::inserter(commonSuffixes, commonSuffixes.end()));
-                            if(std::none_of(commonSuffixes.begin(), commonSuffixes.end(), [&specification, &state1, &state2](decltype(*commonSuffixes.begin()) const &suffix) -> bool {
-                                return isDistinguishingSequence(std::forward<FSM>(specification), state1, state2, suffix);
-                            })) {
-                                addDistinguishingSequencesIfNotAlreadyContained(std::forward<FSM>(specification), state1, state2,
-                                                                                sequence1.begin(), sequence1.end(),
-                                                                                sequence2.begin(), sequence2.end(),
-                                                                                testSuiteDefined.begin(), testSuiteDefined.end(),
-                                                                                std::inserter(testSuiteDefined, testSuiteDefined.end()));
-                            }
-                        }
-                    }
-                }
+                distinguish(stateCoverSequence1, stateCoverSequence2);
             }
         }
     }
@@ -386,92 +639,32 @@ TestSuiteType generateHMethodTestSuite(FSM &&specification, unsigned int additio
     for(auto const &stateCoverSequence1 : stateCover) {
         //NOTE: Implicit (usually justified) assumption, that stateCover sequences are all defined
         //TODO: Encode all implicit assumptions appropriately as assert statements. Preferably using the GSL
-        auto baseStates = getStatesAfter(std::forward<FSM>(specification), stateCoverSequence1);
         for(auto const &stateCoverSequence2 : stateCover) {
-            for(auto const &power : inputAlphabetPowers) {
-                for(auto const &traceInAlphabetPower : power) {
-                    if(std::all_of(baseStates.begin(), baseStates.end(), [&specification, &traceInAlphabetPower](decltype(*baseStates.begin()) const &baseState) {
-                            return inputTraceDefinedOnState(std::forward<FSM>(specification), baseState, traceInAlphabetPower);
-                        })) {
-                        auto sequence1 = concatenateTraces(stateCoverSequence1.begin(), stateCoverSequence1.end(), traceInAlphabetPower.begin(), traceInAlphabetPower.end());
-                        auto const &sequence2 = stateCoverSequence2;
-                        auto states1 = getStatesAfter(std::forward<FSM>(specification), sequence1);
-                        auto states2 = getStatesAfter(std::forward<FSM>(specification), sequence2);
-                        for(auto const &state1 : states1) {
-                            for(auto const &state2 : states2) {
-                                if(state1 != state2) {
-                                    std::vector<decltype(sequence1)> commonSuffixes;
-                                    copyCommonSuffixesOfSequencesInTestSuitePrefixedBySequences1And2(testSuiteDefined.begin(), testSuiteDefined.end(),
-                                                                                                     sequence1.begin(), sequence1.end(),
-                                                                                                     sequence2.begin(), sequence2.end(),
-                                                                                                     std::inserter(commonSuffixes, commonSuffixes.end()));
-                                    if(std::none_of(commonSuffixes.begin(), commonSuffixes.end(), [&specification, &state1, &state2](typename std::decay<decltype(*commonSuffixes.begin())>::type const &suffix) {
-                                        return isDistinguishingSequence(std::forward<FSM>(specification), state1, state2, suffix);
-                                    })) {
-                                        addDistinguishingSequencesIfNotAlreadyContained(std::forward<FSM>(specification), state1, state2,
-                                                                                        sequence1.begin(), sequence1.end(),
-                                                                                        sequence2.begin(), sequence2.end(),
-                                                                                        testSuiteDefined.begin(), testSuiteDefined.end(),
-                                                                                        std::inserter(testSuiteDefined, testSuiteDefined.end()));
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
+            TraceType sequence2(stateCoverSequence2.begin(), stateCoverSequence2.end());
+            for(unsigned int power = 0; power <= additionalStates+1; ++power) {
+                TraceType trace(stateCoverSequence1.begin(), stateCoverSequence1.end());
+                forEachDefinedExtension(states, inputAlphabet, trace, power, [&distinguish, &sequence2](TraceType const &sequence1) {
+                    distinguish(sequence1, sequence2);
+                });
             }
         }
     }
 
     for(auto const &stateCoverSequence : stateCover) {
         //NOTE: Implicit (usually justified) assumption, that stateCover sequences are all defined
-        //TODO: Encode all implicit assumptions appropriately as assert statements. Preferably using the GSL
-        auto baseStates = getStatesAfter(std::forward<FSM>(specification), stateCoverSequence);
-        for(auto const &power : inputAlphabetPowers) {
-            for(auto const &traceInAlphabetPower : power) {
-                if(traceInAlphabetPower.size() > 0
-                   and std::all_of(baseStates.begin(), baseStates.end(), [&specification, &traceInAlphabetPower](decltype(*baseStates.begin()) const &baseState) {
-                            return inputTraceDefinedOnState(std::forward<FSM>(specification), baseState, traceInAlphabetPower);
-                        })) {
-                    for(auto iter = traceInAlphabetPower.begin() + 1; iter != traceInAlphabetPower.end(); ++iter) {
-                        auto sequence1 = concatenateTraces(stateCoverSequence.begin(), stateCoverSequence.end(), traceInAlphabetPower.begin(), traceInAlphabetPower.end());
-                        auto sequence2 = concatenateTraces(stateCoverSequence.begin(), stateCoverSequence.end(), traceInAlphabetPower.begin(), iter);
-                        auto states1 = getStatesAfter(std::forward<FSM>(specification), sequence1);
-                        auto states2 = getStatesAfter(std::forward<FSM>(specification), sequence2);
-                        for(auto const &state1 : states1) {
-                            for(auto const &state2 : states2) {
-                                if(state1 != state2) {
-                                    std::vector<decltype(sequence1)> commonSuffixes;
-                                    copyCommonSuffixesOfSequencesInTestSuitePrefixedBySequences1And2(testSuiteDefined.begin(), testSuiteDefined.end(),
-                                                                                                     sequence1.begin(), sequence1.end(),
-                                                                                                     sequence2.begin(), sequence2.end(),
-                                                                                                     std::inserter(commonSuffixes, commonSuffixes.end()));
-                                    if(std::none_of(commonSuffixes.begin(), commonSuffixes.end(), [&specification, &state1, &state2](typename std::decay<decltype(*commonSuffixes.begin())>::type const &suffix) {
-                                        return isDistinguishingSequence(std::forward<FSM>(specification), state1, state2, suffix);
-                                    })) {
-                                        addDistinguishingSequencesIfNotAlreadyContained(std::forward<FSM>(specification), state1, state2,
-                                                                                        sequence1.begin(), sequence1.end(),
-                                                                                        sequence2.begin(), sequence2.end(),
-                                                                                        testSuiteDefined.begin(), testSuiteDefined.end(),
-                                                                                        std::inserter(testSuiteDefined, testSuiteDefined.end()));
-                                    }
-                                }
-                            }
-                        }
-                    }
+        for(unsigned int power = 2; power <= additionalStates+1; ++power) {
+            TraceType trace(stateCoverSequence.begin(), stateCoverSequence.end());
+            forEachDefinedExtension(states, inputAlphabet, trace, power, [&distinguish, &stateCoverSequence, power](TraceType const &sequence1) {
+                for(unsigned int prefixLength = 1; prefixLength < power; ++prefixLength) {
+                    TraceType sequence2(sequence1.begin(), sequence1.begin() + stateCoverSequence.size() + prefixLength);
+                    distinguish(sequence1, sequence2);
                 }
-            }
+            });
         }
     }
 
-    decltype(testSuiteDefined) prefixFreeDefinedTestSuite;
-    std::copy_if(testSuiteDefined.begin(), testSuiteDefined.end(), std::inserter(prefixFreeDefinedTestSuite, prefixFreeDefinedTestSuite.end()),
-        [&testSuiteDefined](decltype(*testSuiteDefined.begin()) const &potentialTestCase) {
-        return 1 >= std::count_if(testSuiteDefined.begin(), testSuiteDefined.end(), [&potentialTestCase](decltype(*testSuiteDefined.begin()) const &potentialSupersequence) {
-            return isPrefix(potentialTestCase.begin(), potentialTestCase.end(), potentialSupersequence.begin(), potentialSupersequence.end());
-        });
-    });
-
+    TestSuiteType prefixFreeDefinedTestSuite;
+    testSuite.copyMaximalTraces(std::inserter(prefixFreeDefinedTestSuite, prefixFreeDefinedTestSuite.end()));
     return prefixFreeDefinedTestSuite;
 }
 
@@ -9,10 +9,12 @@
 #include <memory>
 #include <cstdlib>
 #include <cstring>
+#include <stdexcept>
 #include <utility>
 #include <unordered_map>
 
 #include "interface/FsmPresentationLayer.h"
+#include "fsm/BinaryFsm.h"
 #include "fsm/Dfsm.h"
 #include "fsm/PkTable.h"
 #include "fsm/FsmNode.h"
@@ -20,10 +22,12 @@
 #include "fsm/SegmentedTrace.h"
 #include "fsm/StrongReductionTestSuiteGenerator.h"
 
+#include "trees/BinaryTestSuite.h"
 #include "trees/IOListContainer.h"
 #include "trees/InputTree.h"
 #include "trees/OutputTree.h"
 #include "trees/TestSuite.h"
+#include "trees/TestCaseSink.h"
 #include "trees/TreeNode.h"
 
 #include "fsm/generalized-h-method.hpp"
@@ -41,7 +45,8 @@ using namespace Json;
 typedef enum {
     FSM_CSV,
     FSM_JSON,
-    FSM_BASIC
+    FSM_BASIC,
+    FSM_BINARY
 } model_type_t;
 
 typedef enum {
@@ -81,6 +86,13 @@ static shared_ptr<Fsm> fsmAbstraction = nullptr;
 
 static bool isDeterministic = false;
 static bool rttMbtStyle = false;
+static bool streaming = false;
+
+/** Write the test suite in binary format, see BinaryTestSuite */
+static bool binaryTestSuite = false;
+
+/** If not empty, the model is converted to binary format, see BinaryFsm */
+static string binaryModelFile;
 
 
 /**
@@ -89,8 +101,8 @@ static bool rttMbtStyle = false;
  */
 static void printUsage(char* name) {
     cerr << "usage: " << name
-    << " [-w|-wp|-h|-hsi|-sr|-spyh] [-s] [-n fsmname] [-p infile outfile statefile] "
-    << "[-a additionalstates] [-t testsuitename] [-rtt <prefix>] modelfile "
+    << " [-w|-wp|-h|-hsi|-sr|-spyh] [-s] [-stream] [-b] [-n fsmname] [-p infile outfile statefile] "
+    << "[-a additionalstates] [-t testsuitename] [-rtt <prefix>] [-convert binarymodelfile] modelfile "
     << "[model abstraction file]" << endl;
 }
 
@@ -107,9 +119,15 @@ static void printUsage(char* name) {
  *
  *  @return FSM_CSV, if the model file has extension .csv
  *
+ *  @return FSM_BINARY, if the model file is a binary model file
+ *
  */
 static model_type_t getModelType(const string& mf) {
     
+    if ( BinaryFsm::isBinaryFsm(mf) ) {
+        return FSM_BINARY;
+    }
+    
     if ( mf.find(".csv") != string::npos ) {
         return FSM_CSV;
     }
@@ -199,6 +217,22 @@ static void parseParameters(int argc, char* argv[]) {
                     break;
             }
         }
+        else if ( strcmp(argv[p],"-stream") == 0 ) {
+            streaming = true;
+        }
+        else if ( strcmp(argv[p],"-b") == 0 ) {
+            binaryTestSuite = true;
+        }
+        else if ( strcmp(argv[p],"-convert") == 0 ) {
+            if ( argc < p+2 ) {
+                cerr << argv[0] << ": missing name of binary model file" << endl;
+                printUsage(argv[0]);
+                exit(1);
+            }
+            else {
+                binaryModelFile = string(argv[++p]);
+            }
+        }
         else if ( strcmp(argv[p],"-n") == 0 ) {
             if ( argc < p+2 ) {
                 cerr << argv[0] << ": missing FSM name" << endl;
@@ -349,6 +383,25 @@ static void readModel(model_type_t mtp,
                 myFsm = nullptr;
             }
             break;
+            
+        case FSM_BINARY:
+            try {
+                BinaryFsm binFsm(thisFileName);
+                if ( binFsm.isDeterministic() ) {
+                    isDeterministic = true;
+                    myDfsm = binFsm.createDfsm();
+                    pl = myDfsm->getPresentationLayer();
+                }
+                else {
+                    myFsm = binFsm.createFsm();
+                    pl = myFsm->getPresentationLayer();
+                }
+            }
+            catch ( const exception& e ) {
+                cerr << e.what() << " - exit." << endl;
+                exit(1);
+            }
+            break;
     }
     
     if ( myFsm != nullptr ) {
@@ -397,6 +450,7 @@ static void readModelAbstraction(model_type_t mtp,
             break;
             
         case FSM_BASIC:
+        case FSM_BINARY:
             cerr << "ERROR. Model abstraction for SAFE W/WP/H METHOD may only be specified in CSV or JSON format - exit." << endl;
             exit(1);
             break;
@@ -1283,14 +1337,39 @@ static void safeWMethod(const shared_ptr<TestSuite> &testSuite) {
 }
 
 
+/**
+ *  Write the IO traces of ot to a binary test suite, in the
+ *  same way as they are written to text test suites.
+ */
+static void writeBinary(BinaryTestSuite::Writer& writer, OutputTree& ot) {
+    
+    vector<int> inVec = ot.getInputTrace().get();
+    IOListContainer iolc = ot.getIOLists();
+    for ( const auto& outVec : *iolc.getIOLists() ) {
+        vector<int> prefix(inVec.begin(),inVec.begin() + outVec.size());
+        writer.push(prefix,outVec);
+    }
+    
+}
+
 static void generateStrongReductionTestSuite() {
 
     StrongReductionTestSuiteGenerator gen(fsm,true);
     InputTree testSuite = gen.generateTestSuite(fsm->getNodes().size() + numAddStates);
 
-    ofstream out(testSuiteFileName);
-    out << testSuite;
-    out.close();
+    if ( binaryTestSuite ) {
+        BinaryTestSuite::Writer writer(testSuiteFileName,false);
+        IOListContainer iolc = testSuite.getIOLists();
+        for ( const auto& inVec : *iolc.getIOLists() ) {
+            writer.push(inVec);
+        }
+        writer.close();
+    }
+    else {
+        ofstream out(testSuiteFileName);
+        out << testSuite;
+        out.close();
+    }
     
     if ( rttMbtStyle ) {
         cout << "RTT-MBT style is not supported for strong reduction testing " << endl;        
@@ -1302,6 +1381,125 @@ static void generateStrongReductionTestSuite() {
 
 
 
+/**
+ *  Sink used in streaming mode: the expected outputs of every test
+ *  case are calculated and written as soon as the test case has been
+ *  generated, so that neither the input sequences nor the OutputTrees
+ *  of the complete test suite are kept in memory.
+ */
+class StreamingTestSuiteWriter : public TestCaseSink {
+private:
+    Fsm& m;
+    string fileName;
+    ofstream out;
+    unique_ptr<BinaryTestSuite::Writer> binOut;
+    size_t numTestCases;
+    size_t totalLength;
+    
+public:
+    StreamingTestSuiteWriter(Fsm& m, const string& fileName) :
+    m(m), fileName(fileName), numTestCases(0), totalLength(0) {
+        if ( binaryTestSuite ) {
+            binOut.reset(new BinaryTestSuite::Writer(fileName,true));
+        }
+        else {
+            out.open(fileName);
+            if ( not out.is_open() ) {
+                throw runtime_error("Could not create test suite file " + fileName);
+            }
+        }
+    }
+    
+    /** Complete the test suite file */
+    void close() {
+        if ( binOut != nullptr ) {
+            binOut->close();
+            return;
+        }
+        out.close();
+        if ( not out ) {
+            throw runtime_error("Could not write test suite file " + fileName);
+        }
+    }
+    
+    void push(const vector<int>& testCase) {
+        
+        InputTrace itrc(testCase,pl);
+        OutputTree ot = m.apply(itrc);
+        if ( binOut != nullptr ) {
+            writeBinary(*binOut,ot);
+        }
+        else {
+            out << ot;
+        }
+        
+        if ( rttMbtStyle ) {
+            vector<IOTrace> iotrcVec;
+            ot.toIOTrace(iotrcVec);
+            
+            for ( size_t iIdx = 0; iIdx < iotrcVec.size(); iIdx++ ) {
+                ostringstream tcFileName;
+                tcFileName << tcFilePrefix << numTestCases << "_" << iIdx << ".log";
+                ofstream outFile(tcFileName.str());
+                outFile << iotrcVec[iIdx].toRttString();
+                outFile.close();
+            }
+        }
+        
+        numTestCases++;
+        totalLength += testCase.size();
+    }
+    
+    size_t size() const { return numTestCases; }
+    size_t getTotalLength() const { return totalLength; }
+};
+
+/**
+ *  Streaming mode of the W-Method and the Wp-Method: the test suite
+ *  file is written while the test cases are generated.
+ */
+static void generateTestSuiteStreaming() {
+    
+    Fsm& m = (dfsm != nullptr) ? static_cast<Fsm&>(*dfsm) : *fsm;
+    
+    try {
+        StreamingTestSuiteWriter writer(m,testSuiteFileName);
+        
+        switch ( genMethod ) {
+            case WMETHOD:
+                if ( dfsm != nullptr ) {
+                    dfsm->wMethod(numAddStates,writer);
+                }
+                else {
+                    fsm->wMethod(numAddStates,writer);
+                }
+                break;
+                
+            case WPMETHOD:
+                if ( dfsm != nullptr ) {
+                    dfsm->wpMethod(numAddStates,writer);
+                }
+                else {
+                    fsm->wpMethod(numAddStates,writer);
+                }
+                break;
+                
+            default:
+                break;
+        }
+        
+        writer.close();
+        
+        cout << "Number of test cases: " << writer.size() << endl;
+        cout << "        total length: " << writer.getTotalLength() << endl;
+    }
+    catch ( const runtime_error& e ) {
+        cerr << e.what() << " - exit." << endl;
+        exit(1);
+    }
+}
+
+
 static void generateTestSuite() {
 
     // test suites for strong reduction are not represented using type
@@ -1311,6 +1509,14 @@ static void generateTestSuite() {
         generateStrongReductionTestSuite();
         return;
     }
+    
+    if ( streaming ) {
+        if ( genMethod == WMETHOD or genMethod == WPMETHOD ) {
+            generateTestSuiteStreaming();
+            return;
+        }
+        cout << "Streaming mode is only supported for the W-Method and the Wp-Method" << endl;
+    }
 
 
     shared_ptr<TestSuite> testSuite =
@@ -1431,7 +1637,16 @@ static void generateTestSuite() {
             return;
     }
     
-    testSuite->save(testSuiteFileName);
+    if ( binaryTestSuite ) {
+        BinaryTestSuite::Writer writer(testSuiteFileName,true);
+        for ( auto& ot : *testSuite ) {
+            writeBinary(writer,ot);
+        }
+        writer.close();
+    }
+    else {
+        testSuite->save(testSuiteFileName);
+    }
     
     if ( rttMbtStyle ) {
         int numTc = 0;
@@ -1464,6 +1679,23 @@ int main(int argc, char* argv[])
     parseParameters(argc,argv);
     readModel(modelType,modelFile,fsmName,fsm,dfsm);
     
+    if ( not binaryModelFile.empty() ) {
+        try {
+            if ( dfsm != nullptr ) {
+                BinaryFsm::write(*dfsm,binaryModelFile);
+            }
+            else {
+                BinaryFsm::write(*fsm,binaryModelFile);
+            }
+        }
+        catch ( const exception& e ) {
+            cerr << e.what() << " - exit." << endl;
+            exit(1);
+        }
+        cout << "Model written to " << binaryModelFile << endl;
+        exit(0);
+    }
+    
     if ( genMethod == SAFE_WPMETHOD or
         genMethod == SAFE_WMETHOD or
         genMethod == SAFE_HMETHOD) {
@@ -1,6 +1,19 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <time.h>
+
+/*
+ *  Parallel test execution creates the worker processes by fork(),
+ *  which is not available on Windows, where the test cases are
+ *  always executed sequentially.
+ */
+#ifndef _WIN32
+#define HAVE_WORKER_PROCESSES 1
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
 
 
 extern void sut_init();
@@ -10,6 +23,45 @@ extern void sut_reset();
 extern const char* sut(const char* input);
 
 
+/** Maximal number of worker processes */
+#define MAX_WORKERS 256
+
+
+#ifdef HAVE_WORKER_PROCESSES
+
+/**
+ *  Record written by a worker process for each test case it executes:
+ *  the output of the test case, including everything the SUT prints
+ *  while executing it, occupies bytes begin..end-1 of the output of the
+ *  worker.
+ */
+typedef struct {
+    long begin;
+    long end;
+    int pass;
+} TestCaseRecord;
+
+
+/** Current position in the output, where stdout must refer to a file */
+long outputPosition() {
+    fflush(stdout);
+    return (long)lseek(STDOUT_FILENO,0,SEEK_CUR);
+}
+
+#endif
+
+
+/** Wall clock time in seconds */
+double currentTime() {
+    struct timespec t;
+#ifdef _WIN32
+    timespec_get(&t,TIME_UTC);
+#else
+    clock_gettime(CLOCK_MONOTONIC,&t);
+#endif
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
 
 void getNextIO(char** p, char** x, char** y) {
     
@@ -41,7 +93,7 @@ void getNextIO(char** p, char** x, char** y) {
 
 
 
-void executeTestCase(const char* tcId, char* line) {
+int executeTestCase(const char* tcId, char* line) {
     
     char* p = line;
     char* x = 0;
@@ -59,7 +111,7 @@ void executeTestCase(const char* tcId, char* line) {
             if ( strcmp(r,y) != 0 ) {
                 printf(" after input %s: expected %s - observed %s: FAIL\n",
                        x,y,r);
-                return;
+                return 0;
             }
             else {
                 printf("(%s,%s)",x,r);
@@ -69,11 +121,20 @@ void executeTestCase(const char* tcId, char* line) {
     }
     
     printf(" PASS\n");
+    return 1;
     
 }
 
 
-void executeTestCases(const char* fname) {
+/**
+ *  Execute the test cases tcNum with tcNum % numWorkers == worker
+ *  @param records if not NULL, a TestCaseRecord is written to it for
+ *         every test case executed, where stdout must refer to a file
+ *         (only supported if HAVE_WORKER_PROCESSES is defined)
+ *  @return number of test cases passed
+ */
+int executeTestCases(const char* fname, int worker, int numWorkers,
+                     FILE* records, int* numTc) {
     
     const int lineSize = 100000;
     char* line = (char*)calloc(lineSize,1);
@@ -84,37 +145,242 @@ void executeTestCases(const char* fname) {
     }
     
     int tcNum = 0;
+    int numPass = 0;
     while ( fgets(line,lineSize,f) ) {
         
         size_t len = strlen(line);
         
         // Replace newline by null character
         if ( len > 1 ) {
+            if ( tcNum++ % numWorkers != worker ) continue;
             line[len-1] = 0;
             char tcId[100];
             *tcId = 0;
-            sprintf(tcId,"TC-%d: ",++tcNum);
-            executeTestCase(tcId,line);
+            sprintf(tcId,"TC-%d: ",tcNum);
+#ifdef HAVE_WORKER_PROCESSES
+            TestCaseRecord rec;
+            if ( records != NULL ) rec.begin = outputPosition();
+            rec.pass = executeTestCase(tcId,line);
+            numPass += rec.pass;
             sut_reset();
+            if ( records != NULL ) {
+                // Flush the record, so that it survives a crash
+                // of the SUT in a later test case
+                rec.end = outputPosition();
+                fwrite(&rec,sizeof(rec),1,records);
+                fflush(records);
+            }
+#else
+            (void)records;
+            numPass += executeTestCase(tcId,line);
+            sut_reset();
+#endif
         }
         
     }
     
+    fclose(f);
+    free(line);
+    *numTc = tcNum;
+    return numPass;
+    
+}
+
+
+#ifdef HAVE_WORKER_PROCESSES
+
+/** Number of test cases in the test suite file */
+int countTestCases(const char* fname) {
+    
+    const int lineSize = 100000;
+    char* line = (char*)calloc(lineSize,1);
+    FILE* f = fopen(fname,"r");
+    if ( f == NULL ) {
+        fprintf(stderr,"Could not open file %s - exit.\n",fname);
+        exit(1);
+    }
+    
+    int tcNum = 0;
+    while ( fgets(line,lineSize,f) ) {
+        if ( strlen(line) > 1 ) tcNum++;
+    }
+    
+    fclose(f);
+    free(line);
+    return tcNum;
+    
 }
 
 
+/**
+ *  Copy the output of the next test case executed by a worker to stdout
+ *  @param out output of the worker
+ *  @param records test case records of the worker
+ *  @return 1 if the test case passed, 0 if it failed,
+ *          -1 if the worker did not execute further test cases
+ */
+int copyResult(FILE* out, FILE* records) {
+    
+    TestCaseRecord rec;
+    if ( fread(&rec,sizeof(rec),1,records) != 1 ) return -1;
+    
+    char buf[4096];
+    long n = rec.end - rec.begin;
+    fseek(out,rec.begin,SEEK_SET);
+    while ( n > 0 ) {
+        size_t k = fread(buf,1,n < (long)sizeof(buf) ? (size_t)n : sizeof(buf),out);
+        if ( k == 0 ) break;
+        fwrite(buf,1,k,stdout);
+        n -= (long)k;
+    }
+    return rec.pass;
+    
+}
+
+
+/**
+ *  Shard the test suite across numWorkers processes, each of them
+ *  with its own SUT instance, and print the verdicts in the order
+ *  of the test suite file. If a worker terminates abnormally, the
+ *  test cases it has not completed fail.
+ *  @param numIncomplete On return, the number of test cases
+ *         that have not been completed
+ *  @return number of test cases passed
+ */
+int executeTestCasesParallel(const char* fname, int numWorkers, int* numTc,
+                             int* numIncomplete) {
+    
+    FILE* results[MAX_WORKERS];
+    FILE* records[MAX_WORKERS];
+    pid_t pids[MAX_WORKERS];
+    int w;
+    
+    fflush(stdout);
+    
+    for ( w = 0; w < numWorkers; w++ ) {
+        results[w] = tmpfile();
+        records[w] = tmpfile();
+        if ( results[w] == NULL || records[w] == NULL ) {
+            fprintf(stderr,"Could not create temporary file - exit.\n");
+            exit(1);
+        }
+        
+        pids[w] = fork();
+        if ( pids[w] < 0 ) {
+            fprintf(stderr,"Could not create worker process - exit.\n");
+            exit(1);
+        }
+        if ( pids[w] == 0 ) {
+            int n;
+            dup2(fileno(results[w]),STDOUT_FILENO);
+            sut_init();
+            executeTestCases(fname,w,numWorkers,records[w],&n);
+            fflush(stdout);
+            fflush(records[w]);
+            _exit(0);
+        }
+    }
+    
+    for ( w = 0; w < numWorkers; w++ ) {
+        int status;
+        if ( waitpid(pids[w],&status,0) < 0 ||
+             ! WIFEXITED(status) || WEXITSTATUS(status) != 0 ) {
+            fprintf(stderr,"Worker %d terminated abnormally.\n",w);
+        }
+        rewind(records[w]);
+    }
+    
+    // Test case number i has been executed by worker i % numWorkers.
+    // The records of a worker that has terminated abnormally end
+    // before its last test case.
+    int numPass = 0;
+    int tcNum;
+    *numTc = countTestCases(fname);
+    *numIncomplete = 0;
+    for ( tcNum = 0; tcNum < *numTc; tcNum++ ) {
+        int r = copyResult(results[tcNum % numWorkers],records[tcNum % numWorkers]);
+        if ( r < 0 ) {
+            printf("TC-%d: not completed by worker %d: FAIL\n",
+                   tcNum + 1, tcNum % numWorkers);
+            (*numIncomplete)++;
+            continue;
+        }
+        numPass += r;
+    }
+    
+    for ( w = 0; w < numWorkers; w++ ) {
+        fclose(results[w]);
+        fclose(records[w]);
+    }
+    
+    return numPass;
+    
+}
+
+#endif
+
+
 
 
 int main(int argc, char** argv) {
     
-    if ( argc < 2 ) {
+    int numWorkers = 1;
+    int p = 1;
+    
+    if ( argc > p+1 && strcmp(argv[p],"-j") == 0 ) {
+        char* end;
+        long n = strtol(argv[p+1],&end,10);
+        if ( end == argv[p+1] || *end != 0 || n < 1 ) {
+            fprintf(stderr,"Illegal number of workers %s - exit.\n",argv[p+1]);
+            fprintf(stderr,"usage: %s [-j numworkers] testsuite\n",argv[0]);
+            exit(1);
+        }
+        numWorkers = ( n > MAX_WORKERS ) ? MAX_WORKERS : (int)n;
+        p += 2;
+    }
+    
+#ifndef HAVE_WORKER_PROCESSES
+    if ( numWorkers > 1 ) {
+        fprintf(stderr,"Worker processes are not supported on this platform, "
+                "executing the test cases sequentially.\n");
+        numWorkers = 1;
+    }
+#endif
+    
+    if ( argc <= p ) {
         fprintf(stderr,"Missing file name of test suite file - exit.\n");
+        fprintf(stderr,"usage: %s [-j numworkers] testsuite\n",argv[0]);
         exit(1);
     }
     
-    sut_init();
+    double start = currentTime();
+    
+    int numTc;
+    int numPass;
+    int numIncomplete = 0;
+    if ( numWorkers == 1 ) {
+        sut_init();
+        numPass = executeTestCases(argv[p],0,1,NULL,&numTc);
+    }
+#ifdef HAVE_WORKER_PROCESSES
+    else {
+        numPass = executeTestCasesParallel(argv[p],numWorkers,&numTc,&numIncomplete);
+    }
+#endif
     
-    executeTestCases(argv[1]);
+    double secs = currentTime() - start;
+    
+    printf("\nNumber of test cases: %d\n",numTc);
+    printf("                PASS: %d\n",numPass);
+    printf("                FAIL: %d\n",numTc - numPass);
+    printf("          Throughput: %.1f test cases/s (%d workers)\n",
+           secs > 0 ? numTc / secs : 0.0, numWorkers);
+    
+    if ( numIncomplete > 0 ) {
+        printf("          Incomplete: %d (worker terminated abnormally)\n",
+               numIncomplete);
+        exit(1);
+    }
     
     exit(0);
     
@@ -5,25 +5,34 @@
  */
 
 #include <string>
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <limits>
 #include <chrono>
 #include <memory>
 #include <random>
+#include <stdexcept>
 #include <unordered_map>
 #include <stdlib.h>
 #include <interface/FsmPresentationLayer.h>
+#include <fsm/BinaryFsm.h>
+#include <fsm/CanonicalFsmEnumerator.h>
 #include <fsm/Dfsm.h>
 #include <fsm/Fsm.h>
 #include <fsm/FsmNode.h>
 #include <fsm/FsmTransition.h>
+#include <fsm/FsmLabel.h>
+#include <fsm/TransitionTable.h>
+#include <fsm/PkTable.h>
 #include <fsm/IOTrace.h>
 #include <fsm/IOTraceContainer.h>
 #include <fsm/FsmPrintVisitor.h>
 #include <fsm/FsmSimVisitor.h>
 #include <fsm/FsmOraVisitor.h>
+#include <trees/BinaryTestSuite.h>
 #include <trees/IOListContainer.h>
 #include <trees/IOTreeContainer.h>
 #include <trees/InputTree.h>
@@ -31,6 +40,7 @@
 #include <trees/TestSuite.h>
 #include "json/json.h"
 #include "utils/Logger.hpp"
+#include "utils/WorkStealingPool.hpp"
 
 #ifndef _WIN32
 #include <unistd.h>
@@ -256,6 +266,9 @@ struct AdaptiveTestConfig
     // The mutant has to comply with the given parameters.
     bool forceTestParameters = true;
     LoggingConfig loggingConfig;
+    // Number of threads executing the tests, 0 for all hardware threads.
+    // The results do not depend on the number of threads.
+    unsigned int numThreads = 0;
 };
 
 struct AdaptiveTestResult
@@ -1184,6 +1197,479 @@ void test16() {
 
 
 
+}
+
+/**
+ *  true if tbl contains the same transitions as a table created
+ *  from the current nodes of f
+ */
+static bool isCurrentTransitionTable(const Fsm& f,
+                                     const shared_ptr<TransitionTable>& tbl)
+{
+    TransitionTable fresh(f.getNodes(),f.getMaxInput());
+    if ( not fresh.isValid() ) return tbl == nullptr;
+    if ( tbl == nullptr ) return false;
+    if ( tbl->getNumStates() != fresh.getNumStates() or
+         tbl->getNumInputs() != fresh.getNumInputs() or
+         tbl->getNumTransitions() != fresh.getNumTransitions() ) {
+        return false;
+    }
+    for ( int s = 0; s < fresh.getNumStates(); s++ ) {
+        for ( int x = 0; x < fresh.getNumInputs(); x++ ) {
+            if ( tbl->count(s,x) != fresh.count(s,x) ) return false;
+            for ( size_t i = 0; i < fresh.count(s,x); i++ ) {
+                if ( tbl->begin(s,x)[i].output != fresh.begin(s,x)[i].output or
+                     tbl->begin(s,x)[i].target != fresh.begin(s,x)[i].target ) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void test17() {
+
+    cout << "TC-FSM-0017 Show that the transition table of an FSM follows "
+    << "modifications of its nodes and transitions"
+    << endl;
+
+    shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+    std::mt19937 gen(17);
+    Dfsm d("D",6,2,2,pl,gen);
+    vector<shared_ptr<FsmNode>> nodes = d.getNodes();
+
+    fsmlib_assert("TC-FSM-0017",
+                  isCurrentTransitionTable(d,d.getTransitionTable()),
+                  "Transition table represents the FSM");
+
+    // Redirect a transition
+    shared_ptr<FsmTransition> tr = nodes[0]->getTransitions().front();
+    shared_ptr<FsmNode> oldTgt = tr->getTarget();
+    tr->setTarget(nodes[(oldTgt->getId() + 1) % nodes.size()]);
+    fsmlib_assert("TC-FSM-0017",
+                  isCurrentTransitionTable(d,d.getTransitionTable()),
+                  "Transition table follows FsmTransition::setTarget()");
+
+    // Change the output of a transition
+    tr->setLabel(make_shared<FsmLabel>(tr->getLabel()->getInput(),
+                                       (tr->getLabel()->getOutput() + 1) % 3,
+                                       pl));
+    fsmlib_assert("TC-FSM-0017",
+                  isCurrentTransitionTable(d,d.getTransitionTable()),
+                  "Transition table follows FsmTransition::setLabel()");
+
+    // Remove a transition and add it again
+    nodes[0]->removeTransition(tr);
+    fsmlib_assert("TC-FSM-0017",
+                  isCurrentTransitionTable(d,d.getTransitionTable()),
+                  "Transition table follows FsmNode::removeTransition()");
+    nodes[0]->addTransition(tr);
+    fsmlib_assert("TC-FSM-0017",
+                  isCurrentTransitionTable(d,d.getTransitionTable()),
+                  "Transition table follows FsmNode::addTransition()");
+
+    // Replace the transitions of a node
+    vector<shared_ptr<FsmTransition>> trs = nodes[1]->getTransitions();
+    nodes[1]->setTransitions(vector<shared_ptr<FsmTransition>>(trs.rbegin(),trs.rend()));
+    fsmlib_assert("TC-FSM-0017",
+                  isCurrentTransitionTable(d,d.getTransitionTable()),
+                  "Transition table follows FsmNode::setTransitions()");
+
+    // Renumber two states, so that the table can no longer be used,
+    // and restore the numbering
+    nodes[2]->setId(3);
+    nodes[3]->setId(2);
+    fsmlib_assert("TC-FSM-0017",
+                  d.getTransitionTable() == nullptr,
+                  "Transition table follows FsmNode::setId()");
+    nodes[2]->setId(2);
+    nodes[3]->setId(3);
+    fsmlib_assert("TC-FSM-0017",
+                  isCurrentTransitionTable(d,d.getTransitionTable()),
+                  "Transition table follows FsmNode::setId()");
+
+    // Add a state reachable by a new transition
+    shared_ptr<FsmNode> n = d.addNode("new");
+    nodes[4]->addTransition(make_shared<FsmTransition>(nodes[4],n,
+                                                       make_shared<FsmLabel>(2,0,pl)));
+    fsmlib_assert("TC-FSM-0017",
+                  isCurrentTransitionTable(d,d.getTransitionTable()),
+                  "Transition table follows Fsm::addNode()");
+
+}
+
+void test18() {
+
+    cout << "TC-DFSM-0018 Show that the Pk-tables created on demand from a "
+    << "partition refinement coincide with the tables calculated table by table"
+    << endl;
+
+    shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+    std::mt19937 gen(18);
+
+    for ( int i = 0; i < 20; i++ ) {
+
+        Dfsm d("D",12,2,1,pl,gen);
+        Dfsm dPr(d);
+        dPr.setMinimisationMode(MinimisationMode::PartitionRefinement);
+        d.calcPkTables();
+        dPr.calcPkTables();
+
+        bool same = ( d.getNumPkTables() == dPr.getNumPkTables() );
+
+        // Request the last table first, then all the others
+        for ( size_t k = dPr.getNumPkTables(); same and k > 0; k-- ) {
+            shared_ptr<PkTable> pk = d.getPkTable(k-1);
+            shared_ptr<PkTable> pkPr = dPr.getPkTable(k-1);
+            for ( int s = 0; s < static_cast<int>(d.size()); s++ ) {
+                if ( pk->getClass(s) != pkPr->getClass(s) ) same = false;
+            }
+        }
+        fsmlib_assert("TC-DFSM-0018",
+                      same,
+                      "Pk-tables coincide");
+
+        Fsm f(d);
+        Fsm fPr(d);
+        fPr.setMinimisationMode(MinimisationMode::PartitionRefinement);
+        Fsm fMin = f.minimiseObservableFSM();
+        Fsm fPrMin = fPr.minimiseObservableFSM();
+        same = ( fMin.size() == fPrMin.size() );
+        for ( int s1 = 0; same and s1 < static_cast<int>(f.size()); s1++ ) {
+            for ( int s2 = s1 + 1; s2 < static_cast<int>(f.size()); s2++ ) {
+                if ( f.distinguishable(*f.getNodes()[s1],*f.getNodes()[s2]) !=
+                     fPr.distinguishable(*fPr.getNodes()[s1],*fPr.getNodes()[s2]) ) {
+                    same = false;
+                }
+            }
+        }
+        fsmlib_assert("TC-DFSM-0018",
+                      same,
+                      "OFSM-tables coincide");
+    }
+
+}
+
+/** True if f1 and f2 have the same states, transitions and names */
+static bool isSameFsm(const Fsm& f1, const Fsm& f2)
+{
+    if ( f1.getName() != f2.getName() or
+         f1.getMaxInput() != f2.getMaxInput() or
+         f1.getMaxOutput() != f2.getMaxOutput() or
+         f1.getMaxState() != f2.getMaxState() or
+         f1.getInitStateIdx() != f2.getInitStateIdx() or
+         f1.getNodes().size() != f2.getNodes().size() ) {
+        return false;
+    }
+    
+    shared_ptr<FsmPresentationLayer> pl1 = f1.getPresentationLayer();
+    shared_ptr<FsmPresentationLayer> pl2 = f2.getPresentationLayer();
+    if ( pl1->getIn2String() != pl2->getIn2String() or
+         pl1->getOut2String() != pl2->getOut2String() or
+         pl1->getState2String() != pl2->getState2String() ) {
+        return false;
+    }
+    
+    for ( size_t s = 0; s < f1.getNodes().size(); s++ ) {
+        shared_ptr<FsmNode> n1 = f1.getNodes()[s];
+        shared_ptr<FsmNode> n2 = f2.getNodes()[s];
+        if ( (n1 == nullptr) != (n2 == nullptr) ) return false;
+        if ( n1 == nullptr ) continue;
+        const vector<shared_ptr<FsmTransition>>& trs1 = n1->getTransitions();
+        const vector<shared_ptr<FsmTransition>>& trs2 = n2->getTransitions();
+        if ( n1->getId() != n2->getId() or trs1.size() != trs2.size() ) return false;
+        for ( size_t i = 0; i < trs1.size(); i++ ) {
+            if ( trs1[i]->getLabel()->getInput() != trs2[i]->getLabel()->getInput() or
+                 trs1[i]->getLabel()->getOutput() != trs2[i]->getLabel()->getOutput() or
+                 trs1[i]->getTarget()->getId() != trs2[i]->getTarget()->getId() ) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void test19() {
+    
+    cout << "TC-FSM-0019 Show that models and test suites written in binary "
+    << "format are read back unchanged"
+    << endl;
+    
+    const vector<string> models = { "garage", "fsmGillA7", "fsma", "fsmb",
+                                    "NN", "nondetnonmin", "card_reader" };
+    const vector<string> plModels = { "fsmGillA7", "fsma", "fsmb" };
+    
+    for ( const auto& m : models ) {
+        
+        string prefix = string(RESOURCES_DIR) + m;
+        shared_ptr<FsmPresentationLayer> pl;
+        if ( m == "garage" ) {
+            pl = make_shared<FsmPresentationLayer>(string(RESOURCES_DIR) + "garageIn.txt",
+                                                   string(RESOURCES_DIR) + "garageOut.txt",
+                                                   string(RESOURCES_DIR) + "garageState.txt");
+        }
+        else if ( find(plModels.begin(),plModels.end(),m) != plModels.end() ) {
+            pl = make_shared<FsmPresentationLayer>(prefix + ".in",
+                                                   prefix + ".out",
+                                                   prefix + ".state");
+        }
+        else {
+            pl = make_shared<FsmPresentationLayer>();
+        }
+        
+        Fsm f(prefix + ".fsm",pl,m);
+        BinaryFsm::write(f,"TC-FSM-0019.fsmb");
+        BinaryFsm bin("TC-FSM-0019.fsmb");
+        shared_ptr<Fsm> fBin = bin.createFsm();
+        
+        fsmlib_assert("TC-FSM-0019",
+                      isSameFsm(f,*fBin),
+                      m + ": model read from binary format equals the text model");
+        
+        IOListContainer iolc = f.wMethod(1);
+        IOListContainer iolcBin = fBin->wMethod(1);
+        fsmlib_assert("TC-FSM-0019",
+                      *iolc.getIOLists() == *iolcBin.getIOLists(),
+                      m + ": test suites of text and binary model coincide");
+        
+        {
+            BinaryTestSuite::Writer writer("TC-FSM-0019.tsb",false);
+            for ( const auto& inVec : *iolc.getIOLists() ) {
+                writer.push(inVec);
+            }
+            writer.close();
+        }
+        BinaryTestSuite ts("TC-FSM-0019.tsb");
+        bool same = ( not ts.hasOutputs() and ts.size() == static_cast<size_t>(iolc.size()) );
+        for ( size_t i = 0; same and i < ts.size(); i++ ) {
+            const vector<int>& inVec = iolc.getIOLists()->at(i);
+            same = ( vector<int>(ts.inputs(i),ts.inputs(i) + ts.length(i)) == inVec );
+        }
+        fsmlib_assert("TC-FSM-0019",
+                      same,
+                      m + ": input sequences read from binary test suite are unchanged");
+        
+        if ( f.isDeterministic() ) {
+            
+            Dfsm d(prefix + ".fsm",pl,m);
+            BinaryFsm::write(d,"TC-FSM-0019.fsmb");
+            BinaryFsm dBin("TC-FSM-0019.fsmb");
+            shared_ptr<Dfsm> dfsmBin = dBin.createDfsm();
+            fsmlib_assert("TC-FSM-0019",
+                          dBin.isDeterministic() and isSameFsm(d,*dfsmBin),
+                          m + ": DFSM read from binary format equals the text model");
+            fsmlib_assert("TC-FSM-0019",
+                          *d.wMethod(1).getIOLists() == *dfsmBin->wMethod(1).getIOLists(),
+                          m + ": DFSM test suites of text and binary model coincide");
+            
+            vector<IOTrace> trcs;
+            {
+                BinaryTestSuite::Writer writer("TC-FSM-0019.tsb",true);
+                for ( const auto& inVec : *iolc.getIOLists() ) {
+                    trcs.push_back(d.applyDet(InputTrace(inVec,pl)));
+                    writer.push(trcs.back().getInputTrace().get(),
+                                trcs.back().getOutputTrace().get());
+                }
+                writer.close();
+            }
+            BinaryTestSuite tsOut("TC-FSM-0019.tsb");
+            same = ( tsOut.hasOutputs() and tsOut.size() == trcs.size() );
+            for ( size_t i = 0; same and i < tsOut.size(); i++ ) {
+                vector<int> inVec(tsOut.inputs(i),tsOut.inputs(i) + tsOut.length(i));
+                vector<int> outVec(tsOut.outputs(i),tsOut.outputs(i) + tsOut.length(i));
+                same = ( inVec == trcs[i].getInputTrace().get() and
+                         outVec == trcs[i].getOutputTrace().get() );
+            }
+            fsmlib_assert("TC-FSM-0019",
+                          same,
+                          m + ": IO traces read from binary test suite are unchanged");
+        }
+    }
+    
+    // Files with counts exceeding their size are rejected before
+    // anything is allocated
+    BinaryFsm::Header h;
+    {
+        ifstream in("TC-FSM-0019.fsmb",ios::binary);
+        in.read(reinterpret_cast<char*>(&h),sizeof(h));
+    }
+    h.maxState = numeric_limits<int32_t>::max();
+    {
+        fstream out("TC-FSM-0019.fsmb",ios::binary | ios::in | ios::out);
+        out.write(reinterpret_cast<const char*>(&h),sizeof(h));
+    }
+    bool rejected = false;
+    try {
+        BinaryFsm bin("TC-FSM-0019.fsmb");
+    }
+    catch ( const runtime_error& ) {
+        rejected = true;
+    }
+    fsmlib_assert("TC-FSM-0019",
+                  rejected,
+                  "Binary model file with illegal number of states is rejected");
+    
+    BinaryTestSuite::Header tsh;
+    {
+        ifstream in("TC-FSM-0019.tsb",ios::binary);
+        in.read(reinterpret_cast<char*>(&tsh),sizeof(tsh));
+    }
+    tsh.numTestCases = numeric_limits<uint64_t>::max();
+    {
+        fstream out("TC-FSM-0019.tsb",ios::binary | ios::in | ios::out);
+        out.write(reinterpret_cast<const char*>(&tsh),sizeof(tsh));
+    }
+    rejected = false;
+    try {
+        BinaryTestSuite ts("TC-FSM-0019.tsb");
+    }
+    catch ( const runtime_error& ) {
+        rejected = true;
+    }
+    fsmlib_assert("TC-FSM-0019",
+                  rejected,
+                  "Binary test suite with illegal number of test cases is rejected");
+    
+}
+
+void test20() {
+    
+    cout << "TC-FSM-0020 Show that Fsm::isReductionOf() coincides with the "
+    << "failure check on the intersection"
+    << endl;
+    
+    shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+    std::mt19937 gen(20);
+    
+    for ( int i = 0; i < 20; i++ ) {
+        
+        // Observable specification, compared directly with the intersection
+        shared_ptr<Fsm> spec = Fsm::createRandomFsm("S",2,2,5,pl,true,gen);
+        int removedTransitions;
+        shared_ptr<Fsm> red = spec->createReduction("R",false,removedTransitions,gen,pl);
+        shared_ptr<Fsm> mutant = spec->createMutant("M",1,1,false,gen,pl);
+        
+        fsmlib_assert("TC-FSM-0020",
+                      spec->isReductionOf(*spec) and red->isReductionOf(*spec),
+                      "FSM and its reduction are reductions");
+        fsmlib_assert("TC-FSM-0020",
+                      mutant->isReductionOf(*spec) ==
+                      not spec->intersect(*mutant).hasFailure(),
+                      "Reduction check of mutant coincides with intersection");
+        
+        // Non-observable specification, compared with its observable form
+        shared_ptr<Fsm> specNonObs = Fsm::createRandomFsm("N",2,2,5,pl,false,gen);
+        shared_ptr<Fsm> mutantNonObs = specNonObs->createMutant("MN",1,1,false,gen,pl);
+        Fsm specObs = specNonObs->transformToObservableFSM();
+        fsmlib_assert("TC-FSM-0020",
+                      mutantNonObs->isReductionOf(*specNonObs) ==
+                      not specObs.intersect(*mutantNonObs).hasFailure(),
+                      "Reduction check against non-observable specification coincides with intersection");
+    }
+    
+}
+
+void test21() {
+    
+    cout << "TC-DFSM-0021 Show that the distinguishing traces of a DFSM "
+    << "are recalculated after modifications of its transitions"
+    << endl;
+    
+    shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+    std::mt19937 gen(21);
+    
+    for ( int i = 0; i < 10; i++ ) {
+        
+        Dfsm d("D",8,2,2,pl,gen);
+        Dfsm dMin = d.minimise();
+        vector<shared_ptr<FsmNode>> nodes = dMin.getNodes();
+        if ( nodes.size() < 2 ) continue;
+        
+        dMin.calculateDistMatrix();
+        fsmlib_assert("TC-DFSM-0021",
+                      dMin.hasCurrentDistMatrix() and
+                      not dMin.getDistTraces(*nodes[0],*nodes[1]).empty(),
+                      "Distinguishability matrix is current after its calculation");
+        
+        // Change the output of a transition
+        shared_ptr<FsmTransition> tr = nodes[0]->getTransitions().front();
+        tr->setLabel(make_shared<FsmLabel>(tr->getLabel()->getInput(),
+                                           (tr->getLabel()->getOutput() + 1) % 3,
+                                           pl));
+        fsmlib_assert("TC-DFSM-0021",
+                      not dMin.hasCurrentDistMatrix() and
+                      dMin.getDistTraces(*nodes[0],*nodes[1]).empty(),
+                      "Stale distinguishability matrix is not used");
+        
+        dMin.calculateDistMatrix();
+        bool distinguishing = true;
+        for ( size_t s1 = 0; s1 < nodes.size(); s1++ ) {
+            for ( size_t s2 = s1 + 1; s2 < nodes.size(); s2++ ) {
+                for ( const auto& trc : dMin.getDistTraces(*nodes[s1],*nodes[s2]) ) {
+                    InputTrace itrc(*trc,pl);
+                    if ( nodes[s1]->apply(itrc) == nodes[s2]->apply(itrc) ) {
+                        distinguishing = false;
+                    }
+                }
+            }
+        }
+        fsmlib_assert("TC-DFSM-0021",
+                      dMin.hasCurrentDistMatrix() and distinguishing,
+                      "Recalculated traces distinguish the states of the modified DFSM");
+    }
+    
+}
+
+void test22() {
+    
+    cout << "TC-FSM-0022 Show that the shards of the canonical FSM enumeration "
+    << "are validated and cover the enumeration"
+    << endl;
+    
+    shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+    
+    size_t numFsms = 0;
+    CanonicalFsmEnumerator all(1,1,2,pl);
+    while ( all.hasNext() ) {
+        all.getNext();
+        numFsms++;
+    }
+    
+    size_t numShardFsms = 0;
+    for ( unsigned int shard = 0; shard < 3; shard++ ) {
+        CanonicalFsmEnumerator e(1,1,2,pl,false,false,3,shard);
+        while ( e.hasNext() ) {
+            e.getNext();
+            numShardFsms++;
+        }
+    }
+    fsmlib_assert("TC-FSM-0022",
+                  numFsms > 0 and numShardFsms == numFsms,
+                  "Shards enumerate as many FSMs as the whole enumeration");
+    
+    bool rejected = false;
+    try {
+        CanonicalFsmEnumerator e(1,1,2,pl,false,false,3,3);
+    }
+    catch ( const invalid_argument& ) {
+        rejected = true;
+    }
+    fsmlib_assert("TC-FSM-0022",
+                  rejected,
+                  "Shard index not below the number of shards is rejected");
+    
+    rejected = false;
+    try {
+        CanonicalFsmEnumerator e(1,1,2,pl,false,false,0,0);
+    }
+    catch ( const invalid_argument& ) {
+        rejected = true;
+    }
+    fsmlib_assert("TC-FSM-0022",
+                  rejected,
+                  "Zero shards are rejected");
+    
 }
 
 string getFieldFromResult(const AdaptiveTestResult& result, const CsvField& field)
@@ -1299,7 +1785,7 @@ string getFieldFromResult(const AdaptiveTestResult& result, const CsvField& fiel
 
 
 
-void logToCsv(ofstream& csvOut, const AdaptiveTestResult& result, const CsvConfig& config)
+void logToCsv(ostream& csvOut, const AdaptiveTestResult& result, const CsvConfig& config)
 {
     string output;
 
@@ -1499,7 +1985,7 @@ void printTestConfig(const AdaptiveTestConfig& config)
 }
 
 void printTestResult(AdaptiveTestResult& result, const CsvConfig& csvConfig,
-                     const LoggingConfig& loggingConfig, ofstream& csvOut)
+                     const LoggingConfig& loggingConfig, ostream& csvOut)
 {
 
     LOG("INFO") << "Test                       : " << result.testName << std::endl;
@@ -1575,13 +2061,6 @@ void printTestResult(AdaptiveTestResult& result, const CsvConfig& csvConfig,
     printTestResult(result, csvConfig, loggingConfig, dummyout);
 }
 
-bool isReduction(Fsm& spec, Fsm& iut, string intersectionName, shared_ptr<Fsm>& intersection)
-{
-    Fsm inter = spec.intersect(iut, intersectionName);
-    intersection = make_shared<Fsm>(inter);
-    return !inter.hasFailure();
-}
-
 void executeAdaptiveTest(const string& testName, Fsm& spec, Fsm& iut, size_t m, string intersectionName,
                          const bool& toDot, const bool& toFsm, const bool& dontTestReductions, AdaptiveTestResult& result)
 {
@@ -1595,8 +2074,7 @@ void executeAdaptiveTest(const string& testName, Fsm& spec, Fsm& iut, size_t m,
     result.numInputs = specMin.getMaxInput() + 1;
     result.numOutputs = specMin.getMaxOutput() + 1;
 
-    shared_ptr<Fsm> intersection;
-    result.iutIsReduction = isReduction(specMin, iutMin, intersectionName, intersection);
+    result.iutIsReduction = iutMin.isReductionOf(specMin);
 
 
     if (toDot)
@@ -1605,7 +2083,8 @@ void executeAdaptiveTest(const string& testName, Fsm& spec, Fsm& iut, size_t m,
         iut.toDot(ascTestResultDirectory + testName + "-"  + iut.getName());
         specMin.toDot(ascTestResultDirectory + testName + "-"  + spec.getName() + "-min");
         iutMin.toDot(ascTestResultDirectory + testName + "-"  + iut.getName() + "-min");
-        intersection->toDot(ascTestResultDirectory + testName + "-"  + intersection->getName());
+        Fsm intersection = specMin.intersect(iutMin, intersectionName);
+        intersection.toDot(ascTestResultDirectory + testName + "-"  + intersection.getName());
     }
     if (toFsm)
     {
@@ -1645,7 +2124,7 @@ void executeAdaptiveTest(const string& testName, Fsm& spec, Fsm& iut, size_t m,
 
 
 void createAndExecuteAdaptiveTest(
-        ofstream& csvOut,
+        ostream& csvOut,
         const string& prefix,
         const int numStates,
         const int numInputs,
@@ -1680,6 +2159,12 @@ void createAndExecuteAdaptiveTest(
     LOG("INFO") << "createMutantSeed         : " << createMutantSeed << std::endl;
     LOG("INFO") << "-------------------------------------------" << std::endl;
 
+    // Separate generators for specification and IUT, so that tests
+    // can be executed concurrently and every test is reproducible from
+    // its seeds alone
+    std::mt19937 specGen(createRandomFsmSeed);
+    std::mt19937 iutGen(createMutantSeed);
+
     LOG("INFO") << "Creating FSM." << std::endl;
     shared_ptr<Fsm> spec = Fsm::createRandomFsm(prefix + "-spec",
                                                 numInputs,
@@ -1691,14 +2176,14 @@ void createAndExecuteAdaptiveTest(
                                                 createReduction,
                                                 true,
                                                 true,
-                                                createRandomFsmSeed);
+                                                specGen);
 
     LOG("INFO") << "Creating mutant." << std::endl;
 
     shared_ptr<Fsm> iut;
     if (createReduction)
     {
-        iut = spec->createReduction(prefix + "-iut", true, result.removedTransitions, createMutantSeed, plIut);
+        iut = spec->createReduction(prefix + "-iut", true, result.removedTransitions, iutGen, plIut);
     }
     else
     {
@@ -1706,7 +2191,7 @@ void createAndExecuteAdaptiveTest(
                                  numOutFaults,
                                  numTransFaults,
                                  true,
-                                 createMutantSeed,
+                                 iutGen,
                                  plIut);
         result.removedTransitions = 0;
     }
@@ -1764,6 +2249,210 @@ int getRandom(std::mt19937& gen)
     return dis(gen);
 }
 
+float getRandomFloat(std::mt19937& gen)
+{
+    std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+    return dis(gen);
+}
+
+/**
+ * A single test of adaptiveTestRandom(): the parameters chosen
+ * when the tests are planned and the result of the test execution
+ */
+struct AdaptiveTestJob
+{
+    string iteration;
+    // Row of the test in the CSV queues
+    int row;
+    int numInputs;
+    int numOutputs;
+    int numStates;
+    int numOutFaults;
+    int numTransFaults;
+    float degreeOfCompleteness;
+    float maxDegreeOfNonDeterminism;
+    unsigned int createRandomFsmSeed;
+    unsigned int createMutantSeed;
+    // Seed for the new seeds drawn if the IUT could not be created
+    unsigned int retrySeed;
+
+    bool couldCreateIut = false;
+    AdaptiveTestResult result;
+    // Written to the CSV file if every iteration is logged
+    string csvLine;
+};
+
+/**
+ * Update of the CSV queues in adaptiveTestRandom(): either the begin
+ * of the next column or the result of a job written to its row
+ */
+struct CsvQueueOp
+{
+    bool nextColumn;
+    size_t job;
+};
+
+/**
+ * Create and execute the test described by job. Only the job and
+ * objects local to this function are modified, so that jobs can be
+ * executed concurrently.
+ */
+void executeAdaptiveTestJob(const AdaptiveTestConfig& config, AdaptiveTestJob& job)
+{
+    LOG("INFO")
+            << "~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~";
+    LOG("INFO") << job.numInputs << " "
+                << job.numOutputs << " "
+                << job.numStates << " "
+                << job.numOutFaults << " "
+                << job.numTransFaults << " "
+                << job.row;
+
+    shared_ptr<FsmPresentationLayer> plTestSpecCopy = make_shared<FsmPresentationLayer>(*plTestSpec);
+    shared_ptr<FsmPresentationLayer> plTestIutCopy = make_shared<FsmPresentationLayer>(*plTestIut);
+
+    int numInputs = job.numInputs;
+    int numOutputs = job.numOutputs;
+    int numStates = job.numStates;
+    int numOutFaults = job.numOutFaults;
+    int numTransFaults = job.numTransFaults;
+    unsigned int createRandomFsmSeed = job.createRandomFsmSeed;
+    unsigned int createMutantSeed = job.createMutantSeed;
+    std::mt19937 retryGen(job.retrySeed);
+
+    AdaptiveTestResult& result = job.result;
+    result.testName = config.testName + "-" + job.iteration;
+
+    LOG("INFO") << "testName: " << result.testName << std::endl;
+
+    stringstream csvOut;
+    bool abort = false;
+    bool newSeeds = false;
+    do
+    {
+        if (newSeeds)
+        {
+            LOG("INFO") << "Generating new seeds." << std::endl;
+            createRandomFsmSeed = static_cast<unsigned int>(getRandom(retryGen));
+            createMutantSeed = static_cast<unsigned int>(getRandom(retryGen));
+            newSeeds = false;
+        }
+        try {
+            createAndExecuteAdaptiveTest(
+                        csvOut,
+                        job.iteration,
+                        numStates,
+                        numInputs,
+                        numOutputs,
+                        numOutFaults,
+                        numTransFaults,
+                        job.degreeOfCompleteness,
+                        job.maxDegreeOfNonDeterminism,
+                        createRandomFsmSeed,
+                        createMutantSeed,
+                        plTestSpecCopy,
+                        plTestIutCopy,
+                        config.createReduction,
+                        config.dontTestReductions,
+                        config.csvConfig,
+                        config.loggingConfig,
+                        result);
+            job.couldCreateIut = true;
+
+            result.setsOfMaximalRDistStates.clear();
+            result.observedTraces.clear();
+
+        }
+        catch (unexpected_reduction& e)
+        {
+            LOG("INFO") << "IUT is a reduction of the specification." << std::endl;
+            if (config.forceTestParameters)
+            {
+                newSeeds = true;
+            }
+            else
+            {
+                abort = true;
+            }
+        }
+        catch (too_many_transition_faults& e)
+        {
+            LOG("INFO") << "Could not create mutant." << std::endl;
+            if (!config.forceTestParameters
+                    && numTransFaults - 1 >= config.minTransFaults && numTransFaults - 1 > 0) {
+                --numTransFaults;
+                LOG("INFO") << "Decreasing transition faults." << std::endl;
+                continue;
+            }
+            else if (config.forceTestParameters)
+            {
+                newSeeds = true;
+
+            }
+            else
+            {
+                abort = true;
+            }
+        }
+        catch (too_many_output_faults& e)
+        {
+            LOG("INFO") << "Could not create mutant." << std::endl;
+            if (!config.forceTestParameters
+                    && numOutFaults - 1 >= config.minOutFaults && numOutFaults - 1 > 0) {
+                --numOutFaults;
+                LOG("INFO") << "Decreasing output faults." << std::endl;
+                continue;
+            }
+            else if (!config.forceTestParameters
+                     && numTransFaults - 1 >= config.minTransFaults && numTransFaults - 1 > 0)
+            {
+                --numTransFaults;
+                LOG("INFO") << "Decreasing transition faults." << std::endl;
+                continue;
+            }
+            else if (config.forceTestParameters)
+            {
+                newSeeds = true;
+
+            }
+            else
+            {
+                abort = true;
+            }
+        }
+        catch (reduction_not_possible& e)
+        {
+            LOG("INFO") << "Could not create reduction." << std::endl;
+            newSeeds = true;
+        }
+    } while (!job.couldCreateIut && !abort);
+
+    if (!job.couldCreateIut)
+    {
+        LOG("INFO") << "numStates: " << numStates + 1 << std::endl;
+        LOG("INFO") << "numInput: " << numInputs + 1 << std::endl;
+        LOG("INFO") << "numOutput: " << numOutputs + 1 << std::endl;
+        LOG("INFO") << "numOutFaults: " << numOutFaults << std::endl;
+        LOG("INFO") << "numTransFaults: " << numTransFaults << std::endl;
+        LOG("INFO") << "createRandomFsmSeed: " << createRandomFsmSeed << std::endl;
+        LOG("INFO") << "createMutantSeed: " << createMutantSeed << std::endl;
+        LOG("WARNING") << "Could not create requested mutant. Skipping." << std::endl;
+        return;
+    }
+
+    job.csvLine = csvOut.str();
+}
+
+/**
+ * Create and execute random adaptive tests as specified by config.
+ *
+ * The tests are planned first, drawing all random parameters of every
+ * test from a generator initialised with config.seed. The tests are then
+ * executed concurrently by config.numThreads threads, each test using
+ * generators initialised with its own seeds. Finally, the results are
+ * written to the CSV files and counted in the order of the tests, so that
+ * the results only depend on config.seed.
+ */
 void adaptiveTestRandom(AdaptiveTestConfig& config)
 {
 
@@ -1851,8 +2540,11 @@ void adaptiveTestRandom(AdaptiveTestConfig& config)
 
     std::mt19937 gen(config.seed);
 
-    int executed = 0;
-    int passed = 0;
+    // Plan the tests. The updates of the CSV queues are recorded
+    // and applied when the results are merged.
+    vector<AdaptiveTestJob> jobs;
+    vector<CsvQueueOp> csvQueueOps;
+    const CsvQueueOp nextColumn = { true, 0 };
     int i = 0;
 
     const TestIteration& loggingContext = config.csvConfig.context;
@@ -1861,37 +2553,37 @@ void adaptiveTestRandom(AdaptiveTestConfig& config)
     {
         if (loggingContext == TestIteration::INPUT)
         {
-            nextColumnInQueue(config.csvConfig.context, config.csvConfig.fieldsContext);
+            csvQueueOps.push_back(nextColumn);
         }
         for (int ctOutput = config.minOutput; ctOutput <= config.maxOutput; ++ctOutput)
         {
             if (loggingContext == TestIteration::OUTPUT)
             {
-                nextColumnInQueue(config.csvConfig.context, config.csvConfig.fieldsContext);
+                csvQueueOps.push_back(nextColumn);
             }
             for (int ctState = config.minStates; ctState <= config.maxStates ; ++ctState)
             {
                 if (loggingContext == TestIteration::STATE)
                 {
-                    nextColumnInQueue(config.csvConfig.context, config.csvConfig.fieldsContext);
+                    csvQueueOps.push_back(nextColumn);
                 }
                 for (int ctOutFault = config.minOutFaults; ctOutFault <= config.maxOutFaults; ++ctOutFault)
                 {
                     if (loggingContext == TestIteration::OUTPUT_FAULT)
                     {
-                        nextColumnInQueue(config.csvConfig.context, config.csvConfig.fieldsContext);
+                        csvQueueOps.push_back(nextColumn);
                     }
                     for (int ctTransFault = config.minTransFaults; ctTransFault <= config.maxTransFaults; ++ctTransFault)
                     {
                         if (loggingContext == TestIteration::TRANSITION_FAULT)
                         {
-                            nextColumnInQueue(config.csvConfig.context, config.csvConfig.fieldsContext);
+                            csvQueueOps.push_back(nextColumn);
                         }
                         for (int degreeCount = 0; degreeCount < degreeOfCompletenessIterations; ++degreeCount)
                         {
                             if (loggingContext == TestIteration::DEGREE_COMPLETENESS)
                             {
-                                nextColumnInQueue(config.csvConfig.context, config.csvConfig.fieldsContext);
+                                csvQueueOps.push_back(nextColumn);
                             }
                             float degreeOfCompleteness;
 
@@ -1903,14 +2595,13 @@ void adaptiveTestRandom(AdaptiveTestConfig& config)
                             else if (config.minDegreeOfCompleteness > 0 && config.maxDegreeOfCompleteness <= 0)
                             {
                                 degreeOfCompleteness = config.minDegreeOfCompleteness +
-                                        static_cast<float>(rand()) / (static_cast <float> (RAND_MAX/(1.0f - config.minDegreeOfCompleteness)));
+                                        getRandomFloat(gen) * (1.0f - config.minDegreeOfCompleteness);
                                 LOG("INFO") << "Selected random degree of completeness with a minimal value of " <<
                                                                      config.minDegreeOfCompleteness << ": " << degreeOfCompleteness;
                             }
                             else if (config.minDegreeOfCompleteness <= 0 && config.maxDegreeOfCompleteness <=1)
                             {
-                                degreeOfCompleteness = 0.1f +
-                                        static_cast<float>(rand()) / (static_cast <float> (RAND_MAX/(1.0f - 0.1f)));
+                                degreeOfCompleteness = 0.1f + getRandomFloat(gen) * (1.0f - 0.1f);
                                 LOG("INFO") << "Selected random degree of completeness with a maximal value of " <<
                                                                      config.maxDegreeOfCompleteness << ": " << degreeOfCompleteness;
                             }
@@ -1923,188 +2614,50 @@ void adaptiveTestRandom(AdaptiveTestConfig& config)
 
                             for (int ctInnerIt = 0; ctInnerIt < innerIterations; ++ctInnerIt)
                             {
-                                LOG("INFO")
-                                        << "~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~";
-                                LOG("INFO") << ctInput << " "
-                                                                                    << ctOutput << " "
-                                                                                    << ctState << " "
-                                                                                    << ctOutFault << " "
-                                                                                    << ctTransFault << " "
-                                                                                    << ctInnerIt;
-
-                                shared_ptr<FsmPresentationLayer> plTestSpecCopy = make_shared<FsmPresentationLayer>(*plTestSpec);
-                                shared_ptr<FsmPresentationLayer> plTestIutCopy = make_shared<FsmPresentationLayer>(*plTestIut);
-
                                 stringstream ss;
                                 ss << setw(numberDigits) << setfill('0') << i;
-                                string iteration = ss.str();
 
-                                int numInputs = ctInput;
-                                int numOutputs = ctOutput;
-                                int numStates = ctState;
-                                int numOutFaults = ctOutFault;
-                                int numTransFaults = ctTransFault;
-
-
-                                if (numOutputs < 1 && numOutFaults > 0)
+                                if (ctOutput < 1 && ctOutFault > 0)
                                 {
-                                    LOG("INFO") << "numStates: " << numStates + 1 << std::endl;
-                                    LOG("INFO") << "numInput: " << numInputs + 1 << std::endl;
-                                    LOG("INFO") << "numOutput: " << numOutputs + 1 << std::endl;
-                                    LOG("INFO") << "numOutFaults: " << numOutFaults << std::endl;
-                                    LOG("INFO") << "numTransFaults: " << numTransFaults << std::endl;
+                                    LOG("INFO") << "numStates: " << ctState + 1 << std::endl;
+                                    LOG("INFO") << "numInput: " << ctInput + 1 << std::endl;
+                                    LOG("INFO") << "numOutput: " << ctOutput + 1 << std::endl;
+                                    LOG("INFO") << "numOutFaults: " << ctOutFault << std::endl;
+                                    LOG("INFO") << "numTransFaults: " << ctTransFault << std::endl;
                                     LOG("WARNING") << "Too little outputs. Can not create requested number of "
                                                                          << "output faults. Could not create mutant. Skipping.";
                                     ++i;
                                     continue;
                                 }
 
-                                unsigned int createRandomFsmSeed = static_cast<unsigned int>(getRandom(gen));
-                                unsigned int createMutantSeed = static_cast<unsigned int>(getRandom(gen));
-
-                                float maxDegNonDet = config.maxDegreeOfNonDeterminism * static_cast <float> (rand()) / static_cast <float> (RAND_MAX);
+                                AdaptiveTestJob job;
+                                job.iteration = ss.str();
+                                job.row = ctInnerIt;
+                                job.numInputs = ctInput;
+                                job.numOutputs = ctOutput;
+                                job.numStates = ctState;
+                                job.numOutFaults = ctOutFault;
+                                job.numTransFaults = ctTransFault;
+                                job.degreeOfCompleteness = degreeOfCompleteness;
+                                job.createRandomFsmSeed = static_cast<unsigned int>(getRandom(gen));
+                                job.createMutantSeed = static_cast<unsigned int>(getRandom(gen));
+
+                                float maxDegNonDet = config.maxDegreeOfNonDeterminism * getRandomFloat(gen);
                                 if (config.createReduction && maxDegNonDet < 0.5f)
                                 {
-                                    maxDegNonDet = 0.5f + static_cast <float> (rand()) /( static_cast <float> (RAND_MAX/(1.0f - 0.5f)));
+                                    maxDegNonDet = 0.5f + getRandomFloat(gen) * (1.0f - 0.5f);
                                     if (config.maxDegreeOfNonDeterminism < 0.5f || maxDegNonDet > config.maxDegreeOfNonDeterminism)
                                     {
                                         LOG("WARNING")
                                                 << "Chosen maximal degree of non-determinism very low. Adjusting.";
                                     }
                                 }
+                                job.maxDegreeOfNonDeterminism = maxDegNonDet;
+                                job.retrySeed = static_cast<unsigned int>(getRandom(gen));
 
-                                AdaptiveTestResult result;
-                                result.testName = config.testName + "-" + iteration;
-
-                                LOG("INFO") << "testName: " << result.testName << std::endl;
-
-                                bool couldCreateIut = false;
-                                bool abort = false;
-                                bool newSeeds = false;
-                                do
-                                {
-                                    if (newSeeds)
-                                    {
-                                        LOG("INFO") << "Generating new seeds." << std::endl;
-                                        createRandomFsmSeed = static_cast<unsigned int>(getRandom(gen));
-                                        createMutantSeed = static_cast<unsigned int>(getRandom(gen));
-                                        newSeeds = false;
-                                    }
-                                    try {
-                                        createAndExecuteAdaptiveTest(
-                                                    *csvOut,
-                                                    iteration,
-                                                    numStates,
-                                                    numInputs,
-                                                    numOutputs,
-                                                    numOutFaults,
-                                                    numTransFaults,
-                                                    degreeOfCompleteness,
-                                                    maxDegNonDet,
-                                                    createRandomFsmSeed,
-                                                    createMutantSeed,
-                                                    plTestSpecCopy,
-                                                    plTestIutCopy,
-                                                    config.createReduction,
-                                                    config.dontTestReductions,
-                                                    config.csvConfig,
-                                                    config.loggingConfig,
-                                                    result);
-                                        couldCreateIut = true;
-
-                                        if (config.csvConfig.context != TestIteration::END)
-                                        {
-                                            writeResultToQueue(result, config.csvConfig.context, config.csvConfig.fieldsContext, ctInnerIt);
-
-                                        }
-                                        result.setsOfMaximalRDistStates.clear();
-                                        result.observedTraces.clear();
-
-                                    }
-                                    catch (unexpected_reduction& e)
-                                    {
-                                        LOG("INFO") << "IUT is a reduction of the specification." << std::endl;
-                                        if (config.forceTestParameters)
-                                        {
-                                            newSeeds = true;
-                                        }
-                                        else
-                                        {
-                                            abort = true;
-                                        }
-                                    }
-                                    catch (too_many_transition_faults& e)
-                                    {
-                                        LOG("INFO") << "Could not create mutant." << std::endl;
-                                        if (!config.forceTestParameters
-                                                && numTransFaults - 1 >= config.minTransFaults && numTransFaults - 1 > 0) {
-                                            --numTransFaults;
-                                            LOG("INFO") << "Decreasing transition faults." << std::endl;
-                                            continue;
-                                        }
-                                        else if (config.forceTestParameters)
-                                        {
-                                            newSeeds = true;
-
-                                        }
-                                        else
-                                        {
-                                            abort = true;
-                                        }
-                                    }
-                                    catch (too_many_output_faults& e)
-                                    {
-                                        LOG("INFO") << "Could not create mutant." << std::endl;
-                                        if (!config.forceTestParameters
-                                                && numOutFaults - 1 >= config.minOutFaults && numOutFaults - 1 > 0) {
-                                            --numOutFaults;
-                                            LOG("INFO") << "Decreasing output faults." << std::endl;
-                                            continue;
-                                        }
-                                        else if (!config.forceTestParameters
-                                                 && numTransFaults - 1 >= config.minTransFaults && numTransFaults - 1 > 0)
-                                        {
-                                            --numTransFaults;
-                                            LOG("INFO") << "Decreasing transition faults." << std::endl;
-                                            continue;
-                                        }
-                                        else if (config.forceTestParameters)
-                                        {
-                                            newSeeds = true;
-
-                                        }
-                                        else
-                                        {
-                                            abort = true;
-                                        }
-                                    }
-                                    catch (reduction_not_possible& e)
-                                    {
-                                        LOG("INFO") << "Could not create reduction." << std::endl;
-                                        newSeeds = true;
-                                    }
-                                } while (!couldCreateIut && !abort);
-                                if (!couldCreateIut)
-                                {
-                                    ++i;
-                                    LOG("INFO") << "numStates: " << numStates + 1 << std::endl;
-                                    LOG("INFO") << "numInput: " << numInputs + 1 << std::endl;
-                                    LOG("INFO") << "numOutput: " << numOutputs + 1 << std::endl;
-                                    LOG("INFO") << "numOutFaults: " << numOutFaults << std::endl;
-                                    LOG("INFO") << "numTransFaults: " << numTransFaults << std::endl;
-                                    LOG("INFO") << "createRandomFsmSeed: " << createRandomFsmSeed << std::endl;
-                                    LOG("INFO") << "createMutantSeed: " << createMutantSeed << std::endl;
-                                    LOG("WARNING") << "Could not create requested mutant. Skipping." << std::endl;
-                                    continue;
-                                }
-
-                                if (result.pass)
-                                {
-                                    ++passed;
-                                }
-
-                                fsmlib_assert(result.testName, result.pass);
-                                ++executed;
+                                CsvQueueOp write = { false, jobs.size() };
+                                csvQueueOps.push_back(write);
+                                jobs.push_back(job);
                                 ++i;
                             }  // End inner loop
 
@@ -2163,6 +2716,46 @@ void adaptiveTestRandom(AdaptiveTestConfig& config)
         }
     } // End inputs
 
+    // Execute the tests
+    WorkStealingPool pool(config.numThreads);
+    LOG("INFO") << "Executing " << jobs.size() << " tests on "
+                << pool.getNumThreads() << " threads." << std::endl;
+    pool.run(jobs.size(), [&config, &jobs](size_t j, unsigned int) {
+        executeAdaptiveTestJob(config, jobs[j]);
+    });
+
+    // Merge the results in the order of the tests
+    int executed = 0;
+    int passed = 0;
+    for (const CsvQueueOp& op : csvQueueOps)
+    {
+        if (op.nextColumn)
+        {
+            nextColumnInQueue(config.csvConfig.context, config.csvConfig.fieldsContext);
+            continue;
+        }
+
+        const AdaptiveTestJob& job = jobs.at(op.job);
+        if (!job.couldCreateIut)
+        {
+            continue;
+        }
+
+        *csvOut << job.csvLine;
+        if (config.csvConfig.context != TestIteration::END)
+        {
+            writeResultToQueue(job.result, config.csvConfig.context, config.csvConfig.fieldsContext, job.row);
+        }
+
+        if (job.result.pass)
+        {
+            ++passed;
+        }
+
+        fsmlib_assert(job.result.testName, job.result.pass);
+        ++executed;
+    }
+
 
     std::chrono::steady_clock::time_point totalEnd = std::chrono::steady_clock::now();
     long durationS = std::chrono::duration_cast<std::chrono::seconds>(totalEnd - totalStart).count();
@@ -2708,13 +3301,18 @@ void setLoggingVerbosity() {
     LogCoordinator::getStandardLogger().createLogTargetAndBind("FATAL", std::cerr);
 }
 
-void testSPYHMethod(int numStates, int numInputs, int numOutputs, int numAddStates, int numRepetitions) 
+/**
+ * Check the SPYH method against random SUTs. The specification and the
+ * SUTs are created from seed, the SUTs are checked concurrently and the
+ * first failing SUT is reported, independently of the number of threads.
+ */
+void testSPYHMethod(int numStates, int numInputs, int numOutputs, int numAddStates, int numRepetitions, unsigned int seed, unsigned int numThreads)
 {
-    srand(getRandomSeed());
+    std::mt19937 gen(seed);
 
     // create spec
     std::shared_ptr<FsmPresentationLayer> pl = std::make_shared<FsmPresentationLayer>();
-    Dfsm spec("SPEC",numStates,numInputs,numOutputs,pl);
+    Dfsm spec("SPEC",numStates,numInputs,numOutputs,pl,gen);
     spec = spec.minimise();
 
     cout << "SPEC min size: " << spec.size() <<  endl;
@@ -2739,26 +3337,54 @@ void testSPYHMethod(int numStates, int numInputs, int numOutputs, int numAddStat
     }
 
     // test against random other fsms with a number of states in [numStates, numStates+numAddStates]
+    vector<int> numSUTStates;
+    vector<unsigned int> sutSeeds;
     for (int i = 0; i < numRepetitions; ++i) {
-
-        int numSUTStates = spec.size() + (numAddStates > 0 ? rand() % numAddStates : 0);
-        Dfsm sut("SUT",numSUTStates,numInputs,numOutputs,pl);
+        numSUTStates.push_back(spec.size() + (numAddStates > 0 ? getRandom(numAddStates - 1, gen) : 0));
+        sutSeeds.push_back(static_cast<unsigned int>(getRandom(gen)));
+    }
+
+    // every worker checks the SUTs against its own copy of spec and the test suite
+    WorkStealingPool pool(numThreads);
+    vector<shared_ptr<Fsm>> specs;
+    vector<shared_ptr<InputTree>> inputTrees;
+    for (unsigned int w = 0; w < pool.getNumThreads(); ++w) {
+        auto plCopy = make_shared<FsmPresentationLayer>(*pl);
+        specs.push_back(make_shared<Fsm>(spec, spec.getName(), plCopy));
+        inputTrees.push_back(make_shared<InputTree>(plCopy));
+        inputTrees.back()->add(testSuite);
+    }
+
+    vector<shared_ptr<Dfsm>> suts(numRepetitions);
+    vector<char> isEq(numRepetitions);
+    vector<char> passesTestSuite(numRepetitions);
+    pool.run(numRepetitions, [&](size_t i, unsigned int w) {
+        std::mt19937 sutGen(sutSeeds[i]);
+        auto plSut = make_shared<FsmPresentationLayer>(*pl);
+        Dfsm sut("SUT",numSUTStates[i],numInputs,numOutputs,plSut,sutGen);
         sut = sut.minimise();
 
         // on complete minimal deterministic fsms strong-reduction and equivalence coincide
-        bool isEq = sut.isStrongSemiReductionOf(spec);
-        
-        bool passesTestSuite = sut.passesStrongSemiReductionTestSuite(spec,inputTree);
+        bool eq = sut.isStrongSemiReductionOf(*specs[w]);
+        bool passes = sut.passesStrongSemiReductionTestSuite(*specs[w],*inputTrees[w]);
+
+        isEq[i] = eq;
+        passesTestSuite[i] = passes;
+        if (eq != passes) {
+            suts[i] = make_shared<Dfsm>(sut);
+        }
+    });
 
-        if (isEq != passesTestSuite) {
+    for (int i = 0; i < numRepetitions; ++i) {
+        if (isEq[i] != passesTestSuite[i]) {
             cout << "ERROR: SUT is " 
-                 << (isEq ? "" : "not ") 
+                 << (isEq[i] ? "" : "not ") 
                  << "equivalent to the SPEC but does " 
-                 << (passesTestSuite ? "" : "not ") 
+                 << (passesTestSuite[i] ? "" : "not ") 
                  << "pass the test suite:" 
                  << endl;
             spec.toDot("SPYH_FAILURE_SPEC");
-            sut.toDot("SPYH_FAILURE_SUT");
+            suts[i]->toDot("SPYH_FAILURE_SUT");
             cout << testSuite << endl;
             exit(1);
         }
@@ -2799,6 +3425,13 @@ int main(int argc, char** argv)
     //runAdaptiveStateCountingTests();
 
 #endif
+
+    test17();
+    test18();
+    test19();
+    test20();
+    test21();
+    test22();
     
     // compute test suite for the SPYH method example fsm
     shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>(string(RESOURCES_DIR) + "spyh-example/m_ex.in",
@@ -2814,10 +3447,16 @@ int main(int argc, char** argv)
     int numRepsPerSpec = 100;
     int maxNumSpecs = 10;
     int maxAddStates = 3;
+    // Workers checking the SUTs of each specification
+    unsigned int numThreads = 4;
+
+    unsigned int seed = getRandomSeed();
+    LOG("INFO") << "SPYH test seed: " << seed << std::endl;
+    std::mt19937 gen(seed);
 
     for (int numAddStates = 0; numAddStates < maxAddStates; ++numAddStates) {
         for (int spec = 0; spec < maxNumSpecs; ++spec) {
-            testSPYHMethod(5,2,2,numAddStates,numRepsPerSpec);
+            testSPYHMethod(5,2,2,numAddStates,numRepsPerSpec,static_cast<unsigned int>(getRandom(gen)),numThreads);
         }
     }
     
@@ -1,26 +1,303 @@
 /*
  * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
- * 
+ *
  * Licensed under the EUPL V.1.1
  */
 #include "sets/HittingSet.h"
-#include "sets/HsTreeNode.h"
+#include "utils/WorkStealingPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <cstdint>
+#include <mutex>
+
+namespace {
+
+typedef std::vector<uint64_t> Bits;
+
+bool intersects(const Bits& a, const Bits& b)
+{
+    for (size_t w = 0; w < a.size(); ++ w)
+    {
+        if ((a[w] & b[w]) != 0) return true;
+    }
+    return false;
+}
+
+bool isSubset(const Bits& a, const Bits& b)
+{
+    for (size_t w = 0; w < a.size(); ++ w)
+    {
+        if ((a[w] & ~b[w]) != 0) return false;
+    }
+    return true;
+}
+
+size_t count(const Bits& a)
+{
+    size_t c = 0;
+    for (uint64_t word : a)
+    {
+        c += std::bitset<64>(word).count();
+    }
+    return c;
+}
+
+void setBit(Bits& a, const size_t i)
+{
+    a[i / 64] |= uint64_t(1) << (i % 64);
+}
+
+bool testBit(const Bits& a, const size_t i)
+{
+    return ((a[i / 64] >> (i % 64)) & 1) != 0;
+}
+
+/** Node of the search tree */
+struct SearchNode
+{
+    /** Elements in the hitting set candidate */
+    Bits chosen;
+    /** Elements that must not be added in this subtree */
+    Bits forbidden;
+    size_t size;
+};
+
+/**
+ *  Branch-and-bound search for a minimal hitting set. The set system
+ *  is encoded as bit sets over the element indices.
+ *
+ *  The incumbent is shared between the tasks exploring different
+ *  subtrees: its size and the number of the task that found it are
+ *  packed into one atomic word, so that the bound can be read
+ *  without locking. If two tasks find hitting sets of the same size,
+ *  the one of the smaller task number wins. Since the tasks are
+ *  numbered in depth-first order, the result is always the first
+ *  minimal hitting set in depth-first order.
+ */
+class BranchAndBound
+{
+private:
+    const std::vector<Bits>& sets;
+    std::atomic<uint64_t> bound;
+    std::mutex mtx;
+    Bits best;
+
+    static uint64_t pack(const size_t size, const uint32_t task)
+    {
+        return (static_cast<uint64_t>(size) << 32) | task;
+    }
+
+public:
+
+    /** Result of the analysis of a search node */
+    enum { HITTING_SET = -1, INFEASIBLE = -2 };
+
+    BranchAndBound(const std::vector<Bits>& sets, const Bits& initial)
+        : sets(sets), bound(pack(count(initial), UINT32_MAX)), best(initial)
+    {
+    }
+
+    const Bits& getBest() const { return best; }
+
+    /**
+     *  Determine the set to branch on: the set not hit by n with the
+     *  fewest elements still allowed. The lower bound for hitting sets
+     *  in the subtree of n is written to lb.
+     *  @return index of the set, HITTING_SET or INFEASIBLE
+     */
+    int analyse(const SearchNode& n, size_t& lb) const
+    {
+        int branchSet = HITTING_SET;
+        size_t branchCount = SIZE_MAX;
+        Bits covered(n.chosen.size(), 0);
+        Bits avail(n.chosen.size());
+        lb = n.size;
+
+        for (size_t i = 0; i < sets.size(); ++ i)
+        {
+            if (intersects(sets[i], n.chosen)) continue;
+
+            for (size_t w = 0; w < avail.size(); ++ w)
+            {
+                avail[w] = sets[i][w] & ~n.forbidden[w];
+            }
+            size_t c = count(avail);
+            if (c == 0) return INFEASIBLE;
+            if (c < branchCount)
+            {
+                branchSet = static_cast<int>(i);
+                branchCount = c;
+            }
+
+            // Pairwise disjoint sets need different elements each
+            if (!intersects(avail, covered))
+            {
+                ++ lb;
+                for (size_t w = 0; w < avail.size(); ++ w)
+                {
+                    covered[w] |= avail[w];
+                }
+            }
+        }
+        return branchSet;
+    }
+
+    /** Create the children of n, branching on set i */
+    void expand(const SearchNode& n, const int i, std::vector<SearchNode>& children) const
+    {
+        SearchNode child = n;
+        ++ child.size;
+        for (size_t e = 0; e < 64 * n.chosen.size(); ++ e)
+        {
+            if (!testBit(sets[i], e) || testBit(n.forbidden, e)) continue;
+
+            SearchNode c = child;
+            setBit(c.chosen, e);
+            children.push_back(c);
+
+            // Hitting sets containing e are covered by the previous child
+            setBit(child.forbidden, e);
+        }
+    }
+
+    void search(const SearchNode& n, const uint32_t task)
+    {
+        size_t lb;
+        int i = analyse(n, lb);
+        if (i == INFEASIBLE) return;
+
+        uint64_t b = bound.load();
+        size_t bestSize = b >> 32;
+        uint32_t bestTask = static_cast<uint32_t>(b);
+        if (lb > bestSize || (lb == bestSize && task >= bestTask)) return;
+
+        if (i == HITTING_SET)
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            b = bound.load();
+            bestSize = b >> 32;
+            bestTask = static_cast<uint32_t>(b);
+            if (n.size < bestSize || (n.size == bestSize && task < bestTask))
+            {
+                best = n.chosen;
+                bound.store(pack(n.size, task));
+            }
+            return;
+        }
+
+        std::vector<SearchNode> children;
+        expand(n, i, children);
+        for (const SearchNode& c : children)
+        {
+            search(c, task);
+        }
+    }
+};
+
+}
 
 HittingSet::HittingSet(const std::vector<std::unordered_set<int>>& s)
 	: s(s)
 {
     // The initial hitting set candidate h is the union of
     // all sets in s
-	for (std::unordered_set<int> z : s)
+	for (const std::unordered_set<int>& z : s)
 	{
 		h.insert(z.begin(), z.end());
 	}
-	HsTreeNode::hSmallest = h;
 }
 
-std::unordered_set<int> HittingSet::calcMinCardHittingSet() const
+std::unordered_set<int> HittingSet::calcMinCardHittingSet(const unsigned int numThreads) const
 {
-	HsTreeNode root = HsTreeNode(h, s);
-	root.expandNode();
-	return HsTreeNode::hSmallest;
+    // Map the elements to bit positions, in ascending order
+    std::vector<int> elements(h.begin(), h.end());
+    std::sort(elements.begin(), elements.end());
+    size_t numWords = (elements.size() + 63) / 64;
+
+    std::vector<Bits> sets;
+    for (const std::unordered_set<int>& z : s)
+    {
+        if (z.empty()) return h;
+        Bits b(numWords, 0);
+        for (int i : z)
+        {
+            setBit(b, std::lower_bound(elements.begin(), elements.end(), i) - elements.begin());
+        }
+        sets.push_back(b);
+    }
+
+    // Sets containing another set of the system are hit anyway
+    std::stable_sort(sets.begin(), sets.end(), [](const Bits& a, const Bits& b) {
+        return count(a) < count(b);
+    });
+    std::vector<Bits> reduced;
+    for (const Bits& b : sets)
+    {
+        bool redundant = false;
+        for (const Bits& r : reduced)
+        {
+            if (isSubset(r, b))
+            {
+                redundant = true;
+                break;
+            }
+        }
+        if (!redundant) reduced.push_back(b);
+    }
+
+    Bits all(numWords, 0);
+    for (size_t e = 0; e < elements.size(); ++ e)
+    {
+        setBit(all, e);
+    }
+
+    BranchAndBound bb(reduced, all);
+    SearchNode root;
+    root.chosen.assign(numWords, 0);
+    root.forbidden.assign(numWords, 0);
+    root.size = 0;
+
+    WorkStealingPool pool(numThreads);
+    if (pool.getNumThreads() <= 1)
+    {
+        bb.search(root, 0);
+    }
+    else
+    {
+        // Split the search tree into subtrees, preserving
+        // the depth-first order of their roots
+        std::vector<SearchNode> tasks(1, root);
+        bool expanded = true;
+        while (expanded && tasks.size() < 8 * pool.getNumThreads())
+        {
+            expanded = false;
+            std::vector<SearchNode> next;
+            for (const SearchNode& n : tasks)
+            {
+                size_t lb;
+                int i = bb.analyse(n, lb);
+                if (i < 0)
+                {
+                    next.push_back(n);
+                    continue;
+                }
+                bb.expand(n, i, next);
+                expanded = true;
+            }
+            tasks.swap(next);
+        }
+
+        pool.run(tasks.size(), [&](const size_t t, const unsigned int) {
+            bb.search(tasks[t], static_cast<uint32_t>(t));
+        });
+    }
+
+    std::unordered_set<int> result;
+    for (size_t e = 0; e < elements.size(); ++ e)
+    {
+        if (testBit(bb.getBest(), e)) result.insert(elements[e]);
+    }
+    return result;
 }
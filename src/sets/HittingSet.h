@@ -9,6 +9,13 @@
 #include <unordered_set>
 #include <vector>
 
+/**
+ *  Solver for the minimal hitting set problem.
+ *
+ *  All state of a calculation is local to the HittingSet instance
+ *  and the calculation itself, so that several instances may be
+ *  used concurrently in different threads.
+ */
 class HittingSet
 {
 private:
@@ -18,7 +25,7 @@ private:
 	 */
 	std::vector<std::unordered_set<int>> s;
 
-	/** the current candidate for the minimal hitting set problem */
+	/** the initial candidate for the minimal hitting set problem */
 	std::unordered_set<int> h;
 public:
    /**
@@ -32,11 +39,23 @@ public:
 	/**
 	 * Calculate the smallest hitting set for the set system
      * specified when instantiating the object.
-	 * @return The smallest set into the hitting set
+     *
+     * The calculation is a branch-and-bound search on bit sets:
+     * each step branches over the elements of a set that is not yet
+     * hit, and subtrees are pruned if a lower bound obtained from
+     * pairwise disjoint sets that are not yet hit shows that they
+     * cannot contain a hitting set smaller than the best one found so far.
+     *
+     * @param numThreads Number of threads exploring the subtrees of
+     *        the search tree, 0 means one thread per hardware thread.
+     *        The result does not depend on the number of threads.
+	 * @return The smallest set into the hitting set. If some set of the
+     *         set system is empty, no hitting set exists and the union
+     *         of all sets is returned.
      *
      * @note this algorithm has worst case complexity
      * of O(2^(#(union s)))
 	 */
-	std::unordered_set<int> calcMinCardHittingSet() const;
+	std::unordered_set<int> calcMinCardHittingSet(const unsigned int numThreads = 1) const;
 };
 #endif //FSM_SETS_HITTINGSET_H_
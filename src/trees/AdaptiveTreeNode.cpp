@@ -9,7 +9,8 @@ AdaptiveTreeNode::AdaptiveTreeNode(int input):
 
 }
 
-AdaptiveTreeNode::AdaptiveTreeNode()
+AdaptiveTreeNode::AdaptiveTreeNode():
+    input(-1)
 {
 
 }
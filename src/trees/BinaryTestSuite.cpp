@@ -0,0 +1,132 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include <cstring>
+#include <stdexcept>
+
+#include "trees/BinaryTestSuite.h"
+
+using namespace std;
+
+static_assert(sizeof(BinaryTestSuite::Header) == 32, "unexpected padding in BinaryTestSuite::Header");
+static_assert(sizeof(int) == sizeof(int32_t), "test cases are written as int vectors");
+
+static const char magic[4] = { 'F', 'S', 'M', 'T' };
+static const uint32_t byteOrderMark = 0x01020304;
+
+BinaryTestSuite::Writer::Writer(const string& fname, const bool hasOutputs)
+: out(fname, ios::binary), offsets(1, 0), fname(fname)
+{
+    if ( not out ) {
+        throw runtime_error("Could not create binary test suite file " + fname);
+    }
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, magic, sizeof(magic));
+    header.version = VERSION;
+    header.byteOrder = byteOrderMark;
+    header.hasOutputs = hasOutputs ? 1 : 0;
+
+    // The header is completed by close()
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+BinaryTestSuite::Writer::~Writer()
+{
+    if ( out.is_open() ) {
+        try {
+            close();
+        }
+        catch ( const exception& ) {
+        }
+    }
+}
+
+void BinaryTestSuite::Writer::push(const vector<int>& testCase)
+{
+    if ( header.hasOutputs ) {
+        throw logic_error("test cases of " + fname + " need outputs");
+    }
+    out.write(reinterpret_cast<const char*>(testCase.data()), testCase.size() * sizeof(int));
+    offsets.push_back(offsets.back() + testCase.size());
+}
+
+void BinaryTestSuite::Writer::push(const vector<int>& inputs, const vector<int>& outputs)
+{
+    if ( not header.hasOutputs or inputs.size() != outputs.size() ) {
+        throw logic_error("illegal IO trace for " + fname);
+    }
+    out.write(reinterpret_cast<const char*>(inputs.data()), inputs.size() * sizeof(int));
+    out.write(reinterpret_cast<const char*>(outputs.data()), outputs.size() * sizeof(int));
+    offsets.push_back(offsets.back() + inputs.size() + outputs.size());
+}
+
+void BinaryTestSuite::Writer::close()
+{
+    header.numTestCases = offsets.size() - 1;
+    header.indexPos = sizeof(Header) + offsets.back() * sizeof(int32_t);
+
+    // Keep the index aligned for in-place access
+    if ( header.indexPos % sizeof(uint64_t) != 0 ) {
+        int32_t pad = 0;
+        out.write(reinterpret_cast<const char*>(&pad), sizeof(pad));
+        header.indexPos += sizeof(pad);
+    }
+    out.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if ( not out ) {
+        throw runtime_error("Could not write binary test suite file " + fname);
+    }
+}
+
+BinaryTestSuite::BinaryTestSuite(const string& fname)
+: file(fname), header(nullptr), data(nullptr), index(nullptr)
+{
+    const char* base = file.data();
+    size_t size = file.size();
+
+    if ( size < sizeof(Header) ) {
+        throw runtime_error(fname + " is not a binary test suite file");
+    }
+    header = reinterpret_cast<const Header*>(base);
+    if ( memcmp(header->magic, magic, sizeof(magic)) != 0 ) {
+        throw runtime_error(fname + " is not a binary test suite file");
+    }
+    if ( header->byteOrder != byteOrderMark ) {
+        throw runtime_error(fname + " has been written on a machine with different byte order");
+    }
+    if ( header->version != VERSION ) {
+        throw runtime_error(fname + " has unsupported format version " +
+                            to_string(header->version));
+    }
+    if ( header->indexPos < sizeof(Header) or header->indexPos > size or
+         (size - header->indexPos) / sizeof(uint64_t) <= header->numTestCases ) {
+        throw runtime_error(fname + " is truncated");
+    }
+
+    data = reinterpret_cast<const int32_t*>(base + sizeof(Header));
+    index = reinterpret_cast<const uint64_t*>(base + header->indexPos);
+
+    // Every test case must lie inside the data preceding the index
+    uint64_t dataSize = (header->indexPos - sizeof(Header)) / sizeof(int32_t);
+    if ( index[0] != 0 or index[header->numTestCases] > dataSize ) {
+        throw runtime_error(fname + " contains an illegal index");
+    }
+    for ( uint64_t i = 0; i < header->numTestCases; i++ ) {
+        if ( index[i] > index[i+1] or
+             (header->hasOutputs and (index[i+1] - index[i]) % 2 != 0) ) {
+            throw runtime_error(fname + " contains an illegal index");
+        }
+    }
+}
+
+bool BinaryTestSuite::isBinaryTestSuite(const string& fname)
+{
+    ifstream in(fname, ios::binary);
+    char buf[sizeof(magic)];
+    if ( not in.read(buf, sizeof(buf)) ) return false;
+    return memcmp(buf, magic, sizeof(magic)) == 0;
+}
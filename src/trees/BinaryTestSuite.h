@@ -0,0 +1,134 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_TREES_BINARYTESTSUITE_H_
+#define FSM_TREES_BINARYTESTSUITE_H_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "trees/TestCaseSink.h"
+#include "utils/MappedFile.hpp"
+
+/**
+ *  Binary file format for test suites consisting of input sequences,
+ *  or of input sequences together with their expected outputs
+ *  (one IO trace per test case, like the lines of a text test suite
+ *  written by TestSuite::save()).
+ *
+ *  Layout (all numbers in host byte order, detected by the byte order mark):
+ *  \li Header, see below
+ *  \li the test cases as 32-bit integers: the inputs of a test case,
+ *      followed by its outputs if the suite has outputs
+ *  \li (numTestCases + 1) 64-bit offsets of the test cases, counted in
+ *      32-bit integers from the start of the test case data
+ *
+ *  The index is written last, so that a suite can be written while it
+ *  is generated, without knowing the number of test cases in advance.
+ */
+class BinaryTestSuite
+{
+public:
+
+    /** Current version of the format */
+    static const uint32_t VERSION = 1;
+
+    struct Header
+    {
+        /** "FSMT" */
+        char magic[4];
+        uint32_t version;
+        /** 0x01020304, written in host byte order */
+        uint32_t byteOrder;
+        /** 1 if every test case contains the expected outputs */
+        uint32_t hasOutputs;
+        uint64_t numTestCases;
+        /** File position of the index */
+        uint64_t indexPos;
+    };
+
+    /**
+     *  Writer for binary test suite files. Input sequences can be
+     *  pushed by test generation methods producing test cases one by one.
+     */
+    class Writer : public TestCaseSink
+    {
+    private:
+        std::ofstream out;
+        Header header;
+        std::vector<uint64_t> offsets;
+        std::string fname;
+
+    public:
+
+        /**
+         *  Create the file fname
+         *  @param hasOutputs true if IO traces will be written,
+         *         false if input sequences will be written
+         *  @throws std::runtime_error if the file cannot be created
+         */
+        Writer(const std::string& fname, const bool hasOutputs);
+
+        ~Writer();
+
+        /** Write an input sequence, only for suites without outputs */
+        void push(const std::vector<int>& testCase);
+
+        /** Write an IO trace, only for suites with outputs */
+        void push(const std::vector<int>& inputs, const std::vector<int>& outputs);
+
+        /**
+         *  Write the index and close the file. Called by the
+         *  destructor, if it has not been called before.
+         *  @throws std::runtime_error if the file could not be written
+         */
+        void close();
+    };
+
+private:
+
+    MappedFile file;
+    const Header* header;
+    const int32_t* data;
+    const uint64_t* index;
+
+public:
+
+    /**
+     *  Map a binary test suite file
+     *  @throws std::runtime_error if the file cannot be read or is
+     *          not a binary test suite file of the current version
+     */
+    explicit BinaryTestSuite(const std::string& fname);
+
+    /** Return true if the file starts like a binary test suite file */
+    static bool isBinaryTestSuite(const std::string& fname);
+
+    bool hasOutputs() const { return header->hasOutputs != 0; }
+
+    /** Number of test cases */
+    size_t size() const { return header->numTestCases; }
+
+    /** Number of inputs of test case i */
+    size_t length(const size_t i) const
+    {
+        size_t n = index[i+1] - index[i];
+        return hasOutputs() ? n / 2 : n;
+    }
+
+    /** Inputs of test case i, stored in place in the mapped file */
+    const int32_t* inputs(const size_t i) const { return data + index[i]; }
+
+    /** Expected outputs of test case i, or nullptr if the suite has no outputs */
+    const int32_t* outputs(const size_t i) const
+    {
+        return hasOutputs() ? data + index[i] + length(i) : nullptr;
+    }
+
+};
+
+#endif //FSM_TREES_BINARYTESTSUITE_H_
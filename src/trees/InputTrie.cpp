@@ -0,0 +1,258 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include <algorithm>
+
+#include "trees/InputTrie.h"
+#include "trees/IOListContainer.h"
+#include "trees/Tree.h"
+#include "trees/TreeNode.h"
+#include "trees/TreeEdge.h"
+
+using namespace std;
+
+const InputTrie::NodeId InputTrie::ROOT;
+const InputTrie::NodeId InputTrie::NONE;
+
+InputTrie::InputTrie(const shared_ptr<FsmPresentationLayer>& presentationLayer)
+: presentationLayer(presentationLayer)
+{
+    Node root;
+    root.label = -1;
+    root.parent = NONE;
+    root.firstChild = NONE;
+    root.nextSibling = NONE;
+    nodes.push_back(root);
+}
+
+InputTrie::InputTrie(const Tree& tree)
+: InputTrie(tree.getPresentationLayer())
+{
+    // Copy the tree node by node, depth-first
+    vector<pair<shared_ptr<TreeNode>,NodeId>> stack;
+    stack.push_back(make_pair(tree.getRoot(),ROOT));
+    while ( not stack.empty() ) {
+        auto top = stack.back();
+        stack.pop_back();
+        for ( auto e : *top.first->getChildren() ) {
+            stack.push_back(make_pair(e->getTarget(),addChild(top.second,e->getIO())));
+        }
+    }
+}
+
+InputTrie::NodeId InputTrie::after(const NodeId n, const int x) const
+{
+    for ( NodeId c = nodes[n].firstChild; c != NONE; c = nodes[c].nextSibling ) {
+        if ( nodes[c].label == x ) return c;
+        if ( nodes[c].label > x ) break;
+    }
+    return NONE;
+}
+
+InputTrie::NodeId InputTrie::after(NodeId n,
+                                   vector<int>::const_iterator begin,
+                                   const vector<int>::const_iterator end) const
+{
+    for ( ; begin != end and n != NONE; ++begin ) {
+        n = after(n,*begin);
+    }
+    return n;
+}
+
+InputTrie::NodeId InputTrie::addChild(const NodeId n, const int x)
+{
+    // Find the position in the sorted list of children
+    NodeId prev = NONE;
+    NodeId c = nodes[n].firstChild;
+    while ( c != NONE and nodes[c].label < x ) {
+        prev = c;
+        c = nodes[c].nextSibling;
+    }
+    if ( c != NONE and nodes[c].label == x ) return c;
+
+    Node newNode;
+    newNode.label = x;
+    newNode.parent = n;
+    newNode.firstChild = NONE;
+    newNode.nextSibling = c;
+    NodeId id = static_cast<NodeId>(nodes.size());
+    nodes.push_back(newNode);
+
+    if ( prev == NONE ) nodes[n].firstChild = id;
+    else nodes[prev].nextSibling = id;
+
+    return id;
+}
+
+vector<int> InputTrie::getPath(NodeId n) const
+{
+    vector<int> path;
+    for ( ; n != ROOT; n = nodes[n].parent ) {
+        path.push_back(nodes[n].label);
+    }
+    reverse(path.begin(),path.end());
+    return path;
+}
+
+vector<InputTrie::NodeId> InputTrie::getLeaves() const
+{
+    vector<NodeId> leaves;
+    vector<NodeId> stack;
+    stack.push_back(ROOT);
+    while ( not stack.empty() ) {
+        NodeId n = stack.back();
+        stack.pop_back();
+        if ( isLeaf(n) ) {
+            leaves.push_back(n);
+            continue;
+        }
+        // Push the children in reverse order, so that
+        // the smallest label is processed first
+        size_t top = stack.size();
+        for ( NodeId c = nodes[n].firstChild; c != NONE; c = nodes[c].nextSibling ) {
+            stack.push_back(c);
+        }
+        reverse(stack.begin() + top,stack.end());
+    }
+    return leaves;
+}
+
+InputTrie::NodeId InputTrie::addToNode(NodeId n, const vector<int>& lst)
+{
+    for ( int x : lst ) n = addChild(n,x);
+    return n;
+}
+
+void InputTrie::addToRoot(const IOListContainer& tcl)
+{
+    for ( const auto& lst : *tcl.getIOLists() ) addToNode(ROOT,lst);
+}
+
+void InputTrie::add(const IOListContainer& tcl)
+{
+    // Only the nodes existing before the operation are extended
+    NodeId numNodes = static_cast<NodeId>(nodes.size());
+    for ( NodeId n = 0; n < numNodes; n++ ) {
+        for ( const auto& lst : *tcl.getIOLists() ) addToNode(n,lst);
+    }
+}
+
+void InputTrie::copyChildren(const NodeId r, const InputTrie& t, const NodeId n)
+{
+    for ( NodeId c = t.nodes[n].firstChild; c != NONE; c = t.nodes[c].nextSibling ) {
+        NodeId rc = addChild(r,t.nodes[c].label);
+        copyChildren(rc,t,c);
+    }
+}
+
+void InputTrie::unionTree(const InputTrie& otherTrie)
+{
+    copyChildren(ROOT,otherTrie,ROOT);
+}
+
+int InputTrie::tentativeAddToRoot(const vector<int>& alpha) const
+{
+    NodeId n = ROOT;
+    for ( int x : alpha ) {
+        if ( isLeaf(n) ) return 1;
+        n = after(n,x);
+        if ( n == NONE ) return 2;
+    }
+    return 0;
+}
+
+shared_ptr<InputTrie> InputTrie::getSubTree(const vector<int>& alpha) const
+{
+    NodeId n = after(ROOT,alpha.cbegin(),alpha.cend());
+    if ( n == NONE ) return nullptr;
+    shared_ptr<InputTrie> sub = make_shared<InputTrie>(presentationLayer);
+    sub->copyChildren(ROOT,*this,n);
+    return sub;
+}
+
+void InputTrie::addPrefixRelations(const InputTrie& a, const NodeId na,
+                                   const InputTrie& b, const NodeId nb,
+                                   vector<int>& path)
+{
+    // Both children lists are sorted, so they are merged
+    NodeId ca = a.nodes[na].firstChild;
+    NodeId cb = b.nodes[nb].firstChild;
+    while ( ca != NONE and cb != NONE ) {
+        int xa = a.nodes[ca].label;
+        int xb = b.nodes[cb].label;
+        if ( xa < xb ) {
+            ca = a.nodes[ca].nextSibling;
+            continue;
+        }
+        if ( xb < xa ) {
+            cb = b.nodes[cb].nextSibling;
+            continue;
+        }
+
+        path.push_back(xa);
+        if ( a.isLeaf(ca) or b.isLeaf(cb) ) {
+            // The path to this leaf is a prefix of every path
+            // in the subtree of the other trie: add the longer paths
+            NodeId r = addToNode(ROOT,path);
+            if ( not a.isLeaf(ca) ) copyChildren(r,a,ca);
+            if ( not b.isLeaf(cb) ) copyChildren(r,b,cb);
+        }
+        else {
+            addPrefixRelations(a,ca,b,cb,path);
+        }
+        path.pop_back();
+
+        ca = a.nodes[ca].nextSibling;
+        cb = b.nodes[cb].nextSibling;
+    }
+}
+
+shared_ptr<InputTrie> InputTrie::getPrefixRelationTree(const NodeId a,
+                                                       const InputTrie& other,
+                                                       const NodeId b) const
+{
+    shared_ptr<InputTrie> tree = make_shared<InputTrie>(presentationLayer);
+    if ( a == NONE or b == NONE ) return tree;
+
+    if ( isLeaf(a) and other.isLeaf(b) ) return tree;
+    if ( isLeaf(a) ) {
+        tree->copyChildren(ROOT,other,b);
+        return tree;
+    }
+    if ( other.isLeaf(b) ) {
+        tree->copyChildren(ROOT,*this,a);
+        return tree;
+    }
+
+    vector<int> path;
+    tree->addPrefixRelations(*this,a,other,b,path);
+    return tree;
+}
+
+IOListContainer InputTrie::getIOLists() const
+{
+    shared_ptr<vector<vector<int>>> ioll = make_shared<vector<vector<int>>>();
+    for ( NodeId n : getLeaves() ) {
+        ioll->push_back(getPath(n));
+    }
+    return IOListContainer(ioll,presentationLayer);
+}
+
+shared_ptr<Tree> InputTrie::toTree() const
+{
+    shared_ptr<TreeNode> root = make_shared<TreeNode>();
+    vector<pair<NodeId,shared_ptr<TreeNode>>> stack;
+    stack.push_back(make_pair(ROOT,root));
+    while ( not stack.empty() ) {
+        auto top = stack.back();
+        stack.pop_back();
+        for ( NodeId c = nodes[top.first].firstChild; c != NONE; c = nodes[c].nextSibling ) {
+            shared_ptr<TreeNode> tgt = make_shared<TreeNode>();
+            top.second->add(make_shared<TreeEdge>(nodes[c].label,tgt));
+            stack.push_back(make_pair(c,tgt));
+        }
+    }
+    return make_shared<Tree>(root,presentationLayer);
+}
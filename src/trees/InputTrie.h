@@ -0,0 +1,155 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_TREES_INPUTTRIE_H_
+#define FSM_TREES_INPUTTRIE_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class FsmPresentationLayer;
+class IOListContainer;
+class Tree;
+
+/**
+ *  Trie of input (or I/O) sequences, offering the operations of Tree
+ *  that are used when building test suites, but without allocating
+ *  every node and edge separately.
+ *
+ *  All nodes are stored in a single array and refer to each other by
+ *  32-bit indices. The children of a node are linked in a list sorted
+ *  by their labels, so that every node occupies 16 bytes, and the whole
+ *  trie is released by a single deallocation.
+ *
+ *  Since the children are sorted, the leaves and paths of the trie are
+ *  always enumerated in lexicographic order, independent of the order
+ *  in which the sequences have been added.
+ */
+class InputTrie
+{
+public:
+
+    /** Index of a node in the trie */
+    typedef uint32_t NodeId;
+
+    /** Index of the root node */
+    static const NodeId ROOT = 0;
+
+    /** Index returned when a node does not exist */
+    static const NodeId NONE = UINT32_MAX;
+
+private:
+
+    struct Node
+    {
+        /** Label of the edge leading from the parent to this node */
+        int label;
+        NodeId parent;
+        NodeId firstChild;
+        NodeId nextSibling;
+    };
+
+    std::vector<Node> nodes;
+
+    std::shared_ptr<FsmPresentationLayer> presentationLayer;
+
+    /** Copy the subtree below node n of trie t as children of node r */
+    void copyChildren(NodeId r, const InputTrie& t, NodeId n);
+
+    void addPrefixRelations(const InputTrie& a, NodeId na,
+                            const InputTrie& b, NodeId nb,
+                            std::vector<int>& path);
+
+public:
+
+    /** Create a trie consisting of the root only */
+    explicit InputTrie(const std::shared_ptr<FsmPresentationLayer>& presentationLayer);
+
+    /** Create a trie containing the same paths as tree */
+    explicit InputTrie(const Tree& tree);
+
+    /** Number of nodes, including the root */
+    size_t size() const { return nodes.size(); }
+
+    bool isLeaf(const NodeId n) const { return nodes[n].firstChild == NONE; }
+    int getLabel(const NodeId n) const { return nodes[n].label; }
+    NodeId getParent(const NodeId n) const { return nodes[n].parent; }
+    NodeId getFirstChild(const NodeId n) const { return nodes[n].firstChild; }
+    NodeId getNextSibling(const NodeId n) const { return nodes[n].nextSibling; }
+
+    /** Return the child of n reached by label x, or NONE */
+    NodeId after(const NodeId n, const int x) const;
+
+    /** Return the node reached from n by the sequence [begin,end), or NONE */
+    NodeId after(NodeId n,
+                 std::vector<int>::const_iterator begin,
+                 const std::vector<int>::const_iterator end) const;
+
+    /**
+     *  Return the child of n reached by label x,
+     *  creating it if it does not exist yet
+     */
+    NodeId addChild(const NodeId n, const int x);
+
+    /** Return the labels on the path from the root to n */
+    std::vector<int> getPath(NodeId n) const;
+
+    /** Return the leaves in lexicographic order of their paths */
+    std::vector<NodeId> getLeaves() const;
+
+    /** Append the sequence lst at node n, return the node reached */
+    NodeId addToNode(const NodeId n, const std::vector<int>& lst);
+
+    /** See Tree::addToRoot() */
+    NodeId addToRoot(const std::vector<int>& lst) { return addToNode(ROOT, lst); }
+    void addToRoot(const IOListContainer& tcl);
+
+    /** Append each sequence of tcl to EVERY node of the trie, see Tree::add() */
+    void add(const IOListContainer& tcl);
+
+    /** Add every path of otherTrie, see Tree::unionTree() */
+    void unionTree(const InputTrie& otherTrie);
+
+    /**
+     *  See Tree::tentativeAddToRoot()
+     *  @return 0 if alpha is already contained in the trie,
+     *          1 if adding alpha just extends a path at a leaf,
+     *          2 if adding alpha creates a new branch
+     */
+    int tentativeAddToRoot(const std::vector<int>& alpha) const;
+
+    /**
+     *  Create a copy of the subtree reached by alpha, see Tree::getSubTree().
+     *  @return nullptr if alpha does not lead to a node of the trie
+     */
+    std::shared_ptr<InputTrie> getSubTree(const std::vector<int>& alpha) const;
+
+    /**
+     *  Construct the prefix relation tree of the subtree below node a
+     *  of this trie and the subtree below node b of trie other,
+     *  see Tree::getPrefixRelationTree(). In contrast to the Tree
+     *  operation, no copies of the subtrees are needed, and the
+     *  calculation is linear in the size of the subtrees.
+     */
+    std::shared_ptr<InputTrie> getPrefixRelationTree(const NodeId a,
+                                                     const InputTrie& other,
+                                                     const NodeId b) const;
+
+    /** See Tree::getPrefixRelationTree() */
+    std::shared_ptr<InputTrie> getPrefixRelationTree(const InputTrie& other) const
+    {
+        return getPrefixRelationTree(ROOT, other, ROOT);
+    }
+
+    /** Return the paths from the root to all leaves, see Tree::getIOLists() */
+    IOListContainer getIOLists() const;
+
+    /** Create a Tree containing the same paths */
+    std::shared_ptr<Tree> toTree() const;
+
+};
+
+#endif //FSM_TREES_INPUTTRIE_H_
@@ -0,0 +1,31 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_TREES_TESTCASESINK_H_
+#define FSM_TREES_TESTCASESINK_H_
+
+#include <vector>
+
+/**
+ *  Receiver of the test cases produced by a test generation method
+ *  that does not materialise the complete test suite as an
+ *  IOListContainer, but hands each test case (an input sequence)
+ *  over as soon as it has been generated.
+ */
+class TestCaseSink
+{
+public:
+
+    virtual ~TestCaseSink() { }
+
+    /**
+     *  Accept the next test case. The referenced vector is only valid
+     *  during the call, so it must be copied if it is needed later.
+     */
+    virtual void push(const std::vector<int>& testCase) = 0;
+
+};
+
+#endif //FSM_TREES_TESTCASESINK_H_
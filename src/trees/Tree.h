@@ -80,6 +80,12 @@ public:
 	*/
 	std::shared_ptr<TreeNode> getRoot() const;
 
+	/**
+	Getter for the presentation layer of this tree
+	@return The presentation layer used by this tree
+	*/
+	std::shared_ptr<FsmPresentationLayer> getPresentationLayer() const { return presentationLayer; }
+
 	/**
      * Get vector of all I/O lists in the tree.
      * Each list is represented as a vector.
@@ -8,29 +8,51 @@ LogCoordinator &LogCoordinator::getStandardLogger() {
 
 LogCoordinator::LogCoordinator() : defaultStream(devNull) {
     this->devNull.setstate(std::ios::badbit);
+    this->updateEnabled();
 }
 
 LogCoordinator::LogCoordinator(LogCoordinator &&other) : defaultStream(devNull) {
     this->devNull.setstate(std::ios::badbit);
     std::swap(this->streams, other.streams);
+    this->updateEnabled();
+}
+
+void LogCoordinator::updateEnabled() {
+    // Channels without a log target will be bound to the default stream
+    for(int id = 0; id < NUM_CHANNELS; ++id) {
+        auto it = this->streams.find(channelName(id));
+        std::ostream &stream = (it != this->streams.end()) ? it->second.get() : this->defaultStream.get();
+        this->enabled[id] = (&stream != &this->devNull);
+    }
 }
 
 void LogCoordinator::createLogTargetAndBind(std::string const &name, std::ostream &stream) {
+    std::lock_guard<std::mutex> lock(this->mtx);
     if(this->streams.count(name) == 0) {
         this->streams.emplace(std::piecewise_construct, std::tuple<std::string const &>(name), std::tuple<std::ostream &>(stream));
+        this->updateEnabled();
     }
 }
 
 void LogCoordinator::createLogTarget(std::string const &name) {
-    this->createLogTargetAndBind(name, this->defaultStream);
+    this->operator[](name);
 }
 
 void LogCoordinator::setDefaultStream(std::ostream &stream) {
+    std::lock_guard<std::mutex> lock(this->mtx);
     this->defaultStream = stream;
+    this->updateEnabled();
 }
 
 void LogCoordinator::bindToStream(std::string const &name, std::ostream &stream) {
-    this->operator[](name) = stream;
+    std::lock_guard<std::mutex> lock(this->mtx);
+    auto it = this->streams.find(name);
+    if(it == this->streams.end()) {
+        this->streams.emplace(std::piecewise_construct, std::tuple<std::string const &>(name), std::tuple<std::ostream &>(stream));
+    } else {
+        it->second = stream;
+    }
+    this->updateEnabled();
 }
 
 void LogCoordinator::bindToDevNull(std::string const &name) {
@@ -38,24 +60,37 @@ void LogCoordinator::bindToDevNull(std::string const &name) {
 }
 
 void LogCoordinator::bindAllToStream(std::ostream &stream) {
-    this->setDefaultStream(stream);
+    std::lock_guard<std::mutex> lock(this->mtx);
+    this->defaultStream = stream;
     for(auto &kvp : this->streams) {
-        this->bindToStream(kvp.first, stream);
+        kvp.second = stream;
     }
+    this->updateEnabled();
 }
 
 void LogCoordinator::bindAllToDevNull() {
     this->bindAllToStream(this->devNull);
 }
 
+void LogCoordinator::write(int id, std::string const &message) {
+    std::lock_guard<std::mutex> lock(this->mtx);
+    auto it = this->streams.find(channelName(id));
+    std::ostream &stream = (it != this->streams.end()) ? it->second.get() : this->defaultStream.get();
+    stream << message;
+    stream.flush();
+}
+
 std::reference_wrapper<std::ostream> &LogCoordinator::operator[](std::string const &name) {
+    std::lock_guard<std::mutex> lock(this->mtx);
     if(this->streams.count(name) == 0) {
-        this->createLogTarget(name);
+        this->streams.emplace(std::piecewise_construct, std::tuple<std::string const &>(name), std::tuple<std::ostream &>(this->defaultStream.get()));
+        this->updateEnabled();
     }
     return this->streams.at(name);
 }
 
 std::ostream &LogCoordinator::operator[](std::string const &name) const {
+    std::lock_guard<std::mutex> lock(this->mtx);
     return this->streams.at(name).get();
 }
 
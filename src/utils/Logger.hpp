@@ -1,13 +1,70 @@
 #ifndef __FSMLIB_CPP_UTILS_LOGGER_HPP__
 #define __FSMLIB_CPP_UTILS_LOGGER_HPP__
 
+#include <atomic>
 #include <functional>
 #include <ostream>
 #include <map>
+#include <mutex>
 #include <sstream>
+#include <string>
 
 class LogCoordinator {
 public:
+    /**
+     * Channels which can be used with the LOG macro, ordered by
+     * increasing verbosity. They are identified by their names
+     * "FATAL", "ERROR", "WARNING", "INFO", "DEBUG" and
+     * "VERBOSE_1" .. "VERBOSE_9".
+     */
+    enum {
+        CHANNEL_FATAL,
+        CHANNEL_ERROR,
+        CHANNEL_WARNING,
+        CHANNEL_INFO,
+        CHANNEL_DEBUG,
+        CHANNEL_VERBOSE_1,
+        CHANNEL_VERBOSE_9 = CHANNEL_VERBOSE_1 + 8,
+        NUM_CHANNELS
+    };
+
+    /** Name of channel id */
+    static constexpr const char *channelName(int id) {
+        return id == CHANNEL_FATAL ? "FATAL" :
+               id == CHANNEL_ERROR ? "ERROR" :
+               id == CHANNEL_WARNING ? "WARNING" :
+               id == CHANNEL_INFO ? "INFO" :
+               id == CHANNEL_DEBUG ? "DEBUG" :
+               id == CHANNEL_VERBOSE_1 ? "VERBOSE_1" :
+               id == CHANNEL_VERBOSE_1 + 1 ? "VERBOSE_2" :
+               id == CHANNEL_VERBOSE_1 + 2 ? "VERBOSE_3" :
+               id == CHANNEL_VERBOSE_1 + 3 ? "VERBOSE_4" :
+               id == CHANNEL_VERBOSE_1 + 4 ? "VERBOSE_5" :
+               id == CHANNEL_VERBOSE_1 + 5 ? "VERBOSE_6" :
+               id == CHANNEL_VERBOSE_1 + 6 ? "VERBOSE_7" :
+               id == CHANNEL_VERBOSE_1 + 7 ? "VERBOSE_8" :
+               id == CHANNEL_VERBOSE_9 ? "VERBOSE_9" : "";
+    }
+
+    /** Id of the channel with the given name, -1 if there is no such channel */
+    static constexpr int channelId(char const *name, int id = 0) {
+        return id == NUM_CHANNELS ? -1 :
+               nameEquals(name, channelName(id)) ? id : channelId(name, id + 1);
+    }
+
+    /**
+     * Return true if the LOG statements of channel id are compiled.
+     * If FSMLIB_STRIP_VERBOSE_LOGGING is defined, the VERBOSE channels
+     * are removed at compile time.
+     */
+    static constexpr bool isCompiledIn(int id) {
+#ifdef FSMLIB_STRIP_VERBOSE_LOGGING
+        return id < CHANNEL_VERBOSE_1;
+#else
+        return id >= 0;
+#endif
+    }
+
     static LogCoordinator &getStandardLogger();
 
     void setDefaultStream(std::ostream &);
@@ -23,19 +80,85 @@ public:
     void bindAllToStream(std::ostream &);
     void bindAllToDevNull();
 
+    /**
+     * Return false if the messages of channel id would be written
+     * to devNull, so that they need not be formatted at all.
+     */
+    bool isEnabled(int id) const {
+        return this->enabled[id].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Write a formatted message to the stream of channel id and
+     * flush it, holding a lock, so that messages of different
+     * threads are not interleaved. Channels without a log target
+     * are written to the default stream; no target is created.
+     */
+    void write(int id, std::string const &message);
+
+    /**
+     * Access to the stream of a log target. Rebinding the returned
+     * reference bypasses isEnabled(), use bindToStream() instead.
+     * The lookup holds the same lock as write() and the binding
+     * functions; the non-const variant creates a missing target.
+     */
     std::reference_wrapper<std::ostream> &operator[](std::string const &);
     std::ostream &operator[](std::string const&) const;
 protected:
     LogCoordinator();
     LogCoordinator(LogCoordinator&&);
-    
+
+    static constexpr bool nameEquals(char const *a, char const *b) {
+        return *a == *b && (*a == 0 || nameEquals(a + 1, b + 1));
+    }
+
+    /** Recalculate the enabled flags, the lock must be held */
+    void updateEnabled();
+
     std::map<std::string, std::reference_wrapper<std::ostream>> streams;
     std::ostringstream devNull;
     std::reference_wrapper<std::ostream> defaultStream;
+    std::atomic<bool> enabled[NUM_CHANNELS];
+    mutable std::mutex mtx;
+};
+
+/** Compile-time id of a channel name, rejecting unknown names */
+template <int id>
+struct LogChannelId {
+    static_assert(id >= 0, "unknown log channel");
+    static const int value = id;
+};
+
+/**
+ * A single message, formatted into a buffer of the logging thread
+ * and written to its channel when the message is destroyed at the
+ * end of the LOG statement.
+ */
+class LogMessage {
+public:
+    explicit LogMessage(int id) : id(id) { }
+    ~LogMessage() {
+        // Written and flushed as a whole, so that the message is visible immediately
+        LogCoordinator::getStandardLogger().write(this->id, this->buffer.str());
+    }
+    std::ostream &stream() {
+        return this->buffer;
+    }
+private:
+    int id;
+    std::ostringstream buffer;
 };
 
 #define LOG_CONST(x) const_cast<LogCoordinator const&>(LogCoordinator::getStandardLogger())[(x)]
-#define LOG(x) (LogCoordinator::getStandardLogger()[(x)].get())
 
-#endif //__FSMLIB_CPP_UTILS_LOGGER_HPP__
+/**
+ * Stream a message to channel x, which must be one of the channel names
+ * listed in LogCoordinator. The operands following LOG(x) are not
+ * evaluated if the channel is bound to devNull or removed at compile time.
+ */
+#define LOG(x) \
+    if (!LogCoordinator::isCompiledIn(LogChannelId<LogCoordinator::channelId(x)>::value) || \
+        !LogCoordinator::getStandardLogger().isEnabled(LogChannelId<LogCoordinator::channelId(x)>::value)) ; \
+    else LogMessage(LogChannelId<LogCoordinator::channelId(x)>::value).stream()
 
+#endif //__FSMLIB_CPP_UTILS_LOGGER_HPP__
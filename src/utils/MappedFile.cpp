@@ -0,0 +1,65 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include "utils/MappedFile.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define FSMLIB_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& fname):
+    base(nullptr), length(0)
+{
+#ifdef FSMLIB_HAVE_MMAP
+    int fd = open(fname.c_str(), O_RDONLY);
+    if ( fd < 0 ) {
+        throw std::runtime_error("Could not open file " + fname);
+    }
+
+    struct stat st;
+    if ( fstat(fd, &st) != 0 ) {
+        close(fd);
+        throw std::runtime_error("Could not determine size of file " + fname);
+    }
+    length = static_cast<size_t>(st.st_size);
+
+    // mmap() does not accept empty mappings
+    if ( length > 0 ) {
+        void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if ( p == MAP_FAILED ) {
+            close(fd);
+            throw std::runtime_error("Could not map file " + fname);
+        }
+        base = static_cast<const char*>(p);
+    }
+    close(fd);
+#else
+    std::ifstream in(fname, std::ios::binary);
+    if ( not in ) {
+        throw std::runtime_error("Could not open file " + fname);
+    }
+    buffer.assign(std::istreambuf_iterator<char>(in),
+                  std::istreambuf_iterator<char>());
+    base = buffer.data();
+    length = buffer.size();
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef FSMLIB_HAVE_MMAP
+    if ( base != nullptr ) {
+        munmap(const_cast<char*>(base), length);
+    }
+#endif
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef __FSMLIB_CPP_UTILS_MAPPEDFILE_HPP__
+#define __FSMLIB_CPP_UTILS_MAPPEDFILE_HPP__
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ *  Read-only view of the contents of a file.
+ *
+ *  On POSIX systems, the file is mapped into memory, so that its
+ *  contents are only loaded on demand by the operating system and
+ *  can be used in place without copying. On other systems, the
+ *  file is read into a buffer instead.
+ *
+ *  The mapped data stay valid as long as the MappedFile exists.
+ */
+class MappedFile {
+public:
+
+    /**
+     *  Map the file fname into memory.
+     *  @throws std::runtime_error if the file cannot be opened or mapped
+     */
+    explicit MappedFile(const std::string& fname);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /** Pointer to the first byte of the file */
+    const char* data() const { return base; }
+
+    /** Size of the file in bytes */
+    size_t size() const { return length; }
+
+private:
+    const char* base;
+    size_t length;
+
+    /** Contents of the file, if it could not be mapped */
+    std::vector<char> buffer;
+};
+
+#endif //__FSMLIB_CPP_UTILS_MAPPEDFILE_HPP__
@@ -0,0 +1,217 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include "utils/MaximalCliqueEnumerator.hpp"
+#include "utils/WorkStealingPool.hpp"
+
+#include <algorithm>
+#include <bitset>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+size_t count(const std::vector<uint64_t>& a)
+{
+    size_t c = 0;
+    for (uint64_t word : a)
+    {
+        c += std::bitset<64>(word).count();
+    }
+    return c;
+}
+
+size_t countIntersection(const std::vector<uint64_t>& a, const std::vector<uint64_t>& b)
+{
+    size_t c = 0;
+    for (size_t w = 0; w < a.size(); ++ w)
+    {
+        c += std::bitset<64>(a[w] & b[w]).count();
+    }
+    return c;
+}
+
+bool isEmpty(const std::vector<uint64_t>& a)
+{
+    for (uint64_t word : a)
+    {
+        if (word != 0) return false;
+    }
+    return true;
+}
+
+void setBit(std::vector<uint64_t>& a, const size_t i)
+{
+    a[i / 64] |= uint64_t(1) << (i % 64);
+}
+
+void clearBit(std::vector<uint64_t>& a, const size_t i)
+{
+    a[i / 64] &= ~(uint64_t(1) << (i % 64));
+}
+
+bool testBit(const std::vector<uint64_t>& a, const size_t i)
+{
+    return ((a[i / 64] >> (i % 64)) & 1) != 0;
+}
+
+/** Call f(i) for each bit i set in a, in ascending order */
+template<typename Function>
+void forEachBit(const std::vector<uint64_t>& a, Function f)
+{
+    for (size_t w = 0; w < a.size(); ++ w)
+    {
+        uint64_t word = a[w];
+        while (word != 0)
+        {
+            uint64_t lowest = word & (~word + 1);
+            f(w * 64 + (std::bitset<64>(lowest - 1).count()));
+            word ^= lowest;
+        }
+    }
+}
+
+}
+
+MaximalCliqueEnumerator::MaximalCliqueEnumerator(size_t numVertices):
+    numVertices(numVertices),
+    numWords((numVertices + 63) / 64),
+    adjacency(numVertices, Bitset((numVertices + 63) / 64, 0))
+{
+}
+
+void MaximalCliqueEnumerator::addEdge(size_t u, size_t v)
+{
+    if (u == v) return;
+    setBit(adjacency[u], v);
+    setBit(adjacency[v], u);
+}
+
+bool MaximalCliqueEnumerator::hasEdge(size_t u, size_t v) const
+{
+    return testBit(adjacency[u], v);
+}
+
+void MaximalCliqueEnumerator::expand(std::vector<size_t>& clique, Bitset& candidates, Bitset& excluded,
+                                     const CliqueCallback& report) const
+{
+    if (isEmpty(candidates))
+    {
+        if (isEmpty(excluded))
+        {
+            report(clique);
+        }
+        return;
+    }
+
+    // Pivot: vertex of candidates or excluded with most neighbours among the
+    // candidates; only candidates not adjacent to the pivot need to be tried
+    size_t pivot = 0;
+    size_t pivotNeighbours = 0;
+    bool first = true;
+    auto choosePivot = [&](size_t u) {
+        size_t n = countIntersection(candidates, adjacency[u]);
+        if (first || n > pivotNeighbours)
+        {
+            pivot = u;
+            pivotNeighbours = n;
+            first = false;
+        }
+    };
+    forEachBit(candidates, choosePivot);
+    forEachBit(excluded, choosePivot);
+
+    Bitset branches(numWords);
+    for (size_t w = 0; w < numWords; ++ w)
+    {
+        branches[w] = candidates[w] & ~adjacency[pivot][w];
+    }
+
+    Bitset nextCandidates(numWords);
+    Bitset nextExcluded(numWords);
+    forEachBit(branches, [&](size_t v) {
+        for (size_t w = 0; w < numWords; ++ w)
+        {
+            nextCandidates[w] = candidates[w] & adjacency[v][w];
+            nextExcluded[w] = excluded[w] & adjacency[v][w];
+        }
+        clique.push_back(v);
+        expand(clique, nextCandidates, nextExcluded, report);
+        clique.pop_back();
+        clearBit(candidates, v);
+        setBit(excluded, v);
+    });
+}
+
+void MaximalCliqueEnumerator::enumerate(const CliqueCallback& callback, unsigned int numThreads) const
+{
+    // Vertices of low degree first, so that the subproblems of the
+    // later vertices have few candidates left
+    std::vector<size_t> order(numVertices);
+    std::vector<size_t> degree(numVertices);
+    for (size_t v = 0; v < numVertices; ++ v)
+    {
+        order[v] = v;
+        degree[v] = count(adjacency[v]);
+    }
+    std::stable_sort(order.begin(), order.end(), [&degree](size_t a, size_t b) {
+        return degree[a] < degree[b];
+    });
+    std::vector<size_t> position(numVertices);
+    for (size_t i = 0; i < numVertices; ++ i)
+    {
+        position[order[i]] = i;
+    }
+
+    std::mutex mtx;
+    CliqueCallback report = [&](const std::vector<size_t>& clique) {
+        std::vector<size_t> sorted(clique);
+        std::sort(sorted.begin(), sorted.end());
+        std::lock_guard<std::mutex> lock(mtx);
+        callback(sorted);
+    };
+
+    auto task = [&](size_t i, unsigned int) {
+        size_t v = order[i];
+        Bitset candidates(numWords, 0);
+        Bitset excluded(numWords, 0);
+        forEachBit(adjacency[v], [&](size_t u) {
+            if (position[u] > i)
+            {
+                setBit(candidates, u);
+            }
+            else
+            {
+                setBit(excluded, u);
+            }
+        });
+        std::vector<size_t> clique { v };
+        expand(clique, candidates, excluded, report);
+    };
+
+    std::unique_ptr<WorkStealingPool> pool;
+    if (numThreads != 1)
+    {
+        pool.reset(new WorkStealingPool(numThreads));
+    }
+    if (pool && pool->getNumThreads() > 1)
+    {
+        pool->run(numVertices, task);
+    }
+    else
+    {
+        for (size_t i = 0; i < numVertices; ++ i) task(i, 0);
+    }
+}
+
+std::vector<std::vector<size_t>> MaximalCliqueEnumerator::getMaximalCliques(unsigned int numThreads) const
+{
+    std::vector<std::vector<size_t>> result;
+    enumerate([&result](const std::vector<size_t>& clique) {
+        result.push_back(clique);
+    }, numThreads);
+    std::sort(result.begin(), result.end());
+    return result;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef __FSMLIB_CPP_UTILS_MAXIMALCLIQUEENUMERATOR_HPP__
+#define __FSMLIB_CPP_UTILS_MAXIMALCLIQUEENUMERATOR_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ *  Enumerates the maximal cliques of an undirected graph on the
+ *  vertices 0..numVertices-1.
+ *
+ *  The adjacency of each vertex is stored as a bitset, and the cliques
+ *  are enumerated by the Bron-Kerbosch algorithm with pivoting (a pivot
+ *  with a maximal number of neighbours among the candidates is chosen).
+ *  At the top level, the vertices are processed in order of ascending
+ *  degree, and each vertex v yields an independent subproblem consisting
+ *  of the neighbours of v processed after v (candidates) and before v
+ *  (excluded). These subproblems are distributed over a WorkStealingPool
+ *  if more than one thread is requested.
+ */
+class MaximalCliqueEnumerator {
+public:
+
+    typedef std::function<void(const std::vector<size_t>&)> CliqueCallback;
+
+    explicit MaximalCliqueEnumerator(size_t numVertices);
+
+    size_t getNumVertices() const { return numVertices; }
+
+    /** Add the undirected edge {u,v}; self-loops are ignored */
+    void addEdge(size_t u, size_t v);
+
+    bool hasEdge(size_t u, size_t v) const;
+
+    /**
+     *  Call callback(clique) for each maximal clique, where clique lists
+     *  the vertices of the clique in ascending order. Each maximal clique
+     *  is reported exactly once, and the cliques are not stored, so that
+     *  the memory required does not depend on their number.
+     *
+     *  The callback is never called concurrently. If numThreads != 1,
+     *  the order in which the cliques are reported is unspecified.
+     *
+     *  @param numThreads Number of worker threads; if 0, the number
+     *         of hardware threads is used.
+     */
+    void enumerate(const CliqueCallback& callback, unsigned int numThreads = 1) const;
+
+    /** @return all maximal cliques, sorted lexicographically */
+    std::vector<std::vector<size_t>> getMaximalCliques(unsigned int numThreads = 1) const;
+
+private:
+    typedef std::vector<uint64_t> Bitset;
+
+    size_t numVertices;
+
+    /** Number of 64 bit words of a bitset over the vertices */
+    size_t numWords;
+
+    /** adjacency[u] is the set of neighbours of u */
+    std::vector<Bitset> adjacency;
+
+    void expand(std::vector<size_t>& clique, Bitset& candidates, Bitset& excluded,
+                const CliqueCallback& report) const;
+};
+
+#endif //__FSMLIB_CPP_UTILS_MAXIMALCLIQUEENUMERATOR_HPP__
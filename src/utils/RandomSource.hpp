@@ -0,0 +1,50 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef __FSMLIB_CPP_UTILS_RANDOMSOURCE_HPP__
+#define __FSMLIB_CPP_UTILS_RANDOMSOURCE_HPP__
+
+#include <cstdlib>
+#include <random>
+
+/**
+ *  Source of the pseudo random numbers used by the random generation
+ *  of FSMs: either the global generator of rand(), initialised by
+ *  srand(), or a std::mt19937 owned by the caller.
+ *
+ *  The global generator is shared by all threads. A std::mt19937 per
+ *  thread allows several FSMs to be generated concurrently, each of
+ *  them reproducible from the seed of its own generator.
+ */
+class RandomSource {
+public:
+
+    /** Draw numbers from rand() */
+    RandomSource() : gen(nullptr) { }
+
+    /** Draw numbers from gen, which must outlive this object */
+    explicit RandomSource(std::mt19937& gen) : gen(&gen) { }
+
+    /** Next number in range 0..RAND_MAX, as returned by rand() */
+    int operator()() {
+        if (gen == nullptr) return rand();
+        return static_cast<int>((*gen)() % (static_cast<unsigned long>(RAND_MAX) + 1));
+    }
+
+    /** Continue with a new seed taken from the current sequence */
+    void reseed() {
+        if (gen == nullptr) {
+            srand(static_cast<unsigned int>(rand()));
+        }
+        else {
+            gen->seed((*gen)());
+        }
+    }
+
+private:
+    std::mt19937* gen;
+};
+
+#endif //__FSMLIB_CPP_UTILS_RANDOMSOURCE_HPP__
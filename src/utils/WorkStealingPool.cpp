@@ -0,0 +1,121 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include "utils/WorkStealingPool.hpp"
+
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <atomic>
+
+namespace {
+
+/** Range of task numbers [next,end) owned by one worker */
+struct TaskRange {
+    std::mutex mtx;
+    size_t next = 0;
+    size_t end = 0;
+};
+
+}
+
+WorkStealingPool::WorkStealingPool(unsigned int numThreads):
+    numThreads(numThreads == 0 ? getHardwareThreads() : numThreads)
+{
+}
+
+unsigned int WorkStealingPool::getHardwareThreads() {
+    unsigned int n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+}
+
+void WorkStealingPool::run(size_t numTasks,
+                           const std::function<void(size_t, unsigned int)>& task) const {
+
+    if ( numTasks == 0 ) return;
+
+    size_t numWorkers = numThreads;
+    if ( numWorkers > numTasks ) numWorkers = numTasks;
+
+    if ( numWorkers <= 1 ) {
+        for ( size_t i = 0; i < numTasks; i++ ) task(i, 0);
+        return;
+    }
+
+    std::vector<std::unique_ptr<TaskRange>> ranges;
+    for ( size_t w = 0; w < numWorkers; w++ ) {
+        std::unique_ptr<TaskRange> r(new TaskRange());
+        r->next = numTasks * w / numWorkers;
+        r->end = numTasks * (w + 1) / numWorkers;
+        ranges.push_back(std::move(r));
+    }
+
+    std::atomic<bool> failed(false);
+    std::exception_ptr firstException;
+    std::mutex exceptionMtx;
+
+    auto worker = [&](const unsigned int w) {
+        TaskRange& own = *ranges[w];
+        while ( not failed ) {
+            size_t i;
+            {
+                std::lock_guard<std::mutex> lock(own.mtx);
+                if ( own.next < own.end ) {
+                    i = own.next++;
+                }
+                else {
+                    i = numTasks;
+                }
+            }
+
+            if ( i == numTasks ) {
+                // Steal the upper half of the largest remaining range
+                size_t victim = numWorkers;
+                size_t victimSize = 0;
+                for ( size_t v = 0; v < numWorkers; v++ ) {
+                    if ( v == w ) continue;
+                    std::lock_guard<std::mutex> lock(ranges[v]->mtx);
+                    size_t sz = ranges[v]->end - ranges[v]->next;
+                    if ( sz > victimSize ) {
+                        victim = v;
+                        victimSize = sz;
+                    }
+                }
+                if ( victim == numWorkers ) return;
+
+                std::lock(own.mtx, ranges[victim]->mtx);
+                std::lock_guard<std::mutex> lockOwn(own.mtx, std::adopt_lock);
+                std::lock_guard<std::mutex> lockVictim(ranges[victim]->mtx, std::adopt_lock);
+                TaskRange& v = *ranges[victim];
+                if ( v.next >= v.end ) continue;
+                size_t mid = v.next + (v.end - v.next) / 2;
+                own.next = mid;
+                own.end = v.end;
+                v.end = mid;
+                continue;
+            }
+
+            try {
+                task(i, w);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(exceptionMtx);
+                if ( not firstException ) firstException = std::current_exception();
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for ( size_t w = 1; w < numWorkers; w++ ) {
+        threads.push_back(std::thread(worker, static_cast<unsigned int>(w)));
+    }
+    worker(0);
+    for ( auto& t : threads ) t.join();
+
+    if ( firstException ) std::rethrow_exception(firstException);
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef __FSMLIB_CPP_UTILS_WORKSTEALINGPOOL_HPP__
+#define __FSMLIB_CPP_UTILS_WORKSTEALINGPOOL_HPP__
+
+#include <cstddef>
+#include <functional>
+
+/**
+ *  Executes a number of independent tasks 0..numTasks-1 on a
+ *  set of worker threads.
+ *
+ *  Each worker initially owns a contiguous range of task numbers and
+ *  processes them in ascending order. A worker that has run out of
+ *  tasks steals the last half of the remaining tasks of another worker.
+ *  This keeps the workers busy even if the tasks have very different
+ *  costs, while neighbouring tasks are still likely to be executed by
+ *  the same worker.
+ *
+ *  The task function must be thread-safe: it is called concurrently
+ *  for different task numbers. The worker number passed to the task
+ *  function can be used to access per-worker scratch data.
+ */
+class WorkStealingPool {
+public:
+
+    /**
+     *  @param numThreads Number of worker threads; if 0, the number
+     *         of hardware threads is used.
+     */
+    explicit WorkStealingPool(unsigned int numThreads = 0);
+
+    /** Number of worker threads used by run() */
+    unsigned int getNumThreads() const { return numThreads; }
+
+    /**
+     *  Execute task(i, worker) for every i in 0..numTasks-1, where
+     *  worker is in range 0..getNumThreads()-1. Returns when all
+     *  tasks have been executed. If a task throws an exception, the
+     *  remaining tasks are skipped and the first exception is
+     *  re-thrown by run().
+     */
+    void run(size_t numTasks,
+             const std::function<void(size_t, unsigned int)>& task) const;
+
+    /** Number of hardware threads, at least 1 */
+    static unsigned int getHardwareThreads();
+
+private:
+    unsigned int numThreads;
+};
+
+#endif //__FSMLIB_CPP_UTILS_WORKSTEALINGPOOL_HPP__
@@ -2,6 +2,8 @@
 #define __FSM_LIB_GENERIC_EQUIVALENCE_CLASS_CALCULATION_HPP__
 
 #include <set>
+#include <map>
+#include <unordered_map>
 #include <algorithm>
 #include <type_traits>
 #include <vector>
@@ -87,6 +89,113 @@ std::vector<typename std::decay<StateCollectionType>::type> createInitialPartiti
 }
 
 
+//Indexed variant of fixpoint(refineStatePartitioning, prePartitioning, symbolSet, transitionFunction).
+//States are numbered once and the transition function is evaluated once per state and symbol.
+//Each round then assigns a class id to each state by hashing its signature, consisting of
+//its current class id and the sets of class ids reached by each symbol, and the fixpoint
+//is reached as soon as a round does not increase the number of classes.
+//Unlike refineStatePartitioning, states of different classes of the pre-partitioning are never
+//put into the same class, so that the result is always a refinement of prePartitioning.
+//Apart from that, the classes and their order are the same as in the non-indexed variant.
+//In addition to the requirements of refineStatePartitioning, states must be comparable by operator<.
+template<typename StateEquivalencePartitioningType, typename SymbolContainerType, typename TransitionFunctionType>
+typename std::decay<StateEquivalencePartitioningType>::type
+refineStatePartitioningIndexed(StateEquivalencePartitioningType &&prePartitioning,
+                               SymbolContainerType &&symbolSet,
+                               TransitionFunctionType &&transitionFunction) {
+    typedef typename std::decay<StateEquivalencePartitioningType>::type PartitioningType;
+    typedef typename std::decay<decltype(*std::declval<StateEquivalencePartitioningType>().begin())>::type PartitionType;
+    typedef typename std::decay<decltype(*std::declval<PartitionType>().begin())>::type StateType;
+
+    //Number the states in order of their occurrence in the pre-partitioning
+    std::vector<StateType> states;
+    std::vector<size_t> classOf;
+    std::map<StateType, size_t> indexOf;
+    size_t numClasses = 0;
+    for(auto const &partition : prePartitioning) {
+        for(auto const &state : partition) {
+            indexOf.emplace(state, states.size());
+            states.push_back(state);
+            classOf.push_back(numClasses);
+        }
+        ++numClasses;
+    }
+
+    //Successors of each state for each symbol, states outside of the partitioning are mapped to outside
+    size_t const outside = states.size();
+    std::vector<std::vector<std::vector<size_t>>> successors(states.size());
+    for(size_t index = 0; index < states.size(); ++index) {
+        for(auto const &symbol : symbolSet) {
+            std::vector<size_t> successorIndices;
+            for(auto const &postState : transitionFunction(states[index], symbol)) {
+                auto entry = indexOf.find(postState);
+                successorIndices.push_back(entry == indexOf.end() ? outside : entry->second);
+            }
+            successors[index].emplace_back(std::move(successorIndices));
+        }
+    }
+
+    //Hash of the signature of a state, local to this function
+    struct StateSignatureHash {
+        size_t operator()(std::vector<size_t> const &signature) const {
+            size_t hash = signature.size();
+            for(auto const &entry : signature) {
+                hash ^= entry + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+            }
+            return hash;
+        }
+    };
+
+    std::vector<std::vector<size_t>> members;
+    std::unordered_map<std::vector<size_t>, size_t, StateSignatureHash> classOfSignature;
+    std::vector<size_t> signature;
+    std::vector<size_t> reachedClasses;
+    size_t previousNumClasses;
+    do {
+        previousNumClasses = numClasses;
+
+        members.assign(numClasses, std::vector<size_t>());
+        for(size_t index = 0; index < states.size(); ++index) {
+            members[classOf[index]].push_back(index);
+        }
+
+        //Visiting the classes in order of their ids keeps the order of the non-indexed variant
+        classOfSignature.clear();
+        std::vector<size_t> nextClassOf(states.size());
+        for(auto const &classMembers : members) {
+            for(auto const &index : classMembers) {
+                signature.assign(1, classOf[index]);
+                for(auto const &successorIndices : successors[index]) {
+                    reachedClasses.clear();
+                    for(auto const &successor : successorIndices) {
+                        reachedClasses.push_back(successor == outside ? outside : classOf[successor]);
+                    }
+                    std::sort(reachedClasses.begin(), reachedClasses.end());
+                    reachedClasses.erase(std::unique(reachedClasses.begin(), reachedClasses.end()), reachedClasses.end());
+                    signature.push_back(reachedClasses.size());
+                    signature.insert(signature.end(), reachedClasses.begin(), reachedClasses.end());
+                }
+                nextClassOf[index] = classOfSignature.emplace(signature, classOfSignature.size()).first->second;
+            }
+        }
+        classOf.swap(nextClassOf);
+        numClasses = classOfSignature.size();
+    } while(numClasses != previousNumClasses);
+
+    std::vector<PartitionType> partitions(numClasses);
+    for(size_t index = 0; index < states.size(); ++index) {
+        auto inserter = std::inserter(partitions[classOf[index]], partitions[classOf[index]].end());
+        *inserter = states[index];
+    }
+    PartitioningType partitioning;
+    auto inserter = std::inserter(partitioning, partitioning.end());
+    for(auto &partition : partitions) {
+        *inserter = std::move(partition);
+    }
+    return partitioning;
+}
+
+
 template<typename Data, typename Fn, typename... Args>
 typename std::decay<Data>::type fixpoint(Fn &&function, Data &&initialData, Args&& ...additionalArgs) {
     typedef typename std::decay<Data>::type DataType;